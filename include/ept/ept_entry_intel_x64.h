@@ -0,0 +1,359 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef EPT_ENTRY_INTEL_X64_H
+#define EPT_ENTRY_INTEL_X64_H
+
+#include <bfgsl.h>
+
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EPT
+#ifdef SHARED_EPT
+#define EXPORT_EPT EXPORT_SYM
+#else
+#define EXPORT_EPT IMPORT_SYM
+#endif
+#else
+#define EXPORT_EPT
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+// *INDENT-OFF*
+
+namespace intel_x64
+{
+namespace ept
+{
+    using access_type = uint64_t;
+
+    namespace access
+    {
+        constexpr const auto none                   = 0x0ULL;
+        constexpr const auto read                   = 0x1ULL;
+        constexpr const auto write                  = 0x2ULL;
+        constexpr const auto execute                = 0x4ULL;
+        constexpr const auto read_write             = 0x3ULL;
+        constexpr const auto read_execute           = 0x5ULL;
+        constexpr const auto read_write_execute     = 0x7ULL;
+    }
+}
+}
+
+// *INDENT-ON*
+
+// -----------------------------------------------------------------------------
+// Definition
+// -----------------------------------------------------------------------------
+
+/// EPT Entry
+///
+/// Encapsulates an EPT paging-structure entry (see the Intel SDM, section
+/// 28.2.2). The same class is used for entries that point to a table, and
+/// for entries that map a page. Memory type, ignore PAT and dirty are only
+/// valid for entries that map a page.
+///
+class EXPORT_EPT ept_entry_intel_x64
+{
+public:
+
+    using pointer = uintptr_t *;
+    using integer_pointer = uintptr_t;
+    using access_type = intel_x64::ept::access_type;
+    using memory_type = uint64_t;
+
+    /// EPTE Constructor
+    ///
+    /// @expects epte != nullptr
+    /// @ensures none
+    ///
+    /// @param epte the epte that this EPT entry encapsulates.
+    ///
+    ept_entry_intel_x64(gsl::not_null<pointer> epte) noexcept;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~ept_entry_intel_x64() = default;
+
+    /// Present
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if any access is allowed, false otherwise
+    ///
+    bool present() const noexcept;
+
+    /// Read Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if reads are allowed, false otherwise
+    ///
+    bool read() const noexcept;
+
+    /// Set Read Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if reads are allowed, false otherwise
+    ///
+    void set_read(bool enabled) noexcept;
+
+    /// Write Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if writes are allowed, false otherwise
+    ///
+    bool write() const noexcept;
+
+    /// Set Write Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if writes are allowed, false otherwise
+    ///
+    void set_write(bool enabled) noexcept;
+
+    /// Execute Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if instruction fetches are allowed, false otherwise
+    ///
+    bool execute() const noexcept;
+
+    /// Set Execute Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if instruction fetches are allowed, false
+    ///     otherwise
+    ///
+    void set_execute(bool enabled) noexcept;
+
+    /// Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the read / write / execute bits (see intel_x64::ept::access)
+    ///
+    access_type access() const noexcept;
+
+    /// Set Access
+    ///
+    /// @expects access <= intel_x64::ept::access::read_write_execute
+    /// @ensures none
+    ///
+    /// @param access the read / write / execute bits (see
+    ///     intel_x64::ept::access)
+    ///
+    void set_access(access_type access);
+
+    /// Memory Type
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the memory type of the page
+    ///
+    memory_type mem_type() const noexcept;
+
+    /// Set Memory Type
+    ///
+    /// @expects type is a valid EPT memory type (UC, WC, WT, WP or WB)
+    /// @ensures none
+    ///
+    /// @param type the memory type of the page (see x64::memory_type)
+    ///
+    void set_mem_type(memory_type type);
+
+    /// Ignore PAT
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the guest's PAT is ignored, false otherwise
+    ///
+    bool ignore_pat() const noexcept;
+
+    /// Set Ignore PAT
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if the guest's PAT is ignored, false otherwise
+    ///
+    void set_ignore_pat(bool enabled) noexcept;
+
+    /// Large Page
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if this entry maps a 1g / 2m page, false otherwise
+    ///
+    bool large_page() const noexcept;
+
+    /// Set Large Page
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if this entry maps a 1g / 2m page, false
+    ///     otherwise
+    ///
+    void set_large_page(bool enabled) noexcept;
+
+    /// Accessed
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if this entry has been accessed, false otherwise
+    ///
+    bool accessed() const noexcept;
+
+    /// Set Accessed
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if this entry has been accessed, false otherwise
+    ///
+    void set_accessed(bool enabled) noexcept;
+
+    /// Dirty
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the page is dirty, false otherwise
+    ///
+    bool dirty() const noexcept;
+
+    /// Set Dirty
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if the page is dirty, false otherwise
+    ///
+    void set_dirty(bool enabled) noexcept;
+
+    /// Physical Address
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the physical address of the page / table
+    ///
+    integer_pointer phys_addr() const noexcept;
+
+    /// Set Physical Address
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the physical address of the page / table
+    ///
+    void set_phys_addr(integer_pointer addr) noexcept;
+
+    /// Suppress #VE
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if EPT violations cause VM exits instead of #VE,
+    ///     false otherwise
+    ///
+    bool suppress_ve() const noexcept;
+
+    /// Set Suppress #VE
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if EPT violations cause VM exits instead of
+    ///     #VE, false otherwise
+    ///
+    void set_suppress_ve(bool enabled) noexcept;
+
+    /// Get
+    ///
+    /// @expects none
+    /// @ensures ret != nullptr
+    ///
+    /// @return the epte that this EPT entry encapsulates
+    ///
+    pointer get() const noexcept
+    { return m_epte; }
+
+    /// Clear EPTE
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void clear() noexcept;
+
+private:
+
+    pointer m_epte;
+
+public:
+
+    ept_entry_intel_x64(ept_entry_intel_x64 &&) noexcept = default;
+    ept_entry_intel_x64 &operator=(ept_entry_intel_x64 &&) noexcept = default;
+
+    ept_entry_intel_x64(const ept_entry_intel_x64 &) = delete;
+    ept_entry_intel_x64 &operator=(const ept_entry_intel_x64 &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,300 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef EPT_INTEL_X64_H
+#define EPT_INTEL_X64_H
+
+#include <bfgsl.h>
+
+#include <mutex>
+#include <bitset>
+#include <memory>
+#include <cstdint>
+
+#include <ept/mtrr_intel_x64.h>
+#include <ept/ept_entry_intel_x64.h>
+#include <memory_manager/page_table_x64.h>
+
+#include <intrinsics/x86/common_x64.h>
+#include <intrinsics/x86/intel/per_cpu_intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EPT
+#ifdef SHARED_EPT
+#define EXPORT_EPT EXPORT_SYM
+#else
+#define EXPORT_EPT IMPORT_SYM
+#endif
+#else
+#define EXPORT_EPT
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// Extended Page Tables
+///
+/// Maps guest-physical memory to host-physical memory. The tables use the
+/// same layout as the x64 page tables, and are built using page_table_x64,
+/// with EPT entries in place of x64 entries. Mapping or unmapping a page
+/// inside a larger page splits the larger page into smaller pages with
+/// the same address, access rights and memory type, so the rest of it
+/// stays mapped.
+///
+/// The EPT pointer is computed once, as the root of the tables never moves.
+/// Each time a present entry is changed or removed, an INVEPT is needed.
+/// Instead of executing an INVEPT for each change, the EPT records that a
+/// flush is pending, and flush() (which the exit handler calls before each
+/// VM entry) executes a single INVEPT for all of the changes that were
+/// made. INVEPT only invalidates the TLB of the CPU that executes it, and
+/// the same tables can be in use on several CPUs (e.g. by the vCPUs of a
+/// guest), so the pending flush is recorded for every CPU, and each CPU
+/// clears its own when it flushes.
+///
+class EXPORT_EPT ept_intel_x64
+{
+public:
+
+    using integer_pointer = uintptr_t;
+    using eptp_type = uint64_t;
+    using size_type = uint64_t;
+    using access_type = ept_entry_intel_x64::access_type;
+    using memory_type = ept_entry_intel_x64::memory_type;
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ept_intel_x64();
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual ~ept_intel_x64() = default;
+
+    /// EPTP
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the value of the VMCS EPT pointer field that points to
+    ///     these tables
+    ///
+    virtual eptp_type eptp() const noexcept
+    { return m_eptp; }
+
+    /// Map (1 Gigabyte)
+    ///
+    /// Maps 1 gigabyte of guest-physical memory to host-physical memory.
+    ///
+    /// @expects gpa and hpa are 1g aligned
+    /// @ensures none
+    ///
+    /// @param gpa the guest-physical address to map
+    /// @param hpa the host-physical address to map gpa to
+    /// @param access the access rights of the mapping
+    /// @param type the memory type of the mapping
+    ///
+    virtual void map_1g(
+        integer_pointer gpa, integer_pointer hpa, access_type access, memory_type type)
+    { this->map_page(gpa, hpa, access, type, x64::page_table::pdpt::size_bytes); }
+
+    /// Map (2 Megabytes)
+    ///
+    /// Maps 2 megabytes of guest-physical memory to host-physical memory.
+    ///
+    /// @expects gpa and hpa are 2m aligned
+    /// @ensures none
+    ///
+    /// @param gpa the guest-physical address to map
+    /// @param hpa the host-physical address to map gpa to
+    /// @param access the access rights of the mapping
+    /// @param type the memory type of the mapping
+    ///
+    virtual void map_2m(
+        integer_pointer gpa, integer_pointer hpa, access_type access, memory_type type)
+    { this->map_page(gpa, hpa, access, type, x64::page_table::pd::size_bytes); }
+
+    /// Map (4 Kilobytes)
+    ///
+    /// Maps 4 kilobytes of guest-physical memory to host-physical memory.
+    ///
+    /// @expects gpa and hpa are 4k aligned
+    /// @ensures none
+    ///
+    /// @param gpa the guest-physical address to map
+    /// @param hpa the host-physical address to map gpa to
+    /// @param access the access rights of the mapping
+    /// @param type the memory type of the mapping
+    ///
+    virtual void map_4k(
+        integer_pointer gpa, integer_pointer hpa, access_type access, memory_type type)
+    { this->map_page(gpa, hpa, access, type, x64::page_table::pt::size_bytes); }
+
+    /// Unmap
+    ///
+    /// Unmaps the 4k page that contains gpa. A 1g or 2m page that
+    /// contains gpa is split into smaller pages first, so the rest of it
+    /// stays mapped.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest-physical address to unmap
+    ///
+    virtual void unmap(integer_pointer gpa) noexcept;
+
+    /// Setup Identity Map
+    ///
+    /// Identity maps [saddr, eaddr) using the largest pages possible. A
+    /// 1g or 2m page is used when the range covers it, the hardware
+    /// supports it, and the MTRRs give the whole page a single memory
+    /// type. Everything else is mapped using 4k pages.
+    ///
+    /// @expects saddr and eaddr are 4k aligned
+    /// @ensures none
+    ///
+    /// @param saddr the starting address of the identity map
+    /// @param eaddr the ending address of the identity map
+    /// @param access the access rights of the identity map
+    ///
+    void setup_identity_map(
+        integer_pointer saddr, integer_pointer eaddr,
+        access_type access = intel_x64::ept::access::read_write_execute);
+
+    /// Guest-Physical Address To EPT Entry
+    ///
+    /// Locates the EPT entry that maps gpa. Note that unmapping the page
+    /// invalidates the entry returned by this function.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest-physical address to look up
+    /// @return the EPT entry that maps gpa
+    ///
+    ept_entry_intel_x64 gpa_to_epte(integer_pointer gpa) const;
+
+    /// Is Mapped
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest-physical address to look up
+    /// @return true if gpa is mapped, false otherwise
+    ///
+    bool is_mapped(integer_pointer gpa) const;
+
+    /// Memory Type
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest-physical address to look up
+    /// @return the memory type the MTRRs give the 4k page that contains
+    ///     gpa, which is what setup_identity_map() uses
+    ///
+    memory_type mtrr_type(integer_pointer gpa) const
+    { return m_mtrrs.type(gpa); }
+
+    /// Flush
+    ///
+    /// Invalidates the translations the CPU this is called on derived
+    /// from these tables, if they were changed since this CPU last
+    /// flushed them. Uses a single-context INVEPT when supported, and a
+    /// global INVEPT otherwise.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual void flush();
+
+    /// Is Flush Pending
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if these tables were changed since the CPU this is
+    ///     called on last flushed them
+    ///
+    bool is_flush_pending() const noexcept;
+
+    /// Is Supported
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the CPU supports EPT with a 4 level page walk,
+    ///     a supported EPTP memory type and INVEPT
+    ///
+    static bool is_supported();
+
+private:
+
+    void map_page(integer_pointer gpa, integer_pointer hpa, access_type access,
+                  memory_type type, size_type size);
+
+    bool is_present(integer_pointer gpa) const;
+
+    static void init_ept_entry(page_table_x64::pointer epte, integer_pointer phys);
+    static void split_ept_entry(page_table_x64::pointer epte, integer_pointer large,
+                                integer_pointer offset, bool is_large);
+
+private:
+
+    integer_pointer m_root{0};
+    eptp_type m_eptp{0};
+
+    std::bitset<intel_x64::per_cpu::max_cpus> m_flush_pending;
+
+    mtrr_intel_x64 m_mtrrs;
+    std::unique_ptr<page_table_x64> m_pt;
+
+    mutable std::mutex m_mutex;
+
+public:
+
+    ept_intel_x64(ept_intel_x64 &&) noexcept = delete;
+    ept_intel_x64 &operator=(ept_intel_x64 &&) noexcept = delete;
+
+    ept_intel_x64(const ept_intel_x64 &) = delete;
+    ept_intel_x64 &operator=(const ept_intel_x64 &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef MTRR_INTEL_X64_H
+#define MTRR_INTEL_X64_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EPT
+#ifdef SHARED_EPT
+#define EXPORT_EPT EXPORT_SYM
+#else
+#define EXPORT_EPT IMPORT_SYM
+#endif
+#else
+#define EXPORT_EPT
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// MTRRs
+///
+/// A snapshot of the MTRRs of the CPU that created it, used to decide
+/// the memory type of guest-physical memory. Once EPT is enabled, the CPU
+/// uses the memory type in the EPT instead of the MTRRs (which are left
+/// to the guest), while the guest's PAT still applies on top of it. An
+/// identity map that uses the MTRR memory type therefore ends up with
+/// the same effective memory types the guest had without EPT.
+///
+/// When more than one variable range covers an address, the memory type
+/// is decided as described by the Intel SDM (section 11.11.4.1), and
+/// combinations the SDM leaves undefined are UC.
+///
+class EXPORT_EPT mtrr_intel_x64
+{
+public:
+
+    using integer_pointer = uintptr_t;
+    using size_type = uint64_t;
+    using memory_type = uint64_t;
+
+    /// Mixed
+    ///
+    /// Returned by range_type() when the range does not have a single
+    /// memory type.
+    ///
+    static constexpr const memory_type mixed = 0xFF;
+
+    /// Number of Fixed Ranges
+    ///
+    /// 8 64k ranges, 16 16k ranges and 64 4k ranges, which cover the
+    /// first megabyte of physical memory.
+    ///
+    static constexpr const size_type num_fixed_ranges = 88;
+
+    /// Default Constructor
+    ///
+    /// Reads the MTRRs of the current CPU.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    mtrr_intel_x64();
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~mtrr_intel_x64() = default;
+
+    /// Memory Type
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the physical address to look up
+    /// @return the memory type of the 4k page that contains addr
+    ///
+    memory_type type(integer_pointer addr) const
+    { return range_type(addr & ~0xFFFULL, 0x1000); }
+
+    /// Range Memory Type
+    ///
+    /// @expects size is a power of 2, and size >= 4k
+    /// @expects addr is aligned to size
+    /// @ensures none
+    ///
+    /// @param addr the physical address of the range
+    /// @param size the size of the range
+    /// @return the memory type of the range, or mixed if the range does
+    ///     not have a single memory type
+    ///
+    memory_type range_type(integer_pointer addr, size_type size) const;
+
+private:
+
+    memory_type variable_type(integer_pointer addr, size_type size) const noexcept;
+
+private:
+
+    struct variable_range_type
+    {
+        integer_pointer base;
+        integer_pointer mask;
+        memory_type type;
+    };
+
+    bool m_enabled{false};
+    bool m_fixed_enabled{false};
+    memory_type m_default_type{0};
+
+    std::array<memory_type, num_fixed_ranges> m_fixed{};
+    std::vector<variable_range_type> m_variable;
+
+public:
+
+    mtrr_intel_x64(mtrr_intel_x64 &&) noexcept = default;
+    mtrr_intel_x64 &operator=(mtrr_intel_x64 &&) noexcept = default;
+
+    mtrr_intel_x64(const mtrr_intel_x64 &) = default;
+    mtrr_intel_x64 &operator=(const mtrr_intel_x64 &) = default;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
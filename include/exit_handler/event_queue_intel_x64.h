@@ -0,0 +1,341 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef EVENT_QUEUE_INTEL_X64_H
+#define EVENT_QUEUE_INTEL_X64_H
+
+#include <vector>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EXIT_HANDLER
+#ifdef SHARED_EXIT_HANDLER
+#define EXPORT_EXIT_HANDLER EXPORT_SYM
+#else
+#define EXPORT_EXIT_HANDLER IMPORT_SYM
+#endif
+#else
+#define EXPORT_EXIT_HANDLER
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// Pending Event
+///
+/// An event waiting to be injected into the guest.
+///
+/// - vector: the event's vector
+/// - type: the interruption type (as defined by the VM-entry interruption
+///   information field)
+/// - error_code: the error code to deliver (if error_code_valid)
+/// - instruction_length: the length of the instruction that caused a
+///   software interrupt / exception
+///
+struct pending_event_t
+{
+    uint64_t vector;
+    uint64_t type;
+    uint64_t error_code;
+    bool error_code_valid;
+    uint64_t instruction_length;
+};
+
+// -----------------------------------------------------------------------------
+// Event Queue
+// -----------------------------------------------------------------------------
+
+/// Event Queue
+///
+/// Holds the events (exceptions, NMIs and external interrupts) that are
+/// waiting to be injected into the guest, and injects them one at a time,
+/// as the guest becomes able to take them.
+///
+/// Events are ordered the way the CPU prioritizes them: exceptions (in the
+/// order they were queued) first, then NMIs, then external interrupts (the
+/// highest vector first). Like the local APIC, an external interrupt whose
+/// vector is already pending is not queued twice, and at most one NMI is
+/// pending at a time.
+///
+/// inject() is called just before every VM entry. It injects the highest
+/// priority event that the guest is not blocking, and if anything is still
+/// pending, arms interrupt-window (or NMI-window) exiting so that the guest
+/// exits as soon as it can take the next event. Once nothing is pending,
+/// the window exits are disarmed again, so a guest with nothing pending
+/// never pays for them. NMI-window exiting requires virtual NMIs. If
+/// virtual NMIs are not enabled, a blocked NMI waits for an
+/// interrupt-window exit instead.
+///
+/// An exit can happen while an event is being delivered (e.g. an EPT
+/// violation on the guest's stack), in which case the event is not
+/// delivered, and is reported by the IDT-vectoring information instead.
+/// The exit handler gives such an event back with requeue(), and it is
+/// delivered again on the next entry, ahead of anything else that is
+/// pending. As its delivery had already started, it is not held back by
+/// the guest's RFLAGS.IF / interruptibility state.
+///
+/// Events that are only held back because another event was injected on
+/// the same entry (e.g. a second exception) are not gated by RFLAGS.IF,
+/// and so do not wait for the interrupt window. Instead, the monitor trap
+/// flag is armed, which exits right after the injected event has been
+/// delivered. If the CPU does not support the monitor trap flag, these
+/// events fall back to the interrupt window.
+///
+/// Note that inject() modifies the VMCS, and must be called with the
+/// vCPU's VMCS loaded (i.e. from the vCPU's exit handler).
+///
+class EXPORT_EXIT_HANDLER event_queue_intel_x64
+{
+public:
+
+    using event_type = pending_event_t;
+    using size_type = std::size_t;
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    event_queue_intel_x64() = default;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~event_queue_intel_x64() = default;
+
+    /// Queue
+    ///
+    /// @expects event.vector < 256
+    /// @expects event.type != reserved && event.type != other_event
+    /// @ensures none
+    ///
+    /// @param event the event to queue
+    ///
+    void queue(const event_type &event);
+
+    /// Queue External Interrupt
+    ///
+    /// @expects vector < 256
+    /// @ensures none
+    ///
+    /// @param vector the interrupt's vector
+    ///
+    void queue_external_interrupt(uint64_t vector);
+
+    /// Queue NMI
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void queue_nmi();
+
+    /// Queue Exception
+    ///
+    /// Queues a hardware exception without an error code.
+    ///
+    /// @expects vector < 32
+    /// @ensures none
+    ///
+    /// @param vector the exception's vector
+    ///
+    void queue_exception(uint64_t vector);
+
+    /// Queue Exception
+    ///
+    /// Queues a hardware exception with an error code.
+    ///
+    /// @expects vector < 32
+    /// @ensures none
+    ///
+    /// @param vector the exception's vector
+    /// @param error_code the exception's error code
+    ///
+    void queue_exception(uint64_t vector, uint64_t error_code);
+
+    /// Requeue
+    ///
+    /// Gives back an event whose delivery was interrupted by a VM exit (as
+    /// reported by the IDT-vectoring information), so that it is delivered
+    /// again, before any other pending event.
+    ///
+    /// @expects event.vector < 256
+    /// @expects event.type != reserved && event.type != other_event
+    /// @ensures none
+    ///
+    /// @param event the event whose delivery was interrupted
+    ///
+    void requeue(const event_type &event);
+
+    /// Queue Nested Exception
+    ///
+    /// Queues an exception that was raised while delivering the event
+    /// given back by requeue() (e.g. a #PF that was intercepted, and is
+    /// reflected to the guest), and combines the two the way the CPU does
+    /// (see the SDM's rules for generating a double fault):
+    ///
+    /// - A contributory exception during the delivery of a contributory
+    ///   exception, or a #PF / contributory exception during the delivery
+    ///   of a #PF, becomes a #DF, which replaces both.
+    /// - A #PF / contributory exception during the delivery of a #DF is a
+    ///   triple fault, which cannot be delivered, and throws.
+    /// - Otherwise, the exception is delivered first. An interrupted
+    ///   external interrupt or NMI is delivered after it (once the guest
+    ///   can take it), while an interrupted exception or software
+    ///   interrupt is dropped, as the guest raises it again when it
+    ///   retries the instruction.
+    ///
+    /// If no event was interrupted, this is the same as queue().
+    ///
+    /// @expects exception.vector < 256
+    /// @expects exception.type != reserved && exception.type != other_event
+    /// @ensures none
+    ///
+    /// @param exception the exception raised during the delivery
+    ///
+    void queue_nested_exception(const event_type &exception);
+
+    /// Inject
+    ///
+    /// Injects (at most) one pending event, and arms / disarms the
+    /// interrupt-window, NMI-window and monitor trap flag exits for the
+    /// events that are still pending. Does nothing (and touches no VMCS
+    /// fields) if nothing is pending, and none of these exits is armed.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param failed set to true if a VMCS access fails, never cleared
+    ///
+    void inject(bool &failed) noexcept;
+
+    /// Resync
+    ///
+    /// The window / monitor trap flag exits are armed in the VMCS that is
+    /// loaded, and inject() only writes them when they change. This
+    /// reads which of them are armed from the VMCS that is loaded, and
+    /// must be called when another VMCS is loaded (e.g. when the exit
+    /// handler switches to another VMCS context).
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param failed set to true if a VMCS access fails, never cleared
+    ///
+    void resync(bool &failed) noexcept;
+
+    /// Size
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of pending events
+    ///
+    size_type size() const noexcept
+    { return m_events.size() + (m_interrupted_pending ? 1 : 0); }
+
+    /// Empty
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if no events are pending, false otherwise
+    ///
+    bool empty() const noexcept
+    { return m_events.empty() && !m_interrupted_pending; }
+
+    /// Interrupt Window Armed
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if interrupt-window exiting is enabled
+    ///
+    bool interrupt_window_armed() const noexcept
+    { return m_interrupt_window_armed; }
+
+    /// NMI Window Armed
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if NMI-window exiting is enabled
+    ///
+    bool nmi_window_armed() const noexcept
+    { return m_nmi_window_armed; }
+
+    /// Monitor Trap Flag Armed
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the monitor trap flag was enabled by inject()
+    ///
+    bool mtf_armed() const noexcept
+    { return m_mtf_armed; }
+
+private:
+
+    void write(const event_type &event, bool &failed) noexcept;
+    void arm(bool interrupt_window, bool nmi_window, bool mtf, bool &failed) noexcept;
+
+private:
+
+    // Sorted by priority, with the highest priority event at the back
+
+    std::vector<event_type> m_events;
+
+    // The event whose delivery was interrupted by the last exit (if any),
+    // which goes ahead of the sorted events
+
+    event_type m_interrupted{};
+    bool m_interrupted_pending{false};
+
+    bool m_interrupt_window_armed{false};
+    bool m_nmi_window_armed{false};
+    bool m_mtf_armed{false};
+
+public:
+
+    event_queue_intel_x64(event_queue_intel_x64 &&) noexcept = default;
+    event_queue_intel_x64 &operator=(event_queue_intel_x64 &&) noexcept = default;
+
+    event_queue_intel_x64(const event_queue_intel_x64 &) = delete;
+    event_queue_intel_x64 &operator=(const event_queue_intel_x64 &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,261 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef EXCEPTION_INTERCEPT_INTEL_X64_H
+#define EXCEPTION_INTERCEPT_INTEL_X64_H
+
+#include <vector>
+#include <functional>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EXIT_HANDLER
+#ifdef SHARED_EXIT_HANDLER
+#define EXPORT_EXIT_HANDLER EXPORT_SYM
+#else
+#define EXPORT_EXIT_HANDLER IMPORT_SYM
+#endif
+#else
+#define EXPORT_EXIT_HANDLER
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// Exception Info
+///
+/// Describes the exception that caused an exception_or_nmi exit.
+///
+/// - vector: the exception's vector
+/// - type: the interruption type (as defined by the VM-exit interruption
+///   information field)
+/// - error_code: the exception's error code (if error_code_valid)
+/// - qualification: the exit qualification (the faulting address for a
+///   #PF, or the pending debug exceptions for a #DB)
+/// - instruction_length: the length of the instruction that caused a
+///   software exception (#BP / #OF)
+///
+struct exception_info_t
+{
+    uint64_t vector;
+    uint64_t type;
+    uint64_t error_code;
+    bool error_code_valid;
+    uint64_t qualification;
+    uint64_t instruction_length;
+};
+
+// -----------------------------------------------------------------------------
+// Exception Intercept
+// -----------------------------------------------------------------------------
+
+/// Exception Intercept
+///
+/// Lets any number of subscribers ask for the guest's exceptions to be
+/// intercepted, either by vector, or (for #PF) by error code pattern, and
+/// programs the exception bitmap, and the #PF error code mask / match, so
+/// that the guest only exits for the exceptions somebody asked for.
+///
+/// A #PF subscription with mask / match only wants the page faults whose
+/// error code satisfies (error_code & mask) == match. The VMCS can only
+/// express one such pattern, so when subscribers ask for different
+/// patterns, the combined pattern only keeps the bits they all agree on
+/// (i.e. the CPU exits for a superset of the requested page faults), and
+/// each subscriber is still only given the page faults it asked for.
+///
+/// When an exception is intercepted, dispatch() gives it to every
+/// interested subscriber (in the order they subscribed), until one claims
+/// it. An exception that is not claimed should be reinjected into the
+/// guest by the caller.
+///
+/// Note that subscribe() / unsubscribe() modify the VMCS, and must be
+/// called with the vCPU's VMCS loaded (i.e. from the vCPU's exit handler).
+///
+class EXPORT_EXIT_HANDLER exception_intercept_intel_x64
+{
+public:
+
+    using id_type = uint64_t;
+    using info_type = exception_info_t;
+
+    /// Handler
+    ///
+    /// Returns true if the exception was claimed (i.e. it should not be
+    /// given to other subscribers, or reinjected into the guest).
+    ///
+    using handler_type = std::function<bool(const info_type &)>;
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    exception_intercept_intel_x64() = default;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~exception_intercept_intel_x64() = default;
+
+    /// Subscribe
+    ///
+    /// Intercepts every exception with the provided vector.
+    ///
+    /// @expects vector < 32
+    /// @expects handler
+    /// @ensures none
+    ///
+    /// @param vector the exception vector to intercept
+    /// @param handler the handler to call when the exception occurs
+    /// @return the subscription's id (to unsubscribe)
+    ///
+    id_type subscribe(uint64_t vector, handler_type handler);
+
+    /// Subscribe Page Fault
+    ///
+    /// Intercepts the page faults whose error code satisfies
+    /// (error_code & mask) == match.
+    ///
+    /// @expects (match & ~mask) == 0
+    /// @expects handler
+    /// @ensures none
+    ///
+    /// @param mask the error code bits to test
+    /// @param match the expected value of the tested bits
+    /// @param handler the handler to call when the page fault occurs
+    /// @return the subscription's id (to unsubscribe)
+    ///
+    id_type subscribe_page_fault(uint64_t mask, uint64_t match, handler_type handler);
+
+    /// Unsubscribe
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param id the subscription to remove. Does nothing if id does not
+    ///     exist.
+    ///
+    void unsubscribe(id_type id);
+
+    /// Dispatch
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param info the exception that was intercepted
+    /// @return true if a subscriber claimed the exception, false if it
+    ///     should be reinjected
+    ///
+    bool dispatch(const info_type &info);
+
+    /// Resync
+    ///
+    /// Writes the exception bitmap and the #PF error code mask / match
+    /// to the VMCS that is loaded. Subscribing / unsubscribing only writes
+    /// them to the VMCS that is loaded at the time, so this must be called
+    /// when another VMCS is loaded (e.g. when the exit handler switches to
+    /// another VMCS context).
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param failed set to true if a VMCS access fails, never cleared
+    ///
+    void resync(bool &failed) noexcept;
+
+    /// Exception Bitmap
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the exception bitmap programmed into the VMCS
+    ///
+    uint64_t exception_bitmap() const noexcept
+    { return m_exception_bitmap; }
+
+    /// Page Fault Error Code Mask
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the #PF error code mask programmed into the VMCS
+    ///
+    uint64_t page_fault_error_code_mask() const noexcept
+    { return m_page_fault_error_code_mask; }
+
+    /// Page Fault Error Code Match
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the #PF error code match programmed into the VMCS
+    ///
+    uint64_t page_fault_error_code_match() const noexcept
+    { return m_page_fault_error_code_match; }
+
+private:
+
+    struct subscriber_type
+    {
+        id_type id;
+        uint64_t vector;
+        uint64_t mask;
+        uint64_t match;
+        handler_type handler;
+    };
+
+    void update();
+
+private:
+
+    id_type m_next_id{1};
+    std::vector<subscriber_type> m_subscribers;
+
+    uint64_t m_exception_bitmap{0};
+    uint64_t m_page_fault_error_code_mask{0};
+    uint64_t m_page_fault_error_code_match{0};
+
+public:
+
+    exception_intercept_intel_x64(exception_intercept_intel_x64 &&) = default;
+    exception_intercept_intel_x64 &operator=(exception_intercept_intel_x64 &&) = default;
+
+    exception_intercept_intel_x64(const exception_intercept_intel_x64 &) = delete;
+    exception_intercept_intel_x64 &operator=(const exception_intercept_intel_x64 &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
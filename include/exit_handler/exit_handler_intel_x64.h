@@ -25,6 +25,16 @@
 #include <memory>
 
 #include <vmcs/vmcs_intel_x64.h>
+#include <vmcs/vmcs_intel_x64_guest_shadow.h>
+#include <vmcs/vmcs_intel_x64_context_set.h>
+#include <exit_handler/xstate_intel_x64.h>
+#include <exit_handler/vmcall_ring_intel_x64.h>
+#include <exit_handler/vmcall_cbor.h>
+#include <exit_handler/profiler_intel_x64.h>
+#include <exit_handler/ple_intel_x64.h>
+#include <exit_handler/exit_trace_intel_x64.h>
+#include <exit_handler/exception_intercept_intel_x64.h>
+#include <exit_handler/event_queue_intel_x64.h>
 #include <memory_manager/map_ptr_x64.h>
 #include <intrinsics/x86/intel_x64.h>
 
@@ -119,6 +129,42 @@ public:
     ///
     virtual void stop() noexcept;
 
+    /// Enable Fast Path
+    ///
+    /// Allows exits with the provided basic exit reason to be handled by
+    /// exit_handler_fast_path, directly from the exit handler's entry point,
+    /// bypassing dispatch(). Only CPUID, INVD, RDMSR and WRMSR are
+    /// supported, and they are emulated the same way this class's default
+    /// handlers emulate them. For this reason, the fast path is disabled
+    /// by default, and a subclass that changes how one of these exits is
+    /// handled should not enable the fast path for it.
+    ///
+    /// The fast path resumes the guest directly, without resume(). It
+    /// never handles an exit while events are waiting to be injected, the
+    /// exit trace is enabled, or the VMCS is checked on entry (i.e. dirty
+    /// field tracking is on), nor RDMSR / WRMSR to an MSR in the VMCS's MSR
+    /// area; these exits go through dispatch() instead. Any other state
+    /// resume() depends on must not be changed by the fast path's exits.
+    ///
+    /// @expects m_state_save != nullptr
+    /// @ensures none
+    ///
+    /// @param reason the basic exit reason to enable the fast path for
+    ///
+    void enable_fast_path(intel_x64::vmcs::value_type reason);
+
+    /// Disable Fast Path
+    ///
+    /// Exits with the provided basic exit reason will be handled by
+    /// dispatch().
+    ///
+    /// @expects m_state_save != nullptr
+    /// @ensures none
+    ///
+    /// @param reason the basic exit reason to disable the fast path for
+    ///
+    void disable_fast_path(intel_x64::vmcs::value_type reason);
+
 #ifndef ENABLE_UNITTESTING
 protected:
 #endif
@@ -128,6 +174,9 @@ protected:
     virtual void resume();
     virtual void advance_and_resume();
 
+    virtual void switch_to(
+        vmcs_intel_x64_context_set::context_type ctx);
+
     virtual void handle_exit(
         intel_x64::vmcs::value_type reason);
 
@@ -137,10 +186,48 @@ protected:
     void handle_vmxoff();
     void handle_rdmsr();
     void handle_wrmsr();
+    void handle_preemption_timer();
+    void handle_control_register_accesses();
+    void handle_pause();
+    void handle_exception_or_nmi();
+    void handle_interrupt_window();
+    void handle_nmi_window();
+    void handle_monitor_trap_flag();
+    void handle_ept_violation();
+    void handle_ept_misconfiguration();
+
+    void reinject_exception(const exception_info_t &info);
+    void requeue_interrupted_event();
+
+    virtual bool handle_pause_loop();
+
+    uint64_t read_guest_cr0() noexcept;
+    uint64_t read_guest_cr4() noexcept;
+    void write_guest_cr0(uint64_t val) noexcept;
+    void write_guest_cr4(uint64_t val) noexcept;
+
+    vmcs_intel_x64_vpid::vpid_type guest_vpid();
+
+    uint64_t &guest_gpr(uint64_t index);
 
     void advance_rip() noexcept;
     void unimplemented_handler() noexcept;
 
+    intel_x64::vmcs::value_type vm_exit_reason() noexcept;
+    intel_x64::vmcs::value_type vm_exit_qualification() noexcept;
+    intel_x64::vmcs::value_type vm_exit_instruction_length() noexcept;
+    intel_x64::vmcs::value_type vm_exit_instruction_information() noexcept;
+    intel_x64::vmcs::value_type vm_exit_guest_linear_address() noexcept;
+    intel_x64::vmcs::value_type vm_exit_guest_physical_address() noexcept;
+    intel_x64::vmcs::value_type vm_exit_interruption_information() noexcept;
+    intel_x64::vmcs::value_type vm_exit_interruption_error_code() noexcept;
+    intel_x64::vmcs::value_type vm_exit_idt_vectoring_information() noexcept;
+    intel_x64::vmcs::value_type vm_exit_idt_vectoring_error_code() noexcept;
+
+    intel_x64::vmcs::value_type exit_info(
+        uint64_t index, intel_x64::vmcs::field_type addr) noexcept;
+    void invalidate_exit_info() noexcept;
+
     virtual void complete_vmcall(
         ret_type ret, vmcall_registers_t &regs) noexcept;
 
@@ -158,6 +245,31 @@ protected:
         vmcall_registers_t &regs);
     virtual void handle_vmcall_unittest(
         vmcall_registers_t &regs);
+    virtual void handle_vmcall_ring(
+        vmcall_registers_t &regs);
+    virtual void handle_vmcall_profiler(
+        vmcall_registers_t &regs);
+    virtual void handle_vmcall_ple(
+        vmcall_registers_t &regs);
+    virtual void handle_vmcall_exit_trace(
+        vmcall_registers_t &regs);
+
+    virtual void handle_vmcall_ring_entry(
+        uint64_t opcode, vmcall_registers_t &regs);
+
+    uint64_t process_vmcall_ring();
+
+    virtual uint64_t handle_vmcall_data_string_unformatted_raw(
+        gsl::span<const char> ispan, gsl::span<char> ospan);
+
+    virtual uint64_t handle_vmcall_data_string_json_raw(
+        gsl::span<const char> ispan, gsl::span<char> ospan);
+
+    virtual uint64_t handle_vmcall_data_binary_unformatted_raw(
+        gsl::span<const char> ispan, gsl::span<char> ospan);
+
+    virtual uint64_t handle_vmcall_data_binary_cbor_raw(
+        gsl::span<const char> ispan, gsl::span<char> ospan);
 
     virtual void handle_vmcall_data_string_unformatted(
         const std::string &istr, std::string &ostr);
@@ -169,6 +281,9 @@ protected:
         const bfn::unique_map_ptr_x64<char> &imap,
         const bfn::unique_map_ptr_x64<char> &omap);
 
+    virtual void handle_vmcall_data_binary_cbor(
+        cbor_decoder &decoder, cbor_encoder &encoder);
+
     void reply_with_string(
         vmcall_registers_t &regs, const std::string &str,
         const bfn::unique_map_ptr_x64<char> &omap);
@@ -177,6 +292,12 @@ protected:
         vmcall_registers_t &regs, const json &str,
         const bfn::unique_map_ptr_x64<char> &omap);
 
+    uint64_t reply_with_string(
+        const std::string &str, gsl::span<char> ospan);
+
+    uint64_t reply_with_json(
+        const json &ojson, gsl::span<char> ospan);
+
 public:
 
     // The following are only marked public for unit testing. Do not use
@@ -186,13 +307,91 @@ public:
     vmcs_intel_x64 *m_vmcs{nullptr};
     state_save_intel_x64 *m_state_save{nullptr};
 
+    // Sticky error flag used by the noexcept VMCS accessors while handling
+    // an exit. It is cleared by dispatch(), and checked once by resume().
+
+    bool m_vmcs_failed{false};
+
+    // Write-back cache of the guest fields that the handlers read / write.
+    // Dirty fields are flushed by resume() / promote().
+
+    vmcs_intel_x64_guest_shadow m_guest_shadow;
+
+    // Manages the guest's extended state. A handler that needs the FPU
+    // must call m_xstate.save() before touching it.
+
+    xstate_intel_x64 m_xstate;
+
+    // The guest's vmcall ring (if registered). The ring stays mapped until
+    // the guest unregisters it, so a doorbell does not have to walk the
+    // guest's page tables.
+
+    bfn::unique_map_ptr_x64<vmcall_ring_t> m_vmcall_ring;
+
+    // Samples the guest's RIP using the VMX-preemption timer. Disabled
+    // (i.e. the timer is not active) unless the guest enables it.
+
+    profiler_intel_x64 m_profiler;
+
+    // Pause-loop exiting, and its per-vCPU counters. Disabled unless the
+    // guest enables it. Whether an exit was useful is decided by
+    // handle_pause_loop(), which a VMM that can run something else (e.g.
+    // the lock holder's vCPU) should override.
+
+    ple_intel_x64 m_ple;
+
+    // Records the exits handled by dispatch() (if enabled by the guest),
+    // so that they can be replayed offline.
+
+    exit_trace_intel_x64 m_trace;
+
+    // The guest exceptions that are intercepted, and who wants them.
+    // Exceptions that no subscriber claims are reinjected.
+
+    exception_intercept_intel_x64 m_exceptions;
+
+    // The events waiting to be injected into the guest. resume() injects
+    // one per entry, and arms the window exits while any are blocked.
+
+    event_queue_intel_x64 m_events;
+
+    // The EPT of the guest (if any), which must be the same EPT as the
+    // VMCS uses. Unmapped memory is identity mapped when the guest first
+    // touches it, and resume() flushes the changes once per exit.
+
+    ept_intel_x64 *m_ept{nullptr};
+
+    // The VMCS contexts of the vCPU (if set). switch_to() makes another
+    // context's VMCS and state save the ones this handler uses, and
+    // resume() resumes (or launches) the current context.
+
+    vmcs_intel_x64_context_set *m_contexts{nullptr};
+
+    // The MSR area of the VMCS (if set). rdmsr / wrmsr to an MSR in the
+    // area read / write the guest's value in the area, as the CPU loads
+    // the VMM's value on every VM exit, and so never take the fast path.
+
+    vmcs_intel_x64_msr_area *m_msr_area{nullptr};
+
     virtual void set_vmcs(
         gsl::not_null<vmcs_intel_x64 *> vmcs)
     { m_vmcs = vmcs; }
 
     virtual void set_state_save(
         gsl::not_null<state_save_intel_x64 *> state_save)
-    { m_state_save = state_save; }
+    {
+        m_state_save = state_save;
+        m_xstate.set_state_save(state_save);
+    }
+
+    virtual void set_ept(ept_intel_x64 *ept)
+    { m_ept = ept; }
+
+    virtual void set_contexts(vmcs_intel_x64_context_set *contexts)
+    { m_contexts = contexts; }
+
+    virtual void set_msr_area(vmcs_intel_x64_msr_area *msr_area)
+    { m_msr_area = msr_area; }
 
 private:
 
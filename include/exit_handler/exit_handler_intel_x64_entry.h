@@ -36,4 +36,24 @@
 extern "C" EXPORT_EXIT_HANDLER void exit_handler(
     exit_handler_intel_x64 *exit_handler) noexcept;
 
+/// Exit Handler Fast Path
+///
+/// Called by the entry point, prior to exit_handler, when the basic exit
+/// reason has been enabled using exit_handler_intel_x64::enable_fast_path.
+/// This function emulates the CPUID, INVD, RDMSR and WRMSR instructions the
+/// same way the exit handler's default handlers do, but without the
+/// virtual dispatch, exception guards, and VMCS accessors, and then resumes
+/// the guest directly. If the exit cannot be handled (for example, a RDMSR
+/// of an MSR that is stored in the VMCS), this function returns without
+/// modifying the guest's state, and the exit is handled by exit_handler.
+///
+/// @expects exit_handler != nullptr
+/// @ensures none
+///
+/// @param exit_handler the exit handler associated with the exit
+/// @param reason the basic exit reason of the exit
+///
+extern "C" EXPORT_EXIT_HANDLER void exit_handler_fast_path(
+    exit_handler_intel_x64 *exit_handler, uint64_t reason) noexcept;
+
 #endif
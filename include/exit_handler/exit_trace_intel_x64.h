@@ -0,0 +1,310 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef EXIT_TRACE_INTEL_X64_H
+#define EXIT_TRACE_INTEL_X64_H
+
+#include <memory>
+
+#include <bfgsl.h>
+
+#include <exit_handler/state_save_intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EXIT_HANDLER
+#ifdef SHARED_EXIT_HANDLER
+#define EXPORT_EXIT_HANDLER EXPORT_SYM
+#else
+#define EXPORT_EXIT_HANDLER IMPORT_SYM
+#endif
+#else
+#define EXPORT_EXIT_HANDLER
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCall Exit Trace Opcode
+///
+/// rax = VMCALL_EXIT_TRACE, rdx = VMCALL_MAGIC_NUMBER, rcx = one of the
+/// VMCALL_EXIT_TRACE_* operations below.
+///
+/// - VMCALL_EXIT_TRACE_ENABLE: rbx = number of records the ring can hold
+///   (0 for the default, at most exit_trace_intel_x64::max_num_records)
+/// - VMCALL_EXIT_TRACE_DISABLE: no arguments
+/// - VMCALL_EXIT_TRACE_READ: rbx = guest virtual address of a buffer of
+///   exit_trace_record_t, rsi = size of the buffer (in bytes, at most the
+///   size of the ring, i.e. capacity() records). On return,
+///   rbx holds the number of records copied, and rsi the number of records
+///   dropped since the last read because the ring was full.
+///
+/// A trace file is the concatenation of the records returned by
+/// VMCALL_EXIT_TRACE_READ, in the order they were read.
+///
+#ifndef VMCALL_EXIT_TRACE
+#define VMCALL_EXIT_TRACE 11
+#endif
+
+#define VMCALL_EXIT_TRACE_ENABLE 1
+#define VMCALL_EXIT_TRACE_DISABLE 2
+#define VMCALL_EXIT_TRACE_READ 3
+
+/// Exit Trace Outcomes
+///
+/// - EXIT_TRACE_OUTCOME_RESUMED: the guest was resumed
+/// - EXIT_TRACE_OUTCOME_PROMOTED: the guest was promoted (i.e. VMX was
+///   turned off)
+/// - EXIT_TRACE_OUTCOME_ADVANCED: the guest's RIP was advanced
+/// - EXIT_TRACE_OUTCOME_VMCS_FAILED: a VMCS access failed while handling
+///   the exit
+///
+#define EXIT_TRACE_OUTCOME_RESUMED (1ULL << 0)
+#define EXIT_TRACE_OUTCOME_PROMOTED (1ULL << 1)
+#define EXIT_TRACE_OUTCOME_ADVANCED (1ULL << 2)
+#define EXIT_TRACE_OUTCOME_VMCS_FAILED (1ULL << 3)
+
+#pragma pack(push, 1)
+
+/// Exit Trace Record
+///
+/// The inputs of an exit (as the exit handler saw them), plus its timing
+/// and outcome. tsc_delta is the time (in TSC ticks) since the previous
+/// exit was handled (i.e. mostly time spent in the guest), and
+/// handler_tsc the time it took to handle this exit.
+///
+struct exit_trace_record_t
+{
+    uint64_t reason;
+    uint64_t qualification;
+    uint64_t instruction_length;
+    uint64_t instruction_information;
+
+    uint64_t rip;
+    uint64_t rax;
+    uint64_t rbx;
+    uint64_t rcx;
+    uint64_t rdx;
+    uint64_t rsi;
+    uint64_t rdi;
+    uint64_t r08;
+    uint64_t r09;
+
+    uint64_t tsc_delta;
+    uint64_t handler_tsc;
+    uint64_t outcome;
+};
+
+#pragma pack(pop)
+
+// -----------------------------------------------------------------------------
+// Exit Trace
+// -----------------------------------------------------------------------------
+
+/// Exit Trace
+///
+/// Records every exit that goes through the exit handler's dispatch() into
+/// a fixed size ring, so that the exit mix of a real workload can be read
+/// by the guest, saved to a file, and replayed offline through the exit
+/// handler (see the exit handler's replay test).
+///
+/// The exit handler calls begin() once it has read the exit reason, and
+/// end() right before it resumes (or promotes) the guest. If the ring is
+/// full, new records are dropped (and counted) until it is read. When the
+/// trace is disabled, begin() / end() only test a flag.
+///
+/// Exits handled by the exit handler's fast path never reach dispatch(),
+/// and are not traced. Disable the fast path to trace them.
+///
+class EXPORT_EXIT_HANDLER exit_trace_intel_x64
+{
+public:
+
+    using size_type = uint64_t;
+    using record_type = exit_trace_record_t;
+
+    /// Default Number Of Records
+    ///
+    static constexpr const size_type default_num_records = 0x1000;
+
+    /// Max Number Of Records
+    ///
+    /// The number of records is chosen by the guest, so the size of the
+    /// ring (and the buffer VMCALL_EXIT_TRACE_READ maps) is bounded.
+    ///
+    static constexpr const size_type max_num_records = 0x10000;
+
+    /// Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    exit_trace_intel_x64() noexcept = default;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~exit_trace_intel_x64() = default;
+
+    /// Enable
+    ///
+    /// Allocates the ring (if needed) and starts tracing. Records that
+    /// have not been read are discarded if the size of the ring changes.
+    ///
+    /// @expects num_records != 0
+    /// @expects num_records <= max_num_records
+    /// @ensures is_enabled() == true
+    ///
+    /// @param num_records the number of records the ring can hold
+    ///
+    void enable(size_type num_records = default_num_records);
+
+    /// Disable
+    ///
+    /// Stops tracing. Records that have not been read are kept.
+    ///
+    /// @expects none
+    /// @ensures is_enabled() == false
+    ///
+    void disable() noexcept;
+
+    /// Is Enabled
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the trace is enabled, false otherwise
+    ///
+    bool is_enabled() const noexcept
+    { return m_enabled; }
+
+    /// Begin
+    ///
+    /// Starts a record for the exit that is being handled.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param reason the exit reason
+    /// @param qualification the exit qualification
+    /// @param instruction_length the exit instruction length
+    /// @param instruction_information the exit instruction information
+    /// @param state the guest's registers
+    ///
+    void begin(uint64_t reason,
+               uint64_t qualification,
+               uint64_t instruction_length,
+               uint64_t instruction_information,
+               const state_save_intel_x64 &state) noexcept;
+
+    /// End
+    ///
+    /// Completes the record started by begin(), and adds it to the ring.
+    /// Does nothing if no record was started.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param state the guest's registers
+    /// @param outcome the outcome of the exit (EXIT_TRACE_OUTCOME_*).
+    ///     EXIT_TRACE_OUTCOME_ADVANCED is added if the guest's RIP changed.
+    ///
+    void end(const state_save_intel_x64 &state, uint64_t outcome) noexcept;
+
+    /// Read
+    ///
+    /// Moves the oldest records into the provided buffer, and resets the
+    /// dropped record count.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param records the buffer to copy the records to
+    /// @param dropped returns the number of records dropped since the
+    ///     last read
+    /// @return the number of records copied
+    ///
+    size_type read(gsl::span<record_type> records, size_type &dropped) noexcept;
+
+    /// Size
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of records that have not been read
+    ///
+    size_type size() const noexcept
+    { return m_tail - m_head; }
+
+    /// Capacity
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of records the ring can hold (0 if the trace
+    ///     was never enabled)
+    ///
+    size_type capacity() const noexcept
+    { return m_num_records; }
+
+private:
+
+    bool m_enabled{false};
+    bool m_pending{false};
+
+    uint64_t m_begin_tsc{0};
+    uint64_t m_end_tsc{0};
+
+    record_type m_record{};
+
+    size_type m_num_records{0};
+    size_type m_head{0};
+    size_type m_tail{0};
+    size_type m_dropped{0};
+
+    std::unique_ptr<record_type[]> m_records;
+
+public:
+
+    exit_trace_intel_x64(exit_trace_intel_x64 &&) noexcept = default;
+    exit_trace_intel_x64 &operator=(exit_trace_intel_x64 &&) noexcept = default;
+
+    exit_trace_intel_x64(const exit_trace_intel_x64 &) = delete;
+    exit_trace_intel_x64 &operator=(const exit_trace_intel_x64 &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
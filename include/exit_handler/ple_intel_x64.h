@@ -0,0 +1,264 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef PLE_INTEL_X64_H
+#define PLE_INTEL_X64_H
+
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EXIT_HANDLER
+#ifdef SHARED_EXIT_HANDLER
+#define EXPORT_EXIT_HANDLER EXPORT_SYM
+#else
+#define EXPORT_EXIT_HANDLER IMPORT_SYM
+#endif
+#else
+#define EXPORT_EXIT_HANDLER
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCall Pause-Loop Exiting Opcode
+///
+/// rax = VMCALL_PLE, rdx = VMCALL_MAGIC_NUMBER, rcx = one of the
+/// VMCALL_PLE_* operations below.
+///
+/// - VMCALL_PLE_ENABLE: rbx = gap, rsi = window, r08 = maximum window (all
+///   in TSC ticks). If r08 is 0, the window is not adapted.
+/// - VMCALL_PLE_DISABLE: no arguments
+/// - VMCALL_PLE_COUNTERS: on return, rbx = exits, rsi = useful exits,
+///   r08 = number of times the window grew, r09 = number of times the
+///   window shrank, r10 = current window. The counters are then reset.
+///
+#ifndef VMCALL_PLE
+#define VMCALL_PLE 10
+#endif
+
+#define VMCALL_PLE_ENABLE 1
+#define VMCALL_PLE_DISABLE 2
+#define VMCALL_PLE_COUNTERS 3
+
+/// Pause-Loop Exiting Counters
+///
+struct ple_counters_t
+{
+    uint64_t exits;
+    uint64_t useful_exits;
+    uint64_t grows;
+    uint64_t shrinks;
+};
+
+// -----------------------------------------------------------------------------
+// Pause-Loop Exiting
+// -----------------------------------------------------------------------------
+
+/// Pause-Loop Exiting
+///
+/// When pause-loop exiting is enabled, a guest that executes PAUSE in a
+/// loop (i.e. successive PAUSEs no more than gap TSC ticks apart) for
+/// longer than window TSC ticks exits. This is the signature of a spinlock
+/// whose holder is not running (for example, because its vCPU has been
+/// preempted by VMM work), and gives the VMM a chance to run something
+/// useful instead of letting the vCPU burn its core.
+///
+/// The exit handler reports each exit with pause_exit(), stating whether
+/// the exit was useful (i.e. whether the VMM had something better to do,
+/// like running the lock holder). The window then adapts: useful exits
+/// shrink the window back towards its initial value so that spinning is
+/// detected early, while useless exits grow it (up to the maximum window),
+/// so that a guest spinning on a lock that is about to be released is not
+/// needlessly interrupted.
+///
+/// Note that enable() / disable() and pause_exit() modify the VMCS, and
+/// must be called with the vCPU's VMCS loaded (i.e. from the vCPU's exit
+/// handler).
+///
+class EXPORT_EXIT_HANDLER ple_intel_x64
+{
+public:
+
+    using counters_type = ple_counters_t;
+
+    /// Default Gap / Window (in TSC ticks)
+    ///
+    static constexpr const uint64_t default_gap = 128;
+    static constexpr const uint64_t default_window = 4096;
+    static constexpr const uint64_t default_max_window = default_window << 6;
+
+    /// Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ple_intel_x64() noexcept = default;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~ple_intel_x64() = default;
+
+    /// Enable
+    ///
+    /// Programs the PLE gap / window, and enables pause-loop exiting.
+    ///
+    /// @expects gap != 0
+    /// @expects window != 0
+    /// @expects max_window == 0 || max_window >= window
+    /// @expects pause-loop exiting is supported
+    /// @ensures is_enabled() == true
+    ///
+    /// @param gap the maximum number of TSC ticks between two PAUSEs of
+    ///     the same loop
+    /// @param window the number of TSC ticks a guest may spin before it
+    ///     exits
+    /// @param max_window the maximum window the window can grow to. If 0,
+    ///     the window is not adapted.
+    ///
+    void enable(uint64_t gap = default_gap,
+                uint64_t window = default_window,
+                uint64_t max_window = default_max_window);
+
+    /// Disable
+    ///
+    /// Disables pause-loop exiting. The counters are kept.
+    ///
+    /// @expects none
+    /// @ensures is_enabled() == false
+    ///
+    void disable();
+
+    /// Is Enabled
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if pause-loop exiting is enabled, false otherwise
+    ///
+    bool is_enabled() const noexcept
+    { return m_enabled; }
+
+    /// Pause Exit
+    ///
+    /// Records a pause-loop exit, and adapts the window. Called by the
+    /// exit handler on every pause exit.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param useful true if the exit was useful, false otherwise
+    /// @param failed set to true if updating the window failed
+    ///
+    void pause_exit(bool useful, bool &failed) noexcept;
+
+    /// Resync
+    ///
+    /// Writes the PLE gap / window, and enables / disables pause-loop
+    /// exiting, in the VMCS that is loaded. enable() / disable() and
+    /// pause_exit() only change the VMCS that is loaded at the time, so
+    /// this must be called when another VMCS is loaded (e.g. when the exit
+    /// handler switches to another VMCS context). Does nothing if
+    /// pause-loop exiting was never enabled.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param failed set to true if a VMCS access fails, never cleared
+    ///
+    void resync(bool &failed) noexcept;
+
+    /// Counters
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the counters accumulated since the last reset
+    ///
+    const counters_type &counters() const noexcept
+    { return m_counters; }
+
+    /// Reset Counters
+    ///
+    /// @expects none
+    /// @ensures counters() are all 0
+    ///
+    void reset_counters() noexcept
+    { m_counters = {}; }
+
+    /// Gap
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the PLE gap
+    ///
+    uint64_t gap() const noexcept
+    { return m_gap; }
+
+    /// Window
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the current PLE window
+    ///
+    uint64_t window() const noexcept
+    { return m_window; }
+
+private:
+
+    bool m_enabled{false};
+
+    uint64_t m_gap{0};
+    uint64_t m_window{0};
+    uint64_t m_min_window{0};
+    uint64_t m_max_window{0};
+
+    counters_type m_counters{};
+
+public:
+
+    ple_intel_x64(ple_intel_x64 &&) noexcept = default;
+    ple_intel_x64 &operator=(ple_intel_x64 &&) noexcept = default;
+
+    ple_intel_x64(const ple_intel_x64 &) = delete;
+    ple_intel_x64 &operator=(const ple_intel_x64 &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
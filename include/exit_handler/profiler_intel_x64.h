@@ -0,0 +1,254 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef PROFILER_INTEL_X64_H
+#define PROFILER_INTEL_X64_H
+
+#include <memory>
+
+#include <bfgsl.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EXIT_HANDLER
+#ifdef SHARED_EXIT_HANDLER
+#define EXPORT_EXIT_HANDLER EXPORT_SYM
+#else
+#define EXPORT_EXIT_HANDLER IMPORT_SYM
+#endif
+#else
+#define EXPORT_EXIT_HANDLER
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCall Profiler Opcode
+///
+/// rax = VMCALL_PROFILER, rdx = VMCALL_MAGIC_NUMBER, rcx = one of the
+/// VMCALL_PROFILER_* operations below.
+///
+/// - VMCALL_PROFILER_ENABLE: rbx = sampling period (in TSC ticks)
+/// - VMCALL_PROFILER_DISABLE: no arguments
+/// - VMCALL_PROFILER_READ: rbx = guest virtual address of a buffer of
+///   profiler_sample_t, rsi = size of the buffer (in bytes), which must not
+///   be larger than the ring (see profiler_intel_x64::capacity()). On
+///   return, rbx holds the number of samples copied, and rsi the number of
+///   samples dropped since the last read because the ring was full.
+///
+#ifndef VMCALL_PROFILER
+#define VMCALL_PROFILER 9
+#endif
+
+#define VMCALL_PROFILER_ENABLE 1
+#define VMCALL_PROFILER_DISABLE 2
+#define VMCALL_PROFILER_READ 3
+
+#pragma pack(push, 1)
+
+/// Profiler Sample
+///
+struct profiler_sample_t
+{
+    uint64_t rip;
+    uint64_t cr3;
+    uint64_t cpl;
+};
+
+#pragma pack(pop)
+
+// -----------------------------------------------------------------------------
+// Profiler
+// -----------------------------------------------------------------------------
+
+/// Guest Sampling Profiler
+///
+/// Samples where a vCPU's guest is executing using the VMX-preemption
+/// timer. Once enabled, the guest exits every period TSC ticks (converted
+/// to preemption timer ticks using IA32_VMX_MISC), and the exit handler
+/// records the guest's RIP, CR3 and CPL by calling sample(). Samples are
+/// stored in a fixed size ring that is allocated when the profiler is
+/// enabled, and are retrieved in bulk with read(). If the ring is full,
+/// new samples are dropped (and counted) until it is read.
+///
+/// When the profiler is disabled, the preemption timer is not active, so
+/// profiling costs nothing.
+///
+/// Note that enable() / disable() modify the VMCS, and must be called with
+/// the vCPU's VMCS loaded (i.e. from the vCPU's exit handler).
+///
+class EXPORT_EXIT_HANDLER profiler_intel_x64
+{
+public:
+
+    using size_type = uint64_t;
+    using sample_type = profiler_sample_t;
+
+    /// Default Number Of Samples
+    ///
+    static constexpr const size_type default_num_samples = 0x1000;
+
+    /// Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param num_samples the number of samples the ring can hold
+    ///
+    profiler_intel_x64(size_type num_samples = default_num_samples) noexcept;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~profiler_intel_x64() = default;
+
+    /// Enable
+    ///
+    /// Activates the VMX-preemption timer, and starts sampling.
+    ///
+    /// @expects period != 0
+    /// @expects the preemption timer is supported
+    /// @ensures is_enabled() == true
+    ///
+    /// @param period the sampling period in TSC ticks
+    ///
+    void enable(uint64_t period);
+
+    /// Disable
+    ///
+    /// Deactivates the VMX-preemption timer. Samples that have not been
+    /// read are kept.
+    ///
+    /// @expects none
+    /// @ensures is_enabled() == false
+    ///
+    void disable();
+
+    /// Is Enabled
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the profiler is enabled, false otherwise
+    ///
+    bool is_enabled() const noexcept
+    { return m_enabled; }
+
+    /// Sample
+    ///
+    /// Records a sample, and re-arms the preemption timer. Called by the
+    /// exit handler on every preemption timer exit.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param rip the guest's RIP
+    /// @param cr3 the guest's CR3
+    /// @param cpl the guest's CPL
+    /// @param failed set to true if re-arming the timer failed
+    ///
+    void sample(uint64_t rip, uint64_t cr3, uint64_t cpl, bool &failed) noexcept;
+
+    /// Read
+    ///
+    /// Moves the oldest samples into the provided buffer, and resets the
+    /// dropped sample count.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param samples the buffer to copy the samples to
+    /// @param dropped returns the number of samples dropped since the last
+    ///     read
+    /// @return the number of samples copied
+    ///
+    size_type read(gsl::span<sample_type> samples, size_type &dropped) noexcept;
+
+    /// Size
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of samples that have not been read
+    ///
+    size_type size() const noexcept
+    { return m_tail - m_head; }
+
+    /// Capacity
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of samples the ring can hold
+    ///
+    size_type capacity() const noexcept
+    { return m_num_samples; }
+
+    /// Timer Value
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the value the preemption timer is armed with (the sampling
+    ///     period in preemption timer ticks)
+    ///
+    uint64_t timer_value() const noexcept
+    { return m_timer_value; }
+
+private:
+
+    bool m_enabled{false};
+    bool m_rearm{false};
+    uint64_t m_timer_value{0};
+
+    size_type m_num_samples;
+    size_type m_head{0};
+    size_type m_tail{0};
+    size_type m_dropped{0};
+
+    std::unique_ptr<sample_type[]> m_samples;
+
+public:
+
+    profiler_intel_x64(profiler_intel_x64 &&) noexcept = default;
+    profiler_intel_x64 &operator=(profiler_intel_x64 &&) noexcept = default;
+
+    profiler_intel_x64(const profiler_intel_x64 &) = delete;
+    profiler_intel_x64 &operator=(const profiler_intel_x64 &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
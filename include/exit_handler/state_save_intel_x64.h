@@ -71,7 +71,40 @@ struct state_save_intel_x64 {
     uint64_t ymm14[4];              // 0x280
     uint64_t ymm15[4];              // 0x2A0
 
-    uint64_t remaining_space_in_page[0x1A8];
+    uint64_t fast_path_exits;       // 0x2C0
+
+    // The exit information cache holds the VM-exit information fields
+    // that have been read during the current exit (see
+    // exit_handler_intel_x64::vm_exit_reason, etc...). exit_info_valid has
+    // one bit per entry, and is reset on every exit by the entry point:
+    //
+    // 0: exit reason
+    // 1: exit qualification
+    // 2: VM-exit instruction length
+    // 3: VM-exit instruction information
+    // 4: guest-linear address
+    // 5: guest-physical address
+    // 6: VM-exit interruption information
+    // 7: VM-exit interruption error code
+    // 8: IDT-vectoring information
+    // 9: IDT-vectoring error code
+
+    uint64_t exit_info_valid;       // 0x2C8
+    uint64_t exit_info[10];         // 0x2D0
+
+    // Extended state (see xstate_intel_x64). xstate_flags is read by the
+    // entry point and vmcs_resume:
+    //
+    // bit 0: lazy, xmm0-xmm7 are not saved by the entry point
+    // bit 1: saved, xstate_area must be restored (XRSTOR) on resume
+    // bit 2: xmm0-xmm7 were saved by the entry point, and must be restored
+    //        on resume (the mode can change in the middle of an exit)
+
+    uint64_t xstate_flags;          // 0x320
+    uint64_t xstate_area;           // 0x328
+    uint64_t xstate_rfbm;           // 0x330
+
+    uint64_t remaining_space_in_page[0x199];
 };
 
 #pragma pack(pop)
@@ -0,0 +1,426 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCALL_CBOR_H
+#define VMCALL_CBOR_H
+
+#include <bfgsl.h>
+#include <bfvmcallinterface.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EXIT_HANDLER
+#ifdef SHARED_EXIT_HANDLER
+#define EXPORT_EXIT_HANDLER EXPORT_SYM
+#else
+#define EXPORT_EXIT_HANDLER IMPORT_SYM
+#endif
+#else
+#define EXPORT_EXIT_HANDLER
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCall Data Type (CBOR)
+///
+/// The input and output buffers of the vmcall hold a sequence of CBOR
+/// (RFC 7049) data items. Only definite length items are supported.
+///
+#ifndef VMCALL_DATA_BINARY_CBOR
+#define VMCALL_DATA_BINARY_CBOR 4
+#endif
+
+namespace cbor
+{
+
+using major_type = uint64_t;
+
+constexpr const major_type unsigned_integer = 0;
+constexpr const major_type negative_integer = 1;
+constexpr const major_type byte_string = 2;
+constexpr const major_type text_string = 3;
+constexpr const major_type array = 4;
+constexpr const major_type map = 5;
+constexpr const major_type tag = 6;
+constexpr const major_type simple = 7;
+
+}
+
+// -----------------------------------------------------------------------------
+// CBOR Encoder
+// -----------------------------------------------------------------------------
+
+/// CBOR Encoder
+///
+/// Encodes CBOR data items directly into a caller provided buffer (e.g.
+/// the mapped output buffer of a vmcall). Nothing is allocated. If an item
+/// does not fit in the buffer, an exception is thrown and the buffer is
+/// left as it was before the item was encoded.
+///
+/// @b Example: @n
+/// @code
+/// cbor_encoder encoder(ospan);
+///
+/// encoder.encode_map(1);
+/// encoder.encode_text("exits");
+/// encoder.encode_uint(42);
+///
+/// return encoder.size();
+/// @endcode
+///
+class EXPORT_EXIT_HANDLER cbor_encoder
+{
+public:
+
+    /// Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param buf the buffer to encode into
+    ///
+    cbor_encoder(gsl::span<char> buf) noexcept;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~cbor_encoder() = default;
+
+    /// Encode Unsigned Integer
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param val the value to encode
+    ///
+    void encode_uint(uint64_t val);
+
+    /// Encode Signed Integer
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param val the value to encode
+    ///
+    void encode_int(int64_t val);
+
+    /// Encode Boolean
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param val the value to encode
+    ///
+    void encode_bool(bool val);
+
+    /// Encode Null
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void encode_null();
+
+    /// Encode Byte String
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param bytes the bytes to encode
+    ///
+    void encode_bytes(gsl::span<const char> bytes);
+
+    /// Encode Text String
+    ///
+    /// @expects str != nullptr
+    /// @ensures none
+    ///
+    /// @param str the null terminated (UTF-8) string to encode
+    ///
+    void encode_text(const char *str);
+
+    /// Encode Text String
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param str the (UTF-8) string to encode
+    ///
+    void encode_text(gsl::span<const char> str);
+
+    /// Encode Array
+    ///
+    /// Starts an array. The next num items encoded are its elements.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param num the number of elements in the array
+    ///
+    void encode_array(uint64_t num);
+
+    /// Encode Map
+    ///
+    /// Starts a map. The next num pairs of items encoded are its keys and
+    /// values.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param num the number of key / value pairs in the map
+    ///
+    void encode_map(uint64_t num);
+
+    /// Encode Raw
+    ///
+    /// Appends an already encoded data item (e.g. one returned by
+    /// cbor_decoder::decode_raw()) as is.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param item the encoded data item
+    ///
+    void encode_raw(gsl::span<const char> item);
+
+    /// Size
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of bytes encoded so far
+    ///
+    uint64_t size() const noexcept
+    { return m_index; }
+
+private:
+
+    void encode_head(cbor::major_type type, uint64_t val);
+    void write(const char *data, uint64_t len);
+
+private:
+
+    gsl::span<char> m_buf;
+    uint64_t m_index{0};
+
+public:
+
+    cbor_encoder(cbor_encoder &&) noexcept = default;
+    cbor_encoder &operator=(cbor_encoder &&) noexcept = default;
+
+    cbor_encoder(const cbor_encoder &) = delete;
+    cbor_encoder &operator=(const cbor_encoder &) = delete;
+};
+
+// -----------------------------------------------------------------------------
+// CBOR Decoder
+// -----------------------------------------------------------------------------
+
+/// CBOR Decoder
+///
+/// Streaming (pull) decoder over a caller provided buffer (e.g. the mapped
+/// input buffer of a vmcall). Items are decoded one at a time, in order,
+/// and strings are returned as views into the buffer, so nothing is
+/// allocated or copied. The input is untrusted: any malformed, truncated,
+/// or unsupported item results in an exception.
+///
+/// @b Example: @n
+/// @code
+/// cbor_decoder decoder(ispan);
+///
+/// auto &&num = decoder.decode_map();
+/// for (auto i = 0ULL; i < num; i++) {
+///     auto &&key = decoder.decode_text();
+///     auto &&val = decoder.decode_uint();
+/// }
+/// @endcode
+///
+class EXPORT_EXIT_HANDLER cbor_decoder
+{
+public:
+
+    /// Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param buf the buffer to decode from
+    ///
+    cbor_decoder(gsl::span<const char> buf) noexcept;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~cbor_decoder() = default;
+
+    /// Empty
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if there are no more items to decode
+    ///
+    bool empty() const noexcept;
+
+    /// Peek
+    ///
+    /// @expects empty() == false
+    /// @ensures none
+    ///
+    /// @return the major type of the next item, without decoding it
+    ///
+    cbor::major_type peek() const;
+
+    /// Decode Unsigned Integer
+    ///
+    /// @expects peek() == cbor::unsigned_integer
+    /// @ensures none
+    ///
+    /// @return the decoded value
+    ///
+    uint64_t decode_uint();
+
+    /// Decode Signed Integer
+    ///
+    /// @expects peek() == cbor::unsigned_integer or cbor::negative_integer
+    /// @expects the value fits in an int64_t
+    /// @ensures none
+    ///
+    /// @return the decoded value
+    ///
+    int64_t decode_int();
+
+    /// Decode Boolean
+    ///
+    /// @expects the next item is true or false
+    /// @ensures none
+    ///
+    /// @return the decoded value
+    ///
+    bool decode_bool();
+
+    /// Decode Null
+    ///
+    /// @expects the next item is null
+    /// @ensures none
+    ///
+    void decode_null();
+
+    /// Decode Byte String
+    ///
+    /// @expects peek() == cbor::byte_string
+    /// @ensures none
+    ///
+    /// @return a view of the bytes in the decoder's buffer
+    ///
+    gsl::span<const char> decode_bytes();
+
+    /// Decode Text String
+    ///
+    /// @expects peek() == cbor::text_string
+    /// @ensures none
+    ///
+    /// @return a view of the string in the decoder's buffer. Note that the
+    ///     string is not null terminated
+    ///
+    gsl::span<const char> decode_text();
+
+    /// Decode Array
+    ///
+    /// @expects peek() == cbor::array
+    /// @ensures none
+    ///
+    /// @return the number of elements in the array, which are the next
+    ///     items to be decoded
+    ///
+    uint64_t decode_array();
+
+    /// Decode Map
+    ///
+    /// @expects peek() == cbor::map
+    /// @ensures none
+    ///
+    /// @return the number of key / value pairs in the map, which are the
+    ///     next items to be decoded
+    ///
+    uint64_t decode_map();
+
+    /// Decode Raw
+    ///
+    /// Skips the next data item, including all of the items it contains,
+    /// validating it along the way.
+    ///
+    /// @expects empty() == false
+    /// @ensures none
+    ///
+    /// @return a view of the encoded item in the decoder's buffer
+    ///
+    gsl::span<const char> decode_raw();
+
+    /// Skip
+    ///
+    /// Same as decode_raw(), ignoring the result.
+    ///
+    /// @expects empty() == false
+    /// @ensures none
+    ///
+    void skip()
+    { decode_raw(); }
+
+private:
+
+    uint64_t decode_head(cbor::major_type type);
+    uint64_t read_head(uint64_t &index, cbor::major_type &type, uint64_t &info) const;
+    gsl::span<const char> read(uint64_t len);
+
+private:
+
+    gsl::span<const char> m_buf;
+    uint64_t m_index{0};
+
+public:
+
+    cbor_decoder(cbor_decoder &&) noexcept = default;
+    cbor_decoder &operator=(cbor_decoder &&) noexcept = default;
+
+    cbor_decoder(const cbor_decoder &) = delete;
+    cbor_decoder &operator=(const cbor_decoder &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCALL_RING_INTEL_X64_H
+#define VMCALL_RING_INTEL_X64_H
+
+#include <bfvmcallinterface.h>
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCall Ring Opcode
+///
+/// rax = VMCALL_RING, rdx = VMCALL_MAGIC_NUMBER, rcx = one of the
+/// VMCALL_RING_* operations below. For VMCALL_RING_REGISTER, rbx holds
+/// the (page aligned) guest physical address of the ring. For
+/// VMCALL_RING_DOORBELL, rbx returns the number of entries processed.
+///
+#ifndef VMCALL_RING
+#define VMCALL_RING 8
+#endif
+
+#define VMCALL_RING_REGISTER 1
+#define VMCALL_RING_UNREGISTER 2
+#define VMCALL_RING_DOORBELL 3
+
+/// Number of entries in the ring. The ring (header + entries) must fit in
+/// a single 4k page.
+///
+#define VMCALL_RING_SIZE 28
+
+// -----------------------------------------------------------------------------
+// Ring Layout
+// -----------------------------------------------------------------------------
+
+#pragma pack(push, 1)
+
+/// VMCall Ring Entry
+///
+/// The guest fills in opcode and regs (using the same register mapping
+/// as a vmcall, where regs.r02 is rcx, regs.r03 is rbx, etc...). Once the
+/// VMM has processed the entry, ret holds the result that a vmcall would
+/// have returned in rdx, and regs holds the registers that a vmcall would
+/// have returned. Entries are completed in place.
+///
+struct vmcall_ring_entry_t
+{
+    uint64_t opcode;
+    int64_t ret;
+    vmcall_registers_t regs;
+};
+
+/// VMCall Ring
+///
+/// head and tail are free running counters (i.e. they are never wrapped),
+/// and the entry for a given counter is entries[counter % size]. The guest
+/// owns tail, and increments it after an entry has been filled in. The VMM
+/// owns head, and increments it after an entry has been completed, so any
+/// entry below head is complete. The guest must never let tail - head
+/// exceed size.
+///
+/// On registration, the VMM resets head and tail to 0, and sets size.
+///
+struct vmcall_ring_t
+{
+    uint64_t head;
+    uint64_t tail;
+    uint64_t size;
+    uint64_t reserved;
+
+    vmcall_ring_entry_t entries[VMCALL_RING_SIZE];
+};
+
+#pragma pack(pop)
+
+#endif
@@ -0,0 +1,214 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef XSTATE_INTEL_X64_H
+#define XSTATE_INTEL_X64_H
+
+#include <memory>
+
+#include <bfgsl.h>
+#include <exit_handler/state_save_intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_EXIT_HANDLER
+#ifdef SHARED_EXIT_HANDLER
+#define EXPORT_EXIT_HANDLER EXPORT_SYM
+#else
+#define EXPORT_EXIT_HANDLER IMPORT_SYM
+#endif
+#else
+#define EXPORT_EXIT_HANDLER
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Extended State
+// -----------------------------------------------------------------------------
+
+/// Extended State Manager
+///
+/// Manages the guest's extended state (x87, SSE, AVX, etc...) for a vCPU.
+/// There are two modes:
+///
+/// - eager (the default): the entry point and vmcs_resume save / restore
+///   xmm0-xmm7 on every exit, which is what the VMM's compiled code is
+///   allowed to clobber.
+///
+/// - lazy: the entry point and vmcs_resume do not touch the extended state
+///   at all. Instead, the host CR0.TS is set, so the first instruction
+///   that uses the FPU / SSE / AVX registers during an exit raises a #NM,
+///   and the VMM's #NM handler (see vmcs_nm_handler) saves the guest's
+///   extended state before the instruction is executed. Exits that do not
+///   use these registers (most of them) do not pay for saving them.
+///
+/// In either mode, a handler that needs the guest's extended state (for
+/// example, to emulate an instruction that touches the AVX registers)
+/// calls save() before it uses any of these registers. This executes an
+/// XSAVEOPT of all of the state components enabled in the guest's XCR0,
+/// and the state is then restored with XRSTOR by vmcs_resume, just prior
+/// to resuming the guest.
+///
+class EXPORT_EXIT_HANDLER xstate_intel_x64
+{
+public:
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    xstate_intel_x64() = default;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~xstate_intel_x64() = default;
+
+    /// Set State Save
+    ///
+    /// The extended state belongs to the vCPU, and not to a state save. If
+    /// the state save is changed (e.g. when the vCPU switches to another
+    /// VMCS context), the mode, and the saved state (if any), are moved to
+    /// the new state save, so that the state is restored by whichever
+    /// state save is resumed next.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param state_save the state save of the vCPU this manager is for
+    ///
+    void set_state_save(gsl::not_null<state_save_intel_x64 *> state_save) noexcept;
+
+    /// Enable Lazy
+    ///
+    /// Stops the entry point and vmcs_resume from saving / restoring
+    /// xmm0-xmm7 on every exit, and sets CR0.TS in the host state of the
+    /// VMCS that is loaded, starting with the next exit.
+    ///
+    /// @expects m_state_save != nullptr
+    /// @expects CR4.OSXSAVE == 1
+    /// @ensures is_lazy() == true
+    ///
+    void enable_lazy();
+
+    /// Disable Lazy
+    ///
+    /// Restores eager mode, starting with the next exit.
+    ///
+    /// @expects m_state_save != nullptr
+    /// @ensures is_lazy() == false
+    ///
+    void disable_lazy();
+
+    /// Is Lazy
+    ///
+    /// @expects m_state_save != nullptr
+    /// @ensures none
+    ///
+    /// @return true if lazy mode is enabled, false otherwise
+    ///
+    bool is_lazy() const;
+
+    /// Resync
+    ///
+    /// Sets / clears CR0.TS in the host state of the VMCS that is loaded to
+    /// match the mode. enable_lazy() / disable_lazy() only change the VMCS
+    /// that is loaded at the time, so this must be called when another
+    /// VMCS is loaded (e.g. when the exit handler switches to another VMCS
+    /// context), after set_state_save().
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param failed set to true if a VMCS access fails, never cleared
+    ///
+    void resync(bool &failed) noexcept;
+
+    /// Save
+    ///
+    /// Declares that the calling handler needs the FPU. Saves the guest's
+    /// extended state (all of the components enabled in XCR0), which will be
+    /// restored when the guest is resumed. Calling this more than once
+    /// during the same exit does nothing.
+    ///
+    /// @expects m_state_save != nullptr
+    /// @expects CR4.OSXSAVE == 1
+    /// @ensures is_saved() == true
+    ///
+    void save();
+
+    /// Is Saved
+    ///
+    /// @expects m_state_save != nullptr
+    /// @ensures none
+    ///
+    /// @return true if the guest's extended state was saved during the
+    ///     current exit, false otherwise
+    ///
+    bool is_saved() const;
+
+    /// Area
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the XSAVE area that holds the guest's extended state, or
+    ///     nullptr if save() has never been called
+    ///
+    void *area() const noexcept
+    { return m_area; }
+
+private:
+
+    void allocate_area();
+
+private:
+
+    state_save_intel_x64 *m_state_save{nullptr};
+
+    void *m_area{nullptr};
+    std::unique_ptr<uint8_t[]> m_area_buffer;
+
+public:
+
+    xstate_intel_x64(xstate_intel_x64 &&) noexcept = default;
+    xstate_intel_x64 &operator=(xstate_intel_x64 &&) noexcept = default;
+
+    xstate_intel_x64(const xstate_intel_x64 &) = delete;
+    xstate_intel_x64 &operator=(const xstate_intel_x64 &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
@@ -42,6 +42,8 @@
 // Definitions
 // -----------------------------------------------------------------------------
 
+extern "C" EXPORT_INTRINSICS uint64_t _read_dr6(void) noexcept;
+extern "C" EXPORT_INTRINSICS void _write_dr6(uint64_t val) noexcept;
 extern "C" EXPORT_INTRINSICS uint64_t _read_dr7(void) noexcept;
 extern "C" EXPORT_INTRINSICS void _write_dr7(uint64_t val) noexcept;
 
@@ -49,6 +51,17 @@ extern "C" EXPORT_INTRINSICS void _write_dr7(uint64_t val) noexcept;
 
 namespace x64
 {
+namespace dr6
+{
+    using value_type = uint64_t;
+
+    inline auto get() noexcept
+    { return _read_dr6(); }
+
+    inline void set(value_type val) noexcept
+    { _write_dr6(val); }
+}
+
 namespace dr7
 {
     using value_type = uint64_t;
@@ -0,0 +1,105 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef XSAVE_X64_H
+#define XSAVE_X64_H
+
+#include <intrinsics/x86/common/cpuid_x64.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_INTRINSICS
+#ifdef SHARED_INTRINSICS
+#define EXPORT_INTRINSICS EXPORT_SYM
+#else
+#define EXPORT_INTRINSICS IMPORT_SYM
+#endif
+#else
+#define EXPORT_INTRINSICS
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+extern "C" EXPORT_INTRINSICS uint64_t _xgetbv(uint32_t xcr) noexcept;
+extern "C" EXPORT_INTRINSICS void _xsetbv(uint32_t xcr, uint64_t val) noexcept;
+extern "C" EXPORT_INTRINSICS void _xsaveopt(void *area, uint64_t rfbm) noexcept;
+extern "C" EXPORT_INTRINSICS void _xrstor(void *area, uint64_t rfbm) noexcept;
+
+// *INDENT-OFF*
+
+namespace x64
+{
+namespace xcr0
+{
+    constexpr const auto addr = 0x00000000U;
+    constexpr const auto name = "xcr0";
+
+    using value_type = uint64_t;
+
+    inline auto get() noexcept
+    { return _xgetbv(addr); }
+
+    inline void set(value_type val) noexcept
+    { _xsetbv(addr, val); }
+}
+
+namespace xsave
+{
+    using pointer = void *;
+    using value_type = uint64_t;
+
+    constexpr const auto alignment = 64U;
+
+    /// Size
+    ///
+    /// @return the size (in bytes) of the XSAVE area needed to hold the
+    ///     state components that are currently enabled in XCR0
+    ///
+    inline auto size() noexcept
+    { return _cpuid_subebx(0xD, 0); }
+
+    /// Max Size
+    ///
+    /// @return the size (in bytes) of the XSAVE area needed to hold all of
+    ///     the state components supported by the CPU, which is large
+    ///     enough for any value of XCR0 (e.g. after the guest executes
+    ///     XSETBV)
+    ///
+    inline auto max_size() noexcept
+    { return _cpuid_subecx(0xD, 0); }
+
+    inline void saveopt(pointer area, value_type rfbm) noexcept
+    { _xsaveopt(area, rfbm); }
+
+    inline void restore(pointer area, value_type rfbm) noexcept
+    { _xrstor(area, rfbm); }
+}
+}
+
+// *INDENT-ON*
+
+#endif
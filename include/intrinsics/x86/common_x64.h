@@ -38,5 +38,6 @@
 #include <intrinsics/x86/common/tlb_x64.h>
 #include <intrinsics/x86/common/tss_x64.h>
 #include <intrinsics/x86/common/x64.h>
+#include <intrinsics/x86/common/xsave_x64.h>
 
 #endif
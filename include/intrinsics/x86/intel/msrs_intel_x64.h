@@ -23,6 +23,7 @@
 #define MSRS_INTEL_X64_H
 
 #include <intrinsics/x86/common/msrs_x64.h>
+#include <intrinsics/x86/intel/vmx_capabilities_intel_x64.h>
 
 // *INDENT-OFF*
 
@@ -10769,7 +10770,7 @@ namespace ia32_vmx_basic
     constexpr const auto name = "ia32_vmx_basic";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace revision_id
     {
@@ -10778,7 +10779,7 @@ namespace ia32_vmx_basic
         constexpr const auto name = "revision_id";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -10794,7 +10795,7 @@ namespace ia32_vmx_basic
         constexpr const auto name = "vmxon_vmcs_region_size";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -10810,13 +10811,13 @@ namespace ia32_vmx_basic
         constexpr const auto name = "physical_address_width";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -10832,13 +10833,13 @@ namespace ia32_vmx_basic
         constexpr const auto name = "dual_monitor_mode_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -10854,7 +10855,7 @@ namespace ia32_vmx_basic
         constexpr const auto name = "memory_type";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -10870,13 +10871,13 @@ namespace ia32_vmx_basic
         constexpr const auto name = "ins_outs_exit_information";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -10892,13 +10893,13 @@ namespace ia32_vmx_basic
         constexpr const auto name = "true_based_controls";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -10926,7 +10927,7 @@ namespace ia32_vmx_pinbased_ctls
     constexpr const auto name = "ia32_vmx_pinbased_ctls";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace allowed_0_settings
     {
@@ -10935,7 +10936,7 @@ namespace ia32_vmx_pinbased_ctls
         constexpr const auto name = "allowed_0_settings";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -10951,7 +10952,7 @@ namespace ia32_vmx_pinbased_ctls
         constexpr const auto name = "allowed_1_settings";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -10974,7 +10975,7 @@ namespace ia32_vmx_procbased_ctls
     constexpr const auto name = "ia32_vmx_procbased_ctls";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace allowed_0_settings
     {
@@ -10983,7 +10984,7 @@ namespace ia32_vmx_procbased_ctls
         constexpr const auto name = "allowed_0_settings";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -10999,7 +11000,7 @@ namespace ia32_vmx_procbased_ctls
         constexpr const auto name = "allowed_1_settings";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11022,7 +11023,7 @@ namespace ia32_vmx_exit_ctls
     constexpr const auto name = "ia32_vmx_exit_ctls";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace allowed_0_settings
     {
@@ -11031,7 +11032,7 @@ namespace ia32_vmx_exit_ctls
         constexpr const auto name = "allowed_0_settings";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11047,7 +11048,7 @@ namespace ia32_vmx_exit_ctls
         constexpr const auto name = "allowed_1_settings";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11070,7 +11071,7 @@ namespace ia32_vmx_entry_ctls
     constexpr const auto name = "ia32_vmx_entry_ctls";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace allowed_0_settings
     {
@@ -11079,7 +11080,7 @@ namespace ia32_vmx_entry_ctls
         constexpr const auto name = "allowed_0_settings";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11095,7 +11096,7 @@ namespace ia32_vmx_entry_ctls
         constexpr const auto name = "allowed_1_settings";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11118,7 +11119,7 @@ namespace ia32_vmx_misc
     constexpr const auto name = "ia32_vmx_misc";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace preemption_timer_decrement
     {
@@ -11127,7 +11128,7 @@ namespace ia32_vmx_misc
         constexpr const auto name = "preemption_timer_decrement";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11143,13 +11144,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "store_efer_lma_on_vm_exit";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11165,13 +11166,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "activity_state_hlt_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11187,13 +11188,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "activity_state_shutdown_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11209,13 +11210,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "activity_state_wait_for_sipi_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11231,13 +11232,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "processor_trace_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11253,13 +11254,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "rdmsr_in_smm_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11275,7 +11276,7 @@ namespace ia32_vmx_misc
         constexpr const auto name = "cr3_targets";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11291,7 +11292,7 @@ namespace ia32_vmx_misc
         constexpr const auto name = "max_num_msr_load_store_on_exit";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11307,13 +11308,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "vmxoff_blocked_smi_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11329,13 +11330,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "vmwrite_all_fields_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11351,13 +11352,13 @@ namespace ia32_vmx_misc
         constexpr const auto name = "injection_with_instruction_length_of_zero";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -11390,7 +11391,7 @@ namespace ia32_vmx_cr0_fixed0
     constexpr const auto name = "ia32_vmx_cr0_fixed0";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline void dump(int level, std::string *msg = nullptr)
     { bfdebug_nhex(level, name, get(), msg); }
@@ -11402,7 +11403,7 @@ namespace ia32_vmx_cr0_fixed1
     constexpr const auto name = "ia32_vmx_cr0_fixed1";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline void dump(int level, std::string *msg = nullptr)
     { bfdebug_nhex(level, name, get(), msg); }
@@ -11414,7 +11415,7 @@ namespace ia32_vmx_cr4_fixed0
     constexpr const auto name = "ia32_vmx_cr4_fixed0";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline void dump(int level, std::string *msg = nullptr)
     { bfdebug_nhex(level, name, get(), msg); }
@@ -11426,7 +11427,7 @@ namespace ia32_vmx_cr4_fixed1
     constexpr const auto name = "ia32_vmx_cr4_fixed1";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline void dump(int level, std::string *msg = nullptr)
     { bfdebug_nhex(level, name, get(), msg); }
@@ -11438,7 +11439,7 @@ namespace ia32_vmx_vmcs_enum
     constexpr const auto name = "ia32_vmx_vmcs_enum";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace highest_index
     {
@@ -11447,7 +11448,7 @@ namespace ia32_vmx_vmcs_enum
         constexpr const auto name = "highest_index";
 
         inline auto get() noexcept
-        { return get_bits(_read_msr(addr), mask) >> from; }
+        { return get_bits(vmx_capabilities::read_msr(addr), mask) >> from; }
 
         inline auto get(value_type msr) noexcept
         { return get_bits(msr, mask) >> from; }
@@ -11469,13 +11470,13 @@ namespace ia32_vmx_procbased_ctls2
     constexpr const auto name = "ia32_vmx_procbased_ctls2";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline auto allowed0()
-    { return (_read_msr(addr) & 0x00000000FFFFFFFFULL); }
+    { return (vmx_capabilities::read_msr(addr) & 0x00000000FFFFFFFFULL); }
 
     inline auto allowed1()
-    { return ((_read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
+    { return ((vmx_capabilities::read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
 
     namespace virtualize_apic_accesses
     {
@@ -11484,22 +11485,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "virtualize_apic_accesses";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11512,22 +11513,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "enable_ept";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11540,22 +11541,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "descriptor_table_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11568,22 +11569,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "enable_rdtscp";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11596,22 +11597,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "virtualize_x2apic_mode";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11624,22 +11625,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "enable_vpid";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11652,22 +11653,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "wbinvd_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11680,22 +11681,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "unrestricted_guest";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11708,22 +11709,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "apic_register_virtualization";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11736,22 +11737,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "virtual_interrupt_delivery";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11764,22 +11765,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "pause_loop_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11792,22 +11793,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "rdrand_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11820,22 +11821,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "enable_invpcid";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11848,22 +11849,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "enable_vm_functions";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11876,22 +11877,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "vmcs_shadowing";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11904,22 +11905,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "enable_encls_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11932,22 +11933,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "rdseed_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11960,22 +11961,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "enable_pml";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -11988,22 +11989,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "ept_violation_ve";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12016,22 +12017,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "pt_conceal_nonroot_operation";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12044,22 +12045,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "enable_xsaves_xrstors";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12072,22 +12073,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "ept_mode_based_control";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12100,22 +12101,22 @@ namespace ia32_vmx_procbased_ctls2
         constexpr const auto name = "use_tsc_scaling";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12156,7 +12157,7 @@ namespace ia32_vmx_ept_vpid_cap
     constexpr const auto name = "ia32_vmx_ept_vpid_cap";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace execute_only_translation
     {
@@ -12165,13 +12166,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "execute_only_translation";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12187,13 +12188,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "page_walk_length_of_4";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12209,13 +12210,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "memory_type_uncacheable_supported";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12231,13 +12232,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "memory_type_write_back_supported";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12253,13 +12254,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "pde_2mb_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12275,13 +12276,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "pdpte_1gb_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12297,13 +12298,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "invept_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12319,13 +12320,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "accessed_dirty_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12341,13 +12342,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "invept_single_context_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12363,13 +12364,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "invept_all_context_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12385,13 +12386,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "invvpid_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12407,13 +12408,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "invvpid_individual_address_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12429,13 +12430,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "invvpid_single_context_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12451,13 +12452,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "invvpid_all_context_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12473,13 +12474,13 @@ namespace ia32_vmx_ept_vpid_cap
         constexpr const auto name = "invvpid_single_context_retaining_globals_support";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
@@ -12515,13 +12516,13 @@ namespace ia32_vmx_true_pinbased_ctls
     constexpr const auto name = "ia32_vmx_true_pinbased_ctls";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline auto allowed0()
-    { return (_read_msr(addr) & 0x00000000FFFFFFFFULL); }
+    { return (vmx_capabilities::read_msr(addr) & 0x00000000FFFFFFFFULL); }
 
     inline auto allowed1()
-    { return ((_read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
+    { return ((vmx_capabilities::read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
 
     namespace external_interrupt_exiting
     {
@@ -12530,22 +12531,22 @@ namespace ia32_vmx_true_pinbased_ctls
         constexpr const auto name = "external_interrupt_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12558,22 +12559,22 @@ namespace ia32_vmx_true_pinbased_ctls
         constexpr const auto name = "nmi_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12586,22 +12587,22 @@ namespace ia32_vmx_true_pinbased_ctls
         constexpr const auto name = "virtual_nmis";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12614,22 +12615,22 @@ namespace ia32_vmx_true_pinbased_ctls
         constexpr const auto name = "activate_vmx_preemption_timer";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12642,22 +12643,22 @@ namespace ia32_vmx_true_pinbased_ctls
         constexpr const auto name = "process_posted_interrupts";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12680,13 +12681,13 @@ namespace ia32_vmx_true_procbased_ctls
     constexpr const auto name = "ia32_vmx_true_procbased_ctls";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline auto allowed0()
-    { return (_read_msr(addr) & 0x00000000FFFFFFFFULL); }
+    { return (vmx_capabilities::read_msr(addr) & 0x00000000FFFFFFFFULL); }
 
     inline auto allowed1()
-    { return ((_read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
+    { return ((vmx_capabilities::read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
 
     namespace interrupt_window_exiting
     {
@@ -12695,22 +12696,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "interrupt_window_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12723,22 +12724,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "use_tsc_offsetting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12751,22 +12752,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "hlt_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12779,22 +12780,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "invlpg_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12807,22 +12808,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "mwait_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12835,22 +12836,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "rdpmc_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12863,22 +12864,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "rdtsc_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12891,22 +12892,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "cr3_load_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12919,22 +12920,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "cr3_store_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12947,22 +12948,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "cr8_load_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -12975,22 +12976,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "cr8_store_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13003,22 +13004,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "use_tpr_shadow";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13031,22 +13032,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "nmi_window_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13059,22 +13060,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "mov_dr_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13087,22 +13088,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "unconditional_io_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13115,22 +13116,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "use_io_bitmaps";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13143,22 +13144,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "monitor_trap_flag";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13171,22 +13172,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "use_msr_bitmap";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13199,22 +13200,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "monitor_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13227,22 +13228,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "pause_exiting";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13255,22 +13256,22 @@ namespace ia32_vmx_true_procbased_ctls
         constexpr const auto name = "activate_secondary_controls";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13309,13 +13310,13 @@ namespace ia32_vmx_true_exit_ctls
     constexpr const auto name = "ia32_vmx_true_exit_ctls";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline auto allowed0()
-    { return (_read_msr(addr) & 0x00000000FFFFFFFFULL); }
+    { return (vmx_capabilities::read_msr(addr) & 0x00000000FFFFFFFFULL); }
 
     inline auto allowed1()
-    { return ((_read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
+    { return ((vmx_capabilities::read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
 
     namespace save_debug_controls
     {
@@ -13324,22 +13325,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "save_debug_controls";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13352,22 +13353,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "host_address_space_size";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13380,22 +13381,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "load_ia32_perf_global_ctrl";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13408,22 +13409,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "acknowledge_interrupt_on_exit";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13436,22 +13437,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "save_ia32_pat";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13464,22 +13465,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "load_ia32_pat";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13492,22 +13493,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "save_ia32_efer";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13520,22 +13521,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "load_ia32_efer";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13548,22 +13549,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "save_vmx_preemption_timer_value";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13576,22 +13577,22 @@ namespace ia32_vmx_true_exit_ctls
         constexpr const auto name = "clear_ia32_bndcfgs";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13619,13 +13620,13 @@ namespace ia32_vmx_true_entry_ctls
     constexpr const auto name = "ia32_vmx_true_entry_ctls";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     inline auto allowed0()
-    { return (_read_msr(addr) & 0x00000000FFFFFFFFULL); }
+    { return (vmx_capabilities::read_msr(addr) & 0x00000000FFFFFFFFULL); }
 
     inline auto allowed1()
-    { return ((_read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
+    { return ((vmx_capabilities::read_msr(addr) & 0xFFFFFFFF00000000ULL) >> 32); }
 
     namespace load_debug_controls
     {
@@ -13634,22 +13635,22 @@ namespace ia32_vmx_true_entry_ctls
         constexpr const auto name = "load_debug_controls";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13662,22 +13663,22 @@ namespace ia32_vmx_true_entry_ctls
         constexpr const auto name = "ia_32e_mode_guest";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13690,22 +13691,22 @@ namespace ia32_vmx_true_entry_ctls
         constexpr const auto name = "entry_to_smm";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13718,22 +13719,22 @@ namespace ia32_vmx_true_entry_ctls
         constexpr const auto name = "deactivate_dual_monitor_treatment";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13746,22 +13747,22 @@ namespace ia32_vmx_true_entry_ctls
         constexpr const auto name = "load_ia32_perf_global_ctrl";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13774,22 +13775,22 @@ namespace ia32_vmx_true_entry_ctls
         constexpr const auto name = "load_ia32_pat";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13802,22 +13803,22 @@ namespace ia32_vmx_true_entry_ctls
         constexpr const auto name = "load_ia32_efer";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13830,22 +13831,22 @@ namespace ia32_vmx_true_entry_ctls
         constexpr const auto name = "load_ia32_bndcfgs";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_disabled()
-        { return is_bit_cleared(_read_msr(addr), from); }
+        { return is_bit_cleared(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_disabled(value_type msr)
         { return is_bit_cleared(msr, from); }
 
         inline auto is_allowed0() noexcept
-        { return (_read_msr(addr) & mask) == 0; }
+        { return (vmx_capabilities::read_msr(addr) & mask) == 0; }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -13871,7 +13872,7 @@ namespace ia32_vmx_vmfunc
     constexpr const auto name = "ia32_vmx_vmfunc";
 
     inline auto get() noexcept
-    { return _read_msr(addr); }
+    { return vmx_capabilities::read_msr(addr); }
 
     namespace eptp_switching
     {
@@ -13880,13 +13881,13 @@ namespace ia32_vmx_vmfunc
         constexpr const auto name = "eptp_switching";
 
         inline auto is_enabled()
-        { return is_bit_set(_read_msr(addr), from); }
+        { return is_bit_set(vmx_capabilities::read_msr(addr), from); }
 
         inline auto is_enabled(value_type msr)
         { return is_bit_set(msr, from); }
 
         inline auto is_allowed1() noexcept
-        { return (_read_msr(addr) & (mask << 32)) != 0; }
+        { return (vmx_capabilities::read_msr(addr) & (mask << 32)) != 0; }
 
         inline void dump(int level, std::string *msg = nullptr)
         { bfdebug_subbool(level, name, is_enabled(), msg); }
@@ -0,0 +1,126 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef PER_CPU_INTEL_X64_H
+#define PER_CPU_INTEL_X64_H
+
+#include <bfgsl.h>
+
+#include <cstdint>
+#include <intrinsics/x86/common/thread_context_x64.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_INTRINSICS
+#ifdef SHARED_INTRINSICS
+#define EXPORT_INTRINSICS EXPORT_SYM
+#else
+#define EXPORT_INTRINSICS IMPORT_SYM
+#endif
+#else
+#define EXPORT_INTRINSICS
+#endif
+
+// -----------------------------------------------------------------------------
+// Per-CPU State
+// -----------------------------------------------------------------------------
+
+// The little state the intrinsics keep for each CPU (its current VMCS, the
+// fields of that VMCS that have been written, and its VMX capability
+// snapshot) lives in a single table, indexed by thread_context_cpuid().
+// The table is defined once, by the intrinsics library, so that every
+// module that uses the intrinsics sees the same state. A CPU whose id is
+// max_cpus or larger has no entry, and the intrinsics fall back to their
+// untracked behavior on it (see vm::current(), vm::is_dirty() and
+// vmx_capabilities::current()).
+
+// *INDENT-OFF*
+
+namespace intel_x64
+{
+namespace per_cpu
+{
+    /// Max CPUs
+    ///
+    /// The number of CPUs the table has an entry for, which is meant to
+    /// cover the logical CPUs of current multi-socket servers.
+    ///
+    constexpr const auto max_cpus = 0x200ULL;
+
+    constexpr const auto vmx_capability_msrs = 0x12ULL;
+    constexpr const std::ptrdiff_t dirty_words = 16;
+
+    struct vmx_capabilities_type
+    {
+        bool captured;
+        uint64_t msrs[vmx_capability_msrs];
+        uint64_t phys_addr_bits;
+    };
+
+    struct state_type
+    {
+        uintptr_t current_vmcs;
+        uint64_t vmxoff_count;
+        uint64_t dirty[dirty_words];
+        vmx_capabilities_type vmx_capabilities;
+    };
+
+    extern EXPORT_INTRINSICS state_type g_state[max_cpus];
+    extern EXPORT_INTRINSICS bool g_track_dirty_fields;
+
+    /// CPU
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param cpuid the id of the CPU (see thread_context_cpuid())
+    /// @return the state of the given CPU, or nullptr if its id is too
+    ///     large to have an entry
+    ///
+    inline state_type *cpu(uint64_t cpuid) noexcept
+    {
+        if (cpuid >= max_cpus) {
+            return nullptr;
+        }
+
+        return &gsl::at(g_state, static_cast<std::ptrdiff_t>(cpuid));
+    }
+
+    /// This CPU
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the state of the CPU this is called on, or nullptr if its
+    ///     id is too large to have an entry
+    ///
+    inline state_type *this_cpu() noexcept
+    { return cpu(thread_context_cpuid()); }
+}
+}
+
+// *INDENT-ON*
+
+#endif
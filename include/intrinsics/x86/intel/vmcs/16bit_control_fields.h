@@ -53,12 +53,18 @@ namespace virtual_processor_identifier
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -77,12 +83,18 @@ namespace posted_interrupt_notification_vector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -104,12 +116,18 @@ namespace eptp_index
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -50,12 +50,18 @@ namespace guest_es_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -190,12 +196,18 @@ namespace guest_cs_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -330,12 +342,18 @@ namespace guest_ss_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -470,12 +488,18 @@ namespace guest_ds_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -610,12 +634,18 @@ namespace guest_fs_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -750,12 +780,18 @@ namespace guest_gs_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -890,12 +926,18 @@ namespace guest_ldtr_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1030,12 +1072,18 @@ namespace guest_tr_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1173,12 +1221,18 @@ namespace guest_interrupt_status
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1200,12 +1254,18 @@ namespace pml_index
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -50,12 +50,18 @@ namespace host_es_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -190,12 +196,18 @@ namespace host_cs_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -330,12 +342,18 @@ namespace host_ss_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -470,12 +488,18 @@ namespace host_ds_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -610,12 +634,18 @@ namespace host_fs_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -750,12 +780,18 @@ namespace host_gs_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -890,12 +926,18 @@ namespace host_tr_selector
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -49,12 +49,18 @@ namespace pin_based_vm_execution_controls
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -310,12 +316,18 @@ namespace primary_processor_based_vm_execution_controls
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1323,12 +1335,18 @@ namespace exception_bitmap
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1347,12 +1365,18 @@ namespace page_fault_error_code_mask
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1371,12 +1395,18 @@ namespace page_fault_error_code_match
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1395,12 +1425,18 @@ namespace cr3_target_count
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1419,12 +1455,18 @@ namespace vm_exit_controls
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1962,12 +2004,18 @@ namespace vm_exit_msr_store_count
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1986,12 +2034,18 @@ namespace vm_exit_msr_load_count
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2010,12 +2064,18 @@ namespace vm_entry_controls
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2459,12 +2519,18 @@ namespace vm_entry_msr_load_count
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2483,12 +2549,18 @@ namespace vm_entry_interruption_information
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2717,12 +2789,18 @@ namespace vm_entry_exception_error_code
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2741,12 +2819,18 @@ namespace vm_entry_instruction_length
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2765,12 +2849,18 @@ namespace tpr_threshold
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2789,12 +2879,18 @@ namespace secondary_processor_based_vm_execution_controls
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -3899,12 +3995,18 @@ namespace ple_gap
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -3926,12 +4028,18 @@ namespace ple_window
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
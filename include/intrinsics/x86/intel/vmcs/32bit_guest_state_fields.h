@@ -50,12 +50,18 @@ namespace guest_es_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -74,12 +80,18 @@ namespace guest_cs_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -98,12 +110,18 @@ namespace guest_ss_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -122,12 +140,18 @@ namespace guest_ds_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -146,12 +170,18 @@ namespace guest_fs_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -170,12 +200,18 @@ namespace guest_gs_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -194,12 +230,18 @@ namespace guest_ldtr_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -218,12 +260,18 @@ namespace guest_tr_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -242,12 +290,18 @@ namespace guest_gdtr_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -266,12 +320,18 @@ namespace guest_idtr_limit
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -290,12 +350,18 @@ namespace guest_es_access_rights
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -795,12 +861,18 @@ namespace guest_cs_access_rights
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1300,12 +1372,18 @@ namespace guest_ss_access_rights
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1805,12 +1883,18 @@ namespace guest_ds_access_rights
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2310,12 +2394,18 @@ namespace guest_fs_access_rights
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2815,12 +2905,18 @@ namespace guest_gs_access_rights
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -3320,12 +3416,18 @@ namespace guest_ldtr_access_rights
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -3825,12 +3927,18 @@ namespace guest_tr_access_rights
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -4330,12 +4438,18 @@ namespace guest_interruptibility_state
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -4670,12 +4784,18 @@ namespace guest_activity_state
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -4694,12 +4814,18 @@ namespace guest_smbase
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -4718,12 +4844,18 @@ namespace guest_ia32_sysenter_cs
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -4742,12 +4874,18 @@ namespace vmx_preemption_timer_value
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
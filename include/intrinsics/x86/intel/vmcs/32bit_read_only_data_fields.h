@@ -50,6 +50,9 @@ namespace vm_instruction_error
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto vm_instruction_error_description(value_type error)
     {
         switch (error) {
@@ -140,6 +143,9 @@ namespace vm_instruction_error
 
     inline auto description()
     { return vm_instruction_error_description(get_vmcs_field(addr, name, exists())); }
+
+    inline void dump(int level, std::string *msg = nullptr)
+    { dump_vmcs_text(level, msg); }
 }
 
 namespace exit_reason
@@ -153,6 +159,9 @@ namespace exit_reason
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     namespace basic_exit_reason
     {
         constexpr const auto mask = 0x000000000000FFFFULL;
@@ -223,6 +232,9 @@ namespace exit_reason
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask) >> from; }
 
+        inline auto get(value_type field)
+        { return get_bits(field, mask) >> from; }
+
         inline auto basic_exit_reason_description(value_type reason)
         {
             switch (reason) {
@@ -569,6 +581,9 @@ namespace vm_exit_interruption_information
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
@@ -741,6 +756,9 @@ namespace vm_exit_interruption_error_code
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
@@ -759,6 +777,9 @@ namespace idt_vectoring_information
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
@@ -904,6 +925,9 @@ namespace idt_vectoring_error_code
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
@@ -922,6 +946,9 @@ namespace vm_exit_instruction_length
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
@@ -940,6 +967,9 @@ namespace vm_exit_instruction_information
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
@@ -50,12 +50,18 @@ namespace vmcs_link_pointer
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -74,12 +80,18 @@ namespace guest_ia32_debugctl
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -803,12 +815,18 @@ namespace guest_ia32_pat
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1544,12 +1562,18 @@ namespace guest_ia32_efer
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1823,12 +1847,18 @@ namespace guest_ia32_perf_global_ctrl
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1880,12 +1910,18 @@ namespace guest_pdpte0
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -1950,7 +1986,7 @@ namespace guest_pdpte0
         constexpr const auto name = "reserved";
 
         inline auto mask()
-        { return (0xFFFFFFFFFFFFFFFFULL << x64::cpuid::addr_size::phys::get() | 0x1E6ULL); }
+        { return (0xFFFFFFFFFFFFFFFFULL << vmx_capabilities::phys_addr_bits() | 0x1E6ULL); }
 
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask()) >> from; }
@@ -2090,7 +2126,7 @@ namespace guest_pdpte0
         constexpr const auto name = "page_directory_addr";
 
         inline auto mask()
-        { return (0xFFFFFFFFFFFFFFFFULL << x64::cpuid::addr_size::phys::get() | 0x1E6ULL); }
+        { return (0xFFFFFFFFFFFFFFFFULL << vmx_capabilities::phys_addr_bits() | 0x1E6ULL); }
 
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask()) >> from; }
@@ -2139,12 +2175,18 @@ namespace guest_pdpte1
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2209,7 +2251,7 @@ namespace guest_pdpte1
         constexpr const auto name = "reserved";
 
         inline auto mask()
-        { return (0xFFFFFFFFFFFFFFFFULL << x64::cpuid::addr_size::phys::get() | 0x1E6ULL); }
+        { return (0xFFFFFFFFFFFFFFFFULL << vmx_capabilities::phys_addr_bits() | 0x1E6ULL); }
 
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask()) >> from; }
@@ -2349,7 +2391,7 @@ namespace guest_pdpte1
         constexpr const auto name = "page_directory_addr";
 
         inline auto mask()
-        { return (0xFFFFFFFFFFFFFFFFULL << x64::cpuid::addr_size::phys::get() | 0x1E6ULL); }
+        { return (0xFFFFFFFFFFFFFFFFULL << vmx_capabilities::phys_addr_bits() | 0x1E6ULL); }
 
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask()) >> from; }
@@ -2398,12 +2440,18 @@ namespace guest_pdpte2
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2468,7 +2516,7 @@ namespace guest_pdpte2
         constexpr const auto name = "reserved";
 
         inline auto mask()
-        { return (0xFFFFFFFFFFFFFFFFULL << x64::cpuid::addr_size::phys::get() | 0x1E6ULL); }
+        { return (0xFFFFFFFFFFFFFFFFULL << vmx_capabilities::phys_addr_bits() | 0x1E6ULL); }
 
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask()) >> from; }
@@ -2608,7 +2656,7 @@ namespace guest_pdpte2
         constexpr const auto name = "page_directory_addr";
 
         inline auto mask()
-        { return (0xFFFFFFFFFFFFFFFFULL << x64::cpuid::addr_size::phys::get() | 0x1E6ULL); }
+        { return (0xFFFFFFFFFFFFFFFFULL << vmx_capabilities::phys_addr_bits() | 0x1E6ULL); }
 
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask()) >> from; }
@@ -2657,12 +2705,18 @@ namespace guest_pdpte3
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
@@ -2727,7 +2781,7 @@ namespace guest_pdpte3
         constexpr const auto name = "reserved";
 
         inline auto mask()
-        { return (0xFFFFFFFFFFFFFFFFULL << x64::cpuid::addr_size::phys::get() | 0x1E6ULL); }
+        { return (0xFFFFFFFFFFFFFFFFULL << vmx_capabilities::phys_addr_bits() | 0x1E6ULL); }
 
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask()) >> from; }
@@ -2867,7 +2921,7 @@ namespace guest_pdpte3
         constexpr const auto name = "page_directory_addr";
 
         inline auto mask()
-        { return (0xFFFFFFFFFFFFFFFFULL << x64::cpuid::addr_size::phys::get() | 0x1E6ULL); }
+        { return (0xFFFFFFFFFFFFFFFFULL << vmx_capabilities::phys_addr_bits() | 0x1E6ULL); }
 
         inline auto get()
         { return get_bits(get_vmcs_field(addr, name, exists()), mask()) >> from; }
@@ -2916,12 +2970,18 @@ namespace guest_ia32_bndcfgs
     inline auto get()
     { return get_vmcs_field(addr, name, exists()); }
 
+    inline auto get_nothrow(bool &failed) noexcept
+    { return get_vmcs_field_nothrow(addr, exists(), failed); }
+
     inline auto get_if_exists(bool verbose = false)
     { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
 
     inline void set(value_type val)
     { set_vmcs_field(val, addr, name, exists()); }
 
+    inline void set_nothrow(value_type val, bool &failed) noexcept
+    { set_vmcs_field_nothrow(val, addr, exists(), failed); }
+
     inline void set_if_exists(value_type val, bool verbose = false)
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 
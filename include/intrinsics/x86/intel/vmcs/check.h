@@ -25,6 +25,7 @@
 #include <intrinsics/x86/intel/vmcs/check_controls.h>
 #include <intrinsics/x86/intel/vmcs/check_guest.h>
 #include <intrinsics/x86/intel/vmcs/check_host.h>
+#include <intrinsics/x86/intel/vmcs/check_dependencies.h>
 
 /// Intel x86_64 VMCS Check
 ///
@@ -49,6 +50,75 @@ all()
     guest_state_all();
 }
 
+/// Is Affected
+///
+/// @expects none
+/// @ensures none
+///
+/// @param dependency the check to look at
+/// @param dirty the dirty fields of this CPU (see vm::dirty_words_of_this_cpu())
+/// @return true if the check has to be run again, as one of the fields
+///     it reads is dirty (or it reads memory)
+///
+inline bool
+is_affected(const dependency_type &dependency, gsl::span<const uint64_t> dirty)
+{
+    if (dependency.reads_memory) {
+        return true;
+    }
+
+    for (auto i = 0ULL; i < dependency.num_fields; i++) {
+
+        auto &&bit = vm::dirty_bit(gsl::at(dependency.fields, static_cast<std::ptrdiff_t>(i)));
+
+        if ((dirty.at(static_cast<std::ptrdiff_t>(bit >> 6)) & (1ULL << (bit & 0x3FU))) != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// Incremental
+///
+/// Runs the checks that check::all() runs, but only those that depend on
+/// a field that has been written since the last time this passed (see
+/// vm::track_dirty_fields()). Once every check passes the dirty fields
+/// are cleared. If dirty field tracking is not enabled (or this CPU's
+/// dirty fields are not tracked), every check is run.
+///
+/// @expects none
+/// @ensures none
+///
+/// @return the number of checks that were run
+///
+inline uint64_t
+incremental()
+{
+    auto &&words = vm::dirty_words_of_this_cpu();
+
+    if (!vm::dirty_enabled() || words == nullptr) {
+        all();
+        return num_dependencies();
+    }
+
+    auto &&dirty = gsl::span<const uint64_t>(words, vm::dirty_words);
+    auto num_run = 0ULL;
+
+    for (const auto &dependency : dependencies()) {
+
+        if (!is_affected(dependency, dirty)) {
+            continue;
+        }
+
+        dependency.check();
+        num_run++;
+    }
+
+    vm::clear_dirty();
+    return num_run;
+}
+
 }
 }
 }
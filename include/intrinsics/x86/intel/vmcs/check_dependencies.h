@@ -0,0 +1,692 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_CHECK_DEPENDENCIES_H
+#define VMCS_INTEL_X64_CHECK_DEPENDENCIES_H
+
+#include <initializer_list>
+
+#include <intrinsics/x86/intel/vmcs/check_controls.h>
+#include <intrinsics/x86/intel/vmcs/check_guest.h>
+#include <intrinsics/x86/intel/vmcs/check_host.h>
+
+/// Intel x86_64 VMCS Check Dependencies
+///
+/// Every check run by check::all(), in the same order, with the VMCS
+/// fields it reads (including those read by the helpers it calls). A
+/// check only has to be run again once one of its fields has been
+/// written, unless it also reads memory the fields point to (e.g. the
+/// virtual-APIC page, or the guest's PDPTEs), which can change without
+/// a VMCS write.
+///
+
+// *INDENT-OFF*
+
+namespace intel_x64
+{
+namespace vmcs
+{
+namespace check
+{
+    constexpr const auto max_dependencies = 9ULL;
+
+    struct dependency_type
+    {
+        const char *name;
+        void (*check)();
+        bool reads_memory;
+        uint64_t num_fields;
+        field_type fields[max_dependencies];
+    };
+
+#define vmcs_check(check, reads_memory, ...)                                                        \
+    { #check, check, reads_memory, std::initializer_list<field_type>{__VA_ARGS__}.size(), { __VA_ARGS__ } }
+
+#define vmcs_check_no_fields(check)                                                                 \
+    { #check, check, false, 0, {} }
+
+    // The table is returned by a function (rather than being defined at
+    // namespace scope) so that the checks are only compiled into the
+    // code that uses it.
+
+    inline const auto &dependencies() noexcept
+    {
+        static constexpr const dependency_type s_dependencies[] = {
+            vmcs_check(control_pin_based_ctls_reserved_properly_set, false,
+                pin_based_vm_execution_controls::addr,
+                primary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_proc_based_ctls_reserved_properly_set, false,
+                primary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_proc_based_ctls2_reserved_properly_set, false,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_cr3_count_less_then_4, false,
+                cr3_target_count::addr),
+            vmcs_check(control_io_bitmap_address_bits, false,
+                address_of_io_bitmap_a::addr,
+                address_of_io_bitmap_b::addr,
+                primary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_msr_bitmap_address_bits, false,
+                address_of_msr_bitmap::addr,
+                primary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_tpr_shadow_and_virtual_apic, true,
+                virtual_apic_address::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                tpr_threshold::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_nmi_exiting_and_virtual_nmi, false,
+                pin_based_vm_execution_controls::addr),
+            vmcs_check(control_virtual_nmi_and_nmi_window, false,
+                pin_based_vm_execution_controls::addr,
+                primary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_virtual_apic_address_bits, false,
+                apic_access_address::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_x2apic_mode_and_virtual_apic_access, false,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_virtual_interrupt_and_external_interrupt, false,
+                pin_based_vm_execution_controls::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_process_posted_interrupt_checks, false,
+                posted_interrupt_notification_vector::addr,
+                posted_interrupt_descriptor_address::addr,
+                pin_based_vm_execution_controls::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                vm_exit_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_vpid_checks, false,
+                virtual_processor_identifier::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_enable_ept_checks, false,
+                ept_pointer::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_enable_pml_checks, false,
+                pml_address::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_unrestricted_guests, false,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_enable_vm_functions, false,
+                vm_function_controls::addr,
+                eptp_list_address::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_enable_vmcs_shadowing, false,
+                vmread_bitmap_address::addr,
+                vmwrite_bitmap_address::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_enable_ept_violation_checks, false,
+                virtualization_exception_information_address::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check(control_vm_exit_ctls_reserved_properly_set, false,
+                primary_processor_based_vm_execution_controls::addr,
+                vm_exit_controls::addr),
+            vmcs_check(control_activate_and_save_preemption_timer_must_be_0, false,
+                pin_based_vm_execution_controls::addr,
+                vm_exit_controls::addr),
+            vmcs_check(control_exit_msr_store_address, false,
+                vm_exit_msr_store_address::addr,
+                vm_exit_msr_store_count::addr),
+            vmcs_check(control_exit_msr_load_address, false,
+                vm_exit_msr_load_address::addr,
+                vm_exit_msr_load_count::addr),
+            vmcs_check(control_vm_entry_ctls_reserved_properly_set, false,
+                primary_processor_based_vm_execution_controls::addr,
+                vm_entry_controls::addr),
+            vmcs_check(control_event_injection_type_vector_checks, false,
+                vm_entry_interruption_information::addr),
+            vmcs_check(control_event_injection_delivery_ec_checks, false,
+                primary_processor_based_vm_execution_controls::addr,
+                vm_entry_interruption_information::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_cr0::addr),
+            vmcs_check(control_event_injection_reserved_bits_checks, false,
+                vm_entry_interruption_information::addr),
+            vmcs_check(control_event_injection_ec_checks, false,
+                vm_entry_interruption_information::addr,
+                vm_entry_exception_error_code::addr),
+            vmcs_check(control_event_injection_instr_length_checks, false,
+                vm_entry_interruption_information::addr,
+                vm_entry_instruction_length::addr),
+            vmcs_check(control_entry_msr_load_address, false,
+                vm_entry_msr_load_address::addr,
+                vm_entry_msr_load_count::addr),
+
+            vmcs_check(host_cr0_for_unsupported_bits, false,
+                host_cr0::addr),
+            vmcs_check(host_cr4_for_unsupported_bits, false,
+                host_cr4::addr),
+            vmcs_check(host_cr3_for_unsupported_bits, false,
+                host_cr3::addr),
+            vmcs_check(host_ia32_sysenter_esp_canonical_address, false,
+                host_ia32_sysenter_esp::addr),
+            vmcs_check(host_ia32_sysenter_eip_canonical_address, false,
+                host_ia32_sysenter_eip::addr),
+            vmcs_check(host_verify_load_ia32_perf_global_ctrl, false,
+                host_ia32_perf_global_ctrl::addr,
+                vm_exit_controls::addr),
+            vmcs_check(host_verify_load_ia32_pat, false,
+                host_ia32_pat::addr,
+                vm_exit_controls::addr),
+            vmcs_check(host_verify_load_ia32_efer, false,
+                host_ia32_efer::addr,
+                vm_exit_controls::addr,
+                host_cr0::addr),
+            vmcs_check(host_es_selector_rpl_ti_equal_zero, false,
+                host_es_selector::addr),
+            vmcs_check(host_cs_selector_rpl_ti_equal_zero, false,
+                host_cs_selector::addr),
+            vmcs_check(host_ss_selector_rpl_ti_equal_zero, false,
+                host_ss_selector::addr),
+            vmcs_check(host_ds_selector_rpl_ti_equal_zero, false,
+                host_ds_selector::addr),
+            vmcs_check(host_fs_selector_rpl_ti_equal_zero, false,
+                host_fs_selector::addr),
+            vmcs_check(host_gs_selector_rpl_ti_equal_zero, false,
+                host_gs_selector::addr),
+            vmcs_check(host_tr_selector_rpl_ti_equal_zero, false,
+                host_tr_selector::addr),
+            vmcs_check(host_cs_not_equal_zero, false,
+                host_cs_selector::addr),
+            vmcs_check(host_tr_not_equal_zero, false,
+                host_tr_selector::addr),
+            vmcs_check(host_ss_not_equal_zero, false,
+                host_ss_selector::addr,
+                vm_exit_controls::addr),
+            vmcs_check(host_fs_canonical_base_address, false,
+                host_fs_base::addr),
+            vmcs_check(host_gs_canonical_base_address, false,
+                host_gs_base::addr),
+            vmcs_check(host_gdtr_canonical_base_address, false,
+                host_gdtr_base::addr),
+            vmcs_check(host_idtr_canonical_base_address, false,
+                host_idtr_base::addr),
+            vmcs_check(host_tr_canonical_base_address, false,
+                host_tr_base::addr),
+            vmcs_check(host_if_outside_ia32e_mode, false,
+                vm_exit_controls::addr,
+                vm_entry_controls::addr),
+            vmcs_check(host_address_space_size_exit_ctl_is_set, false,
+                vm_exit_controls::addr),
+            vmcs_check(host_address_space_disabled, false,
+                vm_exit_controls::addr,
+                vm_entry_controls::addr,
+                host_cr4::addr,
+                host_rip::addr),
+            vmcs_check(host_address_space_enabled, false,
+                vm_exit_controls::addr,
+                host_cr4::addr,
+                host_rip::addr),
+
+            vmcs_check(guest_cr0_for_unsupported_bits, false,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_cr0::addr),
+            vmcs_check(guest_cr0_verify_paging_enabled, false,
+                guest_cr0::addr),
+            vmcs_check(guest_cr4_for_unsupported_bits, false,
+                guest_cr4::addr),
+            vmcs_check(guest_load_debug_controls_verify_reserved, false,
+                guest_ia32_debugctl::addr,
+                vm_entry_controls::addr),
+            vmcs_check(guest_verify_ia_32e_mode_enabled, false,
+                vm_entry_controls::addr,
+                guest_cr0::addr,
+                guest_cr4::addr),
+            vmcs_check(guest_verify_ia_32e_mode_disabled, false,
+                vm_entry_controls::addr,
+                guest_cr4::addr),
+            vmcs_check(guest_cr3_for_unsupported_bits, false,
+                guest_cr3::addr),
+            vmcs_check(guest_load_debug_controls_verify_dr7, false,
+                vm_entry_controls::addr,
+                guest_dr7::addr),
+            vmcs_check(guest_ia32_sysenter_esp_canonical_address, false,
+                guest_ia32_sysenter_esp::addr),
+            vmcs_check(guest_ia32_sysenter_eip_canonical_address, false,
+                guest_ia32_sysenter_eip::addr),
+            vmcs_check(guest_verify_load_ia32_perf_global_ctrl, false,
+                guest_ia32_perf_global_ctrl::addr,
+                vm_entry_controls::addr),
+            vmcs_check(guest_verify_load_ia32_pat, false,
+                guest_ia32_pat::addr,
+                vm_entry_controls::addr),
+            vmcs_check(guest_verify_load_ia32_efer, false,
+                guest_ia32_efer::addr,
+                vm_entry_controls::addr,
+                guest_cr0::addr),
+            vmcs_check(guest_verify_load_ia32_bndcfgs, false,
+                guest_ia32_bndcfgs::addr,
+                vm_entry_controls::addr),
+            vmcs_check(guest_tr_ti_bit_equals_0, false,
+                guest_tr_selector::addr),
+            vmcs_check(guest_ldtr_ti_bit_equals_0, false,
+                guest_ldtr_selector::addr,
+                guest_ldtr_access_rights::addr),
+            vmcs_check(guest_ss_and_cs_rpl_are_the_same, false,
+                guest_cs_selector::addr,
+                guest_ss_selector::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_base_is_shifted, false,
+                guest_cs_selector::addr,
+                guest_cs_base::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_base_is_shifted, false,
+                guest_ss_selector::addr,
+                guest_ss_base::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_base_is_shifted, false,
+                guest_ds_selector::addr,
+                guest_ds_base::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_base_is_shifted, false,
+                guest_es_selector::addr,
+                guest_es_base::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_base_is_shifted, false,
+                guest_fs_selector::addr,
+                guest_fs_base::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_base_is_shifted, false,
+                guest_gs_selector::addr,
+                guest_gs_base::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_tr_base_is_canonical, false,
+                guest_tr_base::addr),
+            vmcs_check(guest_fs_base_is_canonical, false,
+                guest_fs_base::addr),
+            vmcs_check(guest_gs_base_is_canonical, false,
+                guest_gs_base::addr),
+            vmcs_check(guest_ldtr_base_is_canonical, false,
+                guest_ldtr_access_rights::addr,
+                guest_ldtr_base::addr),
+            vmcs_check(guest_cs_base_upper_dword_0, false,
+                guest_cs_base::addr),
+            vmcs_check(guest_ss_base_upper_dword_0, false,
+                guest_ss_access_rights::addr,
+                guest_ss_base::addr),
+            vmcs_check(guest_ds_base_upper_dword_0, false,
+                guest_ds_access_rights::addr,
+                guest_ds_base::addr),
+            vmcs_check(guest_es_base_upper_dword_0, false,
+                guest_es_access_rights::addr,
+                guest_es_base::addr),
+            vmcs_check(guest_cs_limit, false,
+                guest_cs_limit::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_limit, false,
+                guest_ss_limit::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_limit, false,
+                guest_ds_limit::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_limit, false,
+                guest_es_limit::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_limit, false,
+                guest_gs_limit::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_limit, false,
+                guest_fs_limit::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_v8086_cs_access_rights, false,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_v8086_ss_access_rights, false,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_v8086_ds_access_rights, false,
+                guest_ds_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_v8086_es_access_rights, false,
+                guest_es_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_v8086_fs_access_rights, false,
+                guest_fs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_v8086_gs_access_rights, false,
+                guest_gs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_access_rights_type, false,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_access_rights_type, false,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_access_rights_type, false,
+                guest_ds_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_access_rights_type, false,
+                guest_es_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_access_rights_type, false,
+                guest_fs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_access_rights_type, false,
+                guest_gs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_is_not_a_system_descriptor, false,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_is_not_a_system_descriptor, false,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_is_not_a_system_descriptor, false,
+                guest_ds_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_is_not_a_system_descriptor, false,
+                guest_es_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_is_not_a_system_descriptor, false,
+                guest_fs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_is_not_a_system_descriptor, false,
+                guest_gs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_type_not_equal_3, false,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_dpl_adheres_to_ss_dpl, false,
+                guest_cs_access_rights::addr,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_dpl_must_equal_rpl, false,
+                guest_ss_selector::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_dpl_must_equal_zero, false,
+                guest_cs_access_rights::addr,
+                guest_ss_access_rights::addr,
+                guest_cr0::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_dpl, false,
+                guest_ds_selector::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_ds_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_dpl, false,
+                guest_es_selector::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_es_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_dpl, false,
+                guest_fs_selector::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_fs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_dpl, false,
+                guest_gs_selector::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_gs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_must_be_present, false,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_must_be_present_if_usable, false,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_must_be_present_if_usable, false,
+                guest_ds_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_must_be_present_if_usable, false,
+                guest_es_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_must_be_present_if_usable, false,
+                guest_fs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_must_be_present_if_usable, false,
+                guest_gs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_access_rights_reserved_must_be_0, false,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_access_rights_reserved_must_be_0, false,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_access_rights_reserved_must_be_0, false,
+                guest_ds_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_access_rights_reserved_must_be_0, false,
+                guest_es_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_access_rights_reserved_must_be_0, false,
+                guest_fs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_access_rights_reserved_must_be_0, false,
+                guest_gs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_db_must_be_0_if_l_equals_1, false,
+                vm_entry_controls::addr,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_granularity, false,
+                guest_cs_limit::addr,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_granularity, false,
+                guest_ss_limit::addr,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_granularity, false,
+                guest_ds_limit::addr,
+                guest_ds_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_granularity, false,
+                guest_es_limit::addr,
+                guest_es_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_granularity, false,
+                guest_fs_limit::addr,
+                guest_fs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_granularity, false,
+                guest_gs_limit::addr,
+                guest_gs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_cs_access_rights_remaining_reserved_bit_0, false,
+                guest_cs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ss_access_rights_remaining_reserved_bit_0, false,
+                guest_ss_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_ds_access_rights_remaining_reserved_bit_0, false,
+                guest_ds_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_es_access_rights_remaining_reserved_bit_0, false,
+                guest_es_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_fs_access_rights_remaining_reserved_bit_0, false,
+                guest_fs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_gs_access_rights_remaining_reserved_bit_0, false,
+                guest_gs_access_rights::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_tr_type_must_be_11, false,
+                vm_entry_controls::addr,
+                guest_tr_access_rights::addr),
+            vmcs_check(guest_tr_must_be_a_system_descriptor, false,
+                guest_tr_access_rights::addr),
+            vmcs_check(guest_tr_must_be_present, false,
+                guest_tr_access_rights::addr),
+            vmcs_check(guest_tr_access_rights_reserved_must_be_0, false,
+                guest_tr_access_rights::addr),
+            vmcs_check(guest_tr_granularity, false,
+                guest_tr_limit::addr,
+                guest_tr_access_rights::addr),
+            vmcs_check(guest_tr_must_be_usable, false,
+                guest_tr_access_rights::addr),
+            vmcs_check(guest_tr_access_rights_remaining_reserved_bit_0, false,
+                guest_tr_access_rights::addr),
+            vmcs_check(guest_ldtr_type_must_be_2, false,
+                guest_ldtr_access_rights::addr),
+            vmcs_check(guest_ldtr_must_be_a_system_descriptor, false,
+                guest_ldtr_access_rights::addr),
+            vmcs_check(guest_ldtr_must_be_present, false,
+                guest_ldtr_access_rights::addr),
+            vmcs_check(guest_ldtr_access_rights_reserved_must_be_0, false,
+                guest_ldtr_access_rights::addr),
+            vmcs_check(guest_ldtr_granularity, false,
+                guest_ldtr_limit::addr,
+                guest_ldtr_access_rights::addr),
+            vmcs_check(guest_ldtr_access_rights_remaining_reserved_bit_0, false,
+                guest_ldtr_access_rights::addr),
+            vmcs_check(guest_gdtr_base_must_be_canonical, false,
+                guest_gdtr_base::addr),
+            vmcs_check(guest_idtr_base_must_be_canonical, false,
+                guest_idtr_base::addr),
+            vmcs_check(guest_gdtr_limit_reserved_bits, false,
+                guest_gdtr_limit::addr),
+            vmcs_check(guest_idtr_limit_reserved_bits, false,
+                guest_idtr_limit::addr),
+            vmcs_check(guest_rip_upper_bits, false,
+                vm_entry_controls::addr,
+                guest_cs_access_rights::addr,
+                guest_rip::addr),
+            vmcs_check(guest_rip_valid_addr, false,
+                vm_entry_controls::addr,
+                guest_cs_access_rights::addr,
+                guest_rip::addr),
+            vmcs_check(guest_rflags_reserved_bits, false,
+                guest_rflags::addr),
+            vmcs_check(guest_rflags_vm_bit, false,
+                vm_entry_controls::addr,
+                guest_cr0::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_rflag_interrupt_enable, false,
+                vm_entry_interruption_information::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_valid_activity_state, false,
+                guest_activity_state::addr),
+            vmcs_check(guest_activity_state_not_hlt_when_dpl_not_0, false,
+                guest_ss_access_rights::addr,
+                guest_activity_state::addr),
+            vmcs_check(guest_must_be_active_if_injecting_blocking_state, false,
+                guest_interruptibility_state::addr,
+                guest_activity_state::addr),
+            vmcs_check(guest_hlt_valid_interrupts, false,
+                vm_entry_interruption_information::addr,
+                guest_activity_state::addr),
+            vmcs_check(guest_shutdown_valid_interrupts, false,
+                vm_entry_interruption_information::addr,
+                guest_activity_state::addr),
+            vmcs_check(guest_sipi_valid_interrupts, false,
+                vm_entry_interruption_information::addr,
+                guest_activity_state::addr),
+            vmcs_check(guest_valid_activity_state_and_smm, false,
+                vm_entry_controls::addr,
+                guest_activity_state::addr),
+            vmcs_check(guest_interruptibility_state_reserved, false,
+                guest_interruptibility_state::addr),
+            vmcs_check(guest_interruptibility_state_sti_mov_ss, false,
+                guest_interruptibility_state::addr),
+            vmcs_check(guest_interruptibility_state_sti, false,
+                guest_interruptibility_state::addr,
+                guest_rflags::addr),
+            vmcs_check(guest_interruptibility_state_external_interrupt, false,
+                vm_entry_interruption_information::addr,
+                guest_interruptibility_state::addr),
+            vmcs_check(guest_interruptibility_state_nmi, false,
+                vm_entry_interruption_information::addr,
+                guest_interruptibility_state::addr),
+            vmcs_check_no_fields(guest_interruptibility_not_in_smm),
+            vmcs_check(guest_interruptibility_entry_to_smm, false,
+                vm_entry_controls::addr,
+                guest_interruptibility_state::addr),
+            vmcs_check(guest_interruptibility_state_sti_and_nmi, false,
+                vm_entry_interruption_information::addr,
+                guest_interruptibility_state::addr),
+            vmcs_check(guest_interruptibility_state_virtual_nmi, false,
+                pin_based_vm_execution_controls::addr,
+                vm_entry_interruption_information::addr,
+                guest_interruptibility_state::addr),
+            vmcs_check(guest_interruptibility_state_enclave_interrupt, false,
+                guest_interruptibility_state::addr),
+            vmcs_check(guest_pending_debug_exceptions_reserved, false,
+                guest_pending_debug_exceptions::addr),
+            vmcs_check(guest_pending_debug_exceptions_dbg_ctl, false,
+                guest_ia32_debugctl::addr,
+                guest_interruptibility_state::addr,
+                guest_activity_state::addr,
+                guest_rflags::addr,
+                guest_pending_debug_exceptions::addr),
+            vmcs_check(guest_pending_debug_exceptions_rtm, false,
+                guest_interruptibility_state::addr,
+                guest_pending_debug_exceptions::addr),
+            vmcs_check(guest_vmcs_link_pointer_bits_11_0, false,
+                vmcs_link_pointer::addr),
+            vmcs_check(guest_vmcs_link_pointer_valid_addr, false,
+                vmcs_link_pointer::addr),
+            vmcs_check(guest_vmcs_link_pointer_first_word, true,
+                vmcs_link_pointer::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr),
+            vmcs_check_no_fields(guest_vmcs_link_pointer_not_in_smm),
+            vmcs_check_no_fields(guest_vmcs_link_pointer_in_smm),
+            vmcs_check(guest_valid_pdpte_with_ept_disabled, true,
+                vm_entry_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_cr0::addr,
+                guest_cr3::addr,
+                guest_cr4::addr),
+            vmcs_check(guest_valid_pdpte_with_ept_enabled, false,
+                guest_pdpte0::addr,
+                guest_pdpte1::addr,
+                guest_pdpte2::addr,
+                guest_pdpte3::addr,
+                primary_processor_based_vm_execution_controls::addr,
+                vm_entry_controls::addr,
+                secondary_processor_based_vm_execution_controls::addr,
+                guest_cr0::addr,
+                guest_cr4::addr),
+        };
+
+        return s_dependencies;
+    }
+
+#undef vmcs_check
+#undef vmcs_check_no_fields
+
+    inline auto num_dependencies() noexcept
+    { return sizeof(dependencies()) / sizeof(dependency_type); }
+}
+}
+}
+
+// *INDENT-ON*
+
+#endif
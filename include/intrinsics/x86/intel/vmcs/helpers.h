@@ -93,6 +93,39 @@ set_vmcs_field_if_exists(
     }
 }
 
+// The following do not throw. Instead, if the field doesn't exist, or the
+// vmread / vmwrite fails, "failed" is set to true and is never cleared. This
+// allows a sequence of VMCS accesses to be performed, with the result checked
+// once at the end.
+
+inline value_type
+get_vmcs_field_nothrow(
+    field_type addr, bool exists, bool &failed) noexcept
+{
+    value_type value = 0;
+
+    if (!exists || !_vmread(addr, &value)) {
+        failed = true;
+        return 0ULL;
+    }
+
+    return value;
+}
+
+inline void
+set_vmcs_field_nothrow(
+    value_type val, field_type addr, bool exists, bool &failed) noexcept
+{
+    if (!exists || !_vmwrite(addr, val)) {
+        failed = true;
+        return;
+    }
+
+    if (intel_x64::vm::dirty_enabled()) {
+        intel_x64::vm::mark_dirty(addr);
+    }
+}
+
 inline void
 set_vmcs_field_bits(
     value_type val, field_type addr, value_type mask, value_type from, const char *name, bool exists)
@@ -0,0 +1,317 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_REGISTRY_H
+#define VMCS_INTEL_X64_REGISTRY_H
+
+#include <algorithm>
+
+#include <intrinsics/x86/intel/vmcs/16bit_control_fields.h>
+#include <intrinsics/x86/intel/vmcs/16bit_guest_state_fields.h>
+#include <intrinsics/x86/intel/vmcs/16bit_host_state_fields.h>
+#include <intrinsics/x86/intel/vmcs/64bit_control_fields.h>
+#include <intrinsics/x86/intel/vmcs/64bit_read_only_data_fields.h>
+#include <intrinsics/x86/intel/vmcs/64bit_guest_state_fields.h>
+#include <intrinsics/x86/intel/vmcs/64bit_host_state_fields.h>
+#include <intrinsics/x86/intel/vmcs/32bit_control_fields.h>
+#include <intrinsics/x86/intel/vmcs/32bit_read_only_data_fields.h>
+#include <intrinsics/x86/intel/vmcs/32bit_guest_state_fields.h>
+#include <intrinsics/x86/intel/vmcs/32bit_host_state_field.h>
+#include <intrinsics/x86/intel/vmcs/natural_width_control_fields.h>
+#include <intrinsics/x86/intel/vmcs/natural_width_read_only_data_fields.h>
+#include <intrinsics/x86/intel/vmcs/natural_width_guest_state_fields.h>
+#include <intrinsics/x86/intel/vmcs/natural_width_host_state_fields.h>
+
+// -----------------------------------------------------------------------------
+// Registry
+// -----------------------------------------------------------------------------
+
+// Every field of the VMCS in a single table, sorted by encoding, so that
+// code that works on all of the fields (e.g. dumping or snapshotting the
+// VMCS) can iterate over them, or look one up by its encoding, instead of
+// naming each field's namespace. The 64bit fields are listed by their
+// full encoding only (the high halves are not separate fields in 64bit
+// mode). A field's width and type are bits 14:13 and 11:10 of its
+// encoding.
+
+// *INDENT-OFF*
+
+namespace intel_x64
+{
+namespace vmcs
+{
+namespace registry
+{
+    using width_type = uint32_t;
+    using type_type = uint32_t;
+
+    namespace width
+    {
+        constexpr const width_type bits16 = 0U;
+        constexpr const width_type bits64 = 1U;
+        constexpr const width_type bits32 = 2U;
+        constexpr const width_type natural = 3U;
+    }
+
+    namespace type
+    {
+        constexpr const type_type control = 0U;
+        constexpr const type_type read_only = 1U;
+        constexpr const type_type guest_state = 2U;
+        constexpr const type_type host_state = 3U;
+    }
+
+    constexpr width_type width_of(field_type addr) noexcept
+    { return static_cast<width_type>((addr & 0x6000U) >> 13); }
+
+    constexpr type_type type_of(field_type addr) noexcept
+    { return static_cast<type_type>((addr & 0x0C00U) >> 10); }
+
+    struct field_info
+    {
+        field_type addr;
+        width_type width;
+        type_type type;
+        const char *name;
+        bool (*exists)();
+        void (*dump)(int level, std::string *msg);
+    };
+
+#define vmcs_registry_field(field)                                                                  \
+    { field::addr, width_of(field::addr), type_of(field::addr), field::name, field::exists, field::dump }
+
+    constexpr const field_info fields[] = {
+        vmcs_registry_field(virtual_processor_identifier),
+        vmcs_registry_field(posted_interrupt_notification_vector),
+        vmcs_registry_field(eptp_index),
+        vmcs_registry_field(guest_es_selector),
+        vmcs_registry_field(guest_cs_selector),
+        vmcs_registry_field(guest_ss_selector),
+        vmcs_registry_field(guest_ds_selector),
+        vmcs_registry_field(guest_fs_selector),
+        vmcs_registry_field(guest_gs_selector),
+        vmcs_registry_field(guest_ldtr_selector),
+        vmcs_registry_field(guest_tr_selector),
+        vmcs_registry_field(guest_interrupt_status),
+        vmcs_registry_field(pml_index),
+        vmcs_registry_field(host_es_selector),
+        vmcs_registry_field(host_cs_selector),
+        vmcs_registry_field(host_ss_selector),
+        vmcs_registry_field(host_ds_selector),
+        vmcs_registry_field(host_fs_selector),
+        vmcs_registry_field(host_gs_selector),
+        vmcs_registry_field(host_tr_selector),
+        vmcs_registry_field(address_of_io_bitmap_a),
+        vmcs_registry_field(address_of_io_bitmap_b),
+        vmcs_registry_field(address_of_msr_bitmap),
+        vmcs_registry_field(vm_exit_msr_store_address),
+        vmcs_registry_field(vm_exit_msr_load_address),
+        vmcs_registry_field(vm_entry_msr_load_address),
+        vmcs_registry_field(executive_vmcs_pointer),
+        vmcs_registry_field(pml_address),
+        vmcs_registry_field(tsc_offset),
+        vmcs_registry_field(virtual_apic_address),
+        vmcs_registry_field(apic_access_address),
+        vmcs_registry_field(posted_interrupt_descriptor_address),
+        vmcs_registry_field(vm_function_controls),
+        vmcs_registry_field(ept_pointer),
+        vmcs_registry_field(eoi_exit_bitmap_0),
+        vmcs_registry_field(eoi_exit_bitmap_1),
+        vmcs_registry_field(eoi_exit_bitmap_2),
+        vmcs_registry_field(eoi_exit_bitmap_3),
+        vmcs_registry_field(eptp_list_address),
+        vmcs_registry_field(vmread_bitmap_address),
+        vmcs_registry_field(vmwrite_bitmap_address),
+        vmcs_registry_field(virtualization_exception_information_address),
+        vmcs_registry_field(xss_exiting_bitmap),
+        vmcs_registry_field(encls_exiting_bitmap),
+        vmcs_registry_field(tsc_multiplier),
+        vmcs_registry_field(guest_physical_address),
+        vmcs_registry_field(vmcs_link_pointer),
+        vmcs_registry_field(guest_ia32_debugctl),
+        vmcs_registry_field(guest_ia32_pat),
+        vmcs_registry_field(guest_ia32_efer),
+        vmcs_registry_field(guest_ia32_perf_global_ctrl),
+        vmcs_registry_field(guest_pdpte0),
+        vmcs_registry_field(guest_pdpte1),
+        vmcs_registry_field(guest_pdpte2),
+        vmcs_registry_field(guest_pdpte3),
+        vmcs_registry_field(guest_ia32_bndcfgs),
+        vmcs_registry_field(host_ia32_pat),
+        vmcs_registry_field(host_ia32_efer),
+        vmcs_registry_field(host_ia32_perf_global_ctrl),
+        vmcs_registry_field(pin_based_vm_execution_controls),
+        vmcs_registry_field(primary_processor_based_vm_execution_controls),
+        vmcs_registry_field(exception_bitmap),
+        vmcs_registry_field(page_fault_error_code_mask),
+        vmcs_registry_field(page_fault_error_code_match),
+        vmcs_registry_field(cr3_target_count),
+        vmcs_registry_field(vm_exit_controls),
+        vmcs_registry_field(vm_exit_msr_store_count),
+        vmcs_registry_field(vm_exit_msr_load_count),
+        vmcs_registry_field(vm_entry_controls),
+        vmcs_registry_field(vm_entry_msr_load_count),
+        vmcs_registry_field(vm_entry_interruption_information),
+        vmcs_registry_field(vm_entry_exception_error_code),
+        vmcs_registry_field(vm_entry_instruction_length),
+        vmcs_registry_field(tpr_threshold),
+        vmcs_registry_field(secondary_processor_based_vm_execution_controls),
+        vmcs_registry_field(ple_gap),
+        vmcs_registry_field(ple_window),
+        vmcs_registry_field(vm_instruction_error),
+        vmcs_registry_field(exit_reason),
+        vmcs_registry_field(vm_exit_interruption_information),
+        vmcs_registry_field(vm_exit_interruption_error_code),
+        vmcs_registry_field(idt_vectoring_information),
+        vmcs_registry_field(idt_vectoring_error_code),
+        vmcs_registry_field(vm_exit_instruction_length),
+        vmcs_registry_field(vm_exit_instruction_information),
+        vmcs_registry_field(guest_es_limit),
+        vmcs_registry_field(guest_cs_limit),
+        vmcs_registry_field(guest_ss_limit),
+        vmcs_registry_field(guest_ds_limit),
+        vmcs_registry_field(guest_fs_limit),
+        vmcs_registry_field(guest_gs_limit),
+        vmcs_registry_field(guest_ldtr_limit),
+        vmcs_registry_field(guest_tr_limit),
+        vmcs_registry_field(guest_gdtr_limit),
+        vmcs_registry_field(guest_idtr_limit),
+        vmcs_registry_field(guest_es_access_rights),
+        vmcs_registry_field(guest_cs_access_rights),
+        vmcs_registry_field(guest_ss_access_rights),
+        vmcs_registry_field(guest_ds_access_rights),
+        vmcs_registry_field(guest_fs_access_rights),
+        vmcs_registry_field(guest_gs_access_rights),
+        vmcs_registry_field(guest_ldtr_access_rights),
+        vmcs_registry_field(guest_tr_access_rights),
+        vmcs_registry_field(guest_interruptibility_state),
+        vmcs_registry_field(guest_activity_state),
+        vmcs_registry_field(guest_smbase),
+        vmcs_registry_field(guest_ia32_sysenter_cs),
+        vmcs_registry_field(vmx_preemption_timer_value),
+        vmcs_registry_field(host_ia32_sysenter_cs),
+        vmcs_registry_field(cr0_guest_host_mask),
+        vmcs_registry_field(cr4_guest_host_mask),
+        vmcs_registry_field(cr0_read_shadow),
+        vmcs_registry_field(cr4_read_shadow),
+        vmcs_registry_field(cr3_target_value_0),
+        vmcs_registry_field(cr3_target_value_1),
+        vmcs_registry_field(cr3_target_value_2),
+        vmcs_registry_field(cr3_target_value_3),
+        vmcs_registry_field(exit_qualification),
+        vmcs_registry_field(io_rcx),
+        vmcs_registry_field(io_rsi),
+        vmcs_registry_field(io_rdi),
+        vmcs_registry_field(io_rip),
+        vmcs_registry_field(guest_linear_address),
+        vmcs_registry_field(guest_cr0),
+        vmcs_registry_field(guest_cr3),
+        vmcs_registry_field(guest_cr4),
+        vmcs_registry_field(guest_es_base),
+        vmcs_registry_field(guest_cs_base),
+        vmcs_registry_field(guest_ss_base),
+        vmcs_registry_field(guest_ds_base),
+        vmcs_registry_field(guest_fs_base),
+        vmcs_registry_field(guest_gs_base),
+        vmcs_registry_field(guest_ldtr_base),
+        vmcs_registry_field(guest_tr_base),
+        vmcs_registry_field(guest_gdtr_base),
+        vmcs_registry_field(guest_idtr_base),
+        vmcs_registry_field(guest_dr7),
+        vmcs_registry_field(guest_rsp),
+        vmcs_registry_field(guest_rip),
+        vmcs_registry_field(guest_rflags),
+        vmcs_registry_field(guest_pending_debug_exceptions),
+        vmcs_registry_field(guest_ia32_sysenter_esp),
+        vmcs_registry_field(guest_ia32_sysenter_eip),
+        vmcs_registry_field(host_cr0),
+        vmcs_registry_field(host_cr3),
+        vmcs_registry_field(host_cr4),
+        vmcs_registry_field(host_fs_base),
+        vmcs_registry_field(host_gs_base),
+        vmcs_registry_field(host_tr_base),
+        vmcs_registry_field(host_gdtr_base),
+        vmcs_registry_field(host_idtr_base),
+        vmcs_registry_field(host_ia32_sysenter_esp),
+        vmcs_registry_field(host_ia32_sysenter_eip),
+        vmcs_registry_field(host_rsp),
+        vmcs_registry_field(host_rip),
+    };
+
+#undef vmcs_registry_field
+
+    constexpr const auto num_fields = sizeof(fields) / sizeof(field_info);
+
+    constexpr bool is_sorted() noexcept
+    {
+        for (auto i = 1ULL; i < num_fields; i++) {
+            if (fields[i - 1].addr >= fields[i].addr) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static_assert(is_sorted(), "the vmcs field registry must be sorted by encoding");
+
+    /// Find
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the encoding of the field to look up
+    /// @return the field's registry entry, or nullptr if addr is not the
+    ///     encoding of a field
+    ///
+    inline const field_info *find(field_type addr) noexcept
+    {
+        auto &&field = std::lower_bound(std::begin(fields), std::end(fields), addr,
+        [](const field_info &info, field_type a) { return info.addr < a; });
+
+        if (field == std::end(fields) || field->addr != addr) {
+            return nullptr;
+        }
+
+        return field;
+    }
+
+    /// Name Of
+    ///
+    /// @expects none
+    /// @ensures ret != nullptr
+    ///
+    /// @param addr the encoding of the field to look up
+    /// @return the field's name, or "unknown" if addr is not the encoding
+    ///     of a field
+    ///
+    inline const char *name_of(field_type addr) noexcept
+    {
+        auto &&field = find(addr);
+        return field != nullptr ? field->name : "unknown";
+    }
+}
+}
+}
+
+// *INDENT-ON*
+
+#endif
@@ -41,6 +41,7 @@
 #include <intrinsics/x86/intel/vmcs/natural_width_host_state_fields.h>
 #include <intrinsics/x86/intel/vmcs/natural_width_read_only_data_fields.h>
 
+#include <intrinsics/x86/intel/vmcs/registry.h>
 #include <intrinsics/x86/intel/vmcs/check.h>
 #include <intrinsics/x86/intel/vmcs/debug.h>
 
@@ -0,0 +1,201 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMX_CAPABILITIES_INTEL_X64_H
+#define VMX_CAPABILITIES_INTEL_X64_H
+
+#include <intrinsics/x86/common/msrs_x64.h>
+#include <intrinsics/x86/common/cpuid_x64.h>
+#include <intrinsics/x86/common/thread_context_x64.h>
+#include <intrinsics/x86/intel/per_cpu_intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// VMX Capabilities
+// -----------------------------------------------------------------------------
+
+// The IA32_VMX_* capability MSRs (IA32_VMX_BASIC through IA32_VMX_VMFUNC)
+// cannot change while the CPU is running, but the VMCS accessors read them
+// every time a control is enabled / disabled, or a field's existence is
+// checked, each time with a RDMSR. vmxon_intel_x64::start() captures them
+// (along with the CPUID leaves the VMCS checks need) into a per-CPU
+// snapshot, and from then on, the MSR accessors read the snapshot instead.
+// Until a CPU has a snapshot (or if the CPU's id is too large to have
+// one), the accessors fall back to RDMSR / CPUID.
+//
+// The capability MSRs that the CPU does not have (e.g. the TRUE controls,
+// or IA32_VMX_VMFUNC) are captured as 0, which means that none of their
+// controls are allowed to be 1.
+
+namespace intel_x64
+{
+namespace vmx_capabilities
+{
+
+using field_type = x64::msrs::field_type;
+using value_type = x64::msrs::value_type;
+
+constexpr const field_type msrs_begin = 0x00000480U;
+constexpr const field_type msrs_end = 0x00000492U;
+
+using snapshot_type = per_cpu::vmx_capabilities_type;
+
+static_assert(msrs_end - msrs_begin == per_cpu::vmx_capability_msrs,
+              "the snapshot must hold every capability MSR");
+
+inline const snapshot_type *current() noexcept
+{
+    auto &&state = per_cpu::this_cpu();
+
+    if (state == nullptr || !state->vmx_capabilities.captured) {
+        return nullptr;
+    }
+
+    return &state->vmx_capabilities;
+}
+
+/// Capture
+///
+/// Captures the capability MSRs of the CPU this is called on. Any
+/// previous snapshot of this CPU is replaced.
+///
+/// @expects VMX is supported (CPUID.1:ECX.VMX)
+/// @ensures none
+///
+/// @return true if the snapshot was captured, false if the CPU's id is
+///     too large to have one
+///
+inline bool capture() noexcept
+{
+    auto &&state = per_cpu::this_cpu();
+
+    if (state == nullptr) {
+        return false;
+    }
+
+    auto &&snapshot = state->vmx_capabilities;
+    snapshot = {};
+
+    auto &&read = [&](field_type addr)
+    { gsl::at(snapshot.msrs, addr - msrs_begin) = _read_msr(addr); };
+
+    auto &&is_allowed1 = [&](field_type addr, uint64_t from)
+    { return is_bit_set(gsl::at(snapshot.msrs, addr - msrs_begin), from + 32); };
+
+    // IA32_VMX_BASIC through IA32_VMX_VMCS_ENUM always exist
+
+    for (auto addr = msrs_begin; addr <= 0x0000048AU; addr++) {
+        read(addr);
+    }
+
+    // IA32_VMX_PROCBASED_CTLS2 exists if "activate secondary controls"
+    // can be 1, IA32_VMX_EPT_VPID_CAP if "enable EPT" or "enable VPID"
+    // can be 1, and IA32_VMX_VMFUNC if "enable VM functions" can be 1.
+    // The TRUE controls exist if IA32_VMX_BASIC[55] is set.
+
+    if (is_allowed1(0x00000482U, 31)) {
+        read(0x0000048BU);
+
+        if (is_allowed1(0x0000048BU, 1) || is_allowed1(0x0000048BU, 5)) {
+            read(0x0000048CU);
+        }
+
+        if (is_allowed1(0x0000048BU, 13)) {
+            read(0x00000491U);
+        }
+    }
+
+    if (is_bit_set(gsl::at(snapshot.msrs, 0), 55)) {
+        for (auto addr = 0x0000048DU; addr <= 0x00000490U; addr++) {
+            read(addr);
+        }
+    }
+
+    snapshot.phys_addr_bits = x64::cpuid::addr_size::phys::get();
+    snapshot.captured = true;
+
+    return true;
+}
+
+/// Release
+///
+/// Discards the snapshot of the CPU this is called on, after which the
+/// accessors read the MSRs again.
+///
+/// @expects none
+/// @ensures none
+///
+inline void release() noexcept
+{
+    if (auto &&state = per_cpu::this_cpu()) {
+        state->vmx_capabilities.captured = false;
+    }
+}
+
+/// Is Captured
+///
+/// @expects none
+/// @ensures none
+///
+/// @return true if the CPU this is called on has a snapshot
+///
+inline bool is_captured() noexcept
+{ return current() != nullptr; }
+
+/// Read MSR
+///
+/// @expects none
+/// @ensures none
+///
+/// @param addr the capability MSR to read
+/// @return the MSR's value from the snapshot if the CPU this is called on
+///     has one, otherwise the MSR's value
+///
+inline value_type read_msr(field_type addr) noexcept
+{
+    if (auto snapshot = current()) {
+        if (addr >= msrs_begin && addr < msrs_end) {
+            return gsl::at(snapshot->msrs, addr - msrs_begin);
+        }
+    }
+
+    return _read_msr(addr);
+}
+
+/// Physical Address Bits
+///
+/// @expects none
+/// @ensures none
+///
+/// @return the CPU's physical address width (CPUID.80000008H:EAX[7:0])
+///
+inline value_type phys_addr_bits() noexcept
+{
+    if (auto snapshot = current()) {
+        return snapshot->phys_addr_bits;
+    }
+
+    return x64::cpuid::addr_size::phys::get();
+}
+
+}
+}
+
+#endif
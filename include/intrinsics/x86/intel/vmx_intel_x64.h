@@ -26,6 +26,9 @@
 #include <bfdebug.h>
 #include <bfbitmanip.h>
 
+#include <intrinsics/x86/common/thread_context_x64.h>
+#include <intrinsics/x86/intel/per_cpu_intel_x64.h>
+
 // -----------------------------------------------------------------------------
 // Exports
 // -----------------------------------------------------------------------------
@@ -59,19 +62,232 @@ extern "C" EXPORT_INTRINSICS bool _invvpid(uint64_t type, void *ptr) noexcept;
 
 // *INDENT-OFF*
 
+// -----------------------------------------------------------------------------
+// Current VMCS
+// -----------------------------------------------------------------------------
+
+// A CPU has at most one current VMCS (the one its last VMPTRLD loaded), and
+// VMREAD / VMWRITE / VMRESUME all operate on it. vm::load() and vm::clear()
+// record the physical address of the current VMCS of the CPU they run on,
+// and vmx::on() / vmx::off() forget it, so that loading a VMCS that is
+// already current can be skipped. A CPU whose id is too large to be
+// tracked always reports that it has no current VMCS.
+
+namespace intel_x64
+{
+namespace vm
+{
+    using field_type = uint64_t;
+    using value_type = uint64_t;
+    using name_type = const char *;
+    using integer_pointer = uintptr_t;
+
+    /// Current
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the physical address of the current VMCS of the CPU this
+    ///     is called on, or 0 if it has none (or it is not tracked)
+    ///
+    inline integer_pointer current() noexcept
+    {
+        if (auto &&state = per_cpu::this_cpu()) {
+            return state->current_vmcs;
+        }
+
+        return 0;
+    }
+
+    /// Set Current
+    ///
+    /// Records the current VMCS of the CPU this is called on. This is done
+    /// by vm::load() / vm::clear() and vmx::on() / vmx::off(), and should
+    /// only be needed directly when the current VMCS changes some other way.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param phys the physical address of the current VMCS, or 0 if none
+    ///
+    inline void set_current(integer_pointer phys) noexcept
+    {
+        if (auto &&state = per_cpu::this_cpu()) {
+            state->current_vmcs = phys;
+        }
+    }
+}
+}
+
+// -----------------------------------------------------------------------------
+// Dirty Fields
+// -----------------------------------------------------------------------------
+
+// When enabled, vm::write() records which fields of the current VMCS it
+// has written, so that the consistency checks that depend on them can be
+// run again before the next VM entry (and the rest skipped). A field is
+// tracked by its width, type and the low 6 bits of its index, so two
+// fields can share a bit, which only causes extra checks to be run.
+// Loading a VMCS marks every field dirty, as nothing is known about what
+// was written to it since it was last current. Fields written by the CPU
+// on VM exit are not tracked.
+
 namespace intel_x64
 {
+namespace vm
+{
+    constexpr const auto dirty_words = per_cpu::dirty_words;
+
+    inline auto &dirty_enabled() noexcept
+    {
+        return per_cpu::g_track_dirty_fields;
+    }
+
+    constexpr uint64_t dirty_bit(field_type field) noexcept
+    { return ((field & 0x6000ULL) >> 5) | ((field & 0x0C00ULL) >> 4) | ((field & 0x007EULL) >> 1); }
+
+    inline uint64_t *dirty_words_of_this_cpu() noexcept
+    {
+        if (auto &&state = per_cpu::this_cpu()) {
+            return state->dirty;
+        }
+
+        return nullptr;
+    }
+
+    /// Mark Dirty
+    ///
+    /// @expects none
+    /// @ensures is_dirty(field) == true
+    ///
+    /// @param field the field of the current VMCS that was written
+    ///
+    inline void mark_dirty(field_type field) noexcept
+    {
+        if (auto &&words = dirty_words_of_this_cpu()) {
+            auto &&bit = dirty_bit(field);
+            auto &&word = gsl::make_span(words, dirty_words).at(static_cast<std::ptrdiff_t>(bit >> 6));
+
+            word |= 1ULL << (bit & 0x3FU);
+        }
+    }
+
+    /// Mark All Dirty
+    ///
+    /// @expects none
+    /// @ensures is_dirty(field) == true, for every field
+    ///
+    inline void mark_all_dirty() noexcept
+    {
+        if (auto &&words = dirty_words_of_this_cpu()) {
+            for (auto &&word : gsl::make_span(words, dirty_words)) {
+                word = ~0ULL;
+            }
+        }
+    }
+
+    /// Clear Dirty
+    ///
+    /// Forgets which fields of the current VMCS have been written. This
+    /// should be done once the fields have been checked.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    inline void clear_dirty() noexcept
+    {
+        if (auto &&words = dirty_words_of_this_cpu()) {
+            for (auto &&word : gsl::make_span(words, dirty_words)) {
+                word = 0ULL;
+            }
+        }
+    }
+
+    /// Is Dirty
+    ///
+    /// A CPU whose id is too large to be tracked reports every field as
+    /// dirty.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param field the field of the current VMCS to check
+    /// @return true if the field (or one sharing its bit) has been
+    ///     written since the dirty fields were last cleared
+    ///
+    inline bool is_dirty(field_type field) noexcept
+    {
+        if (auto &&words = dirty_words_of_this_cpu()) {
+            auto &&bit = dirty_bit(field);
+            auto &&word = gsl::make_span(words, dirty_words).at(static_cast<std::ptrdiff_t>(bit >> 6));
+
+            return (word & (1ULL << (bit & 0x3FU))) != 0;
+        }
+
+        return true;
+    }
+
+    /// Track Dirty Fields
+    ///
+    /// Enables (or disables) dirty field tracking on every CPU. When it
+    /// is enabled, every field of each CPU's current VMCS starts out dirty.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true to track the fields that vm::write() writes
+    ///
+    inline void track_dirty_fields(bool enabled) noexcept
+    {
+        if (enabled && !dirty_enabled()) {
+            for (auto &&state : per_cpu::g_state) {
+                for (auto &&word : state.dirty) {
+                    word = ~0ULL;
+                }
+            }
+        }
+
+        dirty_enabled() = enabled;
+    }
+}
+
 namespace vmx
 {
     using vpid_type = uint64_t;
     using eptp_type = uint64_t;
     using integer_pointer = uintptr_t;
 
+    /// Off Count
+    ///
+    /// VMXOFF ends VMX operation, after which none of the VMCSs that were
+    /// active on the CPU are active anymore (and VMCLEAR would #UD until
+    /// the next VMXON). vmx::off() counts how often this happened on each
+    /// CPU, so that a VMCS can tell whether it is still active on the CPU
+    /// that loaded it.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param cpuid the id of the CPU
+    /// @return the number of times vmx::off() has succeeded on the given
+    ///     CPU, or ~0 if the CPU is not tracked
+    ///
+    inline uint64_t off_count(uint64_t cpuid) noexcept
+    {
+        if (auto state = per_cpu::cpu(cpuid)) {
+            return state->vmxoff_count;
+        }
+
+        return ~0ULL;
+    }
+
     inline void on(gsl::not_null<void *> ptr)
     {
         if (!_vmxon(ptr)) {
             throw std::runtime_error("vmx::on failed");
         }
+
+        vm::set_current(0);
     }
 
     inline void off()
@@ -79,6 +295,12 @@ namespace vmx
         if (!_vmxoff()) {
             throw std::runtime_error("vmx::off failed");
         }
+
+        vm::set_current(0);
+
+        if (auto state = per_cpu::this_cpu()) {
+            state->vmxoff_count++;
+        }
     }
 
     inline void invept_single_context(eptp_type eptp)
@@ -132,16 +354,15 @@ namespace vmx
 
 namespace vm
 {
-    using field_type = uint64_t;
-    using value_type = uint64_t;
-    using name_type = const char *;
-    using integer_pointer = uintptr_t;
-
     inline void clear(gsl::not_null<void *> ptr)
     {
         if (!_vmclear(ptr)) {
             throw std::runtime_error("vm::clear failed");
         }
+
+        if (current() == *static_cast<integer_pointer *>(ptr.get())) {
+            set_current(0);
+        }
     }
 
     inline void load(gsl::not_null<void *> ptr)
@@ -149,6 +370,12 @@ namespace vm
         if (!_vmptrld(ptr)) {
             throw std::runtime_error("vm::load failed");
         }
+
+        set_current(*static_cast<integer_pointer *>(ptr.get()));
+
+        if (dirty_enabled()) {
+            mark_all_dirty();
+        }
     }
 
     inline void reset(gsl::not_null<void *> ptr)
@@ -183,6 +410,10 @@ namespace vm
 
             throw std::runtime_error("vm::write failed");
         }
+
+        if (dirty_enabled()) {
+            mark_dirty(field);
+        }
     }
 
     inline void launch_demote()
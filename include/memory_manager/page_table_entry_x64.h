@@ -397,6 +397,16 @@ public:
     ///
     void set_pat_index_large(pat_index_type index);
 
+    /// Get
+    ///
+    /// @expects none
+    /// @ensures ret != nullptr
+    ///
+    /// @return the pte that this page table entry encapsulates
+    ///
+    pointer get() const noexcept
+    { return m_pte; }
+
     /// Clear PTE
     ///
     /// @expects none
@@ -64,6 +64,26 @@ public:
     using size_type = std::size_t;
     using memory_descriptor_list = std::vector<memory_descriptor>;
 
+    /// Parent Entry Initializer
+    ///
+    /// Points the parent entry (pte) at a new page table located at the
+    /// physical address phys. Formats that share the x64 layout (4 levels
+    /// of 512 entries, e.g. EPT) only differ in how a parent entry is
+    /// encoded, and provide their own initializer to reuse this class.
+    ///
+    using init_entry_type = void (*)(pointer pte, integer_pointer phys);
+
+    /// Split Entry Initializer
+    ///
+    /// Initializes pte, an entry of the table that replaces a large page
+    /// (large is the value of the large page's entry), so that it maps
+    /// the part of the large page that is offset bytes into it, with the
+    /// same attributes. is_large is true if pte is itself a large page
+    /// (i.e. a 1g page that is split into 2m pages).
+    ///
+    using split_entry_type =
+        void (*)(pointer pte, integer_pointer large, integer_pointer offset, bool is_large);
+
     /// Constructor
     ///
     /// Creates a page table, and stores the parent entry that points to
@@ -74,8 +94,13 @@ public:
     /// @ensures none
     ///
     /// @param pte the parent page table entry that points to this table
+    /// @param init_entry initializes the parent entry of this table (and
+    ///     of all of the tables below it)
+    /// @param split_entry initializes the entries of a table that replaces
+    ///     a large page (in this table, or in any of the tables below it)
     ///
-    page_table_x64(gsl::not_null<pointer> pte);
+    page_table_x64(gsl::not_null<pointer> pte, init_entry_type init_entry = init_x64_entry,
+                   split_entry_type split_entry = split_x64_entry);
 
     /// Destructor
     ///
@@ -90,7 +115,9 @@ public:
     /// public function, and should only be used to add pages to the
     /// PML4 page table. This function will call a private version that
     /// will parse through the different levels making sure the virtual
-    /// address provided is valid.
+    /// address provided is valid. A larger page that contains addr is
+    /// split into smaller pages with the same attributes first, so the
+    /// rest of it stays mapped.
     ///
     /// @expects none
     /// @ensures none
@@ -108,7 +135,9 @@ public:
     /// public function, and should only be used to add pages to the
     /// PML4 page table. This function will call a private version that
     /// will parse through the different levels making sure the virtual
-    /// address provided is valid.
+    /// address provided is valid. A larger page that contains addr is
+    /// split into smaller pages with the same attributes first, so the
+    /// rest of it stays mapped.
     ///
     /// @expects none
     /// @ensures none
@@ -126,7 +155,9 @@ public:
     /// public function, and should only be used to add pages to the
     /// PML4 page table. This function will call a private version that
     /// will parse through the different levels making sure the virtual
-    /// address provided is valid.
+    /// address provided is valid. A larger page that contains addr is
+    /// split into smaller pages with the same attributes first, so the
+    /// rest of it stays mapped.
     ///
     /// @expects none
     /// @ensures none
@@ -182,9 +213,40 @@ public:
     memory_descriptor_list pt_to_mdl() const
     { memory_descriptor_list mdl; return pt_to_mdl(mdl); }
 
+    /// x64 Parent Entry Initializer
+    ///
+    /// Initializes pte as a present, writable, write-back x64 entry that
+    /// points to phys. This is the default initializer.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param pte the parent entry to initialize
+    /// @param phys the physical address of the page table
+    ///
+    static void init_x64_entry(pointer pte, integer_pointer phys);
+
+    /// x64 Split Entry Initializer
+    ///
+    /// Initializes pte as a part of the x64 large page large. This is the
+    /// default split initializer.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param pte the entry to initialize
+    /// @param large the value of the large page's entry
+    /// @param offset the offset of the part of the large page pte maps
+    /// @param is_large true if pte is a large page, false if it is a 4k
+    ///     page
+    ///
+    static void split_x64_entry(
+        pointer pte, integer_pointer large, integer_pointer offset, bool is_large);
+
 private:
 
     page_table_entry_x64 add_page(integer_pointer addr, integer_pointer bits, integer_pointer end);
+    void split_page(integer_pointer large, integer_pointer bits);
     void remove_page(integer_pointer addr, integer_pointer bits);
     page_table_entry_x64 virt_to_pte(integer_pointer addr, integer_pointer bits) const;
     memory_descriptor_list pt_to_mdl(memory_descriptor_list &mdl) const;
@@ -197,6 +259,9 @@ private:
 
     friend class memory_manager_ut;
 
+    init_entry_type m_init_entry;
+    split_entry_type m_split_entry;
+
     std::unique_ptr<integer_pointer[]> m_pt;
     std::vector<std::unique_ptr<page_table_x64>> m_pts;
 
@@ -25,6 +25,7 @@
 #include <vcpu/vcpu.h>
 #include <vmxon/vmxon_intel_x64.h>
 #include <vmcs/vmcs_intel_x64.h>
+#include <vmcs/vmcs_intel_x64_context_set.h>
 #include <vmcs/vmcs_intel_x64_vmm_state.h>
 #include <vmcs/vmcs_intel_x64_host_vm_state.h>
 #include <exit_handler/exit_handler_intel_x64.h>
@@ -127,6 +128,10 @@ public:
 
     /// Run vCPU
     ///
+    /// The first run launches the vCPU's own VMCS (the primary context).
+    /// After that, the vCPU resumes whichever of its VMCS contexts is
+    /// current (see vmcs_intel_x64_context_set).
+    ///
     /// @expects this->is_initialized() == true
     /// @ensures none
     ///
@@ -155,6 +160,7 @@ protected:
     std::unique_ptr<state_save_intel_x64> m_state_save;
     std::unique_ptr<vmcs_intel_x64_state> m_vmm_state;
     std::unique_ptr<vmcs_intel_x64_state> m_guest_state;
+    std::unique_ptr<vmcs_intel_x64_context_set> m_contexts;
 
 public:
 
@@ -24,6 +24,10 @@
 #define VMCS_INTEL_X64_H
 
 #include <vmcs/vmcs_intel_x64_state.h>
+#include <vmcs/vmcs_intel_x64_msr_area.h>
+#include <vmcs/vmcs_intel_x64_vpid.h>
+#include <vmcs/vmcs_intel_x64_snapshot.h>
+#include <ept/ept_intel_x64.h>
 #include <exit_handler/state_save_intel_x64.h>
 
 // -----------------------------------------------------------------------------
@@ -81,10 +85,14 @@ public:
 
     /// Destructor
     ///
+    /// Releases the VMCS region and the exit handler stack, which are
+    /// otherwise kept for as long as the VMCS exists (i.e. until its
+    /// vCPU is deleted).
+    ///
     /// @expects none
     /// @ensures none
     ///
-    virtual ~vmcs_intel_x64() = default;
+    virtual ~vmcs_intel_x64();
 
     /// Launch
     ///
@@ -93,6 +101,18 @@ public:
     /// the VMCS and its state, starting the VM over again. For this reason
     /// it should only be called once, unless you intend to clear the VM.
     ///
+    /// The VMCS region and the exit handler stack are allocated by the
+    /// first launch, and reused by every launch after that (e.g. when the
+    /// VMM is stopped and started again on this CPU). The region is
+    /// cleared, and its revision ID written again, before it is reused.
+    ///
+    /// The control and host state fields written by the first launch are
+    /// kept in a snapshot, so that launching the VMCS again only has to
+    /// compute the guest state (which is read from the CPU each time).
+    ///
+    /// If the VMCS has been prepared (see prepare()) since it was last
+    /// launched, it is launched with the fields as they are.
+    ///
     /// @expects host_state != nullptr
     /// @expects guest_state != nullptr
     /// @ensures none
@@ -101,6 +121,24 @@ public:
         gsl::not_null<vmcs_intel_x64_state *> host_state,
         gsl::not_null<vmcs_intel_x64_state *> guest_state);
 
+    /// Prepare
+    ///
+    /// Does everything launch() does before the VM launch itself: the VMCS
+    /// is created (or cleared), loaded, and its fields are written. The
+    /// fields can then be read / written (e.g. to inject an event into the
+    /// guest) before the VMCS is launched, and the next launch() uses
+    /// them as they are, instead of writing them again. If the VMCS has
+    /// already been prepared since it was last launched, it is only
+    /// loaded.
+    ///
+    /// @expects host_state != nullptr
+    /// @expects guest_state != nullptr
+    /// @ensures none
+    ///
+    virtual void prepare(
+        gsl::not_null<vmcs_intel_x64_state *> host_state,
+        gsl::not_null<vmcs_intel_x64_state *> guest_state);
+
     /// Resume
     ///
     /// Resumes the VMCS. Note that this should only be called after a launch,
@@ -155,7 +193,11 @@ public:
     /// must be executed. Once gain, the CPU needs to know which VMCS to use,
     /// and thus a load is needed.
     ///
-    /// @expects none
+    /// If this VMCS is already the current VMCS of this CPU, the VMPTRLD is
+    /// skipped. A VMCS that is active on another CPU cannot be loaded until
+    /// it has been cleared on that CPU.
+    ///
+    /// @expects the VMCS is not active on another CPU
     /// @ensures none
     ///
     virtual void load();
@@ -168,18 +210,53 @@ public:
     /// valid bit in the VMCS, rendering future reads / writes to this VMCS
     /// invalid.
     ///
-    /// @expects none
+    /// The VMCLEAR is skipped if the VMCS has not been loaded since it was
+    /// last cleared. Clearing the VMCS on the CPU it is active on is also
+    /// how it is moved to another CPU, after which it must be launched
+    /// again (not resumed) on the new CPU.
+    ///
+    /// @expects the VMCS is not active on another CPU
     /// @ensures none
     ///
     virtual void clear();
 
+    /// Set Check On Entry
+    ///
+    /// When enabled, the VMCS is checked for consistency (see
+    /// vmcs::check) before every VM launch / resume, instead of only once
+    /// an entry has failed. This is meant for debugging (e.g. soak
+    /// testing), so that a bad field is caught before the entry that
+    /// uses it. Only the checks that depend on a field written since
+    /// the last entry are run, which requires dirty field tracking (see
+    /// vm::track_dirty_fields()), and so enabling this turns it on.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true to check the VMCS before every VM entry
+    ///
+    virtual void set_check_on_entry(bool enabled);
+
 protected:
 
     virtual void write_fields(gsl::not_null<vmcs_intel_x64_state *> host_state,
                               gsl::not_null<vmcs_intel_x64_state *> guest_state);
 
+    // Used instead of write_fields() when the VMCS is launched again. The
+    // control and host state fields are restored from the snapshot taken
+    // at the first launch, and only the fields that depend on the guest,
+    // or on objects that may have changed since (the exit handler stack,
+    // VPID, MSR area and EPT), are written again. A subclass that
+    // overrides write_fields() should override this as well.
+
+    virtual void restore_fields(gsl::not_null<vmcs_intel_x64_state *> host_state,
+                                gsl::not_null<vmcs_intel_x64_state *> guest_state);
+
+    void check_entry();
+
     void create_vmcs_region();
     void release_vmcs_region() noexcept;
+    bool is_active() const noexcept;
 
     void create_exit_handler_stack();
     void release_exit_handler_stack() noexcept;
@@ -189,15 +266,9 @@ protected:
     void write_32bit_control_state(gsl::not_null<vmcs_intel_x64_state *> state);
     void write_natural_control_state(gsl::not_null<vmcs_intel_x64_state *> state);
 
-    void write_16bit_guest_state(gsl::not_null<vmcs_intel_x64_state *> state);
-    void write_64bit_guest_state(gsl::not_null<vmcs_intel_x64_state *> state);
-    void write_32bit_guest_state(gsl::not_null<vmcs_intel_x64_state *> state);
-    void write_natural_guest_state(gsl::not_null<vmcs_intel_x64_state *> state);
-
-    void write_16bit_host_state(gsl::not_null<vmcs_intel_x64_state *> state);
-    void write_64bit_host_state(gsl::not_null<vmcs_intel_x64_state *> state);
-    void write_32bit_host_state(gsl::not_null<vmcs_intel_x64_state *> state);
-    void write_natural_host_state(gsl::not_null<vmcs_intel_x64_state *> state);
+    void write_guest_state(gsl::not_null<vmcs_intel_x64_state *> state);
+    void write_host_state(gsl::not_null<vmcs_intel_x64_state *> state);
+    void write_exit_handler_state();
 
     void pin_based_vm_execution_controls();
     void primary_processor_based_vm_execution_controls();
@@ -211,17 +282,62 @@ protected:
     std::unique_ptr<uint32_t[]> m_vmcs_region;
     std::unique_ptr<gsl::byte[]> m_exit_handler_stack;
 
+    // The CPU the VMCS is active on (loaded, and not cleared since), if
+    // any, and whether the VMCS is clear (cleared, and not loaded since).
+    // The VMCS stops being active when its CPU leaves VMX operation, which
+    // is why the CPU's vmx::off_count() is recorded when it is loaded.
+
+    bool m_active{false};
+    bool m_cleared{false};
+    uint64_t m_active_cpuid{0};
+    uint64_t m_active_vmxoff_count{0};
+
+    // Whether the fields have been written by prepare(), and not launched
+    // since.
+
+    bool m_prepared{false};
+
+    bool m_check_on_entry{false};
+
 public:
 
     void *m_exit_handler_entry{nullptr};
     state_save_intel_x64 *m_state_save{nullptr};
 
+    // The MSRs the CPU switches between the host and the guest on every
+    // VM entry / exit. Empty (and unallocated) unless an MSR is added,
+    // which is only worth the cost on every exit / entry for an MSR whose
+    // host value differs from the guest's. The exit handler emulates
+    // rdmsr / wrmsr to any MSR in the area using its guest value.
+
+    vmcs_intel_x64_msr_area m_msr_area;
+
+    // The VPID that tags the guest's TLB entries. Allocated the first time
+    // the VMCS is written (if supported), and freed with the VMCS.
+
+    vmcs_intel_x64_vpid m_vpid;
+
+    // The EPT that maps the guest's physical memory, if any. Not owned by
+    // the VMCS, and must outlive it.
+
+    ept_intel_x64 *m_ept{nullptr};
+
+    // The control and host state fields as they were written by the first
+    // launch, which are restored (instead of computed again) every time
+    // the VMCS is launched after that (e.g. when the VMM is stopped and
+    // started again on this CPU).
+
+    vmcs_intel_x64_snapshot m_launch_snapshot;
+
     virtual void set_state_save(gsl::not_null<state_save_intel_x64 *> state_save)
     { m_state_save = state_save; }
 
     virtual void set_exit_handler_entry(void *entry)
     { m_exit_handler_entry = entry; }
 
+    virtual void set_ept(ept_intel_x64 *ept)
+    { m_ept = ept; }
+
 public:
 
     vmcs_intel_x64(vmcs_intel_x64 &&) noexcept = default;
@@ -0,0 +1,273 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_CONTEXT_SET_H
+#define VMCS_INTEL_X64_CONTEXT_SET_H
+
+#include <memory>
+#include <vector>
+
+#include <vmcs/vmcs_intel_x64.h>
+#include <vmcs/vmcs_intel_x64_state.h>
+#include <exit_handler/state_save_intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_VMCS
+#ifdef SHARED_VMCS
+#define EXPORT_VMCS EXPORT_SYM
+#else
+#define EXPORT_VMCS IMPORT_SYM
+#endif
+#else
+#define EXPORT_VMCS
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCS Context Set
+///
+/// The set of VMCS contexts of a vCPU. Each context is a VMCS, the state
+/// save area the VMCS exits to, the guest state the VMCS is launched with,
+/// and whether or not the VMCS has been launched. The first context (the
+/// primary context) is the vCPU's own VMCS and state save, which are
+/// launched by the vCPU. Any other context is added by the VMM (e.g. for a
+/// guest with more than one execution context), and is launched the first
+/// time it is resumed.
+///
+/// Switching to another context only loads its VMCS (VMPTRLD), and makes
+/// its state save the current one. The host state of each VMCS is written
+/// once, when the VMCS is first switched to (or launched), and is not
+/// written again when the vCPU switches between contexts.
+///
+/// Note that all of the contexts of a vCPU must run on the same CPU, as the
+/// VMCS of every context that has been launched stays active on that CPU.
+///
+class EXPORT_VMCS vmcs_intel_x64_context_set
+{
+public:
+
+    using context_type = std::size_t;
+
+    /// Primary Context
+    ///
+    /// The vCPU's own VMCS and state save.
+    ///
+    static constexpr const context_type primary = 0;
+
+    /// Constructor
+    ///
+    /// @expects vmcs != nullptr
+    /// @expects state_save != nullptr
+    /// @expects host_state != nullptr
+    /// @ensures none
+    ///
+    /// @param vmcs the vCPU's VMCS (the primary context)
+    /// @param state_save the vCPU's state save (the primary context)
+    /// @param host_state the host state that is written to the VMCS of
+    ///     each context when it is launched
+    /// @param exit_handler_entry the exit handler's entry point
+    ///
+    vmcs_intel_x64_context_set(
+        gsl::not_null<vmcs_intel_x64 *> vmcs,
+        gsl::not_null<state_save_intel_x64 *> state_save,
+        gsl::not_null<vmcs_intel_x64_state *> host_state,
+        void *exit_handler_entry);
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~vmcs_intel_x64_context_set() = default;
+
+    /// Add
+    ///
+    /// Adds a context to the set. The context gets its own state save,
+    /// which is given the vCPU's ID, VMXON and exit handler (taken from
+    /// the primary context's state save). The guest's RIP and RSP are
+    /// written to the VMCS from the state save when the context is
+    /// launched, so they should be set (see state_save()) before the
+    /// context is first resumed.
+    ///
+    /// @expects vmcs != nullptr
+    /// @expects guest_state != nullptr
+    /// @expects guest_state->is_guest()
+    /// @ensures none
+    ///
+    /// @param vmcs the VMCS of the new context
+    /// @param guest_state the guest state the new context is launched with
+    /// @return the new context
+    ///
+    context_type add(
+        std::unique_ptr<vmcs_intel_x64> vmcs,
+        std::unique_ptr<vmcs_intel_x64_state> guest_state);
+
+    /// Switch To
+    ///
+    /// Makes the provided context the current context, and loads its VMCS
+    /// (which is skipped if it is already the current VMCS), so that its
+    /// fields can be read / written. The VMCS of a context that has not
+    /// been launched yet is prepared (see vmcs_intel_x64::prepare()), and
+    /// is launched with whatever was written to it in the meantime.
+    ///
+    /// @expects ctx < size()
+    /// @ensures current() == ctx
+    ///
+    /// @param ctx the context to switch to
+    ///
+    void switch_to(context_type ctx);
+
+    /// Load
+    ///
+    /// Loads the VMCS of the current context, if it has been launched.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void load();
+
+    /// Resume
+    ///
+    /// Resumes the current context, launching it if this is the first time
+    /// it is resumed. As with vmcs_intel_x64::resume, the VMCS of a context
+    /// that has been launched must be loaded (see switch_to() and load()).
+    /// This function does not return if it is successful.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void resume();
+
+    /// Reset
+    ///
+    /// Makes the primary context the current context, and marks all of the
+    /// other contexts as not launched, so that each one is launched again
+    /// the next time it is resumed. This should be called when the vCPU is
+    /// launched (again).
+    ///
+    /// @expects none
+    /// @ensures current() == primary
+    ///
+    void reset() noexcept;
+
+    /// Current
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the current context
+    ///
+    context_type current() const noexcept
+    { return m_current; }
+
+    /// Size
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of contexts in the set, including the primary
+    ///     context
+    ///
+    std::size_t size() const noexcept
+    { return m_contexts.size(); }
+
+    /// Is Launched
+    ///
+    /// @expects ctx < size()
+    /// @ensures none
+    ///
+    /// @param ctx the context to look up
+    /// @return true if the context has been launched, false otherwise
+    ///
+    bool is_launched(context_type ctx) const;
+
+    /// VMCS
+    ///
+    /// @expects ctx < size()
+    /// @ensures none
+    ///
+    /// @param ctx the context to look up
+    /// @return the VMCS of the context
+    ///
+    vmcs_intel_x64 *vmcs(context_type ctx) const;
+
+    /// State Save
+    ///
+    /// @expects ctx < size()
+    /// @ensures none
+    ///
+    /// @param ctx the context to look up
+    /// @return the state save of the context
+    ///
+    state_save_intel_x64 *state_save(context_type ctx) const;
+
+private:
+
+    struct context
+    {
+        vmcs_intel_x64 *vmcs;
+        state_save_intel_x64 *state_save;
+        vmcs_intel_x64_state *guest_state;
+
+        bool launched;
+
+        std::unique_ptr<vmcs_intel_x64> owned_vmcs;
+        std::unique_ptr<state_save_intel_x64> owned_state_save;
+        std::unique_ptr<vmcs_intel_x64_state> owned_guest_state;
+    };
+
+    context &get(context_type ctx);
+    const context &get(context_type ctx) const;
+
+private:
+
+    std::vector<context> m_contexts;
+    context_type m_current{primary};
+
+    vmcs_intel_x64_state *m_host_state;
+    void *m_exit_handler_entry;
+
+public:
+
+    vmcs_intel_x64_context_set(vmcs_intel_x64_context_set &&) noexcept = default;
+    vmcs_intel_x64_context_set &operator=(vmcs_intel_x64_context_set &&) noexcept = default;
+
+    vmcs_intel_x64_context_set(const vmcs_intel_x64_context_set &) = delete;
+    vmcs_intel_x64_context_set &operator=(const vmcs_intel_x64_context_set &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
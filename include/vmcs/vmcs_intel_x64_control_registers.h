@@ -0,0 +1,94 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_CONTROL_REGISTERS_H
+#define VMCS_INTEL_X64_CONTROL_REGISTERS_H
+
+#include <intrinsics/x86/intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Control Register Virtualization
+// -----------------------------------------------------------------------------
+
+// *INDENT-OFF*
+
+namespace intel_x64
+{
+namespace vmcs
+{
+
+/// Control Register Virtualization
+///
+/// The guest owns every bit of CR0 / CR4, except for the bits that VMX
+/// operation fixes (IA32_VMX_CRx_FIXED0 / FIXED1), which the VMM owns.
+/// Only the owned bits are set in the guest / host masks, so a guest
+/// write only exits if it tries to change one of them (relative to the
+/// read shadow), and every other write is performed by the hardware.
+///
+/// The read shadows hold what the guest believes the owned bits to be.
+/// CR4.VMXE is set by the VMM (not the guest), so it is hidden from the
+/// guest's CR4 read shadow.
+///
+namespace control_registers
+{
+    inline auto cr0_guest_host_mask() noexcept
+    {
+        return msrs::ia32_vmx_cr0_fixed0::get() |
+               ~msrs::ia32_vmx_cr0_fixed1::get();
+    }
+
+    inline auto cr4_guest_host_mask() noexcept
+    {
+        return msrs::ia32_vmx_cr4_fixed0::get() |
+               ~msrs::ia32_vmx_cr4_fixed1::get();
+    }
+
+    inline auto cr0_read_shadow(value_type cr0) noexcept
+    { return cr0; }
+
+    inline auto cr4_read_shadow(value_type cr4) noexcept
+    { return cr4 & ~intel_x64::cr4::vmx_enable_bit::mask; }
+
+    /// Returns the value that is loaded into the guest's CR0 when the
+    /// guest writes val (i.e. val, with the fixed bits forced).
+    ///
+    inline auto cr0_guest_value(value_type val) noexcept
+    {
+        return (val | msrs::ia32_vmx_cr0_fixed0::get()) &
+               msrs::ia32_vmx_cr0_fixed1::get();
+    }
+
+    /// Returns the value that is loaded into the guest's CR4 when the
+    /// guest writes val (i.e. val, with the fixed bits forced).
+    ///
+    inline auto cr4_guest_value(value_type val) noexcept
+    {
+        return (val | msrs::ia32_vmx_cr4_fixed0::get()) &
+               msrs::ia32_vmx_cr4_fixed1::get();
+    }
+}
+
+}
+}
+
+// *INDENT-ON*
+
+#endif
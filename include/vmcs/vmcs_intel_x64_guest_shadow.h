@@ -0,0 +1,184 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_GUEST_SHADOW_H
+#define VMCS_INTEL_X64_GUEST_SHADOW_H
+
+#include <array>
+#include <intrinsics/x86/intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_VMCS
+#ifdef SHARED_VMCS
+#define EXPORT_VMCS EXPORT_SYM
+#else
+#define EXPORT_VMCS IMPORT_SYM
+#endif
+#else
+#define EXPORT_VMCS
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCS Guest Shadow
+///
+/// Provides a write-back cache of the guest state fields that are
+/// frequently read / written while handling a VM exit (control registers,
+/// RFLAGS, and the MSRs that are stored in the VMCS). A read of a shadowed
+/// field performs a vmread the first time it is accessed, and a write
+/// is simply a memory store that marks the field as dirty. All of the dirty
+/// fields are then written to the VMCS in a single loop by flush(), which
+/// is called just before the guest is resumed, resulting in at most one
+/// vmwrite per field per exit.
+///
+/// Fields that are not shadowed are read / written directly.
+///
+/// Note that the VMCS that is associated with this shadow must be loaded
+/// when any of these functions are called, and the shadow must be
+/// invalidated (flush does this) before the guest executes, as the guest is
+/// free to change some of these fields without generating a VM exit.
+///
+class EXPORT_VMCS vmcs_intel_x64_guest_shadow
+{
+public:
+
+    using field_type = intel_x64::vmcs::field_type;
+    using value_type = intel_x64::vmcs::value_type;
+    using index_type = std::size_t;
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    vmcs_intel_x64_guest_shadow() noexcept = default;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~vmcs_intel_x64_guest_shadow() = default;
+
+    /// Get
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the VMCS field to read
+    /// @param failed set to true if the vmread fails, never cleared
+    /// @return the value of the field
+    ///
+    value_type get(field_type addr, bool &failed) noexcept;
+
+    /// Set
+    ///
+    /// If the field is shadowed, the value is stored and the field is
+    /// marked dirty. Otherwise, the field is written immediately.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the VMCS field to write
+    /// @param val the value to write
+    /// @param failed set to true if the vmwrite fails, never cleared
+    ///
+    void set(field_type addr, value_type val, bool &failed) noexcept;
+
+    /// Flush
+    ///
+    /// Writes all of the dirty fields to the VMCS, and then invalidates
+    /// the shadow.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param failed set to true if a vmwrite fails, never cleared
+    ///
+    void flush(bool &failed) noexcept;
+
+    /// Invalidate
+    ///
+    /// Discards the shadow, including fields that are dirty.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void invalidate() noexcept;
+
+    /// Is Shadowed
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the VMCS field to look up
+    /// @return true if the field is shadowed, false otherwise
+    ///
+    static bool is_shadowed(field_type addr) noexcept;
+
+    /// Is Dirty
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the VMCS field to look up
+    /// @return true if the field is shadowed, and has been written since
+    ///     the last flush, false otherwise
+    ///
+    bool is_dirty(field_type addr) const noexcept;
+
+private:
+
+    static index_type index(field_type addr) noexcept;
+
+private:
+
+    uint64_t m_valid{0};
+    uint64_t m_dirty{0};
+
+    std::array<value_type, 16> m_values{};
+
+public:
+
+    vmcs_intel_x64_guest_shadow(vmcs_intel_x64_guest_shadow &&) noexcept = default;
+    vmcs_intel_x64_guest_shadow &operator=(vmcs_intel_x64_guest_shadow &&) noexcept = default;
+
+    vmcs_intel_x64_guest_shadow(const vmcs_intel_x64_guest_shadow &) = delete;
+    vmcs_intel_x64_guest_shadow &operator=(const vmcs_intel_x64_guest_shadow &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,279 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_MSR_AREA_H
+#define VMCS_INTEL_X64_MSR_AREA_H
+
+#include <memory>
+#include <intrinsics/x86/intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_VMCS
+#ifdef SHARED_VMCS
+#define EXPORT_VMCS EXPORT_SYM
+#else
+#define EXPORT_VMCS IMPORT_SYM
+#endif
+#else
+#define EXPORT_VMCS
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCS MSR Area
+///
+/// Manages the VM-entry MSR-load, VM-exit MSR-store and VM-exit MSR-load
+/// areas of a VMCS, so that the CPU switches MSRs between the host and the
+/// guest on every VM entry / exit, instead of the exit handler doing so
+/// with rdmsr / wrmsr.
+///
+/// The guest area is used as both the VM-entry MSR-load area and the
+/// VM-exit MSR-store area: the guest's values are loaded on entry, and
+/// stored back on exit, so guest_value() always returns the guest's
+/// current value. The host area is the VM-exit MSR-load area. Both areas
+/// are kept sorted by MSR, hold each MSR at most once, and their count
+/// fields always match the number of MSRs being switched.
+///
+/// IA32_EFER, IA32_PAT and IA32_PERF_GLOBAL_CTRL have dedicated VMCS
+/// fields, which are cheaper than the MSR areas. If the VMX capability
+/// MSRs allow the CPU to load / save them, these MSRs are switched using
+/// the dedicated fields instead, and never appear in the areas. The
+/// guest's value of these MSRs is a guest-state field, which the exit
+/// handler caches while it handles an exit, so it is only written by
+/// add() (when the VMCS is set up), and is otherwise accessed through the
+/// exit handler (i.e. by emulating rdmsr / wrmsr).
+///
+/// Note that all of the functions that modify the areas modify the VMCS,
+/// and must be called with the VMCS loaded.
+///
+class EXPORT_VMCS vmcs_intel_x64_msr_area
+{
+public:
+
+    using msr_type = uint32_t;
+    using value_type = uint64_t;
+    using size_type = uint64_t;
+
+#pragma pack(push, 1)
+
+    /// MSR Area Entry
+    ///
+    /// As defined by the Intel SDM (section 24.7.2).
+    ///
+    struct entry_type
+    {
+        uint32_t index;
+        uint32_t reserved;
+        uint64_t data;
+    };
+
+#pragma pack(pop)
+
+    /// Max Entries
+    ///
+    /// Each area is a single page. Note that this is less than the minimum
+    /// the CPU supports (512 entries, see IA32_VMX_MISC).
+    ///
+    static constexpr const size_type max_entries = 0x1000 / sizeof(entry_type);
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    vmcs_intel_x64_msr_area() noexcept = default;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~vmcs_intel_x64_msr_area() = default;
+
+    /// Add
+    ///
+    /// Switches msr between guest_value (while the guest runs) and
+    /// host_value (while the VMM runs). If msr is already switched, its
+    /// values are updated.
+    ///
+    /// @expects size() < max_entries (if msr is not already switched)
+    /// @ensures contains(msr) || is_dedicated(msr)
+    ///
+    /// @param msr the MSR to switch
+    /// @param guest_value the guest's value of the MSR
+    /// @param host_value the host's value of the MSR
+    ///
+    void add(msr_type msr, value_type guest_value, value_type host_value);
+
+    /// Remove
+    ///
+    /// Stops switching msr. Does nothing if msr is not switched, or if it
+    /// is switched using a dedicated VMCS field (these are always
+    /// switched).
+    ///
+    /// @expects none
+    /// @ensures !contains(msr)
+    ///
+    /// @param msr the MSR to stop switching
+    ///
+    void remove(msr_type msr);
+
+    /// Contains
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param msr the MSR to look for
+    /// @return true if msr is switched using the MSR areas, false otherwise
+    ///
+    bool contains(msr_type msr) const noexcept;
+
+    /// Is Dedicated
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param msr the MSR to look for
+    /// @return true if msr is switched using a dedicated VMCS field,
+    ///     false otherwise
+    ///
+    static bool is_dedicated(msr_type msr);
+
+    /// Guest Value
+    ///
+    /// The guest's value of a dedicated MSR is read from the exit
+    /// handler's cache of the guest-state fields instead.
+    ///
+    /// @expects !is_dedicated(msr)
+    /// @expects contains(msr)
+    /// @ensures none
+    ///
+    /// @param msr the MSR to read
+    /// @return the guest's current value of msr
+    ///
+    value_type guest_value(msr_type msr) const;
+
+    /// Set Guest Value
+    ///
+    /// The guest's value of a dedicated MSR is written to the exit
+    /// handler's cache of the guest-state fields instead.
+    ///
+    /// @expects !is_dedicated(msr)
+    /// @expects contains(msr)
+    /// @ensures none
+    ///
+    /// @param msr the MSR to write
+    /// @param val the value to load into msr on the next VM entry
+    ///
+    void set_guest_value(msr_type msr, value_type val);
+
+    /// Host Value
+    ///
+    /// @expects contains(msr) || is_dedicated(msr)
+    /// @ensures none
+    ///
+    /// @param msr the MSR to read
+    /// @return the value loaded into msr on VM exit
+    ///
+    value_type host_value(msr_type msr) const;
+
+    /// Set Host Value
+    ///
+    /// @expects contains(msr) || is_dedicated(msr)
+    /// @ensures none
+    ///
+    /// @param msr the MSR to write
+    /// @param val the value to load into msr on VM exit
+    ///
+    void set_host_value(msr_type msr, value_type val);
+
+    /// Load Guest Values
+    ///
+    /// Writes the guest's value of every MSR in the MSR areas to the CPU.
+    /// The CPU only loads these on VM entry, so this is needed when the
+    /// guest is promoted (i.e. continues without a VM entry).
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void load_guest_values() const noexcept;
+
+    /// Size
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of MSRs switched using the MSR areas
+    ///
+    size_type size() const noexcept
+    { return m_size; }
+
+    /// Write Fields
+    ///
+    /// Writes the addresses and counts of the MSR areas to the VMCS.
+    /// Called by the VMCS when it is launched.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void write_fields();
+
+private:
+
+    size_type find(msr_type msr) const noexcept;
+    void allocate();
+
+private:
+
+    size_type m_size{0};
+
+    uintptr_t m_guest_area_phys{0};
+    uintptr_t m_host_area_phys{0};
+
+    std::unique_ptr<entry_type[]> m_guest_area;
+    std::unique_ptr<entry_type[]> m_host_area;
+
+public:
+
+    vmcs_intel_x64_msr_area(vmcs_intel_x64_msr_area &&) noexcept = default;
+    vmcs_intel_x64_msr_area &operator=(vmcs_intel_x64_msr_area &&) noexcept = default;
+
+    vmcs_intel_x64_msr_area(const vmcs_intel_x64_msr_area &) = delete;
+    vmcs_intel_x64_msr_area &operator=(const vmcs_intel_x64_msr_area &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
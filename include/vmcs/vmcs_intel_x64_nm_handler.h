@@ -0,0 +1,37 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_NM_HANDLER_H
+#define VMCS_INTEL_X64_NM_HANDLER_H
+
+/// Device Not Available (#NM) Handler
+///
+/// The VMM's #NM handler (see vmcs_intel_x64_vmm_state). When the guest's
+/// extended state is managed lazily (see xstate_intel_x64), the host
+/// CR0.TS is set, so the first FPU / SSE / AVX instruction the VMM
+/// executes after a VM exit raises a #NM. This saves the guest's extended
+/// state into the XSAVE area of the state save that GS points to (which
+/// vmcs_resume restores), clears CR0.TS, and returns to the instruction.
+/// Note that this is an interrupt handler, and cannot be called.
+///
+extern "C" void vmcs_nm_handler() noexcept;
+
+#endif
@@ -0,0 +1,268 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_SNAPSHOT_H
+#define VMCS_INTEL_X64_SNAPSHOT_H
+
+#include <vector>
+#include <cstdint>
+
+#include <bfgsl.h>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_VMCS
+#ifdef SHARED_VMCS
+#define EXPORT_VMCS EXPORT_SYM
+#else
+#define EXPORT_VMCS IMPORT_SYM
+#endif
+#else
+#define EXPORT_VMCS
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VMCS Snapshot
+///
+/// A copy of the fields of a VMCS, keyed by their encoding. A snapshot is
+/// captured from the VMCS that is loaded with a VMREAD of every field that
+/// exists on the CPU, and restored into the VMCS that is loaded with a
+/// VMWRITE of every captured field that is writable and exists on the CPU.
+/// The fields can be limited to one or more classes (control, read-only
+/// data, guest state and host state), which are taken from bits 11:10 of
+/// each field's encoding.
+///
+/// A snapshot can also be serialized into a compact binary image (and
+/// deserialized from one), so that the state of a VMCS can be dumped for
+/// offline debugging without formatting any text. The image is a header
+/// followed by one entry per captured field, in encoding order:
+///
+/// @code
+/// header: magic (u32), version (u16), number of fields (u16),
+///         VMCS revision ID (u32), checksum (u32)
+/// entry:  encoding (u32), reserved (u32), value (u64)
+/// @endcode
+///
+/// The checksum covers the header (with the checksum set to 0) and all of
+/// the entries. An image with the wrong magic, version or checksum is
+/// rejected when it is deserialized, and a snapshot that was captured with
+/// a different VMCS revision ID is rejected when it is restored.
+///
+class EXPORT_VMCS vmcs_intel_x64_snapshot
+{
+public:
+
+    using class_type = uint32_t;
+    using field_type = uint64_t;
+    using value_type = uint64_t;
+    using size_type = std::size_t;
+
+    static constexpr const class_type control = 0x1;
+    static constexpr const class_type read_only = 0x2;
+    static constexpr const class_type guest_state = 0x4;
+    static constexpr const class_type host_state = 0x8;
+    static constexpr const class_type all = 0xF;
+
+    static constexpr const uint32_t magic = 0x53434D56;
+    static constexpr const uint16_t version = 1;
+
+    struct header_type
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t num_fields;
+        uint32_t revision_id;
+        uint32_t checksum;
+    };
+
+    struct entry_type
+    {
+        uint32_t encoding;
+        uint32_t reserved;
+        uint64_t value;
+    };
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures is_valid() == false
+    ///
+    vmcs_intel_x64_snapshot() noexcept = default;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~vmcs_intel_x64_snapshot() = default;
+
+    /// Capture
+    ///
+    /// Replaces the contents of the snapshot with the fields of the
+    /// loaded VMCS that are in classes and exist on this CPU.
+    ///
+    /// @expects the VMCS is loaded
+    /// @ensures is_valid() == true
+    ///
+    /// @param classes the classes of fields to capture
+    ///
+    void capture(class_type classes = all);
+
+    /// Restore
+    ///
+    /// Writes the captured fields that are in classes back into the
+    /// loaded VMCS. Read-only data fields, and fields that do not exist
+    /// on this CPU, are skipped.
+    ///
+    /// @expects is_valid() == true
+    /// @expects the snapshot was captured with this CPU's VMCS revision ID
+    /// @expects the VMCS is loaded
+    /// @ensures none
+    ///
+    /// @param classes the classes of fields to restore
+    ///
+    void restore(class_type classes = all) const;
+
+    /// Reset
+    ///
+    /// @expects none
+    /// @ensures is_valid() == false
+    ///
+    void reset() noexcept;
+
+    /// Is Valid
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the snapshot has been captured (or deserialized),
+    ///     and its checksum is correct
+    ///
+    bool is_valid() const noexcept;
+
+    /// Size
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of captured fields
+    ///
+    size_type size() const noexcept
+    { return m_entries.size(); }
+
+    /// Revision ID
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the VMCS revision ID of the CPU the snapshot was captured on
+    ///
+    uint32_t revision_id() const noexcept
+    { return m_header.revision_id; }
+
+    /// Contains
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param field the encoding of the field to look up
+    /// @return true if the field was captured
+    ///
+    bool contains(field_type field) const noexcept;
+
+    /// Get
+    ///
+    /// @expects contains(field) == true
+    /// @ensures none
+    ///
+    /// @param field the encoding of the field to look up
+    /// @return the captured value of the field
+    ///
+    value_type get(field_type field) const;
+
+    /// Serialize
+    ///
+    /// @expects is_valid() == true
+    /// @ensures none
+    ///
+    /// @return the binary image of the snapshot
+    ///
+    std::vector<gsl::byte> serialize() const;
+
+    /// Deserialize
+    ///
+    /// Replaces the contents of the snapshot with a binary image created
+    /// by serialize(). The snapshot is left empty if the image is rejected.
+    ///
+    /// @expects the image's magic, version, size and checksum are correct
+    /// @ensures is_valid() == true
+    ///
+    /// @param image the binary image to deserialize
+    ///
+    void deserialize(gsl::span<const gsl::byte> image);
+
+    /// Class Of
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param field the encoding of a field
+    /// @return the class of the field (control, read_only, guest_state or
+    ///     host_state)
+    ///
+    static class_type class_of(field_type field) noexcept
+    { return 1U << ((field & 0xC00U) >> 10); }
+
+private:
+
+    uint32_t checksum() const noexcept;
+
+private:
+
+    header_type m_header{};
+    std::vector<entry_type> m_entries;
+
+public:
+
+    vmcs_intel_x64_snapshot(vmcs_intel_x64_snapshot &&) noexcept = default;
+    vmcs_intel_x64_snapshot &operator=(vmcs_intel_x64_snapshot &&) noexcept = default;
+
+    vmcs_intel_x64_snapshot(const vmcs_intel_x64_snapshot &) = default;
+    vmcs_intel_x64_snapshot &operator=(const vmcs_intel_x64_snapshot &) = default;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
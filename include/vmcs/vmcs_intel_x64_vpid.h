@@ -0,0 +1,307 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef VMCS_INTEL_X64_VPID_H
+#define VMCS_INTEL_X64_VPID_H
+
+#include <bitset>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Exports
+// -----------------------------------------------------------------------------
+
+#include <bfexports.h>
+
+#ifndef STATIC_VMCS
+#ifdef SHARED_VMCS
+#define EXPORT_VMCS EXPORT_SYM
+#else
+#define EXPORT_VMCS IMPORT_SYM
+#endif
+#else
+#define EXPORT_VMCS
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+// -----------------------------------------------------------------------------
+
+/// VPID Allocator
+///
+/// Hands out the virtual-processor identifiers used to tag the guest's
+/// TLB entries, so that they survive VM entries / exits. VPID 0 belongs
+/// to the VMM and is never handed out, which leaves 0xFFFF VPIDs for
+/// the guests. A VPID that is freed can be handed out again, which is
+/// why a VPID must be flushed before it is used (see
+/// vmcs_intel_x64_vpid).
+///
+class EXPORT_VMCS vpid_allocator_intel_x64
+{
+public:
+
+    using vpid_type = uint16_t;
+    using size_type = uint64_t;
+
+    /// Max VPIDs
+    ///
+    /// The number of VPIDs that can be allocated at the same time.
+    ///
+    static constexpr const size_type max_vpids = 0xFFFF;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~vpid_allocator_intel_x64() = default;
+
+    /// Get Singleton Instance
+    ///
+    /// @expects none
+    /// @ensures ret != nullptr
+    ///
+    /// @return the VPID allocator
+    ///
+    static vpid_allocator_intel_x64 *instance() noexcept;
+
+    /// Allocate
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return a VPID that is not in use, or 0 if all of the VPIDs are
+    ///     in use
+    ///
+    vpid_type allocate() noexcept;
+
+    /// Free
+    ///
+    /// Returns vpid to the allocator. Does nothing if vpid is 0 or is not
+    /// in use.
+    ///
+    /// @expects none
+    /// @ensures is_allocated(vpid) == false
+    ///
+    /// @param vpid the VPID to free
+    ///
+    void free(vpid_type vpid) noexcept;
+
+    /// Is Allocated
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param vpid the VPID to look up
+    /// @return true if vpid is in use, false otherwise
+    ///
+    bool is_allocated(vpid_type vpid) const noexcept;
+
+    /// Size
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of VPIDs that are in use
+    ///
+    size_type size() const noexcept;
+
+private:
+
+    vpid_allocator_intel_x64() noexcept = default;
+
+private:
+
+    vpid_type m_next{1};
+    std::bitset<max_vpids + 1> m_allocated;
+
+public:
+
+    vpid_allocator_intel_x64(vpid_allocator_intel_x64 &&) noexcept = delete;
+    vpid_allocator_intel_x64 &operator=(vpid_allocator_intel_x64 &&) noexcept = delete;
+
+    vpid_allocator_intel_x64(const vpid_allocator_intel_x64 &) = delete;
+    vpid_allocator_intel_x64 &operator=(const vpid_allocator_intel_x64 &) = delete;
+};
+
+/// VMCS VPID
+///
+/// Owns the VPID of a VMCS. The VPID is allocated the first time the
+/// VMCS is written (if the CPU supports VPIDs), and is returned to the
+/// allocator when the VMCS is destroyed (i.e. when the vCPU that owns the
+/// VMCS is deleted).
+///
+/// Since the TLB is no longer flushed on VM entry / exit once VPIDs are
+/// enabled, an exit handler that changes the guest's translations on the
+/// guest's behalf (e.g. by emulating a write to CR3) must invalidate them
+/// using the flush functions below. These functions do nothing when VPIDs
+/// are not enabled, and fall back to a wider invalidation when the CPU
+/// does not support the narrower one.
+///
+class EXPORT_VMCS vmcs_intel_x64_vpid
+{
+public:
+
+    using vpid_type = vpid_allocator_intel_x64::vpid_type;
+    using integer_pointer = uintptr_t;
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    vmcs_intel_x64_vpid() noexcept = default;
+
+    /// Destructor
+    ///
+    /// Returns the VPID (if any) to the allocator.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~vmcs_intel_x64_vpid() noexcept;
+
+    /// Write Fields
+    ///
+    /// Allocates a VPID (if one has not been allocated yet), flushes any
+    /// stale translations a previous owner of the VPID left behind, and
+    /// writes the VPID to the VMCS, enabling VPIDs. Does nothing if the
+    /// CPU does not support VPIDs, or if all of the VPIDs are in use, in
+    /// which case the TLB is flushed on every VM entry / exit as before.
+    ///
+    /// @expects the VMCS is loaded
+    /// @ensures none
+    ///
+    void write_fields();
+
+    /// Load
+    ///
+    /// INVVPID only invalidates the TLB of the CPU that executes it, so
+    /// the flush done by write_fields() and the flushes done by the exit
+    /// handler leave the VPID's translations in the TLBs of the other
+    /// CPUs. This must be called whenever the VMCS is loaded, and flushes
+    /// the VPID if the CPU this is called on is not the CPU the VMCS last
+    /// ran on. Does nothing if VPIDs are not enabled.
+    ///
+    /// @expects the VMCS is loaded
+    /// @ensures none
+    ///
+    void load();
+
+    /// ID
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the VPID, or 0 if VPIDs are not enabled
+    ///
+    vpid_type id() const noexcept
+    { return m_id; }
+
+    /// Is Supported
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if VPIDs can be enabled, and a VPID can be flushed
+    ///     using INVVPID, false otherwise
+    ///
+    static bool is_supported();
+
+    /// Flush
+    ///
+    /// Invalidates all of the translations tagged with vpid, using a
+    /// single-context INVVPID if supported, and an all-context INVVPID
+    /// otherwise. Does nothing if vpid is 0.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param vpid the VPID to flush
+    ///
+    static void flush(vpid_type vpid);
+
+    /// Flush Non-Global
+    ///
+    /// Invalidates the translations tagged with vpid, except for global
+    /// translations, which is what a MOV to CR3 does. Falls back to
+    /// flush() if the CPU cannot retain global translations. Does nothing
+    /// if vpid is 0.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param vpid the VPID to flush
+    ///
+    static void flush_non_global(vpid_type vpid);
+
+    /// Flush Address
+    ///
+    /// Invalidates the translations for the linear address addr tagged
+    /// with vpid, which is what INVLPG does. Falls back to flush() if the
+    /// CPU does not support individual-address invalidation. Does nothing
+    /// if vpid is 0.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param vpid the VPID to flush
+    /// @param addr the linear address to flush
+    ///
+    static void flush_address(vpid_type vpid, integer_pointer addr);
+
+    /// @cond
+
+    void flush() const
+    { flush(m_id); }
+
+    void flush_non_global() const
+    { flush_non_global(m_id); }
+
+    void flush_address(integer_pointer addr) const
+    { flush_address(m_id, addr); }
+
+    /// @endcond
+
+private:
+
+    vpid_type m_id{0};
+    uint64_t m_cpuid{~0ULL};
+
+public:
+
+    vmcs_intel_x64_vpid(vmcs_intel_x64_vpid &&other) noexcept;
+    vmcs_intel_x64_vpid &operator=(vmcs_intel_x64_vpid &&other) noexcept;
+
+    vmcs_intel_x64_vpid(const vmcs_intel_x64_vpid &) = delete;
+    vmcs_intel_x64_vpid &operator=(const vmcs_intel_x64_vpid &) = delete;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
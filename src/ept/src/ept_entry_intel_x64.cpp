@@ -0,0 +1,132 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <bfbitmanip.h>
+#include <ept/ept_entry_intel_x64.h>
+
+#include <intrinsics/x86/common_x64.h>
+using namespace x64;
+
+ept_entry_intel_x64::ept_entry_intel_x64(gsl::not_null<pointer> epte) noexcept :
+    m_epte(epte.get())
+{ }
+
+bool
+ept_entry_intel_x64::present() const noexcept
+{ return get_bits(*m_epte, 0x7UL) != 0; }
+
+bool
+ept_entry_intel_x64::read() const noexcept
+{ return is_bit_set(*m_epte, 0); }
+
+void
+ept_entry_intel_x64::set_read(bool enabled) noexcept
+{ *m_epte = enabled ? set_bit(*m_epte, 0) : clear_bit(*m_epte, 0); }
+
+bool
+ept_entry_intel_x64::write() const noexcept
+{ return is_bit_set(*m_epte, 1); }
+
+void
+ept_entry_intel_x64::set_write(bool enabled) noexcept
+{ *m_epte = enabled ? set_bit(*m_epte, 1) : clear_bit(*m_epte, 1); }
+
+bool
+ept_entry_intel_x64::execute() const noexcept
+{ return is_bit_set(*m_epte, 2); }
+
+void
+ept_entry_intel_x64::set_execute(bool enabled) noexcept
+{ *m_epte = enabled ? set_bit(*m_epte, 2) : clear_bit(*m_epte, 2); }
+
+ept_entry_intel_x64::access_type
+ept_entry_intel_x64::access() const noexcept
+{ return get_bits(*m_epte, 0x7UL); }
+
+void
+ept_entry_intel_x64::set_access(access_type access)
+{
+    expects(access <= intel_x64::ept::access::read_write_execute);
+    *m_epte = set_bits(*m_epte, 0x7UL, access);
+}
+
+ept_entry_intel_x64::memory_type
+ept_entry_intel_x64::mem_type() const noexcept
+{ return get_bits(*m_epte, 0x38UL) >> 3; }
+
+void
+ept_entry_intel_x64::set_mem_type(memory_type type)
+{
+    expects(type != 2 && type != 3 && type <= x64::memory_type::write_back);
+    *m_epte = set_bits(*m_epte, 0x38UL, type << 3);
+}
+
+bool
+ept_entry_intel_x64::ignore_pat() const noexcept
+{ return is_bit_set(*m_epte, 6); }
+
+void
+ept_entry_intel_x64::set_ignore_pat(bool enabled) noexcept
+{ *m_epte = enabled ? set_bit(*m_epte, 6) : clear_bit(*m_epte, 6); }
+
+bool
+ept_entry_intel_x64::large_page() const noexcept
+{ return is_bit_set(*m_epte, 7); }
+
+void
+ept_entry_intel_x64::set_large_page(bool enabled) noexcept
+{ *m_epte = enabled ? set_bit(*m_epte, 7) : clear_bit(*m_epte, 7); }
+
+bool
+ept_entry_intel_x64::accessed() const noexcept
+{ return is_bit_set(*m_epte, 8); }
+
+void
+ept_entry_intel_x64::set_accessed(bool enabled) noexcept
+{ *m_epte = enabled ? set_bit(*m_epte, 8) : clear_bit(*m_epte, 8); }
+
+bool
+ept_entry_intel_x64::dirty() const noexcept
+{ return is_bit_set(*m_epte, 9); }
+
+void
+ept_entry_intel_x64::set_dirty(bool enabled) noexcept
+{ *m_epte = enabled ? set_bit(*m_epte, 9) : clear_bit(*m_epte, 9); }
+
+ept_entry_intel_x64::integer_pointer
+ept_entry_intel_x64::phys_addr() const noexcept
+{ return get_bits(*m_epte, 0x0000FFFFFFFFF000UL); }
+
+void
+ept_entry_intel_x64::set_phys_addr(integer_pointer addr) noexcept
+{ *m_epte = set_bits(*m_epte, 0x0000FFFFFFFFF000UL, addr); }
+
+bool
+ept_entry_intel_x64::suppress_ve() const noexcept
+{ return is_bit_set(*m_epte, 63); }
+
+void
+ept_entry_intel_x64::set_suppress_ve(bool enabled) noexcept
+{ *m_epte = enabled ? set_bit(*m_epte, 63) : clear_bit(*m_epte, 63); }
+
+void
+ept_entry_intel_x64::clear() noexcept
+{ *m_epte = 0; }
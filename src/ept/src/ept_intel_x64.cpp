@@ -0,0 +1,256 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <bfdebug.h>
+#include <bfexception.h>
+
+#include <ept/ept_intel_x64.h>
+
+#include <intrinsics/x86/intel_x64.h>
+
+using namespace intel_x64;
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+ept_intel_x64::ept_intel_x64() :
+    m_pt{std::make_unique<page_table_x64>(&m_root, init_ept_entry, split_ept_entry)}
+{
+    auto mem_type = vmcs::ept_pointer::memory_type::write_back;
+
+    if (msrs::ia32_vmx_ept_vpid_cap::memory_type_write_back_supported::is_disabled()) {
+        mem_type = vmcs::ept_pointer::memory_type::uncacheable;
+    }
+
+    m_eptp = vmcs::ept_pointer::phys_addr::set(m_eptp, m_root & vmcs::ept_pointer::phys_addr::mask);
+    m_eptp = vmcs::ept_pointer::memory_type::set(m_eptp, mem_type);
+    m_eptp = vmcs::ept_pointer::page_walk_length_minus_one::set(m_eptp, 3UL);
+
+    m_flush_pending.set();
+}
+
+void
+ept_intel_x64::unmap(integer_pointer gpa) noexcept
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // Adding the 4k page first splits a large page that contains gpa, so
+    // that only the 4k page is removed
+
+    guard_exceptions([&] {
+        if (is_present(gpa)) {
+            m_pt->add_page_4k(gpa);
+        }
+
+        m_pt->remove_page(gpa);
+    });
+
+    m_flush_pending.set();
+}
+
+void
+ept_intel_x64::setup_identity_map(
+    integer_pointer saddr, integer_pointer eaddr, access_type access)
+{
+    expects((saddr & (x64::page_table::pt::size_bytes - 1)) == 0);
+    expects((eaddr & (x64::page_table::pt::size_bytes - 1)) == 0);
+
+    auto use_1g = msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::is_enabled();
+    auto use_2m = msrs::ia32_vmx_ept_vpid_cap::pde_2mb_support::is_enabled();
+
+    // A large page can only be used if the MTRRs give all of it the same
+    // memory type, as an EPT entry has a single memory type
+
+    auto fits = [&](integer_pointer addr, size_type size) {
+        return (addr & (size - 1)) == 0 && eaddr - addr >= size &&
+               m_mtrrs.range_type(addr, size) != mtrr_intel_x64::mixed;
+    };
+
+    for (auto addr = saddr; addr < eaddr;) {
+        if (use_1g && fits(addr, x64::page_table::pdpt::size_bytes)) {
+            this->map_1g(addr, addr, access, m_mtrrs.range_type(addr, x64::page_table::pdpt::size_bytes));
+            addr += x64::page_table::pdpt::size_bytes;
+            continue;
+        }
+
+        if (use_2m && fits(addr, x64::page_table::pd::size_bytes)) {
+            this->map_2m(addr, addr, access, m_mtrrs.range_type(addr, x64::page_table::pd::size_bytes));
+            addr += x64::page_table::pd::size_bytes;
+            continue;
+        }
+
+        this->map_4k(addr, addr, access, m_mtrrs.type(addr));
+        addr += x64::page_table::pt::size_bytes;
+    }
+}
+
+ept_entry_intel_x64
+ept_intel_x64::gpa_to_epte(integer_pointer gpa) const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return ept_entry_intel_x64(m_pt->virt_to_pte(gpa).get());
+}
+
+bool
+ept_intel_x64::is_mapped(integer_pointer gpa) const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return is_present(gpa);
+}
+
+void
+ept_intel_x64::flush()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // A CPU that is too large to be tracked flushes on every call
+
+    auto &&cpuid = thread_context_cpuid();
+    auto &&tracked = cpuid < per_cpu::max_cpus;
+
+    if (tracked && !m_flush_pending[cpuid]) {
+        return;
+    }
+
+    if (msrs::ia32_vmx_ept_vpid_cap::invept_single_context_support::is_enabled()) {
+        vmx::invept_single_context(m_eptp);
+    }
+    else {
+        vmx::invept_global();
+    }
+
+    if (tracked) {
+        m_flush_pending[cpuid] = false;
+    }
+}
+
+bool
+ept_intel_x64::is_flush_pending() const noexcept
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto &&cpuid = thread_context_cpuid();
+    return cpuid >= per_cpu::max_cpus || m_flush_pending[cpuid];
+}
+
+bool
+ept_intel_x64::is_supported()
+{
+    if (!msrs::ia32_vmx_true_procbased_ctls::activate_secondary_controls::is_allowed1()) {
+        return false;
+    }
+
+    if (!msrs::ia32_vmx_procbased_ctls2::enable_ept::is_allowed1()) {
+        return false;
+    }
+
+    if (!msrs::ia32_vmx_ept_vpid_cap::page_walk_length_of_4::is_enabled()) {
+        return false;
+    }
+
+    if (!msrs::ia32_vmx_ept_vpid_cap::memory_type_write_back_supported::is_enabled() &&
+        !msrs::ia32_vmx_ept_vpid_cap::memory_type_uncacheable_supported::is_enabled()) {
+        return false;
+    }
+
+    if (!msrs::ia32_vmx_ept_vpid_cap::invept_support::is_enabled()) {
+        return false;
+    }
+
+    return msrs::ia32_vmx_ept_vpid_cap::invept_single_context_support::is_enabled() ||
+           msrs::ia32_vmx_ept_vpid_cap::invept_all_context_support::is_enabled();
+}
+
+void
+ept_intel_x64::map_page(integer_pointer gpa, integer_pointer hpa, access_type access,
+                        memory_type type, size_type size)
+{
+    expects((gpa & (size - 1)) == 0);
+    expects((hpa & (size - 1)) == 0);
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // The CPU only caches translations that are present, so an INVEPT is
+    // only needed if this replaces an existing translation
+
+    auto was_present = is_present(gpa);
+
+    auto &&pte = [&] {
+        switch (size) {
+            case x64::page_table::pdpt::size_bytes:
+                return m_pt->add_page_1g(gpa);
+
+            case x64::page_table::pd::size_bytes:
+                return m_pt->add_page_2m(gpa);
+
+            default:
+                return m_pt->add_page_4k(gpa);
+        }
+    }();
+
+    auto ___ = gsl::on_failure([&]
+    { m_pt->remove_page(gpa); });
+
+    auto &&entry = ept_entry_intel_x64(pte.get());
+
+    entry.clear();
+    entry.set_phys_addr(hpa);
+    entry.set_access(access);
+    entry.set_mem_type(type);
+    entry.set_large_page(size != x64::page_table::pt::size_bytes);
+
+    if (was_present) {
+        m_flush_pending.set();
+    }
+}
+
+bool
+ept_intel_x64::is_present(integer_pointer gpa) const
+{
+    try {
+        return ept_entry_intel_x64(m_pt->virt_to_pte(gpa).get()).present();
+    }
+    catch (std::runtime_error &) {
+        return false;
+    }
+}
+
+void
+ept_intel_x64::init_ept_entry(page_table_x64::pointer epte, integer_pointer phys)
+{
+    auto &&entry = ept_entry_intel_x64(epte);
+
+    entry.clear();
+    entry.set_phys_addr(phys);
+    entry.set_access(ept::access::read_write_execute);
+}
+
+void
+ept_intel_x64::split_ept_entry(
+    page_table_x64::pointer epte, integer_pointer large, integer_pointer offset, bool is_large)
+{
+    auto &&entry = ept_entry_intel_x64(epte);
+    *epte = large;
+
+    entry.set_phys_addr(entry.phys_addr() + offset);
+    entry.set_large_page(is_large);
+}
@@ -0,0 +1,187 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <gsl/gsl>
+
+#include <ept/mtrr_intel_x64.h>
+
+#include <intrinsics/x86/intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+constexpr const auto fixed_range_end = 0x100000ULL;
+constexpr const auto fixed_4k_begin = 0xC0000ULL;
+constexpr const auto fixed_16k_begin = 0x80000ULL;
+
+constexpr const auto variable_range_valid = 0x800ULL;
+constexpr const auto variable_range_addr_mask = 0x000FFFFFFFFFF000ULL;
+
+static uintptr_t
+fixed_index(uintptr_t addr) noexcept
+{
+    if (addr < fixed_16k_begin) {
+        return addr >> 16;
+    }
+
+    if (addr < fixed_4k_begin) {
+        return 8 + ((addr - fixed_16k_begin) >> 14);
+    }
+
+    return 24 + ((addr - fixed_4k_begin) >> 12);
+}
+
+static uint64_t
+combine_types(uint64_t type1, uint64_t type2) noexcept
+{
+    if (type1 == type2) {
+        return type1;
+    }
+
+    if (type1 == x64::memory_type::uncacheable || type2 == x64::memory_type::uncacheable) {
+        return x64::memory_type::uncacheable;
+    }
+
+    if ((type1 == x64::memory_type::write_through && type2 == x64::memory_type::write_back) ||
+        (type1 == x64::memory_type::write_back && type2 == x64::memory_type::write_through)) {
+        return x64::memory_type::write_through;
+    }
+
+    return x64::memory_type::uncacheable;
+}
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+constexpr const mtrr_intel_x64::memory_type mtrr_intel_x64::mixed;
+constexpr const mtrr_intel_x64::size_type mtrr_intel_x64::num_fixed_ranges;
+
+mtrr_intel_x64::mtrr_intel_x64()
+{
+    auto def_type = intel_x64::msrs::ia32_mtrr_def_type::get();
+
+    m_enabled = intel_x64::msrs::ia32_mtrr_def_type::mtrr::is_enabled(def_type);
+    m_default_type = intel_x64::msrs::ia32_mtrr_def_type::def_mem_type::get(def_type);
+
+    if (!m_enabled) {
+        return;
+    }
+
+    auto cap = x64::msrs::ia32_mtrrcap::get();
+
+    if (x64::msrs::ia32_mtrrcap::fixed_range_mtrr::is_enabled(cap)) {
+        m_fixed_enabled = intel_x64::msrs::ia32_mtrr_def_type::fixed_range_mtrr::is_enabled(def_type);
+    }
+
+    if (m_fixed_enabled) {
+        const std::array<uint32_t, 11> fixed_msrs = {{
+                intel_x64::msrs::ia32_mtrr_fix64k_00000::addr,
+                intel_x64::msrs::ia32_mtrr_fix16k_80000::addr,
+                intel_x64::msrs::ia32_mtrr_fix16k_A0000::addr,
+                intel_x64::msrs::ia32_mtrr_fix4k_C0000::addr,
+                intel_x64::msrs::ia32_mtrr_fix4k_C8000::addr,
+                intel_x64::msrs::ia32_mtrr_fix4k_D0000::addr,
+                intel_x64::msrs::ia32_mtrr_fix4k_D8000::addr,
+                intel_x64::msrs::ia32_mtrr_fix4k_E0000::addr,
+                intel_x64::msrs::ia32_mtrr_fix4k_E8000::addr,
+                intel_x64::msrs::ia32_mtrr_fix4k_F0000::addr,
+                intel_x64::msrs::ia32_mtrr_fix4k_F8000::addr
+            }
+        };
+
+        auto index = 0UL;
+        for (const auto &msr : fixed_msrs) {
+            auto types = _read_msr(msr);
+
+            for (auto i = 0U; i < 8; i++) {
+                m_fixed.at(index++) = (types >> (i * 8)) & 0xFF;
+            }
+        }
+    }
+
+    auto vcnt = x64::msrs::ia32_mtrrcap::vcnt::get(cap);
+    for (auto i = 0U; i < vcnt; i++) {
+        auto base = _read_msr(intel_x64::msrs::ia32_mtrr_physbase0::addr + (i * 2));
+        auto mask = _read_msr(intel_x64::msrs::ia32_mtrr_physmask0::addr + (i * 2));
+
+        if ((mask & variable_range_valid) == 0) {
+            continue;
+        }
+
+        m_variable.push_back({
+            base & variable_range_addr_mask, mask & variable_range_addr_mask, base & 0xFF
+        });
+    }
+}
+
+mtrr_intel_x64::memory_type
+mtrr_intel_x64::range_type(integer_pointer addr, size_type size) const
+{
+    expects(size >= 0x1000);
+    expects((size & (size - 1)) == 0);
+    expects((addr & (size - 1)) == 0);
+
+    if (!m_enabled) {
+        return x64::memory_type::uncacheable;
+    }
+
+    if (!m_fixed_enabled || addr >= fixed_range_end) {
+        return variable_type(addr, size);
+    }
+
+    auto end = addr + size < fixed_range_end ? addr + size : fixed_range_end;
+    auto type = m_fixed.at(fixed_index(addr));
+
+    for (auto page = addr; page < end; page += 0x1000) {
+        if (m_fixed.at(fixed_index(page)) != type) {
+            return mixed;
+        }
+    }
+
+    if (addr + size > fixed_range_end && variable_type(addr, size) != type) {
+        return mixed;
+    }
+
+    return type;
+}
+
+mtrr_intel_x64::memory_type
+mtrr_intel_x64::variable_type(integer_pointer addr, size_type size) const noexcept
+{
+    auto type = mixed;
+    auto range_mask = ~(size - 1);
+
+    for (const auto &range : m_variable) {
+        if ((addr & range.mask & range_mask) != (range.base & range.mask & range_mask)) {
+            continue;
+        }
+
+        if ((range.mask & (size - 1)) != 0) {
+            return mixed;
+        }
+
+        type = type == mixed ? range.type : combine_types(type, range.type);
+    }
+
+    return type == mixed ? m_default_type : type;
+}
@@ -0,0 +1,142 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+
+#include <ept/ept_entry_intel_x64.h>
+#include <intrinsics/x86/common_x64.h>
+
+using namespace intel_x64;
+
+TEST_CASE("ept_entry: present")
+{
+    uintptr_t raw = 0;
+    ept_entry_intel_x64 entry{&raw};
+
+    CHECK_FALSE(entry.present());
+
+    entry.set_read(true);
+    CHECK(entry.present());
+    entry.set_read(false);
+
+    entry.set_write(true);
+    CHECK(entry.present());
+    entry.set_write(false);
+
+    entry.set_execute(true);
+    CHECK(entry.present());
+    entry.set_execute(false);
+
+    CHECK_FALSE(entry.present());
+    CHECK(raw == 0);
+}
+
+TEST_CASE("ept_entry: access")
+{
+    uintptr_t raw = 0;
+    ept_entry_intel_x64 entry{&raw};
+
+    entry.set_access(ept::access::read_execute);
+    CHECK(entry.access() == ept::access::read_execute);
+    CHECK(entry.read());
+    CHECK_FALSE(entry.write());
+    CHECK(entry.execute());
+
+    entry.set_access(ept::access::read_write);
+    CHECK(entry.access() == ept::access::read_write);
+    CHECK(raw == 0x3);
+
+    CHECK_THROWS(entry.set_access(0x8));
+    CHECK(entry.access() == ept::access::read_write);
+}
+
+TEST_CASE("ept_entry: memory type")
+{
+    uintptr_t raw = 0;
+    ept_entry_intel_x64 entry{&raw};
+
+    entry.set_mem_type(x64::memory_type::write_back);
+    CHECK(entry.mem_type() == x64::memory_type::write_back);
+    CHECK(raw == 0x30);
+
+    entry.set_mem_type(x64::memory_type::uncacheable);
+    CHECK(entry.mem_type() == x64::memory_type::uncacheable);
+    CHECK(raw == 0);
+
+    CHECK_THROWS(entry.set_mem_type(2));
+    CHECK_THROWS(entry.set_mem_type(x64::memory_type::uncacheable_minus));
+    CHECK(raw == 0);
+}
+
+TEST_CASE("ept_entry: flags")
+{
+    uintptr_t raw = 0;
+    ept_entry_intel_x64 entry{&raw};
+
+    entry.set_ignore_pat(true);
+    CHECK(entry.ignore_pat());
+    entry.set_large_page(true);
+    CHECK(entry.large_page());
+    entry.set_accessed(true);
+    CHECK(entry.accessed());
+    entry.set_dirty(true);
+    CHECK(entry.dirty());
+    entry.set_suppress_ve(true);
+    CHECK(entry.suppress_ve());
+
+    CHECK(raw == 0x80000000000003C0ULL);
+
+    entry.set_ignore_pat(false);
+    entry.set_large_page(false);
+    entry.set_accessed(false);
+    entry.set_dirty(false);
+    entry.set_suppress_ve(false);
+
+    CHECK(raw == 0);
+}
+
+TEST_CASE("ept_entry: phys addr")
+{
+    uintptr_t raw = 0;
+    ept_entry_intel_x64 entry{&raw};
+
+    entry.set_access(ept::access::read_write_execute);
+    entry.set_phys_addr(0x0000123456789000ULL);
+
+    CHECK(entry.phys_addr() == 0x0000123456789000ULL);
+    CHECK(entry.access() == ept::access::read_write_execute);
+
+    entry.set_phys_addr(0xFFFF123456789ABCULL);
+    CHECK(entry.phys_addr() == 0x0000123456789000ULL);
+    CHECK(entry.access() == ept::access::read_write_execute);
+}
+
+TEST_CASE("ept_entry: clear")
+{
+    uintptr_t raw = 0xFFFFFFFFFFFFFFFFULL;
+    ept_entry_intel_x64 entry{&raw};
+
+    CHECK(entry.get() == &raw);
+
+    entry.clear();
+    CHECK(raw == 0);
+    CHECK_FALSE(entry.present());
+}
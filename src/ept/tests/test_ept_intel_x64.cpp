@@ -0,0 +1,563 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <bfbenchmark.h>
+
+#include <ept/ept_intel_x64.h>
+#include <memory_manager/memory_manager_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+constexpr const auto uc = x64::memory_type::uncacheable;
+constexpr const auto wb = x64::memory_type::write_back;
+constexpr const auto rwx = ept::access::read_write_execute;
+
+constexpr const auto one_gb = x64::page_table::pdpt::size_bytes;
+constexpr const auto two_mb = x64::page_table::pd::size_bytes;
+constexpr const auto four_kb = x64::page_table::pt::size_bytes;
+
+struct invept_call
+{
+    uint64_t type;
+    uint64_t eptp;
+};
+
+static std::map<uint32_t, uint64_t> g_msrs;
+static std::vector<invept_call> g_invept_calls;
+static uint64_t g_cpuid = 0;
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static uint64_t
+test_thread_context_cpuid() noexcept
+{ return g_cpuid; }
+
+static bool
+test_invept(uint64_t type, void *ptr) noexcept
+{
+    g_invept_calls.push_back({type, static_cast<uint64_t *>(ptr)[0]});
+    return true;
+}
+
+static uintptr_t
+test_virtptr_to_physint(void *ptr)
+{ return reinterpret_cast<uintptr_t>(ptr); }
+
+static const auto g_all_ept =
+    msrs::ia32_vmx_ept_vpid_cap::page_walk_length_of_4::mask |
+    msrs::ia32_vmx_ept_vpid_cap::memory_type_write_back_supported::mask |
+    msrs::ia32_vmx_ept_vpid_cap::pde_2mb_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::invept_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::invept_single_context_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::invept_all_context_support::mask;
+
+static void
+setup_intrinsics(MockRepository &mocks, uint64_t ept_vpid_cap = g_all_ept)
+{
+    g_msrs.clear();
+    g_invept_calls.clear();
+    g_cpuid = 0;
+
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_ept_vpid_cap::addr] = ept_vpid_cap;
+    g_msrs[msrs::ia32_mtrr_def_type::addr] = 0x800 | wb;
+
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Do(test_virtptr_to_physint);
+
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+    mocks.OnCallFunc(_invept).Do(test_invept);
+    mocks.OnCallFunc(thread_context_cpuid).Do(test_thread_context_cpuid);
+}
+
+TEST_CASE("ept: eptp")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+    auto &&eptp = ept.eptp();
+
+    CHECK(vmcs::ept_pointer::phys_addr::get(eptp) != 0);
+    CHECK(vmcs::ept_pointer::memory_type::get(eptp) == vmcs::ept_pointer::memory_type::write_back);
+    CHECK(vmcs::ept_pointer::page_walk_length_minus_one::get(eptp) == 3);
+    CHECK(vmcs::ept_pointer::reserved::get(eptp) == 0);
+}
+
+TEST_CASE("ept: eptp uncacheable")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::memory_type_write_back_supported::mask);
+
+    ept_intel_x64 ept;
+    CHECK(vmcs::ept_pointer::memory_type::get(ept.eptp()) == vmcs::ept_pointer::memory_type::uncacheable);
+}
+
+TEST_CASE("ept: map 4k")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    CHECK_FALSE(ept.is_mapped(0x1000));
+    CHECK_NOTHROW(ept.map_4k(0x1000, 0x5000, ept::access::read_execute, uc));
+    CHECK(ept.is_mapped(0x1000));
+    CHECK(ept.is_mapped(0x1FFF));
+    CHECK_FALSE(ept.is_mapped(0x2000));
+
+    auto &&entry = ept.gpa_to_epte(0x1000);
+    CHECK(entry.phys_addr() == 0x5000);
+    CHECK(entry.access() == ept::access::read_execute);
+    CHECK(entry.mem_type() == uc);
+    CHECK_FALSE(entry.large_page());
+    CHECK_FALSE(entry.ignore_pat());
+
+    CHECK_THROWS(ept.map_4k(0x1001, 0x5000, rwx, wb));
+    CHECK_THROWS(ept.map_4k(0x2000, 0x5001, rwx, wb));
+}
+
+TEST_CASE("ept: map 2m")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    CHECK_NOTHROW(ept.map_2m(two_mb, two_mb * 4, rwx, wb));
+    CHECK(ept.is_mapped(two_mb + 0x1234));
+
+    auto &&entry = ept.gpa_to_epte(two_mb + 0x1234);
+    CHECK(entry.phys_addr() == two_mb * 4);
+    CHECK(entry.mem_type() == wb);
+    CHECK(entry.large_page());
+
+    CHECK_THROWS(ept.map_2m(0x1000, 0, rwx, wb));
+}
+
+TEST_CASE("ept: map 1g")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    CHECK_NOTHROW(ept.map_1g(one_gb, one_gb * 2, rwx, wb));
+    CHECK(ept.is_mapped(one_gb + two_mb));
+
+    auto &&entry = ept.gpa_to_epte(one_gb + two_mb);
+    CHECK(entry.phys_addr() == one_gb * 2);
+    CHECK(entry.large_page());
+
+    CHECK_THROWS(ept.map_1g(two_mb, two_mb, rwx, wb));
+}
+
+TEST_CASE("ept: map invalid memory type")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    CHECK_THROWS(ept.map_4k(0x1000, 0x1000, rwx, 2));
+    CHECK_FALSE(ept.is_mapped(0x1000));
+}
+
+TEST_CASE("ept: unmap")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    ept.map_4k(0x1000, 0x1000, rwx, wb);
+    ept.map_4k(0x2000, 0x2000, rwx, wb);
+
+    ept.unmap(0x1000);
+    CHECK_FALSE(ept.is_mapped(0x1000));
+    CHECK(ept.is_mapped(0x2000));
+
+    CHECK_NOTHROW(ept.unmap(0x1000));
+    CHECK_NOTHROW(ept.unmap(one_gb * 8));
+}
+
+TEST_CASE("ept: flush")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    CHECK(ept.is_flush_pending());
+    ept.flush();
+    CHECK_FALSE(ept.is_flush_pending());
+    CHECK(g_invept_calls.size() == 1);
+    CHECK(g_invept_calls.at(0).type == 1);
+    CHECK(g_invept_calls.at(0).eptp == ept.eptp());
+
+    ept.flush();
+    CHECK(g_invept_calls.size() == 1);
+}
+
+TEST_CASE("ept: flush global")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::invept_single_context_support::mask);
+
+    ept_intel_x64 ept;
+
+    ept.flush();
+    CHECK(g_invept_calls.size() == 1);
+    CHECK(g_invept_calls.at(0).type == 2);
+}
+
+TEST_CASE("ept: flush is per cpu")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    ept.map_4k(0x1000, 0x1000, rwx, wb);
+    ept.flush();
+
+    g_cpuid = 1;
+    ept.flush();
+    CHECK(g_invept_calls.size() == 2);
+
+    ept.map_4k(0x1000, 0x1000, ept::access::read, wb);
+    ept.flush();
+    CHECK_FALSE(ept.is_flush_pending());
+    CHECK(g_invept_calls.size() == 3);
+
+    g_cpuid = 0;
+    CHECK(ept.is_flush_pending());
+    ept.flush();
+    CHECK(g_invept_calls.size() == 4);
+
+    g_cpuid = per_cpu::max_cpus;
+    CHECK(ept.is_flush_pending());
+    ept.flush();
+    ept.flush();
+    CHECK(g_invept_calls.size() == 6);
+}
+
+TEST_CASE("ept: new mappings do not need a flush")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+    ept.flush();
+
+    ept.map_4k(0x1000, 0x1000, rwx, wb);
+    ept.map_2m(two_mb, two_mb, rwx, wb);
+    ept.map_1g(one_gb, one_gb, rwx, wb);
+    CHECK_FALSE(ept.is_flush_pending());
+}
+
+TEST_CASE("ept: changes are flushed once")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    ept.map_4k(0x1000, 0x1000, rwx, wb);
+    ept.map_4k(0x2000, 0x2000, rwx, wb);
+    ept.flush();
+
+    ept.map_4k(0x1000, 0x1000, ept::access::read, wb);
+    CHECK(ept.is_flush_pending());
+    ept.unmap(0x2000);
+    ept.map_4k(0x2000, 0x2000, rwx, wb);
+
+    g_invept_calls.clear();
+    ept.flush();
+    CHECK(g_invept_calls.size() == 1);
+}
+
+TEST_CASE("ept: replacing a large page needs a flush")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    ept.map_2m(0, 0, rwx, wb);
+    ept.flush();
+
+    ept.map_4k(0x1000, 0x1000, rwx, uc);
+    CHECK(ept.is_flush_pending());
+    CHECK(ept.is_mapped(0x2000));
+    CHECK(ept.is_mapped(0x1000));
+}
+
+TEST_CASE("ept: remap 4k inside a 2m identity page")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask);
+
+    ept_intel_x64 ept;
+    ept.setup_identity_map(0, two_mb * 2);
+
+    ept.map_4k(two_mb + 0x3000, 0x5000, ept::access::read_execute, uc);
+
+    auto &&entry = ept.gpa_to_epte(two_mb + 0x3000);
+    CHECK(entry.phys_addr() == 0x5000);
+    CHECK(entry.access() == ept::access::read_execute);
+    CHECK(entry.mem_type() == uc);
+    CHECK_FALSE(entry.large_page());
+
+    for (auto gpa = two_mb; gpa < two_mb * 2; gpa += 0x1000) {
+        if (gpa == two_mb + 0x3000) {
+            continue;
+        }
+
+        auto &&split = ept.gpa_to_epte(gpa);
+        CHECK(split.phys_addr() == gpa);
+        CHECK(split.access() == rwx);
+        CHECK(split.mem_type() == wb);
+        CHECK_FALSE(split.large_page());
+    }
+
+    CHECK(ept.gpa_to_epte(0).large_page());
+}
+
+TEST_CASE("ept: remap 2m inside a 1g identity page")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+    ept.setup_identity_map(0, one_gb);
+
+    ept.map_2m(two_mb, two_mb * 4, rwx, uc);
+    CHECK(ept.gpa_to_epte(two_mb).phys_addr() == two_mb * 4);
+
+    auto &&entry = ept.gpa_to_epte(two_mb * 2 + 0x1000);
+    CHECK(entry.phys_addr() == two_mb * 2);
+    CHECK(entry.mem_type() == wb);
+    CHECK(entry.large_page());
+}
+
+TEST_CASE("ept: unmap 4k inside a 2m identity page")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask);
+
+    ept_intel_x64 ept;
+    ept.setup_identity_map(0, two_mb);
+    ept.flush();
+
+    ept.unmap(0x3000);
+    CHECK(ept.is_flush_pending());
+    CHECK_FALSE(ept.is_mapped(0x3000));
+
+    CHECK(ept.is_mapped(0x2000));
+    CHECK(ept.is_mapped(0x4000));
+    CHECK(ept.gpa_to_epte(0x4000).phys_addr() == 0x4000);
+    CHECK(ept.gpa_to_epte(two_mb - 0x1000).phys_addr() == two_mb - 0x1000);
+}
+
+TEST_CASE("ept: identity map uses 1g pages")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+    ept.setup_identity_map(0, one_gb * 4);
+
+    for (auto gpa = 0ULL; gpa < one_gb * 4; gpa += one_gb / 2) {
+        auto &&entry = ept.gpa_to_epte(gpa);
+
+        CHECK(entry.phys_addr() == (gpa & ~(one_gb - 1)));
+        CHECK(entry.access() == rwx);
+        CHECK(entry.mem_type() == wb);
+        CHECK(entry.large_page());
+    }
+
+    CHECK_FALSE(ept.is_mapped(one_gb * 4));
+}
+
+TEST_CASE("ept: identity map uses 2m pages without 1g support")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask);
+
+    ept_intel_x64 ept;
+    ept.setup_identity_map(0, one_gb);
+
+    auto &&entry = ept.gpa_to_epte(one_gb - 0x1000);
+    CHECK(entry.phys_addr() == one_gb - two_mb);
+    CHECK(entry.large_page());
+}
+
+TEST_CASE("ept: identity map uses 4k pages without large page support")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_ept &
+                     ~msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask &
+                     ~msrs::ia32_vmx_ept_vpid_cap::pde_2mb_support::mask);
+
+    ept_intel_x64 ept;
+    ept.setup_identity_map(0, two_mb);
+
+    auto &&entry = ept.gpa_to_epte(two_mb - 0x1000);
+    CHECK(entry.phys_addr() == two_mb - 0x1000);
+    CHECK_FALSE(entry.large_page());
+}
+
+TEST_CASE("ept: identity map unaligned")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+
+    CHECK_THROWS(ept.setup_identity_map(0x1, two_mb));
+    CHECK_THROWS(ept.setup_identity_map(0, two_mb + 1));
+}
+
+TEST_CASE("ept: identity map unaligned range")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ept_intel_x64 ept;
+    ept.setup_identity_map(two_mb - four_kb, one_gb * 2 + two_mb + four_kb);
+
+    CHECK_FALSE(ept.gpa_to_epte(two_mb - four_kb).large_page());
+    CHECK(ept.gpa_to_epte(two_mb).large_page());
+    CHECK(ept.gpa_to_epte(one_gb).large_page());
+    CHECK(ept.gpa_to_epte(one_gb).phys_addr() == one_gb);
+    CHECK(ept.gpa_to_epte(one_gb * 2).phys_addr() == one_gb * 2);
+    CHECK_FALSE(ept.gpa_to_epte(one_gb * 2 + two_mb).large_page());
+    CHECK_FALSE(ept.is_mapped(one_gb * 2 + two_mb + four_kb));
+    CHECK_FALSE(ept.is_mapped(two_mb - four_kb * 2));
+}
+
+TEST_CASE("ept: identity map follows the mtrrs")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    // WB memory, except for an uncacheable 4k page at 1g + 4k
+
+    g_msrs[x64::msrs::ia32_mtrrcap::addr] = 0x8;
+    g_msrs[msrs::ia32_mtrr_physbase0::addr] = (one_gb + four_kb) | uc;
+    g_msrs[msrs::ia32_mtrr_physmask0::addr] = 0x0000FFFFFFFFF800ULL;
+
+    ept_intel_x64 ept;
+    ept.setup_identity_map(0, one_gb * 2);
+
+    CHECK(ept.gpa_to_epte(0).large_page());
+    CHECK(ept.gpa_to_epte(0).mem_type() == wb);
+
+    CHECK_FALSE(ept.gpa_to_epte(one_gb).large_page());
+    CHECK(ept.gpa_to_epte(one_gb).mem_type() == wb);
+    CHECK(ept.gpa_to_epte(one_gb + four_kb).mem_type() == uc);
+    CHECK(ept.gpa_to_epte(one_gb + four_kb * 2).mem_type() == wb);
+
+    CHECK(ept.gpa_to_epte(one_gb + two_mb).large_page());
+    CHECK(ept.gpa_to_epte(one_gb + two_mb).mem_type() == wb);
+
+    CHECK(ept.mtrr_type(one_gb + four_kb) == uc);
+}
+
+TEST_CASE("ept: is supported")
+{
+    MockRepository mocks;
+
+    setup_intrinsics(mocks);
+    CHECK(ept_intel_x64::is_supported());
+
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::page_walk_length_of_4::mask);
+    CHECK_FALSE(ept_intel_x64::is_supported());
+
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::invept_support::mask);
+    CHECK_FALSE(ept_intel_x64::is_supported());
+
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::memory_type_write_back_supported::mask);
+    CHECK_FALSE(ept_intel_x64::is_supported());
+
+    setup_intrinsics(mocks, (g_all_ept |
+                             msrs::ia32_vmx_ept_vpid_cap::memory_type_uncacheable_supported::mask) &
+                     ~msrs::ia32_vmx_ept_vpid_cap::memory_type_write_back_supported::mask);
+    CHECK(ept_intel_x64::is_supported());
+
+    setup_intrinsics(mocks);
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = 0;
+    CHECK_FALSE(ept_intel_x64::is_supported());
+}
+
+TEST_CASE("ept: identity map benchmark")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    bfdebug_lnbr(0);
+    bfdebug_info(0, "ept identity map");
+    bfdebug_brk2(0);
+    {
+        ept_intel_x64 ept;
+        auto &&results = benchmark([&] {
+            ept.setup_identity_map(0, one_gb * 512);
+        });
+
+        bfdebug_ndec(0, "512g (1g pages)", results);
+    }
+
+    setup_intrinsics(mocks, g_all_ept & ~msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask);
+    {
+        ept_intel_x64 ept;
+        auto &&results = benchmark([&] {
+            ept.setup_identity_map(0, one_gb * 4);
+        });
+
+        bfdebug_ndec(0, "4g (2m pages)", results);
+    }
+
+    setup_intrinsics(mocks, g_all_ept &
+                     ~msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask &
+                     ~msrs::ia32_vmx_ept_vpid_cap::pde_2mb_support::mask);
+    {
+        ept_intel_x64 ept;
+        auto &&results = benchmark([&] {
+            ept.setup_identity_map(0, two_mb * 32);
+        });
+
+        bfdebug_ndec(0, "64m (4k pages)", results);
+    }
+}
+
+#endif
@@ -0,0 +1,228 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <ept/mtrr_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+constexpr const auto uc = x64::memory_type::uncacheable;
+constexpr const auto wc = x64::memory_type::write_combining;
+constexpr const auto wt = x64::memory_type::write_through;
+constexpr const auto wp = x64::memory_type::write_protected;
+constexpr const auto wb = x64::memory_type::write_back;
+
+constexpr const auto mtrr_enabled = 0x800ULL;
+constexpr const auto fixed_enabled = 0x400ULL;
+constexpr const auto range_valid = 0x800ULL;
+
+constexpr const auto one_mb = 0x100000ULL;
+constexpr const auto two_mb = 0x200000ULL;
+constexpr const auto one_gb = 0x40000000ULL;
+constexpr const auto mask_1gb = 0x0000FFFFC0000000ULL;
+constexpr const auto mask_2mb = 0x0000FFFFFFE00000ULL;
+constexpr const auto mask_4kb = 0x0000FFFFFFFFF000ULL;
+
+static std::map<uint32_t, uint64_t> g_msrs;
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static void
+setup_intrinsics(MockRepository &mocks, uint64_t def_type)
+{
+    g_msrs.clear();
+
+    g_msrs[msrs::ia32_mtrr_def_type::addr] = def_type;
+    g_msrs[x64::msrs::ia32_mtrrcap::addr] = 0x108;
+
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+}
+
+static void
+add_variable_range(uint32_t index, uint64_t base, uint64_t mask, uint64_t type)
+{
+    g_msrs[msrs::ia32_mtrr_physbase0::addr + (index * 2)] = base | type;
+    g_msrs[msrs::ia32_mtrr_physmask0::addr + (index * 2)] = mask | range_valid;
+}
+
+TEST_CASE("mtrr: disabled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, wb);
+
+    add_variable_range(0, 0, mask_1gb, wb);
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.type(0) == uc);
+    CHECK(mtrrs.range_type(0, one_gb) == uc);
+}
+
+TEST_CASE("mtrr: default type")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | wb);
+
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.type(0) == wb);
+    CHECK(mtrrs.type(0x123456789000ULL) == wb);
+    CHECK(mtrrs.range_type(0, one_gb) == wb);
+}
+
+TEST_CASE("mtrr: invalid range")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | wb);
+
+    add_variable_range(0, 0, mask_1gb, uc);
+    g_msrs[msrs::ia32_mtrr_physmask0::addr] = mask_1gb;
+
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.type(0) == wb);
+}
+
+TEST_CASE("mtrr: variable range")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | uc);
+
+    add_variable_range(0, 0, mask_1gb, wb);
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.type(0) == wb);
+    CHECK(mtrrs.type(one_gb - 0x1000) == wb);
+    CHECK(mtrrs.type(one_gb) == uc);
+    CHECK(mtrrs.range_type(0, one_gb) == wb);
+    CHECK(mtrrs.range_type(one_gb, one_gb) == uc);
+    CHECK(mtrrs.range_type(two_mb, two_mb) == wb);
+}
+
+TEST_CASE("mtrr: range larger than a variable range is mixed")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | wb);
+
+    add_variable_range(0, one_gb - two_mb, mask_2mb, uc);
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.range_type(0, one_gb) == mtrr_intel_x64::mixed);
+    CHECK(mtrrs.range_type(0, two_mb) == wb);
+    CHECK(mtrrs.range_type(one_gb - two_mb, two_mb) == uc);
+    CHECK(mtrrs.range_type(one_gb, one_gb) == wb);
+}
+
+TEST_CASE("mtrr: overlapping ranges")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | wb);
+
+    add_variable_range(0, 0, mask_1gb, wb);
+    add_variable_range(1, 0, mask_2mb, wt);
+    add_variable_range(2, two_mb, mask_2mb, uc);
+    add_variable_range(3, two_mb * 2, mask_2mb, wc);
+    add_variable_range(4, two_mb * 3, mask_4kb, wb);
+
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.type(0) == wt);
+    CHECK(mtrrs.type(two_mb) == uc);
+    CHECK(mtrrs.type(two_mb * 2) == uc);
+    CHECK(mtrrs.type(two_mb * 3) == wb);
+    CHECK(mtrrs.range_type(two_mb * 3, two_mb) == mtrr_intel_x64::mixed);
+    CHECK(mtrrs.type(two_mb * 3 + 0x1000) == wb);
+}
+
+TEST_CASE("mtrr: fixed ranges")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | fixed_enabled | wb);
+
+    g_msrs[msrs::ia32_mtrr_fix64k_00000::addr] = 0x0606060606060606ULL;
+    g_msrs[msrs::ia32_mtrr_fix16k_80000::addr] = 0x0606060606060606ULL;
+    g_msrs[msrs::ia32_mtrr_fix16k_A0000::addr] = 0x0000000000000000ULL;
+    g_msrs[msrs::ia32_mtrr_fix4k_F8000::addr] = 0x0505050505050505ULL;
+
+    add_variable_range(0, 0, mask_1gb, wb);
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.type(0) == wb);
+    CHECK(mtrrs.type(0x70000) == wb);
+    CHECK(mtrrs.type(0x9C000) == wb);
+    CHECK(mtrrs.type(0xA0000) == uc);
+    CHECK(mtrrs.type(0xC0000) == uc);
+    CHECK(mtrrs.type(0xFF000) == wp);
+    CHECK(mtrrs.type(one_mb) == wb);
+
+    CHECK(mtrrs.range_type(0, 0x80000) == wb);
+    CHECK(mtrrs.range_type(0, one_mb) == mtrr_intel_x64::mixed);
+    CHECK(mtrrs.range_type(0, two_mb) == mtrr_intel_x64::mixed);
+    CHECK(mtrrs.range_type(two_mb, two_mb) == wb);
+}
+
+TEST_CASE("mtrr: fixed ranges disabled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | wb);
+
+    g_msrs[msrs::ia32_mtrr_fix16k_A0000::addr] = 0x0000000000000000ULL;
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.type(0xA0000) == wb);
+    CHECK(mtrrs.range_type(0, two_mb) == wb);
+}
+
+TEST_CASE("mtrr: fixed ranges match variable ranges")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | fixed_enabled | uc);
+
+    for (auto msr : {0x250U, 0x258U, 0x259U, 0x268U, 0x269U, 0x26AU, 0x26BU, 0x26CU, 0x26DU, 0x26EU, 0x26FU}) {
+        g_msrs[msr] = 0x0606060606060606ULL;
+    }
+
+    add_variable_range(0, 0, mask_1gb, wb);
+    mtrr_intel_x64 mtrrs;
+
+    CHECK(mtrrs.range_type(0, two_mb) == wb);
+    CHECK(mtrrs.range_type(0, one_gb) == wb);
+}
+
+TEST_CASE("mtrr: invalid range arguments")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, mtrr_enabled | wb);
+
+    mtrr_intel_x64 mtrrs;
+
+    CHECK_THROWS(mtrrs.range_type(0, 0x800));
+    CHECK_THROWS(mtrrs.range_type(0, 0x3000));
+    CHECK_THROWS(mtrrs.range_type(0x1000, two_mb));
+}
+
+#endif
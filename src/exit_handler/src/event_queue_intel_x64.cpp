@@ -0,0 +1,374 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <algorithm>
+
+#include <exit_handler/event_queue_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+using namespace x64;
+using namespace intel_x64;
+
+namespace type = vmcs::vm_entry_interruption_information::interruption_type;
+
+// Exceptions all share the same priority, so that they are injected in the
+// order they were queued. External interrupts are prioritized by vector,
+// like the local APIC does.
+
+static uint64_t
+priority(const pending_event_t &event) noexcept
+{
+    switch (event.type) {
+        case type::external_interrupt:
+            return 0x100 + event.vector;
+
+        case type::non_maskable_interrupt:
+            return 0x200;
+
+        default:
+            return 0x300;
+    }
+}
+
+static bool
+is_contributory(const pending_event_t &event) noexcept
+{
+    if (event.type != type::hardware_exception) {
+        return false;
+    }
+
+    switch (event.vector) {
+        case interrupt::divide_error:
+        case interrupt::invalid_tss:
+        case interrupt::segment_not_present:
+        case interrupt::stack_segment_fault:
+        case interrupt::general_protection:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+static bool
+is_exception(const pending_event_t &event, uint64_t vector) noexcept
+{ return event.type == type::hardware_exception && event.vector == vector; }
+
+void
+event_queue_intel_x64::queue(const event_type &event)
+{
+    expects(event.vector < 256);
+    expects(event.type != type::reserved);
+    expects(event.type != type::other_event);
+
+    if (event.type == type::external_interrupt || event.type == type::non_maskable_interrupt) {
+        for (const auto &pending : m_events) {
+            if (pending.type == event.type && pending.vector == event.vector) {
+                return;
+            }
+        }
+    }
+
+    // Events with the same priority are inserted below the events that are
+    // already pending, so that they are injected first in, first out.
+
+    auto &&iter = std::lower_bound(m_events.begin(), m_events.end(), priority(event),
+    [](const auto & pending, auto val) { return priority(pending) < val; });
+
+    m_events.insert(iter, event);
+}
+
+void
+event_queue_intel_x64::queue_external_interrupt(uint64_t vector)
+{ this->queue({vector, type::external_interrupt, 0, false, 0}); }
+
+void
+event_queue_intel_x64::queue_nmi()
+{ this->queue({interrupt::nmi_interrupt, type::non_maskable_interrupt, 0, false, 0}); }
+
+void
+event_queue_intel_x64::queue_exception(uint64_t vector)
+{
+    expects(vector < 32);
+    this->queue({vector, type::hardware_exception, 0, false, 0});
+}
+
+void
+event_queue_intel_x64::queue_exception(uint64_t vector, uint64_t error_code)
+{
+    expects(vector < 32);
+    this->queue({vector, type::hardware_exception, error_code, true, 0});
+}
+
+void
+event_queue_intel_x64::requeue(const event_type &event)
+{
+    expects(event.vector < 256);
+    expects(event.type != type::reserved);
+    expects(event.type != type::other_event);
+
+    // An event that was interrupted before, and is still waiting (as
+    // something else was injected directly, whose delivery was interrupted
+    // in turn), waits with the other pending events instead.
+
+    if (m_interrupted_pending) {
+        this->queue(m_interrupted);
+    }
+
+    m_interrupted = event;
+    m_interrupted_pending = true;
+}
+
+void
+event_queue_intel_x64::queue_nested_exception(const event_type &exception)
+{
+    expects(exception.vector < 256);
+    expects(exception.type != type::reserved);
+    expects(exception.type != type::other_event);
+
+    if (!m_interrupted_pending || exception.type != type::hardware_exception) {
+        return this->queue(exception);
+    }
+
+    const auto first = m_interrupted;
+
+    auto &&second_faults =
+        is_contributory(exception) || is_exception(exception, interrupt::page_fault);
+
+    if (second_faults && is_exception(first, interrupt::double_fault)) {
+        throw std::runtime_error("triple fault while delivering a double fault");
+    }
+
+    if ((is_contributory(first) && is_contributory(exception)) ||
+        (is_exception(first, interrupt::page_fault) && second_faults)) {
+        m_interrupted = {interrupt::double_fault, type::hardware_exception, 0, true, 0};
+        return;
+    }
+
+    // The exceptions are handled serially. The new one takes the place of
+    // the interrupted event, which is delivered ahead of anything else.
+
+    m_interrupted = exception;
+
+    switch (first.type) {
+        case type::external_interrupt:
+        case type::non_maskable_interrupt:
+            this->queue(first);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void
+event_queue_intel_x64::inject(bool &failed) noexcept
+{
+    if (this->empty()) {
+
+        if (m_interrupt_window_armed || m_nmi_window_armed || m_mtf_armed) {
+            this->arm(false, false, false, failed);
+        }
+
+        return;
+    }
+
+    namespace state = vmcs::guest_interruptibility_state;
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    auto &&interruptibility = state::get_nothrow(failed);
+    auto &&flags = vmcs::guest_rflags::get_nothrow(failed);
+    auto &&entry_info = info::get_nothrow(failed);
+
+    if (failed) {
+        return;
+    }
+
+    // If something has already been injected on this entry (i.e. written
+    // directly into the VMCS), nothing else can be, and the pending events
+    // wait for the next window. Note that NMIs are also held back while
+    // blocked by STI, as some CPUs fail the VM entry otherwise.
+
+    auto &&busy = info::valid_bit::is_enabled(entry_info);
+
+    auto &&interrupts_blocked = busy ||
+                                is_bit_cleared(flags, rflags::interrupt_enable_flag::from) ||
+                                state::blocking_by_sti::is_enabled(interruptibility) ||
+                                state::blocking_by_mov_ss::is_enabled(interruptibility);
+
+    auto &&nmis_blocked = busy ||
+                          state::blocking_by_sti::is_enabled(interruptibility) ||
+                          state::blocking_by_mov_ss::is_enabled(interruptibility) ||
+                          state::blocking_by_nmi::is_enabled(interruptibility);
+
+    // An interrupted event had already passed these checks when its
+    // delivery started, so only another injection holds it back.
+
+    if (m_interrupted_pending && !busy) {
+        this->write(m_interrupted, failed);
+        m_interrupted_pending = false;
+
+        busy = true;
+    }
+
+    for (auto i = m_events.size(); !busy && i > 0; i--) {
+        const auto &event = m_events[i - 1];
+
+        if (event.type == type::external_interrupt && interrupts_blocked) {
+            continue;
+        }
+
+        if (event.type == type::non_maskable_interrupt && nmis_blocked) {
+            continue;
+        }
+
+        this->write(event, failed);
+        m_events.erase(m_events.begin() + static_cast<std::ptrdiff_t>(i - 1));
+
+        busy = true;
+        break;
+    }
+
+    // Whatever is left is blocked, either by the guest, or by the event
+    // injected on this entry. Interrupts and NMIs blocked by the guest
+    // wait for their window exit. Anything else (e.g. an exception) only
+    // waits for the next entry, which cannot depend on the interrupt
+    // window, as the guest may keep interrupts disabled for as long as it
+    // likes (e.g. while handling the exception that was just injected).
+    // The monitor trap flag exits right after the injected event is
+    // delivered, whatever the guest's RFLAGS.IF.
+
+    auto &&interrupt_window = false;
+    auto &&nmi_window = false;
+    auto &&mtf = busy && !this->empty();
+
+    for (const auto &event : m_events) {
+        switch (event.type) {
+            case type::external_interrupt:
+                interrupt_window = true;
+                break;
+
+            case type::non_maskable_interrupt:
+                nmi_window = true;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    this->arm(interrupt_window, nmi_window, mtf, failed);
+}
+
+void
+event_queue_intel_x64::write(const event_type &event, bool &failed) noexcept
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    auto interruption_info = 0ULL;
+
+    interruption_info = info::vector::set(interruption_info, event.vector);
+    interruption_info = info::interruption_type::set(interruption_info, event.type);
+    interruption_info = info::valid_bit::enable(interruption_info);
+
+    if (event.error_code_valid) {
+        interruption_info = info::deliver_error_code_bit::enable(interruption_info);
+        vmcs::vm_entry_exception_error_code::set_nothrow(event.error_code, failed);
+    }
+
+    switch (event.type) {
+        case type::software_interrupt:
+        case type::privileged_software_exception:
+        case type::software_exception:
+            vmcs::vm_entry_instruction_length::set_nothrow(event.instruction_length, failed);
+            break;
+
+        default:
+            break;
+    }
+
+    info::set_nothrow(interruption_info, failed);
+}
+
+void
+event_queue_intel_x64::resync(bool &failed) noexcept
+{
+    namespace primary = vmcs::primary_processor_based_vm_execution_controls;
+
+    auto &&controls = primary::get_nothrow(failed);
+
+    m_interrupt_window_armed = is_bit_set(controls, primary::interrupt_window_exiting::from);
+    m_nmi_window_armed = is_bit_set(controls, primary::nmi_window_exiting::from);
+    m_mtf_armed = is_bit_set(controls, primary::monitor_trap_flag::from);
+}
+
+void
+event_queue_intel_x64::arm(bool interrupt_window, bool nmi_window, bool mtf, bool &failed) noexcept
+{
+    namespace pin = vmcs::pin_based_vm_execution_controls;
+    namespace primary = vmcs::primary_processor_based_vm_execution_controls;
+
+    // Without the monitor trap flag, the interrupt-window exit is the
+    // only way to get another entry, and the event waits until the guest
+    // enables interrupts.
+
+    if (mtf && !m_mtf_armed && !primary::monitor_trap_flag::is_allowed1()) {
+        mtf = false;
+        interrupt_window = true;
+    }
+
+    // NMI-window exiting can only be used with virtual NMIs. Without
+    // them, the interrupt-window exit is the next best chance to
+    // inject the NMI.
+
+    if (nmi_window && !m_nmi_window_armed) {
+        if (is_bit_cleared(pin::get_nothrow(failed), pin::virtual_nmis::from)) {
+            nmi_window = false;
+            interrupt_window = true;
+        }
+    }
+
+    if (interrupt_window == m_interrupt_window_armed &&
+        nmi_window == m_nmi_window_armed &&
+        mtf == m_mtf_armed) {
+        return;
+    }
+
+    auto &&controls = primary::get_nothrow(failed);
+
+    controls = interrupt_window ?
+               set_bit(controls, primary::interrupt_window_exiting::from) :
+               clear_bit(controls, primary::interrupt_window_exiting::from);
+
+    controls = nmi_window ?
+               set_bit(controls, primary::nmi_window_exiting::from) :
+               clear_bit(controls, primary::nmi_window_exiting::from);
+
+    controls = mtf ?
+               set_bit(controls, primary::monitor_trap_flag::from) :
+               clear_bit(controls, primary::monitor_trap_flag::from);
+
+    primary::set_nothrow(controls, failed);
+
+    m_interrupt_window_armed = interrupt_window;
+    m_nmi_window_armed = nmi_window;
+    m_mtf_armed = mtf;
+}
@@ -0,0 +1,147 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <bfgsl.h>
+
+#include <exit_handler/exception_intercept_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+using namespace x64;
+using namespace intel_x64;
+
+exception_intercept_intel_x64::id_type
+exception_intercept_intel_x64::subscribe(uint64_t vector, handler_type handler)
+{
+    expects(vector < 32);
+    expects(handler);
+
+    m_subscribers.push_back({m_next_id, vector, 0, 0, std::move(handler)});
+
+    auto ___ = gsl::on_failure([&]
+    { m_subscribers.pop_back(); });
+
+    this->update();
+
+    return m_next_id++;
+}
+
+exception_intercept_intel_x64::id_type
+exception_intercept_intel_x64::subscribe_page_fault(uint64_t mask, uint64_t match, handler_type handler)
+{
+    expects((match & ~mask) == 0);
+    expects(handler);
+
+    m_subscribers.push_back({m_next_id, interrupt::page_fault, mask, match, std::move(handler)});
+
+    auto ___ = gsl::on_failure([&]
+    { m_subscribers.pop_back(); });
+
+    this->update();
+
+    return m_next_id++;
+}
+
+void
+exception_intercept_intel_x64::unsubscribe(id_type id)
+{
+    for (auto iter = m_subscribers.begin(); iter != m_subscribers.end(); ++iter) {
+        if (iter->id == id) {
+            m_subscribers.erase(iter);
+            return this->update();
+        }
+    }
+}
+
+bool
+exception_intercept_intel_x64::dispatch(const info_type &info)
+{
+    // Handlers are allowed to unsubscribe, so the subscribers are walked
+    // by index.
+
+    for (auto i = 0ULL; i < m_subscribers.size(); i++) {
+        const auto &subscriber = m_subscribers[i];
+
+        if (subscriber.vector != info.vector) {
+            continue;
+        }
+
+        if ((info.error_code & subscriber.mask) != subscriber.match) {
+            continue;
+        }
+
+        auto handler = subscriber.handler;
+
+        if (handler(info)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+exception_intercept_intel_x64::resync(bool &failed) noexcept
+{
+    vmcs::exception_bitmap::set_nothrow(m_exception_bitmap, failed);
+    vmcs::page_fault_error_code_mask::set_nothrow(m_page_fault_error_code_mask, failed);
+    vmcs::page_fault_error_code_match::set_nothrow(m_page_fault_error_code_match, failed);
+}
+
+void
+exception_intercept_intel_x64::update()
+{
+    auto bitmap = 0ULL;
+    auto mask = 0ULL;
+    auto match = 0ULL;
+    auto page_faults = false;
+
+    for (const auto &subscriber : m_subscribers) {
+        bitmap = set_bit(bitmap, subscriber.vector);
+
+        if (subscriber.vector != interrupt::page_fault) {
+            continue;
+        }
+
+        // Only keep the error code bits that every #PF subscriber tests,
+        // and expects to have the same value.
+
+        if (!page_faults) {
+            mask = subscriber.mask;
+            match = subscriber.match;
+            page_faults = true;
+        }
+        else {
+            mask &= subscriber.mask & ~(match ^ subscriber.match);
+            match &= mask;
+        }
+    }
+
+    // If nobody wants a #PF, bit 14 is clear, and mask == match == 0, in
+    // which case the CPU never exits on a #PF.
+
+    vmcs::exception_bitmap::set(bitmap);
+    vmcs::page_fault_error_code_mask::set(mask);
+    vmcs::page_fault_error_code_match::set(match);
+
+    m_exception_bitmap = bitmap;
+    m_page_fault_error_code_mask = mask;
+    m_page_fault_error_code_match = match;
+}
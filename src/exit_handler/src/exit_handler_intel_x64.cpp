@@ -30,6 +30,8 @@
 #include <exit_handler/exit_handler_intel_x64_entry.h>
 #include <exit_handler/exit_handler_intel_x64_support.h>
 
+#include <vmcs/vmcs_intel_x64_control_registers.h>
+
 #include <intrinsics/x86/intel_x64.h>
 
 using namespace x64;
@@ -38,9 +40,31 @@ using namespace intel_x64;
 #include <mutex>
 std::mutex g_unimplemented_handler_mutex;
 
+#include <atomic>
+static_assert(sizeof(vmcall_ring_t) <= x64::page_size, "vmcall ring must fit in a page");
+
 void
 exit_handler_intel_x64::dispatch()
-{ handle_exit(vmcs::exit_reason::basic_exit_reason::get()); }
+{
+    m_vmcs_failed = false;
+
+    auto &&reason = vm_exit_reason();
+    if (m_vmcs_failed) {
+        throw std::runtime_error("failed to read the exit reason");
+    }
+
+    if (m_trace.is_enabled()) {
+        m_trace.begin(reason,
+                      vm_exit_qualification(),
+                      vm_exit_instruction_length(),
+                      vm_exit_instruction_information(),
+                      *m_state_save);
+    }
+
+    this->requeue_interrupted_event();
+
+    handle_exit(vmcs::exit_reason::basic_exit_reason::get(reason));
+}
 
 void
 exit_handler_intel_x64::halt() noexcept
@@ -75,13 +99,84 @@ void
 exit_handler_intel_x64::stop() noexcept
 { pm::stop(); }
 
+void
+exit_handler_intel_x64::enable_fast_path(vmcs::value_type reason)
+{
+    expects(m_state_save != nullptr);
+
+    switch (reason) {
+        case vmcs::exit_reason::basic_exit_reason::cpuid:
+        case vmcs::exit_reason::basic_exit_reason::invd:
+        case vmcs::exit_reason::basic_exit_reason::rdmsr:
+        case vmcs::exit_reason::basic_exit_reason::wrmsr:
+            m_state_save->fast_path_exits = set_bit(m_state_save->fast_path_exits, reason);
+            break;
+
+        default:
+            throw std::invalid_argument("fast path not supported for this exit reason");
+    }
+}
+
+void
+exit_handler_intel_x64::disable_fast_path(vmcs::value_type reason)
+{
+    expects(m_state_save != nullptr);
+    expects(reason < 64);
+
+    m_state_save->fast_path_exits = clear_bit(m_state_save->fast_path_exits, reason);
+}
+
 void
 exit_handler_intel_x64::resume()
-{ m_vmcs->resume(); }
+{
+    m_guest_shadow.flush(m_vmcs_failed);
+    m_events.inject(m_vmcs_failed);
+
+    // All of the EPT changes made while handling the exit share a single
+    // INVEPT (if any of them needs one)
+
+    if (m_ept != nullptr) {
+        m_ept->flush();
+    }
+
+    m_trace.end(*m_state_save, EXIT_TRACE_OUTCOME_RESUMED |
+                (m_vmcs_failed ? EXIT_TRACE_OUTCOME_VMCS_FAILED : 0));
+
+    if (m_vmcs_failed) {
+        throw std::runtime_error("vmcs access failed while handling the exit");
+    }
+
+    this->invalidate_exit_info();
+
+    if (m_contexts != nullptr) {
+        m_contexts->resume();
+        return;
+    }
+
+    m_vmcs->resume();
+}
 
 void
 exit_handler_intel_x64::promote()
-{ m_vmcs->promote(); }
+{
+    // Only the primary context's VMCS holds the state of the guest that
+    // is promoted (e.g. the host OS when the VMM is stopped)
+
+    if (m_contexts != nullptr) {
+        this->switch_to(vmcs_intel_x64_context_set::primary);
+    }
+
+    m_guest_shadow.flush(m_vmcs_failed);
+
+    m_trace.end(*m_state_save, EXIT_TRACE_OUTCOME_PROMOTED |
+                (m_vmcs_failed ? EXIT_TRACE_OUTCOME_VMCS_FAILED : 0));
+
+    if (m_vmcs_failed) {
+        throw std::runtime_error("vmcs access failed while handling the exit");
+    }
+
+    m_vmcs->promote();
+}
 
 void
 exit_handler_intel_x64::advance_and_resume()
@@ -90,10 +185,64 @@ exit_handler_intel_x64::advance_and_resume()
     this->resume();
 }
 
+void
+exit_handler_intel_x64::switch_to(vmcs_intel_x64_context_set::context_type ctx)
+{
+    expects(m_contexts != nullptr);
+
+    if (ctx == m_contexts->current()) {
+        return;
+    }
+
+    // The shadowed guest fields belong to the VMCS that is loaded, so
+    // they are written back before the other VMCS is loaded. Pending
+    // events, EPT flushes and the exit trace are per vCPU, and are handled
+    // by resume() for whichever context is resumed. The controls that
+    // this handler programs (the window exits, the exception bitmap, PLE
+    // and the host CR0.TS used by lazy extended state) are per VMCS, and
+    // are synced with the VMCS that is loaded.
+
+    m_guest_shadow.flush(m_vmcs_failed);
+
+    auto &&fast_path_exits = m_state_save->fast_path_exits;
+
+    m_contexts->switch_to(ctx);
+
+    auto &&state_save = m_contexts->state_save(ctx);
+    state_save->fast_path_exits = fast_path_exits;
+
+    this->set_vmcs(m_contexts->vmcs(ctx));
+    this->set_msr_area(&m_contexts->vmcs(ctx)->m_msr_area);
+    this->set_state_save(state_save);
+
+    this->invalidate_exit_info();
+
+    m_events.resync(m_vmcs_failed);
+    m_exceptions.resync(m_vmcs_failed);
+    m_ple.resync(m_vmcs_failed);
+    m_xstate.resync(m_vmcs_failed);
+}
+
 void
 exit_handler_intel_x64::handle_exit(vmcs::value_type reason)
 {
     switch (reason) {
+        case vmcs::exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt:
+            handle_exception_or_nmi();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::interrupt_window:
+            handle_interrupt_window();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::nmi_window:
+            handle_nmi_window();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::monitor_trap_flag:
+            handle_monitor_trap_flag();
+            break;
+
         case vmcs::exit_reason::basic_exit_reason::cpuid:
             handle_cpuid();
             break;
@@ -118,6 +267,26 @@ exit_handler_intel_x64::handle_exit(vmcs::value_type reason)
             handle_wrmsr();
             break;
 
+        case vmcs::exit_reason::basic_exit_reason::vmx_preemption_timer_expired:
+            handle_preemption_timer();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::control_register_accesses:
+            handle_control_register_accesses();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::pause:
+            handle_pause();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::ept_violation:
+            handle_ept_violation();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::ept_misconfiguration:
+            handle_ept_misconfiguration();
+            break;
+
         default:
             unimplemented_handler();
             break;
@@ -209,6 +378,22 @@ exit_handler_intel_x64::handle_vmcall()
                 handle_vmcall_unittest(regs);
                 break;
 
+            case VMCALL_RING:
+                handle_vmcall_ring(regs);
+                break;
+
+            case VMCALL_PROFILER:
+                handle_vmcall_profiler(regs);
+                break;
+
+            case VMCALL_PLE:
+                handle_vmcall_ple(regs);
+                break;
+
+            case VMCALL_EXIT_TRACE:
+                handle_vmcall_exit_trace(regs);
+                break;
+
             default:
                 throw std::runtime_error("unknown vmcall opcode");
         };
@@ -229,42 +414,47 @@ exit_handler_intel_x64::handle_rdmsr()
 
     switch (msr) {
         case intel_x64::msrs::ia32_debugctl::addr:
-            val = vmcs::guest_ia32_debugctl::get();
+            val = m_guest_shadow.get(vmcs::guest_ia32_debugctl::addr, m_vmcs_failed);
             break;
 
         case x64::msrs::ia32_pat::addr:
-            val = vmcs::guest_ia32_pat::get();
+            val = m_guest_shadow.get(vmcs::guest_ia32_pat::addr, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_efer::addr:
-            val = vmcs::guest_ia32_efer::get();
+            val = m_guest_shadow.get(vmcs::guest_ia32_efer::addr, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_perf_global_ctrl::addr:
-            val = vmcs::guest_ia32_perf_global_ctrl::get();
+            val = m_guest_shadow.get(vmcs::guest_ia32_perf_global_ctrl::addr, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_sysenter_cs::addr:
-            val = vmcs::guest_ia32_sysenter_cs::get();
+            val = m_guest_shadow.get(vmcs::guest_ia32_sysenter_cs::addr, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_sysenter_esp::addr:
-            val = vmcs::guest_ia32_sysenter_esp::get();
+            val = m_guest_shadow.get(vmcs::guest_ia32_sysenter_esp::addr, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_sysenter_eip::addr:
-            val = vmcs::guest_ia32_sysenter_eip::get();
+            val = m_guest_shadow.get(vmcs::guest_ia32_sysenter_eip::addr, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_fs_base::addr:
-            val = vmcs::guest_fs_base::get();
+            val = m_guest_shadow.get(vmcs::guest_fs_base::addr, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_gs_base::addr:
-            val = vmcs::guest_gs_base::get();
+            val = m_guest_shadow.get(vmcs::guest_gs_base::addr, m_vmcs_failed);
             break;
 
         default:
+            if (m_msr_area != nullptr && m_msr_area->contains(msr)) {
+                val = m_msr_area->guest_value(msr);
+                break;
+            }
+
             val = intel_x64::msrs::get(msr);
             break;
 
@@ -304,42 +494,47 @@ exit_handler_intel_x64::handle_wrmsr()
 
     switch (msr) {
         case intel_x64::msrs::ia32_debugctl::addr:
-            vmcs::guest_ia32_debugctl::set(val);
+            m_guest_shadow.set(vmcs::guest_ia32_debugctl::addr, val, m_vmcs_failed);
             break;
 
         case x64::msrs::ia32_pat::addr:
-            vmcs::guest_ia32_pat::set(val);
+            m_guest_shadow.set(vmcs::guest_ia32_pat::addr, val, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_efer::addr:
-            vmcs::guest_ia32_efer::set(val);
+            m_guest_shadow.set(vmcs::guest_ia32_efer::addr, val, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_perf_global_ctrl::addr:
-            vmcs::guest_ia32_perf_global_ctrl::set(val);
+            m_guest_shadow.set(vmcs::guest_ia32_perf_global_ctrl::addr, val, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_sysenter_cs::addr:
-            vmcs::guest_ia32_sysenter_cs::set(val);
+            m_guest_shadow.set(vmcs::guest_ia32_sysenter_cs::addr, val, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_sysenter_esp::addr:
-            vmcs::guest_ia32_sysenter_esp::set(val);
+            m_guest_shadow.set(vmcs::guest_ia32_sysenter_esp::addr, val, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_sysenter_eip::addr:
-            vmcs::guest_ia32_sysenter_eip::set(val);
+            m_guest_shadow.set(vmcs::guest_ia32_sysenter_eip::addr, val, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_fs_base::addr:
-            vmcs::guest_fs_base::set(val);
+            m_guest_shadow.set(vmcs::guest_fs_base::addr, val, m_vmcs_failed);
             break;
 
         case intel_x64::msrs::ia32_gs_base::addr:
-            vmcs::guest_gs_base::set(val);
+            m_guest_shadow.set(vmcs::guest_gs_base::addr, val, m_vmcs_failed);
             break;
 
         default:
+            if (m_msr_area != nullptr && m_msr_area->contains(msr)) {
+                m_msr_area->set_guest_value(msr, val);
+                break;
+            }
+
             intel_x64::msrs::set(msr, val);
             break;
     }
@@ -347,9 +542,367 @@ exit_handler_intel_x64::handle_wrmsr()
     advance_rip();
 }
 
+void
+exit_handler_intel_x64::handle_preemption_timer()
+{
+    auto &&cr3 = m_guest_shadow.get(vmcs::guest_cr3::addr, m_vmcs_failed);
+    auto &&ss = vmcs::guest_ss_access_rights::get_nothrow(m_vmcs_failed);
+
+    m_profiler.sample(m_state_save->rip, cr3,
+                      vmcs::guest_ss_access_rights::dpl::get(ss), m_vmcs_failed);
+}
+
+void
+exit_handler_intel_x64::handle_pause()
+{
+    m_ple.pause_exit(handle_pause_loop(), m_vmcs_failed);
+    advance_rip();
+}
+
+bool
+exit_handler_intel_x64::handle_pause_loop()
+{ return false; }
+
+void
+exit_handler_intel_x64::handle_exception_or_nmi()
+{
+    namespace info = vmcs::vm_exit_interruption_information;
+
+    auto &&interruption_info = vm_exit_interruption_information();
+    auto &&exception = exception_info_t{};
+
+    exception.vector = info::vector::get(interruption_info);
+    exception.type = info::interruption_type::get(interruption_info);
+    exception.error_code_valid = info::error_code_valid::is_enabled(interruption_info);
+    exception.qualification = vm_exit_qualification();
+
+    if (exception.error_code_valid) {
+        exception.error_code = vm_exit_interruption_error_code();
+    }
+
+    // The exit and entry interruption types share the same encoding
+
+    namespace type = vmcs::vm_entry_interruption_information::interruption_type;
+
+    if (exception.type == type::software_exception ||
+        exception.type == type::privileged_software_exception) {
+        exception.instruction_length = vm_exit_instruction_length();
+    }
+
+    // The exception was intercepted before it was delivered, so unless a
+    // subscriber claims it, it is given back to the guest, and the guest
+    // is resumed on the same instruction.
+
+    if (!m_exceptions.dispatch(exception)) {
+        reinject_exception(exception);
+    }
+}
+
+void
+exit_handler_intel_x64::reinject_exception(const exception_info_t &exception)
+{
+    // If the exception was raised while delivering another event (see
+    // requeue_interrupted_event()), the two are combined the way the CPU
+    // would have (e.g. into a #DF), which can throw on a triple fault.
+
+    m_events.queue_nested_exception({exception.vector, exception.type, exception.error_code,
+                                     exception.error_code_valid, exception.instruction_length});
+
+    // A #PF exits before CR2 is written, and a #DB before DR6 is, and
+    // neither register is switched on VM entry, so they are written here
+    // from the exit qualification (which, for a #DB, holds the DR6 bits
+    // that the CPU would have set).
+
+    namespace type = vmcs::vm_entry_interruption_information::interruption_type;
+    namespace debug = vmcs::exit_qualification::debug_exception;
+
+    switch (exception.vector) {
+        case x64::interrupt::page_fault:
+            intel_x64::cr2::set(exception.qualification);
+            break;
+
+        case x64::interrupt::debug_exception:
+            if (exception.type == type::hardware_exception) {
+                auto &&trap_bits = debug::b0::mask | debug::b1::mask | debug::b2::mask | debug::b3::mask;
+                auto &&dr6 = x64::dr6::get() & ~trap_bits;
+
+                x64::dr6::set(dr6 | (exception.qualification & (trap_bits | debug::bd::mask | debug::bs::mask)));
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void
+exit_handler_intel_x64::requeue_interrupted_event()
+{
+    namespace vectoring = vmcs::idt_vectoring_information;
+
+    // An exit that happens while an event is being delivered (e.g. an EPT
+    // violation on the guest's stack, or an intercepted #PF) cancels the
+    // delivery, and the event is only reported here. It is given back to
+    // the event queue, which delivers it again ahead of anything else.
+
+    auto &&vectoring_info = vm_exit_idt_vectoring_information();
+    if (vectoring::valid_bit::is_disabled(vectoring_info)) {
+        return;
+    }
+
+    auto &&event = pending_event_t{};
+
+    event.vector = vectoring::vector::get(vectoring_info);
+    event.type = vectoring::interruption_type::get(vectoring_info);
+    event.error_code_valid = vectoring::error_code_valid::is_enabled(vectoring_info);
+
+    if (event.error_code_valid) {
+        event.error_code = vm_exit_idt_vectoring_error_code();
+    }
+
+    switch (event.type) {
+        case vectoring::interruption_type::software_interrupt:
+        case vectoring::interruption_type::privileged_software_exception:
+        case vectoring::interruption_type::software_exception:
+            event.instruction_length = vm_exit_instruction_length();
+            break;
+
+        default:
+            break;
+    }
+
+    m_events.requeue(event);
+}
+
+void
+exit_handler_intel_x64::handle_interrupt_window()
+{
+    // Nothing to emulate. The guest can take an interrupt, which resume()
+    // injects (disarming the window exit if nothing else is pending).
+}
+
+void
+exit_handler_intel_x64::handle_nmi_window()
+{
+    // Nothing to emulate. The guest can take an NMI, which resume()
+    // injects (disarming the window exit if nothing else is pending).
+}
+
+void
+exit_handler_intel_x64::handle_monitor_trap_flag()
+{
+    // Nothing to emulate. The event injected on the last entry has been
+    // delivered, and resume() injects the next one (disarming the monitor
+    // trap flag if nothing else is pending).
+}
+
+void
+exit_handler_intel_x64::handle_ept_violation()
+{
+    auto &&gpa = vm_exit_guest_physical_address() & ~(x64::page_table::pt::size_bytes - 1);
+
+    // Memory that the identity map does not cover (e.g. MMIO above the
+    // end of RAM) is mapped on first use. The guest retries the access
+    // once resumed, so RIP is not advanced.
+
+    if (m_ept == nullptr || m_ept->is_mapped(gpa)) {
+        return unimplemented_handler();
+    }
+
+    m_ept->map_4k(gpa, gpa, ept::access::read_write_execute, m_ept->mtrr_type(gpa));
+}
+
+void
+exit_handler_intel_x64::handle_ept_misconfiguration()
+{
+    bferror_info(0, "ept misconfiguration");
+    bferror_subnhex(0, "gpa", vm_exit_guest_physical_address());
+
+    unimplemented_handler();
+}
+
+void
+exit_handler_intel_x64::handle_control_register_accesses()
+{
+    namespace access = vmcs::exit_qualification::control_register_access;
+
+    auto &&qual = vm_exit_qualification();
+    auto &&num = access::control_register_number::get(qual);
+
+    switch (access::access_type::get(qual)) {
+        case access::access_type::mov_to_cr: {
+            auto &&val = guest_gpr(access::general_purpose_register::get(qual));
+
+            switch (num) {
+                case 0: {
+                    auto &&cr0 = read_guest_cr0();
+                    write_guest_cr0(val);
+
+                    // Once VPIDs are enabled, the guest's translations
+                    // survive the VM entry, so they have to be flushed
+                    // here if the paging mode / access rights changed
+
+                    if (((cr0 ^ val) & (cr0::paging::mask | cr0::write_protect::mask)) != 0) {
+                        vmcs_intel_x64_vpid::flush(guest_vpid());
+                    }
+
+                    break;
+                }
+
+                case 3: {
+                    auto &&cr4 = read_guest_cr4();
+
+                    // With CR4.PCIDE set, bit 63 of the source operand
+                    // asks the CPU to keep the translations of the new
+                    // PCID. The bit is not part of CR3.
+
+                    if ((cr4 & cr4::pcid_enable_bit::mask) != 0 && (val & 0x8000000000000000ULL) != 0) {
+                        m_guest_shadow.set(vmcs::guest_cr3::addr, val & ~0x8000000000000000ULL, m_vmcs_failed);
+                        break;
+                    }
+
+                    m_guest_shadow.set(vmcs::guest_cr3::addr, val, m_vmcs_failed);
+                    vmcs_intel_x64_vpid::flush_non_global(guest_vpid());
+
+                    break;
+                }
+
+                case 4: {
+                    auto &&cr4 = read_guest_cr4();
+                    write_guest_cr4(val);
+
+                    auto &&mask =
+                        cr4::page_size_extensions::mask |
+                        cr4::physical_address_extensions::mask |
+                        cr4::page_global_enable::mask |
+                        cr4::pcid_enable_bit::mask |
+                        cr4::smep_enable_bit::mask |
+                        cr4::smap_enable_bit::mask;
+
+                    if (((cr4 ^ val) & mask) != 0) {
+                        vmcs_intel_x64_vpid::flush(guest_vpid());
+                    }
+
+                    break;
+                }
+
+                default:
+                    return unimplemented_handler();
+            }
+
+            break;
+        }
+
+        case access::access_type::mov_from_cr: {
+            if (num != 3) {
+                return unimplemented_handler();
+            }
+
+            guest_gpr(access::general_purpose_register::get(qual)) =
+                m_guest_shadow.get(vmcs::guest_cr3::addr, m_vmcs_failed);
+
+            break;
+        }
+
+        case access::access_type::clts: {
+            write_guest_cr0(read_guest_cr0() & ~cr0::task_switched::mask);
+            break;
+        }
+
+        default: {
+
+            // LMSW loads CR0[3:0] from its operand, except that it cannot
+            // clear CR0.PE
+
+            auto &&cr0 = read_guest_cr0();
+            auto &&msw = access::source_data::get(qual) & 0xFU;
+
+            write_guest_cr0((cr0 & ~0xEULL) | msw | (cr0 & 0x1U));
+            break;
+        }
+    }
+
+    advance_rip();
+}
+
+uint64_t
+exit_handler_intel_x64::read_guest_cr0() noexcept
+{
+    // The read shadow only holds the bits the VMM owns. The guest changes
+    // every other bit without an exit, so those come from the guest's CR0.
+
+    auto &&cr0 = m_guest_shadow.get(vmcs::guest_cr0::addr, m_vmcs_failed);
+    auto &&mask = vmcs::cr0_guest_host_mask::get_nothrow(m_vmcs_failed);
+    auto &&shadow = vmcs::cr0_read_shadow::get_nothrow(m_vmcs_failed);
+
+    return (cr0 & ~mask) | (shadow & mask);
+}
+
+uint64_t
+exit_handler_intel_x64::read_guest_cr4() noexcept
+{
+    auto &&cr4 = m_guest_shadow.get(vmcs::guest_cr4::addr, m_vmcs_failed);
+    auto &&mask = vmcs::cr4_guest_host_mask::get_nothrow(m_vmcs_failed);
+    auto &&shadow = vmcs::cr4_read_shadow::get_nothrow(m_vmcs_failed);
+
+    return (cr4 & ~mask) | (shadow & mask);
+}
+
+void
+exit_handler_intel_x64::write_guest_cr0(uint64_t val) noexcept
+{
+    m_guest_shadow.set(vmcs::guest_cr0::addr, vmcs::control_registers::cr0_guest_value(val), m_vmcs_failed);
+    vmcs::cr0_read_shadow::set_nothrow(val, m_vmcs_failed);
+}
+
+void
+exit_handler_intel_x64::write_guest_cr4(uint64_t val) noexcept
+{
+    m_guest_shadow.set(vmcs::guest_cr4::addr, vmcs::control_registers::cr4_guest_value(val), m_vmcs_failed);
+    vmcs::cr4_read_shadow::set_nothrow(val, m_vmcs_failed);
+}
+
+vmcs_intel_x64_vpid::vpid_type
+exit_handler_intel_x64::guest_vpid()
+{
+    // The VPID field is only written when VPIDs are enabled (see
+    // vmcs_intel_x64_vpid::write_fields), so 0 means "not enabled"
+
+    return gsl::narrow_cast<vmcs_intel_x64_vpid::vpid_type>(
+               vmcs::virtual_processor_identifier::get_if_exists());
+}
+
+uint64_t &
+exit_handler_intel_x64::guest_gpr(uint64_t index)
+{
+    namespace gpr = vmcs::exit_qualification::control_register_access::general_purpose_register;
+
+    switch (index) {
+        case gpr::rax: return m_state_save->rax;
+        case gpr::rcx: return m_state_save->rcx;
+        case gpr::rdx: return m_state_save->rdx;
+        case gpr::rbx: return m_state_save->rbx;
+        case gpr::rsp: return m_state_save->rsp;
+        case gpr::rbp: return m_state_save->rbp;
+        case gpr::rsi: return m_state_save->rsi;
+        case gpr::rdi: return m_state_save->rdi;
+        case gpr::r8: return m_state_save->r08;
+        case gpr::r9: return m_state_save->r09;
+        case gpr::r10: return m_state_save->r10;
+        case gpr::r11: return m_state_save->r11;
+        case gpr::r12: return m_state_save->r12;
+        case gpr::r13: return m_state_save->r13;
+        case gpr::r14: return m_state_save->r14;
+        case gpr::r15: return m_state_save->r15;
+
+        default:
+            throw std::invalid_argument("invalid general purpose register index");
+    }
+}
+
 void
 exit_handler_intel_x64::advance_rip() noexcept
-{ m_state_save->rip += vmcs::vm_exit_instruction_length::get(); }
+{ m_state_save->rip += vm_exit_instruction_length(); }
 
 void
 exit_handler_intel_x64::unimplemented_handler() noexcept
@@ -359,9 +912,13 @@ exit_handler_intel_x64::unimplemented_handler() noexcept
     bferror_lnbr(0);
     bferror_info(0, "unhandled exit reason");
     bferror_brk1(0);
-    bferror_subtext(0, "exit_reason", vmcs::exit_reason::basic_exit_reason::description());
+    auto &&reason = vm_exit_reason();
+    auto &&basic_exit_reason = vmcs::exit_reason::basic_exit_reason::get(reason);
+
+    bferror_subtext(0, "exit_reason",
+                    vmcs::exit_reason::basic_exit_reason::basic_exit_reason_description(basic_exit_reason));
 
-    if (vmcs::exit_reason::vm_entry_failure::is_enabled()) {
+    if (vmcs::exit_reason::vm_entry_failure::is_enabled(reason)) {
 
         guard_exceptions([&]
         { vmcs::check::all(); });
@@ -373,6 +930,71 @@ exit_handler_intel_x64::unimplemented_handler() noexcept
     this->halt();
 }
 
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_reason() noexcept
+{ return exit_info(0, vmcs::exit_reason::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_qualification() noexcept
+{ return exit_info(1, vmcs::exit_qualification::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_instruction_length() noexcept
+{ return exit_info(2, vmcs::vm_exit_instruction_length::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_instruction_information() noexcept
+{ return exit_info(3, vmcs::vm_exit_instruction_information::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_guest_linear_address() noexcept
+{ return exit_info(4, vmcs::guest_linear_address::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_guest_physical_address() noexcept
+{ return exit_info(5, vmcs::guest_physical_address::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_interruption_information() noexcept
+{ return exit_info(6, vmcs::vm_exit_interruption_information::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_interruption_error_code() noexcept
+{ return exit_info(7, vmcs::vm_exit_interruption_error_code::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_idt_vectoring_information() noexcept
+{ return exit_info(8, vmcs::idt_vectoring_information::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::vm_exit_idt_vectoring_error_code() noexcept
+{ return exit_info(9, vmcs::idt_vectoring_error_code::addr); }
+
+vmcs::value_type
+exit_handler_intel_x64::exit_info(uint64_t index, vmcs::field_type addr) noexcept
+{
+    if (is_bit_set(m_state_save->exit_info_valid, index)) {
+        return gsl::at(m_state_save->exit_info, index);
+    }
+
+    auto failed = false;
+    auto &&value = vmcs::get_vmcs_field_nothrow(addr, true, failed);
+
+    if (failed) {
+        m_vmcs_failed = true;
+        return value;
+    }
+
+    gsl::at(m_state_save->exit_info, index) = value;
+    m_state_save->exit_info_valid = set_bit(m_state_save->exit_info_valid, index);
+
+    return value;
+}
+
+void
+exit_handler_intel_x64::invalidate_exit_info() noexcept
+{ m_state_save->exit_info_valid = 0; }
+
 void
 exit_handler_intel_x64::complete_vmcall(
     ret_type ret, vmcall_registers_t &regs) noexcept
@@ -458,32 +1080,42 @@ exit_handler_intel_x64::handle_vmcall_data(vmcall_registers_t &regs)
     expects(regs.r06 <= VMCALL_IN_BUFFER_SIZE);
     expects(regs.r09 <= VMCALL_OUT_BUFFER_SIZE);
 
-    auto &&imap = bfn::make_unique_map_x64<char>(regs.r05, vmcs::guest_cr3::get(), regs.r06,
-                  vmcs::guest_ia32_pat::get());
-    auto &&omap = bfn::make_unique_map_x64<char>(regs.r08, vmcs::guest_cr3::get(), regs.r09,
-                  vmcs::guest_ia32_pat::get());
+    auto &&cr3 = m_guest_shadow.get(vmcs::guest_cr3::addr, m_vmcs_failed);
+    auto &&pat = m_guest_shadow.get(vmcs::guest_ia32_pat::addr, m_vmcs_failed);
+
+    if (m_vmcs_failed) {
+        throw std::runtime_error("failed to read the guest's cr3 / pat");
+    }
+
+    auto &&imap = bfn::make_unique_map_x64<char>(regs.r05, cr3, regs.r06, pat);
+    auto &&omap = bfn::make_unique_map_x64<char>(regs.r08, cr3, regs.r09, pat);
+
+    // The raw handlers work on the guest's buffers in place. The maps own
+    // the mappings, and must outlive the spans.
+
+    auto &&ispan = gsl::span<const char>(imap.get(), gsl::narrow_cast<std::ptrdiff_t>(regs.r06));
+    auto &&ospan = gsl::span<char>(omap.get(), gsl::narrow_cast<std::ptrdiff_t>(regs.r09));
 
     switch (regs.r04) {
-        case VMCALL_DATA_STRING_UNFORMATTED: {
-            std::string ostr;
-            handle_vmcall_data_string_unformatted(std::string(imap.get(), regs.r06), ostr);
-            reply_with_string(regs, ostr, omap);
+        case VMCALL_DATA_STRING_UNFORMATTED:
+            regs.r09 = handle_vmcall_data_string_unformatted_raw(ispan, ospan);
+            regs.r07 = VMCALL_DATA_STRING_UNFORMATTED;
             break;
-        }
 
-        case VMCALL_DATA_STRING_JSON: {
-            json ojson;
-            handle_vmcall_data_string_json(json::parse(std::string(imap.get(), regs.r06)), ojson);
-            reply_with_json(regs, ojson, omap);
+        case VMCALL_DATA_STRING_JSON:
+            regs.r09 = handle_vmcall_data_string_json_raw(ispan, ospan);
+            regs.r07 = VMCALL_DATA_STRING_JSON;
             break;
-        }
 
-        case VMCALL_DATA_BINARY_UNFORMATTED: {
-            handle_vmcall_data_binary_unformatted(imap, omap);
+        case VMCALL_DATA_BINARY_UNFORMATTED:
+            regs.r09 = handle_vmcall_data_binary_unformatted_raw(ispan, ospan);
             regs.r07 = VMCALL_DATA_BINARY_UNFORMATTED;
-            regs.r09 = regs.r06;
             break;
-        }
+
+        case VMCALL_DATA_BINARY_CBOR:
+            regs.r09 = handle_vmcall_data_binary_cbor_raw(ispan, ospan);
+            regs.r07 = VMCALL_DATA_BINARY_CBOR;
+            break;
 
         default:
             throw std::runtime_error("unknown vmcall data type");
@@ -513,6 +1145,253 @@ exit_handler_intel_x64::handle_vmcall_stop(vmcall_registers_t &regs)
     bfdebug_info(0, "host os is" bfcolor_red " not " bfcolor_end "in a vm");
 }
 
+void
+exit_handler_intel_x64::handle_vmcall_ring(vmcall_registers_t &regs)
+{
+    switch (regs.r02) {
+        case VMCALL_RING_REGISTER: {
+            expects(regs.r03 != 0);
+            expects((regs.r03 & (x64::page_size - 1)) == 0);
+
+            auto &&ring = bfn::make_unique_map_x64<vmcall_ring_t>(regs.r03);
+
+            ring->head = 0;
+            ring->tail = 0;
+            ring->size = VMCALL_RING_SIZE;
+
+            m_vmcall_ring = std::move(ring);
+            break;
+        }
+
+        case VMCALL_RING_UNREGISTER:
+            m_vmcall_ring.reset();
+            break;
+
+        case VMCALL_RING_DOORBELL:
+            regs.r03 = process_vmcall_ring();
+            break;
+
+        default:
+            throw std::runtime_error("unknown vmcall ring operation");
+    }
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_profiler(vmcall_registers_t &regs)
+{
+    switch (regs.r02) {
+        case VMCALL_PROFILER_ENABLE:
+            m_profiler.enable(regs.r03);
+            break;
+
+        case VMCALL_PROFILER_DISABLE:
+            m_profiler.disable();
+            break;
+
+        case VMCALL_PROFILER_READ: {
+            expects(regs.r03 != 0);
+            expects(regs.r04 >= sizeof(profiler_sample_t));
+            expects(regs.r04 <= m_profiler.capacity() * sizeof(profiler_sample_t));
+
+            auto &&cr3 = m_guest_shadow.get(vmcs::guest_cr3::addr, m_vmcs_failed);
+            auto &&pat = m_guest_shadow.get(vmcs::guest_ia32_pat::addr, m_vmcs_failed);
+
+            if (m_vmcs_failed) {
+                throw std::runtime_error("failed to read the guest's cr3 / pat");
+            }
+
+            auto &&omap = bfn::make_unique_map_x64<profiler_sample_t>(regs.r03, cr3, regs.r04, pat);
+            auto &&num = regs.r04 / sizeof(profiler_sample_t);
+            profiler_intel_x64::size_type dropped = 0;
+
+            regs.r03 = m_profiler.read(
+                gsl::span<profiler_sample_t>(omap.get(), gsl::narrow_cast<std::ptrdiff_t>(num)), dropped);
+            regs.r04 = dropped;
+            break;
+        }
+
+        default:
+            throw std::runtime_error("unknown vmcall profiler operation");
+    }
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_ple(vmcall_registers_t &regs)
+{
+    switch (regs.r02) {
+        case VMCALL_PLE_ENABLE:
+            m_ple.enable(regs.r03, regs.r04, regs.r05);
+            break;
+
+        case VMCALL_PLE_DISABLE:
+            m_ple.disable();
+            break;
+
+        case VMCALL_PLE_COUNTERS: {
+            const auto &counters = m_ple.counters();
+
+            regs.r03 = counters.exits;
+            regs.r04 = counters.useful_exits;
+            regs.r05 = counters.grows;
+            regs.r06 = counters.shrinks;
+            regs.r07 = m_ple.window();
+
+            m_ple.reset_counters();
+            break;
+        }
+
+        default:
+            throw std::runtime_error("unknown vmcall ple operation");
+    }
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_exit_trace(vmcall_registers_t &regs)
+{
+    switch (regs.r02) {
+        case VMCALL_EXIT_TRACE_ENABLE:
+            m_trace.enable(regs.r03 != 0 ? regs.r03 : exit_trace_intel_x64::default_num_records);
+            break;
+
+        case VMCALL_EXIT_TRACE_DISABLE:
+            m_trace.disable();
+            break;
+
+        case VMCALL_EXIT_TRACE_READ: {
+            expects(regs.r03 != 0);
+            expects(regs.r04 >= sizeof(exit_trace_record_t));
+            expects(regs.r04 <= m_trace.capacity() * sizeof(exit_trace_record_t));
+
+            auto &&cr3 = m_guest_shadow.get(vmcs::guest_cr3::addr, m_vmcs_failed);
+            auto &&pat = m_guest_shadow.get(vmcs::guest_ia32_pat::addr, m_vmcs_failed);
+
+            if (m_vmcs_failed) {
+                throw std::runtime_error("failed to read the guest's cr3 / pat");
+            }
+
+            auto &&omap = bfn::make_unique_map_x64<exit_trace_record_t>(regs.r03, cr3, regs.r04, pat);
+            auto &&num = regs.r04 / sizeof(exit_trace_record_t);
+            exit_trace_intel_x64::size_type dropped = 0;
+
+            regs.r03 = m_trace.read(
+                gsl::span<exit_trace_record_t>(omap.get(), gsl::narrow_cast<std::ptrdiff_t>(num)), dropped);
+            regs.r04 = dropped;
+            break;
+        }
+
+        default:
+            throw std::runtime_error("unknown vmcall exit trace operation");
+    }
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_ring_entry(
+    uint64_t opcode, vmcall_registers_t &regs)
+{
+    switch (opcode) {
+        case VMCALL_VERSIONS:
+            handle_vmcall_versions(regs);
+            break;
+
+        case VMCALL_REGISTERS:
+            handle_vmcall_registers(regs);
+            break;
+
+        case VMCALL_DATA:
+            handle_vmcall_data(regs);
+            break;
+
+        case VMCALL_EVENT:
+            handle_vmcall_event(regs);
+            break;
+
+        default:
+            throw std::runtime_error("vmcall opcode not supported by the vmcall ring");
+    }
+}
+
+uint64_t
+exit_handler_intel_x64::process_vmcall_ring()
+{
+    if (!m_vmcall_ring) {
+        throw std::runtime_error("vmcall ring not registered");
+    }
+
+    auto &&ring = m_vmcall_ring.get();
+
+    // The guest can modify the ring while we are processing it, so tail is
+    // read once, and each entry's request is copied out before it is used.
+
+    uint64_t head = ring->head;
+    uint64_t tail = static_cast<volatile uint64_t &>(ring->tail);
+
+    if (tail - head > VMCALL_RING_SIZE) {
+        throw std::runtime_error("vmcall ring overflow");
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    for (auto index = head; index != tail; index++) {
+        auto &&entry = gsl::at(ring->entries, index % VMCALL_RING_SIZE);
+
+        uint64_t opcode = entry.opcode;
+        vmcall_registers_t regs = entry.regs;
+
+        entry.ret = guard_exceptions(BF_VMCALL_FAILURE, [&]
+        { handle_vmcall_ring_entry(opcode, regs); });
+
+        entry.regs = regs;
+
+        std::atomic_thread_fence(std::memory_order_release);
+        ring->head = index + 1;
+    }
+
+    return tail - head;
+}
+
+uint64_t
+exit_handler_intel_x64::handle_vmcall_data_string_unformatted_raw(
+    gsl::span<const char> ispan, gsl::span<char> ospan)
+{
+    std::string ostr;
+    handle_vmcall_data_string_unformatted(std::string(ispan.data(), gsl::narrow_cast<std::size_t>(ispan.size())), ostr);
+
+    return reply_with_string(ostr, ospan);
+}
+
+uint64_t
+exit_handler_intel_x64::handle_vmcall_data_string_json_raw(
+    gsl::span<const char> ispan, gsl::span<char> ospan)
+{
+    json ojson;
+    handle_vmcall_data_string_json(json::parse(std::string(ispan.data(), gsl::narrow_cast<std::size_t>(ispan.size()))), ojson);
+
+    return reply_with_json(ojson, ospan);
+}
+
+uint64_t
+exit_handler_intel_x64::handle_vmcall_data_binary_unformatted_raw(
+    gsl::span<const char> ispan, gsl::span<char> ospan)
+{
+    expects(ispan.size() <= ospan.size());
+
+    bfdebug_info(0, "received binary data");
+    memcpy(ospan.data(), ispan.data(), gsl::narrow_cast<std::size_t>(ispan.size()));
+
+    return gsl::narrow_cast<uint64_t>(ispan.size());
+}
+
+uint64_t
+exit_handler_intel_x64::handle_vmcall_data_binary_cbor_raw(
+    gsl::span<const char> ispan, gsl::span<char> ospan)
+{
+    cbor_decoder decoder(ispan);
+    cbor_encoder encoder(ospan);
+
+    handle_vmcall_data_binary_cbor(decoder, encoder);
+    return encoder.size();
+}
+
 void
 exit_handler_intel_x64::handle_vmcall_data_string_unformatted(
     const std::string &istr, std::string &ostr)
@@ -534,20 +1413,32 @@ exit_handler_intel_x64::handle_vmcall_data_binary_unformatted(
     const bfn::unique_map_ptr_x64<char> &imap,
     const bfn::unique_map_ptr_x64<char> &omap)
 {
-    bfdebug_info(0, "received binary data");
-    memcpy(omap.get(), imap.get(), imap.size());
+    auto &&ispan = gsl::span<const char>(imap.get(), gsl::narrow_cast<std::ptrdiff_t>(imap.size()));
+    auto &&ospan = gsl::span<char>(omap.get(), gsl::narrow_cast<std::ptrdiff_t>(omap.size()));
+
+    handle_vmcall_data_binary_unformatted_raw(ispan, ospan);
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_data_binary_cbor(
+    cbor_decoder &decoder, cbor_encoder &encoder)
+{
+    bfdebug_info(0, "received cbor data");
+
+    while (!decoder.empty()) {
+        encoder.encode_raw(decoder.decode_raw());
+    }
 }
 
-void exit_handler_intel_x64::reply_with_string(
+void
+exit_handler_intel_x64::reply_with_string(
     vmcall_registers_t &regs, const std::string &str,
     const bfn::unique_map_ptr_x64<char> &omap)
 {
-    auto &&len = str.length();
-
-    memcpy(omap.get(), str.data(), len);
+    auto &&ospan = gsl::span<char>(omap.get(), gsl::narrow_cast<std::ptrdiff_t>(omap.size()));
 
+    regs.r09 = reply_with_string(str, ospan);
     regs.r07 = VMCALL_DATA_STRING_UNFORMATTED;
-    regs.r09 = len;
 }
 
 void
@@ -555,11 +1446,24 @@ exit_handler_intel_x64::reply_with_json(
     vmcall_registers_t &regs, const json &str,
     const bfn::unique_map_ptr_x64<char> &omap)
 {
-    auto &&dmp = str.dump();
-    auto &&len = dmp.length();
-
-    memcpy(omap.get(), dmp.data(), len);
+    auto &&ospan = gsl::span<char>(omap.get(), gsl::narrow_cast<std::ptrdiff_t>(omap.size()));
 
+    regs.r09 = reply_with_json(str, ospan);
     regs.r07 = VMCALL_DATA_STRING_JSON;
-    regs.r09 = len;
 }
+
+uint64_t
+exit_handler_intel_x64::reply_with_string(
+    const std::string &str, gsl::span<char> ospan)
+{
+    auto &&len = str.length();
+    expects(len <= gsl::narrow_cast<std::size_t>(ospan.size()));
+
+    memcpy(ospan.data(), str.data(), len);
+    return len;
+}
+
+uint64_t
+exit_handler_intel_x64::reply_with_json(
+    const json &ojson, gsl::span<char> ospan)
+{ return reply_with_string(ojson.dump(), ospan); }
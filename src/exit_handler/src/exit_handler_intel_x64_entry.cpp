@@ -23,6 +23,12 @@
 #include <exit_handler/exit_handler_intel_x64.h>
 #include <exit_handler/exit_handler_intel_x64_entry.h>
 
+#include <vmcs/vmcs_intel_x64_resume.h>
+#include <intrinsics/x86/intel_x64.h>
+
+using namespace x64;
+using namespace intel_x64;
+
 // -----------------------------------------------------------------------------
 // Implementation
 // -----------------------------------------------------------------------------
@@ -35,3 +41,120 @@ exit_handler(exit_handler_intel_x64 *exit_handler) noexcept
 
     exit_handler->halt();
 }
+
+static bool
+fast_path_msr(exit_handler_intel_x64 *exit_handler, x64::msrs::field_type msr) noexcept
+{
+    // MSRs in the VMCS's MSR area are switched by the CPU, and so rdmsr /
+    // wrmsr would access the VMM's value instead of the guest's.
+
+    if (exit_handler->m_msr_area != nullptr && exit_handler->m_msr_area->contains(msr)) {
+        return false;
+    }
+
+    switch (msr) {
+
+        // The following MSRs are stored in the VMCS, and the CPU-Z quirks
+        // are emulated by handle_rdmsr, so these are left to the exit
+        // handler.
+
+        case intel_x64::msrs::ia32_debugctl::addr:
+        case x64::msrs::ia32_pat::addr:
+        case intel_x64::msrs::ia32_efer::addr:
+        case intel_x64::msrs::ia32_perf_global_ctrl::addr:
+        case intel_x64::msrs::ia32_sysenter_cs::addr:
+        case intel_x64::msrs::ia32_sysenter_esp::addr:
+        case intel_x64::msrs::ia32_sysenter_eip::addr:
+        case intel_x64::msrs::ia32_fs_base::addr:
+        case intel_x64::msrs::ia32_gs_base::addr:
+        case 0x31:
+        case 0x39:
+        case 0x1ae:
+        case 0x1af:
+        case 0x602:
+            return false;
+
+        default:
+            return true;
+    }
+}
+
+extern "C" void
+exit_handler_fast_path(exit_handler_intel_x64 *exit_handler, uint64_t reason) noexcept
+{
+    vmcs::value_type len = 0;
+    auto state_save = exit_handler->m_state_save;
+
+    // The fast path resumes the guest without going through resume(), so
+    // while there are events to inject, the exit trace is enabled, or the
+    // VMCS is checked before every entry, exits are left to the exit
+    // handler.
+
+    if (!exit_handler->m_events.empty() || exit_handler->m_trace.is_enabled() || vm::dirty_enabled()) {
+        return;
+    }
+
+    if (!_vmread(vmcs::vm_exit_instruction_length::addr, &len)) {
+        return;
+    }
+
+    switch (reason) {
+        case vmcs::exit_reason::basic_exit_reason::cpuid: {
+            auto ret = x64::cpuid::get(gsl::narrow_cast<x64::cpuid::field_type>(state_save->rax),
+                                       gsl::narrow_cast<x64::cpuid::field_type>(state_save->rbx),
+                                       gsl::narrow_cast<x64::cpuid::field_type>(state_save->rcx),
+                                       gsl::narrow_cast<x64::cpuid::field_type>(state_save->rdx));
+
+            state_save->rax = ret.rax;
+            state_save->rbx = ret.rbx;
+            state_save->rcx = ret.rcx;
+            state_save->rdx = ret.rdx;
+            break;
+        }
+
+        case vmcs::exit_reason::basic_exit_reason::invd:
+            cache::wbinvd();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::rdmsr: {
+            auto msr = gsl::narrow_cast<x64::msrs::field_type>(state_save->rcx);
+
+            if (!fast_path_msr(exit_handler, msr)) {
+                return;
+            }
+
+            auto val = x64::msrs::get(msr);
+
+            state_save->rax = ((val >> 0x00) & 0x00000000FFFFFFFF);
+            state_save->rdx = ((val >> 0x20) & 0x00000000FFFFFFFF);
+            break;
+        }
+
+        case vmcs::exit_reason::basic_exit_reason::wrmsr: {
+            auto msr = gsl::narrow_cast<x64::msrs::field_type>(state_save->rcx);
+
+            if (!fast_path_msr(exit_handler, msr)) {
+                return;
+            }
+
+            auto val = 0ULL;
+            val |= ((state_save->rax & 0x00000000FFFFFFFF) << 0x00);
+            val |= ((state_save->rdx & 0x00000000FFFFFFFF) << 0x20);
+
+            x64::msrs::set(msr, val);
+            break;
+        }
+
+        default:
+            return;
+    }
+
+    state_save->rip += len;
+    vmcs_resume(state_save);
+
+    // If we get this far, the resume failed. Since the instruction has
+    // already been emulated, the exit cannot be handed back to the exit
+    // handler, so the only thing left to do is halt.
+
+    exit_handler->halt();
+}
@@ -24,8 +24,10 @@ default rel
 
 %define VMCS_GUEST_RSP 0x0000681C
 %define VMCS_GUEST_RIP 0x0000681E
+%define VMCS_EXIT_REASON 0x00004402
 
 extern exit_handler
+extern exit_handler_fast_path
 global exit_handler_entry:function
 
 section .text
@@ -57,6 +59,15 @@ exit_handler_entry:
     mov [gs:0x068], r14
     mov [gs:0x070], r15
 
+; When the extended state is managed lazily, the host CR0.TS is set, and the
+; guest's extended state is saved by the #NM handler the first time the VMM
+; uses the FPU / SSE / AVX registers (see xstate_intel_x64), so there is no
+; need to save xmm0-xmm7 here. Otherwise, vmcs_resume is told to restore
+; them, as the mode might be changed before the guest is resumed.
+
+    test qword [gs:0x320], 0x1
+    jnz .xmm_saved
+
     movdqa [gs:0x0C0], xmm0
     movdqa [gs:0x0E0], xmm1
     movdqa [gs:0x100], xmm2
@@ -66,11 +77,47 @@ exit_handler_entry:
     movdqa [gs:0x180], xmm6
     movdqa [gs:0x1A0], xmm7
 
+    or qword [gs:0x320], 0x4
+
+.xmm_saved:
+
     mov rdi, VMCS_GUEST_RIP
     vmread [gs:0x078], rdi
     mov rdi, VMCS_GUEST_RSP
     vmread [gs:0x080], rdi
 
+; Fast Path
+;
+; If the basic exit reason has been enabled in the state save's fast path
+; mask, the exit is handed to exit_handler_fast_path, which emulates the
+; instruction and resumes the guest without going through the exit handler's
+; dispatch logic. If the fast path is unable to handle the exit, it returns,
+; and the exit is handled normally.
+
+    mov rdi, VMCS_EXIT_REASON
+    vmread rsi, rdi
+
+; Exit Information
+;
+; The exit reason is needed by both the fast path and dispatch, so it is
+; stored in the state save's exit information cache (index 0), which also
+; invalidates all of the other cached fields from the previous exit.
+
+    mov [gs:0x2D0], rsi
+    mov qword [gs:0x2C8], 0x1
+
+    and rsi, 0xFFFF
+
+    cmp rsi, 0x40
+    jae .dispatch
+    bt qword [gs:0x2C0], rsi
+    jnc .dispatch
+
+    mov rdi, [gs:0x00A0]
+    call exit_handler_fast_path wrt ..plt
+
+.dispatch:
+
     mov rdi, [gs:0x00A0]
     call exit_handler wrt ..plt
 
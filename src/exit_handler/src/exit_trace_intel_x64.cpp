@@ -0,0 +1,132 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <exit_handler/exit_trace_intel_x64.h>
+#include <intrinsics/x86/common_x64.h>
+
+constexpr const exit_trace_intel_x64::size_type exit_trace_intel_x64::default_num_records;
+constexpr const exit_trace_intel_x64::size_type exit_trace_intel_x64::max_num_records;
+
+void
+exit_trace_intel_x64::enable(size_type num_records)
+{
+    expects(num_records != 0);
+    expects(num_records <= max_num_records);
+
+    if (!m_records || num_records != m_num_records) {
+        m_records = std::make_unique<record_type[]>(num_records);
+        m_num_records = num_records;
+
+        m_head = 0;
+        m_tail = 0;
+        m_dropped = 0;
+    }
+
+    m_end_tsc = 0;
+    m_pending = false;
+    m_enabled = true;
+}
+
+void
+exit_trace_intel_x64::disable() noexcept
+{
+    m_pending = false;
+    m_enabled = false;
+}
+
+void
+exit_trace_intel_x64::begin(uint64_t reason,
+                            uint64_t qualification,
+                            uint64_t instruction_length,
+                            uint64_t instruction_information,
+                            const state_save_intel_x64 &state) noexcept
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    m_begin_tsc = x64::read_tsc::get();
+
+    m_record.reason = reason;
+    m_record.qualification = qualification;
+    m_record.instruction_length = instruction_length;
+    m_record.instruction_information = instruction_information;
+
+    m_record.rip = state.rip;
+    m_record.rax = state.rax;
+    m_record.rbx = state.rbx;
+    m_record.rcx = state.rcx;
+    m_record.rdx = state.rdx;
+    m_record.rsi = state.rsi;
+    m_record.rdi = state.rdi;
+    m_record.r08 = state.r08;
+    m_record.r09 = state.r09;
+
+    m_record.tsc_delta = m_end_tsc != 0 ? m_begin_tsc - m_end_tsc : 0;
+
+    m_pending = true;
+}
+
+void
+exit_trace_intel_x64::end(const state_save_intel_x64 &state, uint64_t outcome) noexcept
+{
+    if (!m_pending) {
+        return;
+    }
+
+    m_end_tsc = x64::read_tsc::get();
+    m_pending = false;
+
+    if (state.rip != m_record.rip) {
+        outcome |= EXIT_TRACE_OUTCOME_ADVANCED;
+    }
+
+    m_record.handler_tsc = m_end_tsc - m_begin_tsc;
+    m_record.outcome = outcome;
+
+    if (m_tail - m_head == m_num_records) {
+        m_dropped++;
+        return;
+    }
+
+    m_records.get()[m_tail % m_num_records] = m_record;
+    m_tail++;
+}
+
+exit_trace_intel_x64::size_type
+exit_trace_intel_x64::read(gsl::span<record_type> records, size_type &dropped) noexcept
+{
+    auto num = size();
+    auto max = gsl::narrow_cast<size_type>(records.size());
+
+    num = num > max ? max : num;
+
+    for (auto i = 0ULL; i < num; i++) {
+        records[gsl::narrow_cast<std::ptrdiff_t>(i)] = m_records.get()[(m_head + i) % m_num_records];
+    }
+
+    m_head += num;
+
+    dropped = m_dropped;
+    m_dropped = 0;
+
+    return num;
+}
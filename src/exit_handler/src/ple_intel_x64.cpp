@@ -0,0 +1,127 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <exit_handler/ple_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+using namespace intel_x64;
+
+// The PLE gap and window are 32bit fields.
+
+constexpr const auto max_ple_value = 0xFFFFFFFFULL;
+
+void
+ple_intel_x64::enable(uint64_t gap, uint64_t window, uint64_t max_window)
+{
+    expects(gap != 0);
+    expects(window != 0);
+    expects(max_window == 0 || max_window >= window);
+
+    if (!vmcs::secondary_processor_based_vm_execution_controls::pause_loop_exiting::is_allowed1()) {
+        throw std::runtime_error("pause-loop exiting is not supported");
+    }
+
+    m_gap = gap > max_ple_value ? max_ple_value : gap;
+    m_window = window > max_ple_value ? max_ple_value : window;
+    m_min_window = m_window;
+
+    max_window = max_window == 0 ? m_window : max_window;
+    m_max_window = max_window > max_ple_value ? max_ple_value : max_window;
+
+    vmcs::ple_gap::set(m_gap);
+    vmcs::ple_window::set(m_window);
+    vmcs::secondary_processor_based_vm_execution_controls::pause_loop_exiting::enable();
+
+    m_enabled = true;
+}
+
+void
+ple_intel_x64::disable()
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    vmcs::secondary_processor_based_vm_execution_controls::pause_loop_exiting::disable();
+    m_enabled = false;
+}
+
+void
+ple_intel_x64::pause_exit(bool useful, bool &failed) noexcept
+{
+    m_counters.exits++;
+    m_counters.useful_exits += useful ? 1 : 0;
+
+    if (!m_enabled) {
+        return;
+    }
+
+    auto window = m_window;
+
+    if (useful) {
+        window >>= 1;
+        window = window < m_min_window ? m_min_window : window;
+
+        if (window != m_window) {
+            m_counters.shrinks++;
+        }
+    }
+    else {
+        window <<= 1;
+        window = window > m_max_window ? m_max_window : window;
+
+        if (window != m_window) {
+            m_counters.grows++;
+        }
+    }
+
+    if (window != m_window) {
+        vmcs::ple_window::set_nothrow(window, failed);
+        m_window = window;
+    }
+}
+
+void
+ple_intel_x64::resync(bool &failed) noexcept
+{
+    namespace secondary = vmcs::secondary_processor_based_vm_execution_controls;
+
+    // The gap is never 0 once enabled, so no VMCS has pause-loop exiting
+    // enabled if it is
+
+    if (m_gap == 0) {
+        return;
+    }
+
+    auto &&controls = secondary::get_nothrow(failed);
+
+    if (m_enabled) {
+        vmcs::ple_gap::set_nothrow(m_gap, failed);
+        vmcs::ple_window::set_nothrow(m_window, failed);
+
+        controls = set_bit(controls, secondary::pause_loop_exiting::from);
+    }
+    else {
+        controls = clear_bit(controls, secondary::pause_loop_exiting::from);
+    }
+
+    secondary::set_nothrow(controls, failed);
+}
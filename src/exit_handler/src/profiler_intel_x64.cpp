@@ -0,0 +1,133 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <exit_handler/profiler_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+using namespace intel_x64;
+
+constexpr const auto max_timer_value = 0xFFFFFFFFULL;
+
+profiler_intel_x64::profiler_intel_x64(size_type num_samples) noexcept :
+    m_num_samples(num_samples)
+{ }
+
+void
+profiler_intel_x64::enable(uint64_t period)
+{
+    expects(period != 0);
+    expects(m_num_samples != 0);
+
+    if (!vmcs::pin_based_vm_execution_controls::activate_vmx_preemption_timer::is_allowed1()) {
+        throw std::runtime_error("the vmx preemption timer is not supported");
+    }
+
+    // The preemption timer counts down by 1 every time bit X of the TSC
+    // changes, where X is reported by IA32_VMX_MISC.
+
+    auto &&value = period >> msrs::ia32_vmx_misc::preemption_timer_decrement::get();
+
+    value = value == 0 ? 1 : value;
+    value = value > max_timer_value ? max_timer_value : value;
+
+    if (!m_samples) {
+        m_samples = std::make_unique<sample_type[]>(m_num_samples);
+    }
+
+    // If the timer's value is saved on exit, time spent in the guest
+    // accumulates across unrelated exits, and the timer has to be re-armed
+    // once it expires. Otherwise, the timer restarts from the programmed
+    // value on every VM entry, which biases the samples towards code that
+    // does not exit, but does not need a vmwrite per sample.
+
+    m_rearm = vmcs::vm_exit_controls::save_vmx_preemption_timer_value::is_allowed1();
+
+    if (m_rearm) {
+        vmcs::vm_exit_controls::save_vmx_preemption_timer_value::enable();
+    }
+
+    vmcs::vmx_preemption_timer_value::set(value);
+    vmcs::pin_based_vm_execution_controls::activate_vmx_preemption_timer::enable();
+
+    m_timer_value = value;
+    m_enabled = true;
+}
+
+void
+profiler_intel_x64::disable()
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    vmcs::pin_based_vm_execution_controls::activate_vmx_preemption_timer::disable();
+
+    if (m_rearm) {
+        vmcs::vm_exit_controls::save_vmx_preemption_timer_value::disable();
+    }
+
+    m_enabled = false;
+}
+
+void
+profiler_intel_x64::sample(uint64_t rip, uint64_t cr3, uint64_t cpl, bool &failed) noexcept
+{
+    if (!m_samples) {
+        return;
+    }
+
+    if (m_tail - m_head == m_num_samples) {
+        m_dropped++;
+    }
+    else {
+        auto &&sample = m_samples.get()[m_tail % m_num_samples];
+
+        sample.rip = rip;
+        sample.cr3 = cr3;
+        sample.cpl = cpl;
+
+        m_tail++;
+    }
+
+    if (m_enabled && m_rearm) {
+        vmcs::vmx_preemption_timer_value::set_nothrow(m_timer_value, failed);
+    }
+}
+
+profiler_intel_x64::size_type
+profiler_intel_x64::read(gsl::span<sample_type> samples, size_type &dropped) noexcept
+{
+    auto &&num = size();
+    auto &&max = gsl::narrow_cast<size_type>(samples.size());
+
+    num = num > max ? max : num;
+
+    for (auto i = 0ULL; i < num; i++) {
+        samples[gsl::narrow_cast<std::ptrdiff_t>(i)] = m_samples.get()[(m_head + i) % m_num_samples];
+    }
+
+    m_head += num;
+
+    dropped = m_dropped;
+    m_dropped = 0;
+
+    return num;
+}
@@ -0,0 +1,418 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+#include <exit_handler/vmcall_cbor.h>
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+constexpr const auto cbor_info_uint8 = 24ULL;
+constexpr const auto cbor_info_uint16 = 25ULL;
+constexpr const auto cbor_info_uint32 = 26ULL;
+constexpr const auto cbor_info_uint64 = 27ULL;
+
+constexpr const auto cbor_simple_false = 20ULL;
+constexpr const auto cbor_simple_true = 21ULL;
+constexpr const auto cbor_simple_null = 22ULL;
+
+// -----------------------------------------------------------------------------
+// CBOR Encoder
+// -----------------------------------------------------------------------------
+
+cbor_encoder::cbor_encoder(gsl::span<char> buf) noexcept :
+    m_buf(buf)
+{ }
+
+void
+cbor_encoder::encode_uint(uint64_t val)
+{ encode_head(cbor::unsigned_integer, val); }
+
+void
+cbor_encoder::encode_int(int64_t val)
+{
+    if (val >= 0) {
+        return encode_head(cbor::unsigned_integer, static_cast<uint64_t>(val));
+    }
+
+    encode_head(cbor::negative_integer, static_cast<uint64_t>(-1 - val));
+}
+
+void
+cbor_encoder::encode_bool(bool val)
+{ encode_head(cbor::simple, val ? cbor_simple_true : cbor_simple_false); }
+
+void
+cbor_encoder::encode_null()
+{ encode_head(cbor::simple, cbor_simple_null); }
+
+void
+cbor_encoder::encode_bytes(gsl::span<const char> bytes)
+{
+    auto index = m_index;
+
+    try {
+        encode_head(cbor::byte_string, gsl::narrow_cast<uint64_t>(bytes.size()));
+        write(bytes.data(), gsl::narrow_cast<uint64_t>(bytes.size()));
+    }
+    catch (...) {
+        m_index = index;
+        throw;
+    }
+}
+
+void
+cbor_encoder::encode_text(const char *str)
+{
+    expects(str != nullptr);
+    encode_text(gsl::span<const char>(str, gsl::narrow_cast<std::ptrdiff_t>(strlen(str))));
+}
+
+void
+cbor_encoder::encode_text(gsl::span<const char> str)
+{
+    auto index = m_index;
+
+    try {
+        encode_head(cbor::text_string, gsl::narrow_cast<uint64_t>(str.size()));
+        write(str.data(), gsl::narrow_cast<uint64_t>(str.size()));
+    }
+    catch (...) {
+        m_index = index;
+        throw;
+    }
+}
+
+void
+cbor_encoder::encode_array(uint64_t num)
+{ encode_head(cbor::array, num); }
+
+void
+cbor_encoder::encode_map(uint64_t num)
+{ encode_head(cbor::map, num); }
+
+void
+cbor_encoder::encode_raw(gsl::span<const char> item)
+{ write(item.data(), gsl::narrow_cast<uint64_t>(item.size())); }
+
+void
+cbor_encoder::encode_head(cbor::major_type type, uint64_t val)
+{
+    auto &&head = std::array<char, 9> {};
+    auto &&num = 0ULL;
+
+    if (val < cbor_info_uint8) {
+        head[0] = static_cast<char>((type << 5) | val);
+    }
+    else if (val <= 0xFFULL) {
+        head[0] = static_cast<char>((type << 5) | cbor_info_uint8);
+        num = 1;
+    }
+    else if (val <= 0xFFFFULL) {
+        head[0] = static_cast<char>((type << 5) | cbor_info_uint16);
+        num = 2;
+    }
+    else if (val <= 0xFFFFFFFFULL) {
+        head[0] = static_cast<char>((type << 5) | cbor_info_uint32);
+        num = 4;
+    }
+    else {
+        head[0] = static_cast<char>((type << 5) | cbor_info_uint64);
+        num = 8;
+    }
+
+    for (auto i = 0ULL; i < num; i++) {
+        gsl::at(head, static_cast<std::ptrdiff_t>(1 + i)) = static_cast<char>(val >> ((num - 1 - i) * 8));
+    }
+
+    write(head.data(), num + 1);
+}
+
+void
+cbor_encoder::write(const char *data, uint64_t len)
+{
+    auto &&size = gsl::narrow_cast<uint64_t>(m_buf.size());
+
+    if (len > size - m_index) {
+        throw std::runtime_error("cbor: output buffer too small");
+    }
+
+    if (len != 0) {
+        memcpy(&m_buf[gsl::narrow_cast<std::ptrdiff_t>(m_index)], data, len);
+    }
+
+    m_index += len;
+}
+
+// -----------------------------------------------------------------------------
+// CBOR Decoder
+// -----------------------------------------------------------------------------
+
+cbor_decoder::cbor_decoder(gsl::span<const char> buf) noexcept :
+    m_buf(buf)
+{ }
+
+bool
+cbor_decoder::empty() const noexcept
+{ return m_index >= gsl::narrow_cast<uint64_t>(m_buf.size()); }
+
+cbor::major_type
+cbor_decoder::peek() const
+{
+    auto index = m_index;
+    cbor::major_type type = 0;
+    uint64_t info = 0;
+
+    read_head(index, type, info);
+    return type;
+}
+
+uint64_t
+cbor_decoder::decode_uint()
+{ return decode_head(cbor::unsigned_integer); }
+
+int64_t
+cbor_decoder::decode_int()
+{
+    auto &&type = peek();
+
+    if (type != cbor::unsigned_integer && type != cbor::negative_integer) {
+        throw std::runtime_error("cbor: expected an integer");
+    }
+
+    auto &&val = decode_head(type);
+
+    if (val > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+        throw std::runtime_error("cbor: integer out of range");
+    }
+
+    if (type == cbor::unsigned_integer) {
+        return static_cast<int64_t>(val);
+    }
+
+    return -1 - static_cast<int64_t>(val);
+}
+
+bool
+cbor_decoder::decode_bool()
+{
+    auto index = m_index;
+    cbor::major_type type = 0;
+    uint64_t info = 0;
+
+    read_head(index, type, info);
+
+    if (type != cbor::simple || (info != cbor_simple_false && info != cbor_simple_true)) {
+        throw std::runtime_error("cbor: expected a boolean");
+    }
+
+    m_index = index;
+    return info == cbor_simple_true;
+}
+
+void
+cbor_decoder::decode_null()
+{
+    auto index = m_index;
+    cbor::major_type type = 0;
+    uint64_t info = 0;
+
+    read_head(index, type, info);
+
+    if (type != cbor::simple || info != cbor_simple_null) {
+        throw std::runtime_error("cbor: expected null");
+    }
+
+    m_index = index;
+}
+
+gsl::span<const char>
+cbor_decoder::decode_bytes()
+{
+    auto index = m_index;
+
+    try {
+        return read(decode_head(cbor::byte_string));
+    }
+    catch (...) {
+        m_index = index;
+        throw;
+    }
+}
+
+gsl::span<const char>
+cbor_decoder::decode_text()
+{
+    auto index = m_index;
+
+    try {
+        return read(decode_head(cbor::text_string));
+    }
+    catch (...) {
+        m_index = index;
+        throw;
+    }
+}
+
+uint64_t
+cbor_decoder::decode_array()
+{ return decode_head(cbor::array); }
+
+uint64_t
+cbor_decoder::decode_map()
+{ return decode_head(cbor::map); }
+
+gsl::span<const char>
+cbor_decoder::decode_raw()
+{
+    auto start = m_index;
+    auto &&size = gsl::narrow_cast<uint64_t>(m_buf.size());
+
+    // Nested items are tracked with a count of the items that are still
+    // pending instead of recursion, so a deeply nested item from the
+    // guest cannot exhaust the VMM's stack. Every item takes at least one
+    // byte, so a count that does not fit in what is left is truncated.
+
+    try {
+        auto &&pending = 1ULL;
+
+        while (pending != 0) {
+            cbor::major_type type = 0;
+            uint64_t info = 0;
+            auto &&val = read_head(m_index, type, info);
+
+            pending--;
+
+            switch (type) {
+                case cbor::byte_string:
+                case cbor::text_string:
+                    read(val);
+                    break;
+
+                case cbor::array:
+                    if (val > size - m_index) {
+                        throw std::runtime_error("cbor: truncated input");
+                    }
+                    pending += val;
+                    break;
+
+                case cbor::map:
+                    if (val > (size - m_index) / 2) {
+                        throw std::runtime_error("cbor: truncated input");
+                    }
+                    pending += val * 2;
+                    break;
+
+                case cbor::tag:
+                    pending++;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+    catch (...) {
+        m_index = start;
+        throw;
+    }
+
+    return gsl::span<const char>(&m_buf[gsl::narrow_cast<std::ptrdiff_t>(start)],
+                                 gsl::narrow_cast<std::ptrdiff_t>(m_index - start));
+}
+
+uint64_t
+cbor_decoder::decode_head(cbor::major_type type)
+{
+    auto index = m_index;
+    cbor::major_type actual = 0;
+    uint64_t info = 0;
+    auto &&val = read_head(index, actual, info);
+
+    if (actual != type) {
+        throw std::runtime_error("cbor: unexpected major type");
+    }
+
+    m_index = index;
+    return val;
+}
+
+uint64_t
+cbor_decoder::read_head(uint64_t &index, cbor::major_type &type, uint64_t &info) const
+{
+    auto &&size = gsl::narrow_cast<uint64_t>(m_buf.size());
+
+    if (index >= size) {
+        throw std::runtime_error("cbor: truncated input");
+    }
+
+    auto &&byte = static_cast<uint8_t>(m_buf[gsl::narrow_cast<std::ptrdiff_t>(index++)]);
+
+    type = byte >> 5;
+    info = byte & 0x1FU;
+
+    if (info < cbor_info_uint8) {
+        return info;
+    }
+
+    auto &&num = 0ULL;
+
+    switch (info) {
+        case cbor_info_uint8: num = 1; break;
+        case cbor_info_uint16: num = 2; break;
+        case cbor_info_uint32: num = 4; break;
+        case cbor_info_uint64: num = 8; break;
+
+        default:
+            throw std::runtime_error("cbor: indefinite length items are not supported");
+    }
+
+    if (num > size - index) {
+        throw std::runtime_error("cbor: truncated input");
+    }
+
+    auto &&val = 0ULL;
+
+    for (auto i = 0ULL; i < num; i++) {
+        val = (val << 8) | static_cast<uint8_t>(m_buf[gsl::narrow_cast<std::ptrdiff_t>(index++)]);
+    }
+
+    return val;
+}
+
+gsl::span<const char>
+cbor_decoder::read(uint64_t len)
+{
+    auto &&size = gsl::narrow_cast<uint64_t>(m_buf.size());
+
+    if (len > size - m_index) {
+        throw std::runtime_error("cbor: truncated input");
+    }
+
+    auto &&data = m_buf.data() + m_index;
+    m_index += len;
+
+    return gsl::span<const char>(data, gsl::narrow_cast<std::ptrdiff_t>(len));
+}
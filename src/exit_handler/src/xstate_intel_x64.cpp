@@ -0,0 +1,151 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <bfgsl.h>
+#include <bfbitmanip.h>
+
+#include <exit_handler/xstate_intel_x64.h>
+#include <intrinsics/x86/common_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+constexpr const auto xstate_lazy = 0ULL;
+constexpr const auto xstate_saved = 1ULL;
+
+void
+xstate_intel_x64::set_state_save(gsl::not_null<state_save_intel_x64 *> state_save) noexcept
+{
+    if (m_state_save != nullptr && m_state_save != state_save.get()) {
+        state_save->xstate_flags = m_state_save->xstate_flags;
+        state_save->xstate_area = m_state_save->xstate_area;
+        state_save->xstate_rfbm = m_state_save->xstate_rfbm;
+
+        m_state_save->xstate_flags = clear_bit(m_state_save->xstate_flags, xstate_saved);
+    }
+
+    m_state_save = state_save;
+}
+
+void
+xstate_intel_x64::enable_lazy()
+{
+    expects(m_state_save != nullptr);
+    expects(intel_x64::cr4::osxsave::is_enabled());
+
+    // The #NM handler saves the state, and cannot allocate the area
+
+    this->allocate_area();
+
+    m_state_save->xstate_area = reinterpret_cast<uintptr_t>(m_area);
+    m_state_save->xstate_flags = set_bit(m_state_save->xstate_flags, xstate_lazy);
+
+    intel_x64::vmcs::host_cr0::task_switched::enable();
+}
+
+void
+xstate_intel_x64::disable_lazy()
+{
+    expects(m_state_save != nullptr);
+
+    m_state_save->xstate_flags = clear_bit(m_state_save->xstate_flags, xstate_lazy);
+
+    intel_x64::vmcs::host_cr0::task_switched::disable();
+}
+
+void
+xstate_intel_x64::resync(bool &failed) noexcept
+{
+    namespace host_cr0 = intel_x64::vmcs::host_cr0;
+
+    if (m_state_save == nullptr) {
+        return;
+    }
+
+    auto &&cr0 = host_cr0::get_nothrow(failed);
+
+    if (is_bit_set(m_state_save->xstate_flags, xstate_lazy)) {
+        cr0 = set_bit(cr0, host_cr0::task_switched::from);
+
+        // The #NM handler locates the state save using GS, which still
+        // points to the state save of the exit being handled
+
+        intel_x64::msrs::ia32_gs_base::set(reinterpret_cast<uintptr_t>(m_state_save));
+    }
+    else {
+        cr0 = clear_bit(cr0, host_cr0::task_switched::from);
+    }
+
+    host_cr0::set_nothrow(cr0, failed);
+}
+
+bool
+xstate_intel_x64::is_lazy() const
+{
+    expects(m_state_save != nullptr);
+    return is_bit_set(m_state_save->xstate_flags, xstate_lazy);
+}
+
+void
+xstate_intel_x64::save()
+{
+    expects(m_state_save != nullptr);
+    expects(intel_x64::cr4::osxsave::is_enabled());
+
+    if (is_bit_set(m_state_save->xstate_flags, xstate_saved)) {
+        return;
+    }
+
+    auto &&rfbm = x64::xcr0::get();
+
+    this->allocate_area();
+    x64::xsave::saveopt(m_area, rfbm);
+
+    m_state_save->xstate_area = reinterpret_cast<uintptr_t>(m_area);
+    m_state_save->xstate_rfbm = rfbm;
+    m_state_save->xstate_flags = set_bit(m_state_save->xstate_flags, xstate_saved);
+}
+
+bool
+xstate_intel_x64::is_saved() const
+{
+    expects(m_state_save != nullptr);
+    return is_bit_set(m_state_save->xstate_flags, xstate_saved);
+}
+
+void
+xstate_intel_x64::allocate_area()
+{
+    if (m_area != nullptr) {
+        return;
+    }
+
+    // The area is allocated once, so it is sized for every state component
+    // the CPU supports, and not just the ones enabled in the current XCR0,
+    // as the guest is free to enable more of them later.
+
+    auto &&size = x64::xsave::max_size() + x64::xsave::alignment;
+
+    m_area_buffer = std::make_unique<uint8_t[]>(size);
+
+    auto &&addr = reinterpret_cast<uintptr_t>(m_area_buffer.get());
+    addr = (addr + x64::xsave::alignment - 1) & ~static_cast<uintptr_t>(x64::xsave::alignment - 1);
+
+    m_area = reinterpret_cast<void *>(addr);
+}
@@ -0,0 +1,684 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <exit_handler/event_queue_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#include <map>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace x64;
+using namespace intel_x64;
+
+namespace info = vmcs::vm_entry_interruption_information;
+namespace state = vmcs::guest_interruptibility_state;
+namespace primary = vmcs::primary_processor_based_vm_execution_controls;
+
+static std::map<uint64_t, uint64_t> g_vmcs;
+static std::map<uint32_t, uint64_t> g_msrs;
+static uint64_t g_vmread_count = 0;
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    g_vmread_count++;
+
+    *val = g_vmcs[field];
+    return true;
+}
+
+static bool
+test_vmread_fails(uint64_t field, uint64_t *val) noexcept
+{
+    bfignored(field);
+    bfignored(val);
+
+    return false;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmcs[field] = val;
+    return true;
+}
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_vmcs.clear();
+    g_vmread_count = 0;
+
+    g_vmcs[vmcs::guest_rflags::addr] = rflags::interrupt_enable_flag::mask;
+    g_msrs[intel_x64::msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000UL;
+
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+}
+
+// Simulates a VM entry (which consumes the injected event), and returns
+// the event that was injected (0 if none was)
+
+static auto
+enter()
+{
+    auto interruption_info = g_vmcs[info::addr];
+    g_vmcs[info::addr] = 0;
+
+    return interruption_info;
+}
+
+static auto
+injected(uint64_t vector, uint64_t type)
+{
+    auto interruption_info = info::valid_bit::mask;
+
+    interruption_info = info::vector::set(interruption_info, vector);
+    interruption_info = info::interruption_type::set(interruption_info, type);
+
+    return interruption_info;
+}
+
+static auto
+interrupt_window_exiting()
+{ return is_bit_set(g_vmcs[primary::addr], primary::interrupt_window_exiting::from); }
+
+static auto
+nmi_window_exiting()
+{ return is_bit_set(g_vmcs[primary::addr], primary::nmi_window_exiting::from); }
+
+static auto
+monitor_trap_flag()
+{ return is_bit_set(g_vmcs[primary::addr], primary::monitor_trap_flag::from); }
+
+static pending_event_t
+exception_event(uint64_t vector, uint64_t error_code)
+{ return {vector, info::interruption_type::hardware_exception, error_code, true, 0}; }
+
+TEST_CASE("event_queue: queue_invalid")
+{
+    event_queue_intel_x64 events;
+
+    CHECK_THROWS(events.queue_external_interrupt(256));
+    CHECK_THROWS(events.queue_exception(32));
+    CHECK_THROWS(events.queue_exception(32, 0));
+    CHECK_THROWS(events.queue({0, info::interruption_type::reserved, 0, false, 0}));
+    CHECK_THROWS(events.queue({0, info::interruption_type::other_event, 0, false, 0}));
+    CHECK(events.empty());
+}
+
+TEST_CASE("event_queue: queue_coalesced")
+{
+    event_queue_intel_x64 events;
+
+    events.queue_external_interrupt(0x30);
+    events.queue_external_interrupt(0x30);
+    events.queue_nmi();
+    events.queue_nmi();
+    events.queue_exception(interrupt::general_protection, 0);
+    events.queue_exception(interrupt::general_protection, 0);
+
+    CHECK(events.size() == 4);
+}
+
+TEST_CASE("event_queue: inject_empty")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.inject(failed);
+
+    CHECK_FALSE(failed);
+    CHECK(g_vmread_count == 0);
+    CHECK(enter() == 0);
+}
+
+TEST_CASE("event_queue: inject_priority")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.queue_external_interrupt(0x30);
+    events.queue_external_interrupt(0x80);
+    events.queue_nmi();
+    events.queue_exception(interrupt::invalid_opcode);
+    events.queue_exception(interrupt::divide_error);
+
+    events.inject(failed);
+    CHECK(enter() == injected(interrupt::invalid_opcode, info::interruption_type::hardware_exception));
+
+    events.inject(failed);
+    CHECK(enter() == injected(interrupt::divide_error, info::interruption_type::hardware_exception));
+
+    events.inject(failed);
+    CHECK(enter() == injected(interrupt::nmi_interrupt, info::interruption_type::non_maskable_interrupt));
+
+    events.inject(failed);
+    CHECK(enter() == injected(0x80, info::interruption_type::external_interrupt));
+
+    events.inject(failed);
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+
+    CHECK(events.empty());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: inject_one_per_entry")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.queue_external_interrupt(0x30);
+    events.queue_external_interrupt(0x31);
+
+    events.inject(failed);
+
+    CHECK(events.size() == 1);
+    CHECK(events.interrupt_window_armed());
+    CHECK(interrupt_window_exiting());
+    CHECK(enter() == injected(0x31, info::interruption_type::external_interrupt));
+
+    events.inject(failed);
+
+    CHECK(events.empty());
+    CHECK_FALSE(events.interrupt_window_armed());
+    CHECK_FALSE(interrupt_window_exiting());
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: inject_interrupts_disabled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    g_vmcs[vmcs::guest_rflags::addr] = 0;
+    events.queue_external_interrupt(0x30);
+    events.inject(failed);
+
+    CHECK(enter() == 0);
+    CHECK(interrupt_window_exiting());
+
+    // The window exit re-enters with nothing new to arm / disarm
+
+    g_vmread_count = 0;
+    events.inject(failed);
+
+    CHECK(enter() == 0);
+    CHECK(g_vmread_count == 3);
+
+    g_vmcs[vmcs::guest_rflags::addr] = rflags::interrupt_enable_flag::mask;
+    events.inject(failed);
+
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+    CHECK_FALSE(interrupt_window_exiting());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: inject_blocked_by_sti_and_mov_ss")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.queue_external_interrupt(0x30);
+
+    g_vmcs[state::addr] = state::blocking_by_sti::mask;
+    events.inject(failed);
+    CHECK(enter() == 0);
+
+    g_vmcs[state::addr] = state::blocking_by_mov_ss::mask;
+    events.inject(failed);
+    CHECK(enter() == 0);
+
+    g_vmcs[state::addr] = 0;
+    events.inject(failed);
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+}
+
+TEST_CASE("event_queue: inject_exception_ignores_blocking")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    g_vmcs[vmcs::guest_rflags::addr] = 0;
+    g_vmcs[state::addr] = state::blocking_by_mov_ss::mask;
+
+    events.queue_exception(interrupt::page_fault, 0x2);
+    events.inject(failed);
+
+    auto &&interruption_info = enter();
+
+    CHECK(info::vector::get(interruption_info) == interrupt::page_fault);
+    CHECK(info::deliver_error_code_bit::is_enabled(interruption_info));
+    CHECK(g_vmcs[vmcs::vm_entry_exception_error_code::addr] == 0x2);
+    CHECK_FALSE(interrupt_window_exiting());
+}
+
+TEST_CASE("event_queue: inject_software_exception")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.queue({interrupt::breakpoint, info::interruption_type::software_exception, 0, false, 1});
+    events.inject(failed);
+
+    CHECK(enter() == injected(interrupt::breakpoint, info::interruption_type::software_exception));
+    CHECK(g_vmcs[vmcs::vm_entry_instruction_length::addr] == 1);
+    CHECK(g_vmcs.count(vmcs::vm_entry_exception_error_code::addr) == 0);
+}
+
+TEST_CASE("event_queue: inject_nmi_blocked_virtual_nmis")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    g_vmcs[vmcs::pin_based_vm_execution_controls::addr] =
+        vmcs::pin_based_vm_execution_controls::virtual_nmis::mask;
+    g_vmcs[state::addr] = state::blocking_by_nmi::mask;
+
+    events.queue_nmi();
+    events.queue_external_interrupt(0x30);
+    events.inject(failed);
+
+    // The interrupt is not blocked, so it is injected ahead of the NMI
+
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+    CHECK(events.nmi_window_armed());
+    CHECK(nmi_window_exiting());
+    CHECK_FALSE(interrupt_window_exiting());
+
+    g_vmcs[state::addr] = 0;
+    events.inject(failed);
+
+    CHECK(enter() == injected(interrupt::nmi_interrupt, info::interruption_type::non_maskable_interrupt));
+    CHECK_FALSE(nmi_window_exiting());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: inject_nmi_blocked_no_virtual_nmis")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    g_vmcs[state::addr] = state::blocking_by_nmi::mask;
+
+    events.queue_nmi();
+    events.inject(failed);
+
+    CHECK(enter() == 0);
+    CHECK_FALSE(events.nmi_window_armed());
+    CHECK_FALSE(nmi_window_exiting());
+    CHECK(interrupt_window_exiting());
+}
+
+TEST_CASE("event_queue: inject_already_injected")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    auto &&other = injected(interrupt::general_protection, info::interruption_type::hardware_exception);
+    g_vmcs[info::addr] = other;
+
+    events.queue_exception(interrupt::invalid_opcode);
+    events.inject(failed);
+
+    CHECK(enter() == other);
+    CHECK(events.size() == 1);
+    CHECK(events.mtf_armed());
+    CHECK(monitor_trap_flag());
+    CHECK_FALSE(interrupt_window_exiting());
+}
+
+TEST_CASE("event_queue: inject_exceptions_interrupts_disabled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    // The guest takes the first exception with interrupts disabled, so the
+    // second one must not wait for the interrupt window
+
+    g_vmcs[vmcs::guest_rflags::addr] = 0;
+
+    events.queue_exception(interrupt::general_protection, 0);
+    events.queue_exception(interrupt::invalid_opcode);
+    events.inject(failed);
+
+    CHECK(info::vector::get(enter()) == interrupt::general_protection);
+    CHECK(events.mtf_armed());
+    CHECK(monitor_trap_flag());
+    CHECK_FALSE(interrupt_window_exiting());
+
+    events.inject(failed);
+
+    CHECK(enter() == injected(interrupt::invalid_opcode, info::interruption_type::hardware_exception));
+    CHECK(events.empty());
+    CHECK_FALSE(events.mtf_armed());
+    CHECK_FALSE(monitor_trap_flag());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: inject_exceptions_no_monitor_trap_flag")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    g_msrs[intel_x64::msrs::ia32_vmx_true_procbased_ctls::addr] = 0;
+
+    events.queue_exception(interrupt::general_protection, 0);
+    events.queue_exception(interrupt::invalid_opcode);
+    events.inject(failed);
+
+    CHECK(info::vector::get(enter()) == interrupt::general_protection);
+    CHECK_FALSE(events.mtf_armed());
+    CHECK_FALSE(monitor_trap_flag());
+    CHECK(interrupt_window_exiting());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: requeue_injected_first")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.queue_exception(interrupt::invalid_opcode);
+    events.queue_nmi();
+    events.requeue({0x30, info::interruption_type::external_interrupt, 0, false, 0});
+
+    CHECK(events.size() == 3);
+
+    events.inject(failed);
+
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+    CHECK(events.size() == 2);
+    CHECK(events.mtf_armed());
+
+    events.inject(failed);
+    CHECK(enter() == injected(interrupt::invalid_opcode, info::interruption_type::hardware_exception));
+
+    events.inject(failed);
+    CHECK(enter() == injected(interrupt::nmi_interrupt, info::interruption_type::non_maskable_interrupt));
+
+    CHECK(events.empty());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: requeue_ignores_blocking")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    // The delivery of the interrupt had already started, so the guest
+    // state that would block it does not apply
+
+    g_vmcs[vmcs::guest_rflags::addr] = 0;
+    g_vmcs[state::addr] = state::blocking_by_sti::mask | state::blocking_by_nmi::mask;
+
+    events.requeue({0x30, info::interruption_type::external_interrupt, 0, false, 0});
+    events.inject(failed);
+
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+    CHECK(events.empty());
+    CHECK_FALSE(interrupt_window_exiting());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: requeue_error_code_and_instruction_length")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.requeue({interrupt::page_fault, info::interruption_type::hardware_exception, 0x2, true, 0});
+    events.inject(failed);
+
+    auto &&page_fault = injected(interrupt::page_fault, info::interruption_type::hardware_exception);
+    CHECK(enter() == (page_fault | info::deliver_error_code_bit::mask));
+    CHECK(g_vmcs[vmcs::vm_entry_exception_error_code::addr] == 0x2);
+
+    events.requeue({0x80, info::interruption_type::software_interrupt, 0, false, 2});
+    events.inject(failed);
+
+    CHECK(enter() == injected(0x80, info::interruption_type::software_interrupt));
+    CHECK(g_vmcs[vmcs::vm_entry_instruction_length::addr] == 2);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: requeue_already_injected")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    auto &&other = injected(interrupt::invalid_opcode, info::interruption_type::hardware_exception);
+    g_vmcs[info::addr] = other;
+
+    events.requeue({0x30, info::interruption_type::external_interrupt, 0, false, 0});
+    events.inject(failed);
+
+    CHECK(enter() == other);
+    CHECK(events.size() == 1);
+    CHECK(events.mtf_armed());
+
+    // The injected #UD is interrupted as well, and is delivered first
+
+    events.requeue({interrupt::invalid_opcode, info::interruption_type::hardware_exception, 0, false, 0});
+    events.inject(failed);
+
+    CHECK(enter() == other);
+    CHECK(events.size() == 1);
+
+    g_vmcs[vmcs::guest_rflags::addr] = rflags::interrupt_enable_flag::mask;
+
+    events.inject(failed);
+
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+    CHECK(events.empty());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: nested_exception_without_interrupted_event")
+{
+    event_queue_intel_x64 events;
+
+    events.queue_nested_exception(exception_event(interrupt::page_fault, 0x2));
+    CHECK(events.size() == 1);
+}
+
+TEST_CASE("event_queue: nested_exception_double_fault")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    auto &&double_fault = injected(interrupt::double_fault, info::interruption_type::hardware_exception) |
+                          info::deliver_error_code_bit::mask;
+
+    events.requeue(exception_event(interrupt::page_fault, 0x2));
+    events.queue_nested_exception(exception_event(interrupt::page_fault, 0x3));
+
+    CHECK(events.size() == 1);
+
+    events.inject(failed);
+
+    CHECK(enter() == double_fault);
+    CHECK(g_vmcs[vmcs::vm_entry_exception_error_code::addr] == 0);
+
+    events.requeue(exception_event(interrupt::general_protection, 0));
+    events.queue_nested_exception(exception_event(interrupt::segment_not_present, 0));
+    events.inject(failed);
+
+    CHECK(enter() == double_fault);
+
+    events.requeue(exception_event(interrupt::page_fault, 0x2));
+    events.queue_nested_exception(exception_event(interrupt::general_protection, 0));
+    events.inject(failed);
+
+    CHECK(enter() == double_fault);
+    CHECK(events.empty());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: nested_exception_triple_fault")
+{
+    event_queue_intel_x64 events;
+
+    events.requeue(exception_event(interrupt::double_fault, 0));
+    CHECK_THROWS(events.queue_nested_exception(exception_event(interrupt::page_fault, 0)));
+}
+
+TEST_CASE("event_queue: nested_exception_serial")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    // A #PF during the delivery of a #GP is handled serially (only the
+    // other way around is a #DF), and the guest raises the #GP again when
+    // it retries the instruction
+
+    events.requeue(exception_event(interrupt::general_protection, 0));
+    events.queue_nested_exception(exception_event(interrupt::page_fault, 0x2));
+
+    CHECK(events.size() == 1);
+
+    events.inject(failed);
+    CHECK(info::vector::get(enter()) == interrupt::page_fault);
+
+    events.requeue({0x80, info::interruption_type::software_interrupt, 0, false, 2});
+    events.queue_nested_exception(exception_event(interrupt::page_fault, 0x2));
+
+    CHECK(events.size() == 1);
+
+    events.inject(failed);
+    CHECK(info::vector::get(enter()) == interrupt::page_fault);
+
+    CHECK(events.empty());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: nested_exception_keeps_interrupt")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.requeue({0x30, info::interruption_type::external_interrupt, 0, false, 0});
+    events.queue_nested_exception(exception_event(interrupt::page_fault, 0x2));
+
+    CHECK(events.size() == 2);
+
+    events.inject(failed);
+    CHECK(info::vector::get(enter()) == interrupt::page_fault);
+
+    events.inject(failed);
+    CHECK(enter() == injected(0x30, info::interruption_type::external_interrupt));
+
+    events.requeue({interrupt::nmi_interrupt, info::interruption_type::non_maskable_interrupt, 0, false, 0});
+    events.queue_nested_exception(exception_event(interrupt::general_protection, 0));
+
+    events.inject(failed);
+    CHECK(info::vector::get(enter()) == interrupt::general_protection);
+
+    events.inject(failed);
+    CHECK(enter() == injected(interrupt::nmi_interrupt, info::interruption_type::non_maskable_interrupt));
+
+    CHECK(events.empty());
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("event_queue: inject_vmread_fails")
+{
+    MockRepository mocks;
+    mocks.OnCallFunc(_vmread).Do(test_vmread_fails);
+
+    event_queue_intel_x64 events;
+    auto failed = false;
+
+    events.queue_external_interrupt(0x30);
+    events.inject(failed);
+
+    CHECK(failed);
+    CHECK(events.size() == 1);
+}
+
+#endif
@@ -0,0 +1,267 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <exit_handler/exception_intercept_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#include <map>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace x64;
+using namespace intel_x64;
+
+static std::map<uint64_t, uint64_t> g_vmcs;
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmcs[field] = val;
+    return true;
+}
+
+static bool
+test_vmwrite_fails(uint64_t field, uint64_t val) noexcept
+{
+    bfignored(field);
+    bfignored(val);
+
+    return false;
+}
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_vmcs.clear();
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+}
+
+static auto
+bitmap()
+{ return g_vmcs[vmcs::exception_bitmap::addr]; }
+
+static auto
+pfec_mask()
+{ return g_vmcs[vmcs::page_fault_error_code_mask::addr]; }
+
+static auto
+pfec_match()
+{ return g_vmcs[vmcs::page_fault_error_code_match::addr]; }
+
+static auto
+make_info(uint64_t vector, uint64_t error_code = 0)
+{
+    exception_info_t info{};
+
+    info.vector = vector;
+    info.error_code = error_code;
+
+    return info;
+}
+
+constexpr const auto pfec_present = 0x1ULL;
+constexpr const auto pfec_write = 0x2ULL;
+constexpr const auto pfec_user = 0x4ULL;
+constexpr const auto pfec_fetch = 0x10ULL;
+
+TEST_CASE("exception_intercept: empty")
+{
+    exception_intercept_intel_x64 exceptions;
+
+    CHECK(exceptions.exception_bitmap() == 0);
+    CHECK(exceptions.page_fault_error_code_mask() == 0);
+    CHECK(exceptions.page_fault_error_code_match() == 0);
+    CHECK_FALSE(exceptions.dispatch(make_info(interrupt::breakpoint)));
+}
+
+TEST_CASE("exception_intercept: subscribe_invalid")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    exception_intercept_intel_x64 exceptions;
+
+    CHECK_THROWS(exceptions.subscribe(32, [](auto) { return true; }));
+    CHECK_THROWS(exceptions.subscribe(interrupt::breakpoint, nullptr));
+    CHECK_THROWS(exceptions.subscribe_page_fault(pfec_write, pfec_user, [](auto) { return true; }));
+}
+
+TEST_CASE("exception_intercept: subscribe_vector")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    exception_intercept_intel_x64 exceptions;
+
+    exceptions.subscribe(interrupt::breakpoint, [](auto) { return true; });
+    exceptions.subscribe(interrupt::invalid_opcode, [](auto) { return true; });
+
+    CHECK(bitmap() == ((1ULL << interrupt::breakpoint) | (1ULL << interrupt::invalid_opcode)));
+    CHECK(pfec_mask() == 0);
+    CHECK(pfec_match() == 0);
+    CHECK(exceptions.exception_bitmap() == bitmap());
+}
+
+TEST_CASE("exception_intercept: subscribe_vmwrite_fails")
+{
+    MockRepository mocks;
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite_fails);
+
+    exception_intercept_intel_x64 exceptions;
+
+    auto called = false;
+
+    CHECK_THROWS(exceptions.subscribe(interrupt::breakpoint, [&](auto) { return called = true; }));
+    CHECK_FALSE(exceptions.dispatch(make_info(interrupt::breakpoint)));
+    CHECK_FALSE(called);
+}
+
+TEST_CASE("exception_intercept: unsubscribe")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    exception_intercept_intel_x64 exceptions;
+
+    auto &&id1 = exceptions.subscribe(interrupt::breakpoint, [](auto) { return true; });
+    auto &&id2 = exceptions.subscribe(interrupt::breakpoint, [](auto) { return true; });
+
+    exceptions.unsubscribe(id1);
+    CHECK(bitmap() == (1ULL << interrupt::breakpoint));
+
+    exceptions.unsubscribe(id2);
+    CHECK(bitmap() == 0);
+
+    CHECK_NOTHROW(exceptions.unsubscribe(id2));
+}
+
+TEST_CASE("exception_intercept: page_fault_single_pattern")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    exception_intercept_intel_x64 exceptions;
+
+    exceptions.subscribe_page_fault(pfec_present | pfec_write, pfec_present | pfec_write, [](auto) { return true; });
+
+    CHECK(bitmap() == (1ULL << interrupt::page_fault));
+    CHECK(pfec_mask() == (pfec_present | pfec_write));
+    CHECK(pfec_match() == (pfec_present | pfec_write));
+}
+
+TEST_CASE("exception_intercept: page_fault_combined_patterns")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    exception_intercept_intel_x64 exceptions;
+
+    // Both want present faults, but only agree on the present bit
+
+    exceptions.subscribe_page_fault(pfec_present | pfec_write, pfec_present | pfec_write, [](auto) { return true; });
+    exceptions.subscribe_page_fault(pfec_present | pfec_fetch, pfec_present | pfec_fetch, [](auto) { return true; });
+
+    CHECK(pfec_mask() == pfec_present);
+    CHECK(pfec_match() == pfec_present);
+
+    // Disagreeing on the write bit removes it from the combined pattern
+
+    exceptions.subscribe_page_fault(pfec_present | pfec_write, pfec_present, [](auto) { return true; });
+
+    CHECK(pfec_mask() == pfec_present);
+    CHECK(pfec_match() == pfec_present);
+
+    // A subscriber that wants every #PF wins
+
+    auto &&id = exceptions.subscribe(interrupt::page_fault, [](auto) { return true; });
+
+    CHECK(pfec_mask() == 0);
+    CHECK(pfec_match() == 0);
+
+    exceptions.unsubscribe(id);
+
+    CHECK(pfec_mask() == pfec_present);
+    CHECK(pfec_match() == pfec_present);
+}
+
+TEST_CASE("exception_intercept: dispatch_vector")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    exception_intercept_intel_x64 exceptions;
+
+    auto &&calls = 0;
+
+    exceptions.subscribe(interrupt::breakpoint, [&](auto) { calls++; return false; });
+    exceptions.subscribe(interrupt::breakpoint, [&](auto) { calls++; return true; });
+    exceptions.subscribe(interrupt::breakpoint, [&](auto) { calls++; return true; });
+
+    CHECK(exceptions.dispatch(make_info(interrupt::breakpoint)));
+    CHECK(calls == 2);
+
+    CHECK_FALSE(exceptions.dispatch(make_info(interrupt::invalid_opcode)));
+    CHECK(calls == 2);
+}
+
+TEST_CASE("exception_intercept: dispatch_page_fault_filters")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    exception_intercept_intel_x64 exceptions;
+
+    auto &&writes = 0;
+    auto &&fetches = 0;
+
+    exceptions.subscribe_page_fault(pfec_present | pfec_write, pfec_present | pfec_write, [&](auto) { writes++; return true; });
+    exceptions.subscribe_page_fault(pfec_present | pfec_fetch, pfec_present | pfec_fetch, [&](auto) { fetches++; return true; });
+
+    CHECK(exceptions.dispatch(make_info(interrupt::page_fault, pfec_present | pfec_write)));
+    CHECK(exceptions.dispatch(make_info(interrupt::page_fault, pfec_present | pfec_fetch | pfec_user)));
+    CHECK_FALSE(exceptions.dispatch(make_info(interrupt::page_fault, pfec_present)));
+
+    CHECK(writes == 1);
+    CHECK(fetches == 1);
+}
+
+TEST_CASE("exception_intercept: dispatch_unsubscribe_in_handler")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    exception_intercept_intel_x64 exceptions;
+    exception_intercept_intel_x64::id_type id = 0;
+
+    id = exceptions.subscribe(interrupt::breakpoint, [&](auto) {
+        exceptions.unsubscribe(id);
+        return true;
+    });
+
+    CHECK(exceptions.dispatch(make_info(interrupt::breakpoint)));
+    CHECK_FALSE(exceptions.dispatch(make_info(interrupt::breakpoint)));
+    CHECK(bitmap() == 0);
+}
+
+#endif
@@ -22,6 +22,8 @@
 #include <catch/catch.hpp>
 #include <hippomocks.h>
 
+#include <bfbenchmark.h>
+
 #include <vmcs/vmcs_intel_x64.h>
 #include <intrinsics/x86/common_x64.h>
 #include <intrinsics/x86/intel_x64.h>
@@ -44,6 +46,12 @@ vmcs::value_type g_exit_reason = 0;
 vmcs::value_type g_exit_qualification = 0;
 vmcs::value_type g_exit_instruction_length = 8;
 vmcs::value_type g_exit_instruction_information = 0;
+vmcs::value_type g_exit_interruption_information = 0;
+vmcs::value_type g_exit_interruption_error_code = 0;
+vmcs::value_type g_exit_idt_vectoring_information = 0;
+vmcs::value_type g_exit_idt_vectoring_error_code = 0;
+vmcs::value_type g_vpid = 0;
+vmcs::value_type g_guest_physical_address = 0;
 
 constexpr static int g_map_size = 100;
 static char g_map[g_map_size];
@@ -51,6 +59,16 @@ static auto g_msg = std::string(R"%({"msg":"hello world"})%");
 static std::map<intel_x64::msrs::field_type, intel_x64::msrs::value_type> g_msrs;
 static state_save_intel_x64 g_state_save{};
 static uintptr_t g_rip = 0;
+static uint64_t g_vmread_count = 0;
+static std::map<vmcs::field_type, uint64_t> g_vmwrite_count;
+static std::map<vmcs::field_type, uint64_t> g_vmwrite_value;
+static std::map<vmcs::field_type, uint64_t> g_vmread_value;
+static uint64_t g_invvpid_count = 0;
+static uint64_t g_invvpid_type = 0;
+static uint64_t g_invvpid_vpid = 0;
+static uint64_t g_invept_count = 0;
+
+alignas(0x1000) static char g_ring_page[0x1000];
 
 static void
 test_vmcs_check_all()
@@ -59,6 +77,14 @@ test_vmcs_check_all()
 static bool
 test_vmread(uint64_t field, uint64_t *val) noexcept
 {
+    g_vmread_count++;
+
+    auto &&iter = g_vmread_value.find(field);
+    if (iter != g_vmread_value.end()) {
+        *val = iter->second;
+        return true;
+    }
+
     switch (field) {
         case vmcs::exit_reason::addr:
             *val = g_exit_reason;
@@ -72,11 +98,32 @@ test_vmread(uint64_t field, uint64_t *val) noexcept
         case vmcs::vm_exit_instruction_information::addr:
             *val = g_exit_instruction_information;
             break;
+        case vmcs::vm_exit_interruption_information::addr:
+            *val = g_exit_interruption_information;
+            break;
+        case vmcs::vm_exit_interruption_error_code::addr:
+            *val = g_exit_interruption_error_code;
+            break;
+        case vmcs::idt_vectoring_information::addr:
+            *val = g_exit_idt_vectoring_information;
+            break;
+        case vmcs::idt_vectoring_error_code::addr:
+            *val = g_exit_idt_vectoring_error_code;
+            break;
+        case vmcs::guest_interruptibility_state::addr:
+            *val = 0x0;
+            break;
+        case vmcs::vm_entry_interruption_information::addr:
+            *val = 0x0;
+            break;
         case vmcs::guest_linear_address::addr:
             *val = 0x0;
             break;
         case vmcs::guest_physical_address::addr:
-            *val = 0x0;
+            *val = g_guest_physical_address;
+            break;
+        case vmcs::virtual_processor_identifier::addr:
+            *val = g_vpid;
             break;
         default:
             g_field = field;
@@ -90,6 +137,9 @@ test_vmread(uint64_t field, uint64_t *val) noexcept
 static  bool
 test_vmwrite(uint64_t field, uint64_t val) noexcept
 {
+    g_vmwrite_count[field]++;
+    g_vmwrite_value[field] = val;
+
     g_field = field;
     g_value = val;
 
@@ -132,6 +182,26 @@ static void
 test_invlpg(const void *addr) noexcept
 { bfignored(addr); }
 
+static bool
+test_invvpid(uint64_t type, void *ptr) noexcept
+{
+    g_invvpid_count++;
+    g_invvpid_type = type;
+    g_invvpid_vpid = static_cast<uint64_t *>(ptr)[0];
+
+    return true;
+}
+
+static bool
+test_invept(uint64_t type, void *ptr) noexcept
+{
+    bfignored(type);
+    bfignored(ptr);
+
+    g_invept_count++;
+    return true;
+}
+
 static void
 setup_intrinsics(MockRepository &mocks)
 {
@@ -144,6 +214,8 @@ setup_intrinsics(MockRepository &mocks)
     mocks.OnCallFunc(_cpuid_eax).Do(test_cpuid_eax);
     mocks.OnCallFunc(_cpuid).Do(test_cpuid);
     mocks.OnCallFunc(_invlpg).Do(test_invlpg);
+    mocks.OnCallFunc(_invvpid).Do(test_invvpid);
+    mocks.OnCallFunc(_invept).Do(test_invept);
 }
 
 auto
@@ -207,6 +279,7 @@ setup_ehlr(gsl::not_null<vmcs_intel_x64 *> vmcs)
     auto ehlr = exit_handler_intel_x64{};
     ehlr.set_vmcs(vmcs);
     ehlr.set_state_save(&g_state_save);
+    ehlr.invalidate_exit_info();
 
     g_rip = ehlr.m_state_save->rip + g_exit_instruction_length;
     return ehlr;
@@ -1127,6 +1200,133 @@ TEST_CASE("exit_handler: vm_exit_reason_vmcall_data_data_unformatted_success")
     CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
 }
 
+TEST_CASE("exit_handler: vm_exit_reason_vmcall_data_binary_cbor_success")
+{
+    bool map_success = true;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks, map_success);
+    setup_pt(mocks);
+
+    cbor_encoder encoder(gsl::span<char>(static_cast<char *>(g_map), g_map_size));
+    encoder.encode_map(1);
+    encoder.encode_text("msg");
+    encoder.encode_text("hello world");
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rsi = VMCALL_DATA_BINARY_CBOR;            // r04
+    ehlr.m_state_save->r08 = reinterpret_cast<uint64_t>(g_map);  // r05
+    ehlr.m_state_save->r09 = encoder.size();                     // r06
+    ehlr.m_state_save->r11 = reinterpret_cast<uint64_t>(g_map);  // r08
+    ehlr.m_state_save->r12 = g_map_size;                         // r09
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK(ehlr.m_state_save->r10 == VMCALL_DATA_BINARY_CBOR);
+    CHECK(ehlr.m_state_save->r12 == encoder.size());
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_vmcall_data_binary_cbor_malformed")
+{
+    bool map_success = true;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks, map_success);
+    setup_pt(mocks);
+
+    g_map[0] = static_cast<char>(0x7F);
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rsi = VMCALL_DATA_BINARY_CBOR;            // r04
+    ehlr.m_state_save->r08 = reinterpret_cast<uint64_t>(g_map);  // r05
+    ehlr.m_state_save->r09 = 1;                                  // r06
+    ehlr.m_state_save->r11 = reinterpret_cast<uint64_t>(g_map);  // r08
+    ehlr.m_state_save->r12 = g_map_size;                         // r09
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+class exit_handler_span_ut : public exit_handler_intel_x64
+{
+public:
+
+    uint64_t handle_vmcall_data_binary_unformatted_raw(
+        gsl::span<const char> ispan, gsl::span<char> ospan) override
+    {
+        m_ispan = ispan.data();
+        m_ospan = ospan.data();
+
+        ospan.at(0) = 'X';
+        return 1;
+    }
+
+    const char *m_ispan{nullptr};
+    const char *m_ospan{nullptr};
+};
+
+TEST_CASE("exit_handler: vm_exit_reason_vmcall_data_binary_unformatted_in_place")
+{
+    bool map_success = true;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    setup_mm(mocks, map_success);
+    setup_pt(mocks);
+
+    exit_handler_span_ut ehlr;
+    ehlr.set_vmcs(vmcs);
+    ehlr.set_state_save(&g_state_save);
+    ehlr.invalidate_exit_info();
+
+    g_rip = ehlr.m_state_save->rip + g_exit_instruction_length;
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rsi = VMCALL_DATA_BINARY_UNFORMATTED;     // r04
+    ehlr.m_state_save->r08 = reinterpret_cast<uint64_t>(g_map);  // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = reinterpret_cast<uint64_t>(g_map);  // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+
+    memcpy(static_cast<char *>(g_map), g_msg.data(), g_msg.size());
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK(ehlr.m_state_save->r10 == VMCALL_DATA_BINARY_UNFORMATTED);
+    CHECK(ehlr.m_state_save->r12 == 1);
+
+    CHECK(ehlr.m_ispan == static_cast<char *>(g_map));
+    CHECK(ehlr.m_ospan == static_cast<char *>(g_map));
+    CHECK(g_map[0] == 'X');
+}
+
+TEST_CASE("exit_handler: reply_with_string_output_too_small")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    char buf[4] = {};
+
+    CHECK_THROWS(ehlr.reply_with_string("hello world", gsl::span<char>(buf, 4)));
+    CHECK(ehlr.reply_with_string("hey", gsl::span<char>(buf, 4)) == 3);
+    CHECK(std::string(buf, 3) == "hey");
+}
+
 TEST_CASE("exit_handler: vm_exit_reason_vmcall_data_unknown_type")
 {
     bool map_success = true;
@@ -1559,6 +1759,58 @@ TEST_CASE("exit_handler: vm_exit_reason_wrmsr_default")
     CHECK(ehlr.m_state_save->rip == g_rip);
 }
 
+TEST_CASE("exit_handler: vm_exit_reason_rdmsr_msr_area")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::rdmsr);
+    auto ehlr = setup_ehlr(vmcs);
+
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x1000);
+
+    vmcs_intel_x64_msr_area area;
+    area.add(x64::msrs::ia32_lstar::addr, 0x0000000A00000009, 0x1234);
+    ehlr.set_msr_area(&area);
+
+    g_msrs[x64::msrs::ia32_lstar::addr] = 0x1234;
+    ehlr.m_state_save->rcx = x64::msrs::ia32_lstar::addr;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+
+    CHECK(ehlr.m_state_save->rax == 0x9);
+    CHECK(ehlr.m_state_save->rdx == 0xA);
+    CHECK(ehlr.m_state_save->rip == g_rip);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_wrmsr_msr_area")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::wrmsr);
+    auto ehlr = setup_ehlr(vmcs);
+
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x1000);
+
+    vmcs_intel_x64_msr_area area;
+    area.add(x64::msrs::ia32_lstar::addr, 0, 0x1234);
+    ehlr.set_msr_area(&area);
+
+    g_msrs[x64::msrs::ia32_lstar::addr] = 0x1234;
+    ehlr.m_state_save->rcx = x64::msrs::ia32_lstar::addr;
+    ehlr.m_state_save->rax = 0x9;
+    ehlr.m_state_save->rdx = 0xA;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(area.guest_value(x64::msrs::ia32_lstar::addr) == 0x0000000A00000009);
+    CHECK(area.host_value(x64::msrs::ia32_lstar::addr) == 0x1234);
+    CHECK(g_msrs[x64::msrs::ia32_lstar::addr] == 0x1234);
+    CHECK(ehlr.m_state_save->rip == g_rip);
+}
+
 TEST_CASE("exit_handler: vm_exit_failure_check")
 {
     MockRepository mocks;
@@ -1571,14 +1823,1643 @@ TEST_CASE("exit_handler: vm_exit_failure_check")
     CHECK_NOTHROW(ehlr.dispatch());
 }
 
-TEST_CASE("exit_handler: halt")
+TEST_CASE("exit_handler: exit_info_cached")
 {
     MockRepository mocks;
     setup_intrinsics(mocks);
-    auto vmcs = setup_vmcs_halt(mocks, exit_reason::basic_exit_reason::xrstors);
+    auto vmcs = mocks.Mock<vmcs_intel_x64>();
     auto ehlr = setup_ehlr(vmcs);
 
-    CHECK_NOTHROW(ehlr.halt());
+    g_vmread_count = 0;
+    g_exit_qualification = 42;
+
+    CHECK(ehlr.vm_exit_qualification() == 42);
+    CHECK(ehlr.vm_exit_qualification() == 42);
+    CHECK(ehlr.vm_exit_instruction_length() == g_exit_instruction_length);
+    CHECK(ehlr.vm_exit_instruction_length() == g_exit_instruction_length);
+    CHECK(g_vmread_count == 2);
+
+    ehlr.invalidate_exit_info();
+
+    CHECK(ehlr.vm_exit_qualification() == 42);
+    CHECK(g_vmread_count == 3);
+}
+
+TEST_CASE("exit_handler: exit_info_vmread_count")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::cpuid);
+    auto ehlr = setup_ehlr(vmcs);
+
+    // The entry point has already cached the exit reason, so the only
+    // field left to read for a CPUID exit is the instruction length.
+    // Without the cache, this exit would vmread the exit reason again.
+
+    ehlr.m_state_save->exit_info[0] = exit_reason::basic_exit_reason::cpuid;
+    ehlr.m_state_save->exit_info_valid = 1;
+
+    g_vmread_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_vmread_count == 1);
+    CHECK(ehlr.m_state_save->exit_info_valid == 0);
+}
+
+TEST_CASE("exit_handler: wrmsr_written_once_at_resume")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::wrmsr);
+    auto ehlr = setup_ehlr(vmcs);
+
+    g_vmwrite_count.clear();
+
+    ehlr.m_state_save->rcx = intel_x64::msrs::ia32_efer::addr;
+    ehlr.m_state_save->rax = 0x1;
+    ehlr.m_state_save->rdx = 0x0;
+
+    ehlr.m_guest_shadow.set(vmcs::guest_ia32_efer::addr, 0x42, ehlr.m_vmcs_failed);
+    CHECK(g_vmwrite_count[vmcs::guest_ia32_efer::addr] == 0);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+
+    for (const auto &count : g_vmwrite_count) {
+        CHECK(count.second <= 1);
+    }
+
+    CHECK(g_vmwrite_count[vmcs::guest_ia32_efer::addr] == 1);
+    CHECK(g_field == vmcs::guest_ia32_efer::addr);
+    CHECK(g_value == 0x1);
+}
+
+static auto
+setup_mm_ring(MockRepository &mocks)
+{
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::alloc_map).Return(static_cast<char *>(g_ring_page));
+    mocks.OnCall(mm, memory_manager_x64::free_map);
+
+    return mm;
+}
+
+static void
+vmcall_ring(exit_handler_intel_x64 &ehlr, uint64_t op, uint64_t arg = 0)
+{
+    ehlr.m_state_save->rax = VMCALL_RING;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = op;
+    ehlr.m_state_save->rbx = arg;
+
+    ehlr.dispatch();
+}
+
+static auto
+vmcall_ring_submit(uint64_t opcode, uint64_t r02)
+{
+    auto &&ring = reinterpret_cast<vmcall_ring_t *>(g_ring_page);
+    auto &&entry = gsl::at(ring->entries, ring->tail % VMCALL_RING_SIZE);
+
+    entry.opcode = opcode;
+    entry.ret = 0;
+    entry.regs = {};
+    entry.regs.r02 = r02;
+
+    ring->tail++;
+    return &entry;
+}
+
+TEST_CASE("exit_handler: vmcall_ring_register")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_mm_ring(mocks);
+    setup_pt(mocks);
+
+    auto &&ring = reinterpret_cast<vmcall_ring_t *>(g_ring_page);
+    ring->head = 0xBEEF;
+    ring->tail = 0xBEEF;
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_REGISTER, reinterpret_cast<uintptr_t>(g_ring_page)));
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK(ehlr.m_vmcall_ring.get() == ring);
+    CHECK(ring->head == 0);
+    CHECK(ring->tail == 0);
+    CHECK(ring->size == VMCALL_RING_SIZE);
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_UNREGISTER));
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK_FALSE(ehlr.m_vmcall_ring);
+}
+
+TEST_CASE("exit_handler: vmcall_ring_register_unaligned")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_REGISTER, 0x1234));
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    CHECK_FALSE(ehlr.m_vmcall_ring);
+}
+
+TEST_CASE("exit_handler: vmcall_ring_unknown_operation")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, 0xBEEF));
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+TEST_CASE("exit_handler: vmcall_ring_doorbell_not_registered")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_DOORBELL));
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+TEST_CASE("exit_handler: vmcall_ring_doorbell")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_mm_ring(mocks);
+    setup_pt(mocks);
+
+    auto &&ring = reinterpret_cast<vmcall_ring_t *>(g_ring_page);
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_REGISTER, reinterpret_cast<uintptr_t>(g_ring_page)));
+
+    auto &&entry1 = vmcall_ring_submit(VMCALL_VERSIONS, VMCALL_VERSION_PROTOCOL);
+    auto &&entry2 = vmcall_ring_submit(VMCALL_RING, VMCALL_RING_DOORBELL);
+    auto &&entry3 = vmcall_ring_submit(VMCALL_VERSIONS, VMCALL_VERSION_PROTOCOL);
+
+    g_rip = ehlr.m_state_save->rip + g_exit_instruction_length;
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_DOORBELL));
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK(ehlr.m_state_save->rbx == 3);
+
+    CHECK(ring->head == 3);
+    CHECK(entry1->ret == BF_VMCALL_SUCCESS);
+    CHECK(entry1->regs.r03 == VMCALL_VERSION);
+    CHECK(entry2->ret == BF_VMCALL_FAILURE);
+    CHECK(entry3->ret == BF_VMCALL_SUCCESS);
+    CHECK(entry3->regs.r03 == VMCALL_VERSION);
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_DOORBELL));
+    CHECK(ehlr.m_state_save->rbx == 0);
+}
+
+TEST_CASE("exit_handler: vmcall_ring_doorbell_wraps")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_mm_ring(mocks);
+    setup_pt(mocks);
+
+    auto &&ring = reinterpret_cast<vmcall_ring_t *>(g_ring_page);
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_REGISTER, reinterpret_cast<uintptr_t>(g_ring_page)));
+
+    for (auto i = 0U; i < 3; i++) {
+        for (auto j = 0U; j < VMCALL_RING_SIZE; j++) {
+            vmcall_ring_submit(VMCALL_VERSIONS, VMCALL_VERSION_PROTOCOL);
+        }
+
+        CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_DOORBELL));
+        CHECK(ehlr.m_state_save->rbx == VMCALL_RING_SIZE);
+    }
+
+    CHECK(ring->head == 3 * VMCALL_RING_SIZE);
+}
+
+TEST_CASE("exit_handler: vmcall_ring_doorbell_overflow")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_mm_ring(mocks);
+    setup_pt(mocks);
+
+    auto &&ring = reinterpret_cast<vmcall_ring_t *>(g_ring_page);
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_REGISTER, reinterpret_cast<uintptr_t>(g_ring_page)));
+
+    ring->tail = VMCALL_RING_SIZE + 1;
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_DOORBELL));
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    CHECK(ring->head == 0);
+}
+
+constexpr const auto NUM_RING_ITERATIONS = 0x1000U;
+
+TEST_CASE("exit_handler: vmcall_ring_benchmark")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_mm_ring(mocks);
+    setup_pt(mocks);
+
+    CHECK_NOTHROW(vmcall_ring(ehlr, VMCALL_RING_REGISTER, reinterpret_cast<uintptr_t>(g_ring_page)));
+
+    bfdebug_lnbr(0);
+    bfdebug_info(0, "vmcall ring round trip");
+    bfdebug_subndec(0, "entries per doorbell", VMCALL_RING_SIZE);
+    bfdebug_brk2(0);
+
+    bfdebug_ndec(0, "single vmcalls", benchmark([&] {
+        for (auto i = 0U; i < NUM_RING_ITERATIONS; i++) {
+            for (auto j = 0U; j < VMCALL_RING_SIZE; j++) {
+                ehlr.m_state_save->rax = VMCALL_VERSIONS;
+                ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+                ehlr.m_state_save->rcx = VMCALL_VERSION_PROTOCOL;
+                ehlr.dispatch();
+            }
+        }
+    }));
+
+    bfdebug_ndec(0, "doorbell", benchmark([&] {
+        for (auto i = 0U; i < NUM_RING_ITERATIONS; i++) {
+            for (auto j = 0U; j < VMCALL_RING_SIZE; j++) {
+                vmcall_ring_submit(VMCALL_VERSIONS, VMCALL_VERSION_PROTOCOL);
+            }
+
+            vmcall_ring(ehlr, VMCALL_RING_DOORBELL);
+        }
+    }));
+
+    bfdebug_brk2(0);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_preemption_timer")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmx_preemption_timer_expired);
+    auto ehlr = setup_ehlr(vmcs);
+
+    g_msrs[intel_x64::msrs::ia32_vmx_true_pinbased_ctls::addr] = 0xFFFFFFFF00000000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_misc::addr] = 0x5;
+
+    CHECK_NOTHROW(ehlr.m_profiler.enable(0x1000));
+
+    g_rip = ehlr.m_state_save->rip;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ehlr.m_profiler.size() == 1);
+
+    profiler_sample_t samples[1] = {};
+    profiler_intel_x64::size_type dropped = 0;
+
+    CHECK(ehlr.m_profiler.read(samples, dropped) == 1);
+    CHECK(samples[0].rip == g_rip);
+
+    g_msrs.erase(intel_x64::msrs::ia32_vmx_true_pinbased_ctls::addr);
+    g_msrs.erase(intel_x64::msrs::ia32_vmx_misc::addr);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_preemption_timer_disabled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmx_preemption_timer_expired);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_profiler.size() == 0);
+}
+
+TEST_CASE("exit_handler: vmcall_profiler_unknown_operation")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_PROFILER;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = 0xBEEF;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+TEST_CASE("exit_handler: vmcall_profiler_read_invalid_buffer")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_PROFILER;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_PROFILER_READ;
+    ehlr.m_state_save->rbx = reinterpret_cast<uint64_t>(g_map);
+    ehlr.m_state_save->rsi = sizeof(profiler_sample_t) - 1;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+TEST_CASE("exit_handler: vmcall_profiler_read_buffer_too_big")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_PROFILER;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_PROFILER_READ;
+    ehlr.m_state_save->rbx = reinterpret_cast<uint64_t>(g_map);
+    ehlr.m_state_save->rsi = (ehlr.m_profiler.capacity() + 1) * sizeof(profiler_sample_t);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_pause")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::pause);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(ehlr.m_ple.enable(0x80, 0x1000, 0x4000));
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ehlr.m_ple.counters().exits == 1);
+    CHECK(ehlr.m_ple.counters().useful_exits == 0);
+    CHECK(ehlr.m_ple.window() == 0x2000);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_pause_disabled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::pause);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ehlr.m_ple.counters().exits == 1);
+    CHECK(ehlr.m_ple.window() == 0);
+}
+
+TEST_CASE("exit_handler: vmcall_ple_enable_disable")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_PLE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_PLE_ENABLE;
+    ehlr.m_state_save->rbx = 0x80;
+    ehlr.m_state_save->rsi = 0x1000;
+    ehlr.m_state_save->r08 = 0x4000;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK(ehlr.m_ple.is_enabled());
+    CHECK(ehlr.m_ple.gap() == 0x80);
+    CHECK(ehlr.m_ple.window() == 0x1000);
+
+    ehlr.m_state_save->rax = VMCALL_PLE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_PLE_DISABLE;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK_FALSE(ehlr.m_ple.is_enabled());
+}
+
+TEST_CASE("exit_handler: vmcall_ple_counters")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    auto failed = false;
+
+    ehlr.m_ple.enable(0x80, 0x1000, 0x4000);
+    ehlr.m_ple.pause_exit(false, failed);
+    ehlr.m_ple.pause_exit(false, failed);
+    ehlr.m_ple.pause_exit(true, failed);
+
+    ehlr.m_state_save->rax = VMCALL_PLE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_PLE_COUNTERS;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK(ehlr.m_state_save->rbx == 3);
+    CHECK(ehlr.m_state_save->rsi == 1);
+    CHECK(ehlr.m_state_save->r08 == 2);
+    CHECK(ehlr.m_state_save->r09 == 1);
+    CHECK(ehlr.m_state_save->r10 == 0x2000);
+    CHECK(ehlr.m_ple.counters().exits == 0);
+}
+
+TEST_CASE("exit_handler: vmcall_ple_unknown_operation")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_PLE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = 0xBEEF;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+static uint64_t
+test_read_tsc() noexcept
+{ return 0x1000; }
+
+TEST_CASE("exit_handler: exit_trace")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::cpuid);
+    auto ehlr = setup_ehlr(vmcs);
+
+    mocks.OnCallFunc(_read_tsc).Do(test_read_tsc);
+
+    auto rip = ehlr.m_state_save->rip;
+    ehlr.m_trace.enable(4);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_trace.size() == 1);
+
+    exit_trace_record_t records[1] = {};
+    exit_trace_intel_x64::size_type dropped = 0;
+
+    CHECK(ehlr.m_trace.read(records, dropped) == 1);
+    CHECK(records[0].reason == exit_reason::basic_exit_reason::cpuid);
+    CHECK(records[0].instruction_length == g_exit_instruction_length);
+    CHECK(records[0].rip == rip);
+    CHECK(records[0].outcome == (EXIT_TRACE_OUTCOME_RESUMED | EXIT_TRACE_OUTCOME_ADVANCED));
+}
+
+TEST_CASE("exit_handler: vmcall_exit_trace_enable_disable")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    mocks.OnCallFunc(_read_tsc).Do(test_read_tsc);
+
+    ehlr.m_state_save->rax = VMCALL_EXIT_TRACE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_EXIT_TRACE_ENABLE;
+    ehlr.m_state_save->rbx = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK(ehlr.m_trace.is_enabled());
+
+    ehlr.m_state_save->rax = VMCALL_EXIT_TRACE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_EXIT_TRACE_DISABLE;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    CHECK_FALSE(ehlr.m_trace.is_enabled());
+    CHECK(ehlr.m_trace.size() == 0);
+}
+
+TEST_CASE("exit_handler: vmcall_exit_trace_read_invalid_buffer")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_EXIT_TRACE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_EXIT_TRACE_READ;
+    ehlr.m_state_save->rbx = reinterpret_cast<uint64_t>(g_map);
+    ehlr.m_state_save->rsi = sizeof(exit_trace_record_t) - 1;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+TEST_CASE("exit_handler: vmcall_exit_trace_enable_too_big")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_EXIT_TRACE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_EXIT_TRACE_ENABLE;
+    ehlr.m_state_save->rbx = exit_trace_intel_x64::max_num_records + 1;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    CHECK_FALSE(ehlr.m_trace.is_enabled());
+}
+
+TEST_CASE("exit_handler: vmcall_exit_trace_read_buffer_too_big")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_trace.enable(1);
+
+    ehlr.m_state_save->rax = VMCALL_EXIT_TRACE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = VMCALL_EXIT_TRACE_READ;
+    ehlr.m_state_save->rbx = reinterpret_cast<uint64_t>(g_map);
+    ehlr.m_state_save->rsi = 2 * sizeof(exit_trace_record_t);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+TEST_CASE("exit_handler: vmcall_exit_trace_unknown_operation")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_EXIT_TRACE;
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;
+    ehlr.m_state_save->rcx = 0xBEEF;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(bfscast(int64_t, ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+}
+
+static uint64_t g_cr2 = 0;
+
+static void
+test_write_cr2(uint64_t val) noexcept
+{ g_cr2 = val; }
+
+static uint64_t g_dr6 = 0;
+
+static uint64_t
+test_read_dr6() noexcept
+{ return g_dr6; }
+
+static void
+test_write_dr6(uint64_t val) noexcept
+{ g_dr6 = val; }
+
+static auto
+exception_interruption_information(uint64_t vector, uint64_t type, bool error_code_valid)
+{
+    namespace info = vmcs::vm_exit_interruption_information;
+
+    auto interruption_info = info::valid_bit::mask;
+
+    interruption_info |= (vector << info::vector::from) & info::vector::mask;
+    interruption_info |= (type << info::interruption_type::from) & info::interruption_type::mask;
+
+    if (error_code_valid) {
+        interruption_info |= info::error_code_valid::mask;
+    }
+
+    return interruption_info;
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_exception_reinjected")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt);
+    auto ehlr = setup_ehlr(vmcs);
+    g_vmwrite_value.clear();
+
+    g_exit_interruption_information =
+        exception_interruption_information(x64::interrupt::general_protection,
+                                           info::interruption_type::hardware_exception, true);
+    g_exit_interruption_error_code = 0x10;
+    g_rip = ehlr.m_state_save->rip;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+
+    auto &&interruption_info = g_vmwrite_value[info::addr];
+
+    CHECK(info::vector::get(interruption_info) == x64::interrupt::general_protection);
+    CHECK(info::interruption_type::get(interruption_info) == info::interruption_type::hardware_exception);
+    CHECK(info::deliver_error_code_bit::is_enabled(interruption_info));
+    CHECK(info::valid_bit::is_enabled(interruption_info));
+    CHECK(g_vmwrite_value[vmcs::vm_entry_exception_error_code::addr] == 0x10);
+    CHECK(g_vmwrite_value.count(vmcs::vm_entry_instruction_length::addr) == 0);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_exception_software_reinjected")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt);
+    auto ehlr = setup_ehlr(vmcs);
+    g_vmwrite_value.clear();
+
+    g_exit_interruption_information =
+        exception_interruption_information(x64::interrupt::breakpoint,
+                                           info::interruption_type::software_exception, false);
+    g_rip = ehlr.m_state_save->rip;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+
+    auto &&interruption_info = g_vmwrite_value[info::addr];
+
+    CHECK(info::vector::get(interruption_info) == x64::interrupt::breakpoint);
+    CHECK_FALSE(info::deliver_error_code_bit::is_enabled(interruption_info));
+    CHECK(g_vmwrite_value[vmcs::vm_entry_instruction_length::addr] == g_exit_instruction_length);
+    CHECK(g_vmwrite_value.count(vmcs::vm_entry_exception_error_code::addr) == 0);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_page_fault_reinjected")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt);
+    auto ehlr = setup_ehlr(vmcs);
+    g_vmwrite_value.clear();
+
+    mocks.OnCallFunc(_write_cr2).Do(test_write_cr2);
+
+    g_exit_interruption_information =
+        exception_interruption_information(x64::interrupt::page_fault,
+                                           info::interruption_type::hardware_exception, true);
+    g_exit_interruption_error_code = 0x3;
+    g_exit_qualification = 0xDEAD000;
+    g_cr2 = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_cr2 == 0xDEAD000);
+    CHECK(info::vector::get(g_vmwrite_value[info::addr]) == x64::interrupt::page_fault);
+    CHECK(g_vmwrite_value[vmcs::vm_entry_exception_error_code::addr] == 0x3);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_page_fault_during_page_fault")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt);
+    auto ehlr = setup_ehlr(vmcs);
+    g_vmwrite_value.clear();
+
+    mocks.OnCallFunc(_write_cr2).Do(test_write_cr2);
+
+    auto ___ = gsl::finally([&]
+    { g_exit_idt_vectoring_information = 0; });
+
+    // The #PF that was reflected on the last entry faults again, as the
+    // guest's IDT is not mapped
+
+    g_exit_idt_vectoring_information =
+        exception_interruption_information(x64::interrupt::page_fault,
+                                           info::interruption_type::hardware_exception, true);
+    g_exit_interruption_information =
+        exception_interruption_information(x64::interrupt::page_fault,
+                                           info::interruption_type::hardware_exception, true);
+    g_exit_interruption_error_code = 0x0;
+    g_exit_qualification = 0xFFFF8000;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_cr2 == 0xFFFF8000);
+    CHECK(ehlr.m_events.empty());
+
+    auto &&interruption_info = g_vmwrite_value[info::addr];
+
+    CHECK(info::vector::get(interruption_info) == x64::interrupt::double_fault);
+    CHECK(info::deliver_error_code_bit::is_enabled(interruption_info));
+    CHECK(g_vmwrite_value[vmcs::vm_entry_exception_error_code::addr] == 0);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_page_fault_during_double_fault")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_halt(mocks, exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt);
+    auto ehlr = setup_ehlr(vmcs);
+
+    mocks.OnCallFunc(_write_cr2).Do(test_write_cr2);
+
+    auto ___ = gsl::finally([&]
+    { g_exit_idt_vectoring_information = 0; });
+
+    g_exit_idt_vectoring_information =
+        exception_interruption_information(x64::interrupt::double_fault,
+                                           info::interruption_type::hardware_exception, true);
+    g_exit_interruption_information =
+        exception_interruption_information(x64::interrupt::page_fault,
+                                           info::interruption_type::hardware_exception, true);
+
+    CHECK_THROWS(ehlr.dispatch());
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_page_fault_during_interrupt")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt);
+    auto ehlr = setup_ehlr(vmcs);
+    g_vmwrite_value.clear();
+
+    mocks.OnCallFunc(_write_cr2).Do(test_write_cr2);
+
+    auto ___ = gsl::finally([&]
+    { g_exit_idt_vectoring_information = 0; });
+
+    g_exit_idt_vectoring_information =
+        exception_interruption_information(0x30, info::interruption_type::external_interrupt, false);
+    g_exit_interruption_information =
+        exception_interruption_information(x64::interrupt::page_fault,
+                                           info::interruption_type::hardware_exception, true);
+    g_exit_interruption_error_code = 0x2;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(info::vector::get(g_vmwrite_value[info::addr]) == x64::interrupt::page_fault);
+    CHECK(ehlr.m_events.size() == 1);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_debug_exception_reinjected")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+    namespace debug = vmcs::exit_qualification::debug_exception;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt);
+    auto ehlr = setup_ehlr(vmcs);
+    g_vmwrite_value.clear();
+
+    mocks.OnCallFunc(_read_dr6).Do(test_read_dr6);
+    mocks.OnCallFunc(_write_dr6).Do(test_write_dr6);
+
+    g_exit_interruption_information =
+        exception_interruption_information(x64::interrupt::debug_exception,
+                                           info::interruption_type::hardware_exception, false);
+    g_exit_qualification = debug::b1::mask | debug::bs::mask;
+    g_dr6 = 0xFFFF0FF0 | debug::b0::mask;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_dr6 == (0xFFFF0FF0 | debug::b1::mask | debug::bs::mask));
+    CHECK(info::vector::get(g_vmwrite_value[info::addr]) == x64::interrupt::debug_exception);
+
+    g_exit_qualification = 0;
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_page_fault_claimed")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::exception_or_non_maskable_interrupt);
+    auto ehlr = setup_ehlr(vmcs);
+
+    auto &&error_code = 0ULL;
+    auto &&address = 0ULL;
+
+    ehlr.m_exceptions.subscribe_page_fault(0x3, 0x3, [&](const auto & exception) {
+        error_code = exception.error_code;
+        address = exception.qualification;
+        return true;
+    });
+
+    g_vmwrite_value.clear();
+
+    g_exit_interruption_information =
+        exception_interruption_information(x64::interrupt::page_fault,
+                                           info::interruption_type::hardware_exception, true);
+    g_exit_interruption_error_code = 0x7;
+    g_exit_qualification = 0xBEEF000;
+    g_rip = ehlr.m_state_save->rip;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(error_code == 0x7);
+    CHECK(address == 0xBEEF000);
+    CHECK(g_vmwrite_value.count(info::addr) == 0);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_interrupt_window")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::interrupt_window);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_events.queue_external_interrupt(0x30);
+
+    g_vmwrite_value.clear();
+    g_value = x64::rflags::interrupt_enable_flag::mask;
+    g_rip = ehlr.m_state_save->rip;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ehlr.m_events.empty());
+
+    auto &&interruption_info = g_vmwrite_value[info::addr];
+
+    CHECK(info::vector::get(interruption_info) == 0x30);
+    CHECK(info::interruption_type::get(interruption_info) == info::interruption_type::external_interrupt);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_nmi_window")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::nmi_window);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_events.queue_nmi();
+
+    g_vmwrite_value.clear();
+    g_value = 0;
+    g_rip = ehlr.m_state_save->rip;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ehlr.m_events.empty());
+
+    auto &&interruption_info = g_vmwrite_value[info::addr];
+
+    CHECK(info::vector::get(interruption_info) == x64::interrupt::nmi_interrupt);
+    CHECK(info::interruption_type::get(interruption_info) == info::interruption_type::non_maskable_interrupt);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_monitor_trap_flag")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::monitor_trap_flag);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_events.queue_exception(x64::interrupt::invalid_opcode);
+
+    g_vmwrite_value.clear();
+    g_value = 0;
+    g_rip = ehlr.m_state_save->rip;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ehlr.m_events.empty());
+
+    auto &&interruption_info = g_vmwrite_value[info::addr];
+
+    CHECK(info::vector::get(interruption_info) == x64::interrupt::invalid_opcode);
+    CHECK(info::interruption_type::get(interruption_info) == info::interruption_type::hardware_exception);
+}
+
+static uintptr_t
+test_virtptr_to_physint(void *ptr)
+{ return reinterpret_cast<uintptr_t>(ptr); }
+
+static void
+setup_ept_msrs(MockRepository &mocks)
+{
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Do(test_virtptr_to_physint);
+
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] =
+        intel_x64::msrs::ia32_vmx_ept_vpid_cap::invept_support::mask |
+        intel_x64::msrs::ia32_vmx_ept_vpid_cap::invept_single_context_support::mask;
+
+    g_invept_count = 0;
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_ept_violation_without_ept")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_unhandled(mocks, exit_reason::basic_exit_reason::ept_violation);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_ept_violation_maps_page")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    setup_ept_msrs(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::ept_violation);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ept_intel_x64 ept;
+    ept.flush();
+    ehlr.set_ept(&ept);
+
+    g_guest_physical_address = 0xFEE00123;
+    g_rip = ehlr.m_state_save->rip;
+    g_invept_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ept.is_mapped(0xFEE00000));
+    CHECK(ept.gpa_to_epte(0xFEE00000).phys_addr() == 0xFEE00000);
+    CHECK_FALSE(ept.is_mapped(0xFEE01000));
+    CHECK(g_invept_count == 0);
+
+    g_guest_physical_address = 0;
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_ept_violation_during_delivery")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    setup_ept_msrs(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::ept_violation);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ept_intel_x64 ept;
+    ehlr.set_ept(&ept);
+
+    auto ___ = gsl::finally([&] {
+        g_exit_idt_vectoring_information = 0;
+        g_exit_idt_vectoring_error_code = 0;
+        g_guest_physical_address = 0;
+    });
+
+    // The guest's stack is not mapped yet, and the #GP that was injected
+    // on the last entry could not be pushed onto it
+
+    g_exit_idt_vectoring_information =
+        exception_interruption_information(x64::interrupt::general_protection,
+                                           info::interruption_type::hardware_exception, true);
+    g_exit_idt_vectoring_error_code = 0x10;
+    g_guest_physical_address = 0xFEE00123;
+
+    ehlr.m_events.queue_external_interrupt(0x30);
+
+    g_vmwrite_value.clear();
+    g_value = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ept.is_mapped(0xFEE00000));
+    CHECK(ehlr.m_events.size() == 1);
+
+    auto &&interruption_info = g_vmwrite_value[info::addr];
+
+    CHECK(info::vector::get(interruption_info) == x64::interrupt::general_protection);
+    CHECK(info::interruption_type::get(interruption_info) == info::interruption_type::hardware_exception);
+    CHECK(info::deliver_error_code_bit::is_enabled(interruption_info));
+    CHECK(g_vmwrite_value[vmcs::vm_entry_exception_error_code::addr] == 0x10);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_software_interrupt_during_delivery")
+{
+    namespace info = vmcs::vm_entry_interruption_information;
+
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    setup_ept_msrs(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::ept_violation);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ept_intel_x64 ept;
+    ehlr.set_ept(&ept);
+
+    auto ___ = gsl::finally([&] {
+        g_exit_idt_vectoring_information = 0;
+        g_guest_physical_address = 0;
+    });
+
+    g_exit_idt_vectoring_information =
+        exception_interruption_information(0x80, info::interruption_type::software_interrupt, false);
+    g_guest_physical_address = 0xFEE00123;
+
+    g_vmwrite_value.clear();
+    g_rip = ehlr.m_state_save->rip;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ehlr.m_events.empty());
+
+    auto &&interruption_info = g_vmwrite_value[info::addr];
+
+    CHECK(info::vector::get(interruption_info) == 0x80);
+    CHECK(info::interruption_type::get(interruption_info) == info::interruption_type::software_interrupt);
+    CHECK(g_vmwrite_value[vmcs::vm_entry_instruction_length::addr] == g_exit_instruction_length);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_ept_violation_mapped")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    setup_ept_msrs(mocks);
+    auto vmcs = setup_vmcs_unhandled(mocks, exit_reason::basic_exit_reason::ept_violation);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ept_intel_x64 ept;
+    ept.map_4k(0x1000, 0x1000, ept::access::read, x64::memory_type::write_back);
+    ehlr.set_ept(&ept);
+
+    g_guest_physical_address = 0x1000;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ept.gpa_to_epte(0x1000).access() == ept::access::read);
+
+    g_guest_physical_address = 0;
+}
+
+TEST_CASE("exit_handler: ept_flushed_once_at_resume")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    setup_ept_msrs(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::cpuid);
+    auto ehlr = setup_ehlr(vmcs);
+
+    ept_intel_x64 ept;
+    ept.map_4k(0x1000, 0x1000, ept::access::read_write_execute, x64::memory_type::write_back);
+    ept.map_4k(0x2000, 0x2000, ept::access::read_write_execute, x64::memory_type::write_back);
+    ehlr.set_ept(&ept);
+
+    ept.unmap(0x1000);
+    ept.unmap(0x2000);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_invept_count == 1);
+    CHECK_FALSE(ept.is_flush_pending());
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_ept_misconfiguration")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_unhandled(mocks, exit_reason::basic_exit_reason::ept_misconfiguration);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+}
+
+static void
+setup_cr_fixed_msrs()
+{
+    g_msrs[intel_x64::msrs::ia32_vmx_cr0_fixed0::addr] = 0x80000021UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_cr0_fixed1::addr] = 0xFFFFFFFFUL;
+    g_msrs[intel_x64::msrs::ia32_vmx_cr4_fixed0::addr] = 0x2000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_cr4_fixed1::addr] = 0x3767FFUL;
+
+    g_vmwrite_value.clear();
+}
+
+static auto
+cr_access_qualification(uint64_t cr, uint64_t type, uint64_t gpr, uint64_t source_data = 0)
+{
+    namespace access = vmcs::exit_qualification::control_register_access;
+
+    return (cr << access::control_register_number::from) |
+           (type << access::access_type::from) |
+           (gpr << access::general_purpose_register::from) |
+           (source_data << access::source_data::from);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr0")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(0, 0, 3);
+    ehlr.m_state_save->rbx = 0x00000011UL;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(g_vmwrite_value[vmcs::guest_cr0::addr] == 0x80000031UL);
+    CHECK(g_vmwrite_value[vmcs::cr0_read_shadow::addr] == 0x00000011UL);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr4")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(4, 0, 4);
+    ehlr.m_state_save->rsp = 0x000006A0UL;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(g_vmwrite_value[vmcs::guest_cr4::addr] == 0x000026A0UL);
+    CHECK(g_vmwrite_value[vmcs::cr4_read_shadow::addr] == 0x000006A0UL);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr3")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(3, 0, 15);
+    ehlr.m_state_save->r15 = 0x1000UL;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(g_vmwrite_value[vmcs::guest_cr3::addr] == 0x1000UL);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_from_cr3")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(3, 1, 8);
+    g_value = 0x2000UL;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(ehlr.m_state_save->r08 == 0x2000UL);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr3_flushes_vpid")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] =
+        intel_x64::msrs::ia32_vmx_ept_vpid_cap::invvpid_single_context_retaining_globals_support::mask;
+
+    g_exit_qualification = cr_access_qualification(3, 0, 15);
+    ehlr.m_state_save->r15 = 0x1000UL;
+
+    g_vpid = 1;
+    g_value = 0;
+    g_invvpid_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(g_vmwrite_value[vmcs::guest_cr3::addr] == 0x1000UL);
+    CHECK(g_invvpid_count == 1);
+    CHECK(g_invvpid_type == 3);
+    CHECK(g_invvpid_vpid == 1);
+
+    g_vpid = 0;
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr3_without_vpid")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(3, 0, 15);
+    ehlr.m_state_save->r15 = 0x1000UL;
+
+    g_vpid = 0;
+    g_value = 0;
+    g_invvpid_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_vmwrite_value[vmcs::guest_cr3::addr] == 0x1000UL);
+    CHECK(g_invvpid_count == 0);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr3_pcid_no_flush")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(3, 0, 15);
+    ehlr.m_state_save->r15 = 0x8000000000001001UL;
+
+    g_vpid = 1;
+    g_value = cr4::pcid_enable_bit::mask;
+    g_invvpid_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(g_vmwrite_value[vmcs::guest_cr3::addr] == 0x1001UL);
+    CHECK(g_invvpid_count == 0);
+
+    g_vpid = 0;
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr0_paging_flushes_vpid")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] =
+        intel_x64::msrs::ia32_vmx_ept_vpid_cap::invvpid_all_context_support::mask;
+
+    g_exit_qualification = cr_access_qualification(0, 0, 3);
+    ehlr.m_state_save->rbx = 0x80000011UL;
+
+    g_vpid = 1;
+    g_value = 0x00000011UL;
+    g_invvpid_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_vmwrite_value[vmcs::cr0_read_shadow::addr] == 0x80000011UL);
+    CHECK(g_invvpid_count == 1);
+    CHECK(g_invvpid_type == 2);
+
+    g_vpid = 0;
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr4_pge_flushes_vpid")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] =
+        intel_x64::msrs::ia32_vmx_ept_vpid_cap::invvpid_single_context_support::mask;
+
+    g_exit_qualification = cr_access_qualification(4, 0, 4);
+    ehlr.m_state_save->rsp = 0x000006A0UL;
+
+    g_vpid = 1;
+    g_value = 0x00000620UL;
+    g_invvpid_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_vmwrite_value[vmcs::cr4_read_shadow::addr] == 0x000006A0UL);
+    CHECK(g_invvpid_count == 1);
+    CHECK(g_invvpid_type == 1);
+    CHECK(g_invvpid_vpid == 1);
+
+    g_vpid = 0;
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr0_guest_owned_wp_flushes_vpid")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] =
+        intel_x64::msrs::ia32_vmx_ept_vpid_cap::invvpid_single_context_support::mask;
+
+    // The guest set CR0.WP without an exit, so only the guest's CR0 has it
+
+    g_vmread_value[vmcs::cr0_guest_host_mask::addr] = 0x80000021UL;
+    g_vmread_value[vmcs::cr0_read_shadow::addr] = 0x80000031UL;
+    g_vmread_value[vmcs::guest_cr0::addr] = 0x80010031UL;
+
+    g_exit_qualification = cr_access_qualification(0, 0, 3);
+    ehlr.m_state_save->rbx = 0x80000031UL;
+
+    g_vpid = 1;
+    g_invvpid_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_invvpid_count == 1);
+    CHECK(g_invvpid_vpid == 1);
+
+    g_vpid = 0;
+    g_vmread_value.clear();
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr3_guest_owned_pcid_no_flush")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    // CR4.PCIDE is not owned by the VMM, so only the guest's CR4 has it
+
+    g_vmread_value[vmcs::cr4_guest_host_mask::addr] = cr4::vmx_enable_bit::mask;
+    g_vmread_value[vmcs::cr4_read_shadow::addr] = 0;
+    g_vmread_value[vmcs::guest_cr4::addr] = cr4::vmx_enable_bit::mask | cr4::pcid_enable_bit::mask;
+
+    g_exit_qualification = cr_access_qualification(3, 0, 15);
+    ehlr.m_state_save->r15 = 0x8000000000001001UL;
+
+    g_vpid = 1;
+    g_invvpid_count = 0;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_vmwrite_value[vmcs::guest_cr3::addr] == 0x1001UL);
+    CHECK(g_invvpid_count == 0);
+
+    g_vpid = 0;
+    g_vmread_value.clear();
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_clts")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(0, 2, 0);
+    g_value = 0x80000039UL;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(g_vmwrite_value[vmcs::cr0_read_shadow::addr] == 0x80000031UL);
+    CHECK(g_vmwrite_value[vmcs::guest_cr0::addr] == 0x80000031UL);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_lmsw")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(0, 3, 0, 0xFFF8);
+    g_value = 0x80000033UL;
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(ehlr.m_state_save->rip == g_rip);
+    CHECK(g_vmwrite_value[vmcs::cr0_read_shadow::addr] == 0x80000039UL);
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_clts_stale_read_shadow")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    // The guest set CR0.WP and CR0.AM without an exit (they are not owned
+    // by the VMM), so the read shadow does not have them
+
+    g_vmread_value[vmcs::cr0_guest_host_mask::addr] = 0x80000021UL;
+    g_vmread_value[vmcs::cr0_read_shadow::addr] = 0x80000039UL;
+    g_vmread_value[vmcs::guest_cr0::addr] = 0x80050039UL;
+
+    g_exit_qualification = cr_access_qualification(0, 2, 0);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_vmwrite_value[vmcs::cr0_read_shadow::addr] == 0x80050031UL);
+    CHECK(g_vmwrite_value[vmcs::guest_cr0::addr] == 0x80050031UL);
+
+    g_vmread_value.clear();
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_lmsw_stale_read_shadow")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_vmread_value[vmcs::cr0_guest_host_mask::addr] = 0x80000021UL;
+    g_vmread_value[vmcs::cr0_read_shadow::addr] = 0x80000031UL;
+    g_vmread_value[vmcs::guest_cr0::addr] = 0x80050031UL;
+
+    g_exit_qualification = cr_access_qualification(0, 3, 0, 0xFFF8);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_vmwrite_value[vmcs::cr0_read_shadow::addr] == 0x80050039UL);
+    CHECK(g_vmwrite_value[vmcs::guest_cr0::addr] == 0x80050039UL);
+
+    g_vmread_value.clear();
+}
+
+TEST_CASE("exit_handler: vm_exit_reason_mov_to_cr8_unhandled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_unhandled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto ehlr = setup_ehlr(vmcs);
+    setup_cr_fixed_msrs();
+
+    g_exit_qualification = cr_access_qualification(8, 0, 0);
+
+    CHECK_NOTHROW(ehlr.dispatch());
+    CHECK(g_vmwrite_value.count(vmcs::guest_cr0::addr) == 0);
+}
+
+TEST_CASE("exit_handler: halt")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_halt(mocks, exit_reason::basic_exit_reason::xrstors);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_NOTHROW(ehlr.halt());
+}
+
+TEST_CASE("exit_handler: switch_to_without_contexts")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_halt(mocks, exit_reason::basic_exit_reason::cpuid);
+    auto ehlr = setup_ehlr(vmcs);
+
+    CHECK_THROWS(ehlr.switch_to(1));
+    CHECK(ehlr.m_vmcs == vmcs);
+    CHECK(ehlr.m_state_save == &g_state_save);
+}
+
+TEST_CASE("exit_handler: switch_to")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_halt(mocks, exit_reason::basic_exit_reason::cpuid);
+    auto ehlr = setup_ehlr(vmcs);
+
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto contexts = vmcs_intel_x64_context_set(vmcs, &g_state_save, host_state, nullptr);
+    ehlr.set_contexts(&contexts);
+
+    auto other = mocks.Mock<vmcs_intel_x64>();
+    mocks.OnCallDestructor(other);
+    mocks.OnCall(other, vmcs_intel_x64::set_state_save);
+    mocks.OnCall(other, vmcs_intel_x64::set_exit_handler_entry);
+
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+    mocks.OnCallDestructor(guest_state);
+    mocks.OnCall(guest_state, vmcs_intel_x64_state::is_guest).Return(true);
+
+    auto ctx = contexts.add(std::unique_ptr<vmcs_intel_x64>(other),
+                            std::unique_ptr<vmcs_intel_x64_state>(guest_state));
+
+    g_vmwrite_count.clear();
+
+    ehlr.m_state_save->fast_path_exits = 0x42;
+    ehlr.m_guest_shadow.set(vmcs::guest_ia32_efer::addr, 0x42, ehlr.m_vmcs_failed);
+
+    mocks.ExpectCall(other, vmcs_intel_x64::prepare).With(host_state, guest_state);
+    CHECK_NOTHROW(ehlr.switch_to(ctx));
+
+    CHECK(g_vmwrite_count[vmcs::guest_ia32_efer::addr] == 1);
+    CHECK(ehlr.m_vmcs == other);
+    CHECK(ehlr.m_state_save == contexts.state_save(ctx));
+    CHECK(ehlr.m_state_save->fast_path_exits == 0x42);
+    CHECK(ehlr.m_state_save->exit_info_valid == 0);
+
+    CHECK_NOTHROW(ehlr.switch_to(ctx));
+
+    mocks.ExpectCall(other, vmcs_intel_x64::launch).With(host_state, guest_state);
+    CHECK_NOTHROW(ehlr.resume());
+
+    mocks.ExpectCall(other, vmcs_intel_x64::resume);
+    CHECK_NOTHROW(ehlr.resume());
+
+    g_state_save.fast_path_exits = 0;
+}
+
+TEST_CASE("exit_handler: switch_to_resyncs_controls")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = setup_vmcs_halt(mocks, exit_reason::basic_exit_reason::cpuid);
+    auto ehlr = setup_ehlr(vmcs);
+
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto contexts = vmcs_intel_x64_context_set(vmcs, &g_state_save, host_state, nullptr);
+    ehlr.set_contexts(&contexts);
+
+    auto other = mocks.Mock<vmcs_intel_x64>();
+    mocks.OnCallDestructor(other);
+    mocks.OnCall(other, vmcs_intel_x64::set_state_save);
+    mocks.OnCall(other, vmcs_intel_x64::set_exit_handler_entry);
+    mocks.OnCall(other, vmcs_intel_x64::prepare);
+
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+    mocks.OnCallDestructor(guest_state);
+    mocks.OnCall(guest_state, vmcs_intel_x64_state::is_guest).Return(true);
+
+    auto ctx = contexts.add(std::unique_ptr<vmcs_intel_x64>(other),
+                            std::unique_ptr<vmcs_intel_x64_state>(guest_state));
+
+    ehlr.m_exceptions.subscribe(interrupt::general_protection, [](const auto &) { return true; });
+
+    // The VMCS that is switched to has the interrupt-window exit armed,
+    // and does not have the exception bitmap
+
+    g_vmread_value[vmcs::primary_processor_based_vm_execution_controls::addr] =
+        vmcs::primary_processor_based_vm_execution_controls::interrupt_window_exiting::mask;
+
+    g_vmwrite_count.clear();
+
+    CHECK_NOTHROW(ehlr.switch_to(ctx));
+    CHECK_FALSE(ehlr.m_vmcs_failed);
+    CHECK(ehlr.m_events.interrupt_window_armed());
+    CHECK_FALSE(ehlr.m_events.nmi_window_armed());
+    CHECK(g_vmwrite_count[vmcs::exception_bitmap::addr] == 1);
+    CHECK(g_vmwrite_value[vmcs::exception_bitmap::addr] == ehlr.m_exceptions.exception_bitmap());
+
+    g_vmread_value.clear();
+    g_state_save.fast_path_exits = 0;
+}
+
+TEST_CASE("exit_handler: promote_switches_to_primary")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto vmcs = mocks.Mock<vmcs_intel_x64>();
+    auto ehlr = setup_ehlr(vmcs);
+
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto contexts = vmcs_intel_x64_context_set(vmcs, &g_state_save, host_state, nullptr);
+    ehlr.set_contexts(&contexts);
+
+    auto other = mocks.Mock<vmcs_intel_x64>();
+    mocks.OnCallDestructor(other);
+    mocks.OnCall(other, vmcs_intel_x64::set_state_save);
+    mocks.OnCall(other, vmcs_intel_x64::set_exit_handler_entry);
+    mocks.OnCall(other, vmcs_intel_x64::prepare);
+    mocks.NeverCall(other, vmcs_intel_x64::promote);
+
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+    mocks.OnCallDestructor(guest_state);
+    mocks.OnCall(guest_state, vmcs_intel_x64_state::is_guest).Return(true);
+
+    auto ctx = contexts.add(std::unique_ptr<vmcs_intel_x64>(other),
+                            std::unique_ptr<vmcs_intel_x64_state>(guest_state));
+
+    CHECK_NOTHROW(ehlr.switch_to(ctx));
+
+    mocks.ExpectCall(vmcs, vmcs_intel_x64::load);
+    mocks.ExpectCall(vmcs, vmcs_intel_x64::promote);
+
+    CHECK_NOTHROW(ehlr.promote());
+    CHECK(contexts.current() == vmcs_intel_x64_context_set::primary);
+    CHECK(ehlr.m_vmcs == vmcs);
+    CHECK(ehlr.m_state_save == &g_state_save);
+
+    g_state_save.fast_path_exits = 0;
 }
 
 #endif
@@ -22,12 +22,103 @@
 #include <catch/catch.hpp>
 #include <hippomocks.h>
 
+#include <bfbenchmark.h>
+
+#include <vmcs/vmcs_intel_x64.h>
+#include <vmcs/vmcs_intel_x64_resume.h>
+#include <memory_manager/memory_manager_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
 #include <exit_handler/exit_handler_intel_x64.h>
 #include <exit_handler/exit_handler_intel_x64_entry.h>
 #include <exit_handler/exit_handler_intel_x64_support.h>
 
 #ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
 
+using namespace x64;
+using namespace intel_x64;
+
+static state_save_intel_x64 g_state_save{};
+static std::map<intel_x64::msrs::field_type, intel_x64::msrs::value_type> g_msrs;
+
+static vmcs::value_type g_exit_reason = 0;
+static vmcs::value_type g_exit_instruction_length = 8;
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    switch (field) {
+        case vmcs::exit_reason::addr:
+            *val = g_exit_reason;
+            break;
+        case vmcs::vm_exit_instruction_length::addr:
+            *val = g_exit_instruction_length;
+            break;
+        default:
+            *val = 0;
+            break;
+    }
+
+    return true;
+}
+
+static bool
+test_vmread_fails(uint64_t field, uint64_t *val) noexcept
+{
+    bfignored(field);
+    bfignored(val);
+
+    return false;
+}
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static void
+test_write_msr(uint32_t addr, uint64_t val) noexcept
+{ g_msrs[addr] = val; }
+
+static void
+test_wbinvd() noexcept
+{ }
+
+static void
+test_cpuid(void *eax, void *ebx, void *ecx, void *edx) noexcept
+{
+    *static_cast<uint32_t *>(eax) = 1;
+    *static_cast<uint32_t *>(ebx) = 2;
+    *static_cast<uint32_t *>(ecx) = 3;
+    *static_cast<uint32_t *>(edx) = 4;
+}
+
+static void
+test_vmcs_resume(state_save_intel_x64 *state_save) noexcept
+{ bfignored(state_save); }
+
+class exit_handler_fast_path_ut : public exit_handler_intel_x64
+{
+public:
+
+    exit_handler_fast_path_ut()
+    { set_state_save(&g_state_save); }
+
+    void halt() noexcept override
+    { m_halted = true; }
+
+    bool m_halted{false};
+};
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+    mocks.OnCallFunc(_write_msr).Do(test_write_msr);
+    mocks.OnCallFunc(_wbinvd).Do(test_wbinvd);
+    mocks.OnCallFunc(_cpuid).Do(test_cpuid);
+}
+
 TEST_CASE("exit_handler: entry_valid")
 {
     MockRepository mocks;
@@ -72,4 +163,266 @@ TEST_CASE("exit_handler: entry_throws_any_exception")
     CHECK_NOTHROW(exit_handler(eh));
 }
 
+TEST_CASE("exit_handler: enable_fast_path")
+{
+    exit_handler_fast_path_ut ehlr;
+    g_state_save.fast_path_exits = 0;
+
+    CHECK_NOTHROW(ehlr.enable_fast_path(vmcs::exit_reason::basic_exit_reason::cpuid));
+    CHECK_NOTHROW(ehlr.enable_fast_path(vmcs::exit_reason::basic_exit_reason::invd));
+    CHECK_NOTHROW(ehlr.enable_fast_path(vmcs::exit_reason::basic_exit_reason::rdmsr));
+    CHECK_NOTHROW(ehlr.enable_fast_path(vmcs::exit_reason::basic_exit_reason::wrmsr));
+    CHECK_THROWS(ehlr.enable_fast_path(vmcs::exit_reason::basic_exit_reason::vmcall));
+
+    CHECK(g_state_save.fast_path_exits == 0x0000000180002400UL);
+
+    CHECK_NOTHROW(ehlr.disable_fast_path(vmcs::exit_reason::basic_exit_reason::invd));
+    CHECK(g_state_save.fast_path_exits == 0x0000000180000400UL);
+
+    CHECK_THROWS(ehlr.disable_fast_path(64));
+}
+
+TEST_CASE("exit_handler: fast_path_vmread_fails")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    mocks.OnCallFunc(_vmread).Do(test_vmread_fails);
+    mocks.NeverCallFunc(vmcs_resume);
+
+    g_state_save.rip = 0;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::cpuid);
+
+    CHECK(g_state_save.rip == 0);
+    CHECK(!ehlr.m_halted);
+}
+
+TEST_CASE("exit_handler: fast_path_unsupported_reason")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.NeverCallFunc(vmcs_resume);
+
+    g_state_save.rip = 0;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::vmcall);
+
+    CHECK(g_state_save.rip == 0);
+    CHECK(!ehlr.m_halted);
+}
+
+TEST_CASE("exit_handler: fast_path_pending_events")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.NeverCallFunc(vmcs_resume);
+
+    ehlr.m_events.queue_nmi();
+
+    g_state_save.rip = 0;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::cpuid);
+
+    CHECK(g_state_save.rip == 0);
+    CHECK(!ehlr.m_halted);
+}
+
+TEST_CASE("exit_handler: fast_path_trace_enabled")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.NeverCallFunc(vmcs_resume);
+
+    ehlr.m_trace.enable(1);
+
+    g_state_save.rip = 0;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::cpuid);
+
+    CHECK(g_state_save.rip == 0);
+    CHECK(!ehlr.m_halted);
+}
+
+TEST_CASE("exit_handler: fast_path_check_on_entry")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.NeverCallFunc(vmcs_resume);
+
+    auto ___ = gsl::finally([&]
+    { vm::track_dirty_fields(false); });
+
+    vm::track_dirty_fields(true);
+
+    g_state_save.rip = 0;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::cpuid);
+
+    CHECK(g_state_save.rip == 0);
+    CHECK(!ehlr.m_halted);
+}
+
+TEST_CASE("exit_handler: fast_path_cpuid")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.ExpectCallFunc(vmcs_resume).Do(test_vmcs_resume);
+
+    g_state_save.rip = 0;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::cpuid);
+
+    CHECK(g_state_save.rip == g_exit_instruction_length);
+    CHECK(g_state_save.rax == 1);
+    CHECK(g_state_save.rbx == 2);
+    CHECK(g_state_save.rcx == 3);
+    CHECK(g_state_save.rdx == 4);
+    CHECK(ehlr.m_halted);
+}
+
+TEST_CASE("exit_handler: fast_path_invd")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.ExpectCallFunc(_wbinvd).Do(test_wbinvd);
+    mocks.ExpectCallFunc(vmcs_resume).Do(test_vmcs_resume);
+
+    g_state_save.rip = 0;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::invd);
+
+    CHECK(g_state_save.rip == g_exit_instruction_length);
+}
+
+TEST_CASE("exit_handler: fast_path_rdmsr")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.ExpectCallFunc(vmcs_resume).Do(test_vmcs_resume);
+
+    g_msrs[0x10] = 0x0000000200000001UL;
+
+    g_state_save.rip = 0;
+    g_state_save.rcx = 0x10;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::rdmsr);
+
+    CHECK(g_state_save.rip == g_exit_instruction_length);
+    CHECK(g_state_save.rax == 1);
+    CHECK(g_state_save.rdx == 2);
+}
+
+TEST_CASE("exit_handler: fast_path_rdmsr_vmcs_field")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.NeverCallFunc(vmcs_resume);
+
+    g_state_save.rip = 0;
+    g_state_save.rcx = intel_x64::msrs::ia32_efer::addr;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::rdmsr);
+
+    CHECK(g_state_save.rip == 0);
+    CHECK(!ehlr.m_halted);
+}
+
+TEST_CASE("exit_handler: fast_path_rdmsr_msr_area")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.OnCallFunc(_vmwrite).Return(true);
+    mocks.NeverCallFunc(vmcs_resume);
+
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x1000);
+
+    vmcs_intel_x64_msr_area area;
+    area.add(x64::msrs::ia32_lstar::addr, 0, 0);
+    ehlr.set_msr_area(&area);
+
+    g_state_save.rip = 0;
+    g_state_save.rcx = x64::msrs::ia32_lstar::addr;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::rdmsr);
+
+    CHECK(g_state_save.rip == 0);
+    CHECK(!ehlr.m_halted);
+}
+
+TEST_CASE("exit_handler: fast_path_wrmsr")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.ExpectCallFunc(vmcs_resume).Do(test_vmcs_resume);
+
+    g_state_save.rip = 0;
+    g_state_save.rcx = 0x10;
+    g_state_save.rax = 0x1;
+    g_state_save.rdx = 0x2;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::wrmsr);
+
+    CHECK(g_state_save.rip == g_exit_instruction_length);
+    CHECK(g_msrs[0x10] == 0x0000000200000001UL);
+}
+
+TEST_CASE("exit_handler: fast_path_wrmsr_vmcs_field")
+{
+    MockRepository mocks;
+    exit_handler_fast_path_ut ehlr;
+
+    setup_intrinsics(mocks);
+    mocks.NeverCallFunc(vmcs_resume);
+
+    g_state_save.rip = 0;
+    g_state_save.rcx = intel_x64::msrs::ia32_gs_base::addr;
+    exit_handler_fast_path(&ehlr, vmcs::exit_reason::basic_exit_reason::wrmsr);
+
+    CHECK(g_state_save.rip == 0);
+    CHECK(!ehlr.m_halted);
+}
+
+constexpr const auto NUM_ITERATIONS = 0x10000U;
+
+TEST_CASE("exit_handler: fast_path_benchmark")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto vmcs = mocks.Mock<vmcs_intel_x64>();
+    mocks.OnCall(vmcs, vmcs_intel_x64::resume);
+    mocks.OnCallFunc(vmcs_resume).Do(test_vmcs_resume);
+
+    exit_handler_fast_path_ut ehlr;
+    ehlr.set_vmcs(vmcs);
+
+    g_exit_reason = vmcs::exit_reason::basic_exit_reason::cpuid;
+
+    bfdebug_lnbr(0);
+    bfdebug_info(0, "cpuid round trip");
+    bfdebug_brk2(0);
+
+    bfdebug_ndec(0, "dispatch", benchmark([&] {
+        for (auto i = 0U; i < NUM_ITERATIONS; i++)
+        { ehlr.dispatch(); }
+    }));
+
+    bfdebug_ndec(0, "fast path", benchmark([&] {
+        for (auto i = 0U; i < NUM_ITERATIONS; i++)
+        { exit_handler_fast_path(&ehlr, g_exit_reason); }
+    }));
+}
+
 #endif
@@ -0,0 +1,335 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <bfbenchmark.h>
+
+#include <vmcs/vmcs_intel_x64.h>
+#include <intrinsics/x86/common_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#include <exit_handler/exit_handler_intel_x64.h>
+#include <exit_handler/exit_trace_intel_x64.h>
+
+#include <map>
+#include <vector>
+#include <fstream>
+#include <cstdlib>
+
+// -----------------------------------------------------------------------------
+// Exit Replay
+// -----------------------------------------------------------------------------
+//
+// Feeds a trace recorded by exit_trace_intel_x64 through the exit handler,
+// with the intrinsics mocks returning the recorded values. This makes it
+// possible to benchmark the handlers against the exit mix of a real
+// workload without VT-x hardware.
+//
+// To replay a recorded trace, set BF_EXIT_TRACE to the path of a trace
+// file (the records returned by VMCALL_EXIT_TRACE_READ, back to back).
+// Otherwise, a synthetic trace is replayed.
+//
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace x64;
+using namespace intel_x64;
+
+using trace_type = std::vector<exit_trace_record_t>;
+
+static const exit_trace_record_t *g_record = nullptr;
+static state_save_intel_x64 g_state_save{};
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    switch (field) {
+        case vmcs::exit_reason::addr:
+            *val = g_record->reason;
+            break;
+        case vmcs::exit_qualification::addr:
+            *val = g_record->qualification;
+            break;
+        case vmcs::vm_exit_instruction_length::addr:
+            *val = g_record->instruction_length;
+            break;
+        case vmcs::vm_exit_instruction_information::addr:
+            *val = g_record->instruction_information;
+            break;
+        default:
+            *val = 0;
+            break;
+    }
+
+    return true;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    bfignored(field);
+    bfignored(val);
+
+    return true;
+}
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{
+    bfignored(addr);
+    return 0;
+}
+
+static void
+test_write_msr(uint32_t addr, uint64_t val) noexcept
+{
+    bfignored(addr);
+    bfignored(val);
+}
+
+static void
+test_stop() noexcept
+{ }
+
+static void
+test_wbinvd() noexcept
+{ }
+
+static void
+test_cpuid(void *eax, void *ebx, void *ecx, void *edx) noexcept
+{
+    bfignored(eax);
+    bfignored(ebx);
+    bfignored(ecx);
+    bfignored(edx);
+}
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+    mocks.OnCallFunc(_write_msr).Do(test_write_msr);
+    mocks.OnCallFunc(_stop).Do(test_stop);
+    mocks.OnCallFunc(_wbinvd).Do(test_wbinvd);
+    mocks.OnCallFunc(_cpuid).Do(test_cpuid);
+}
+
+static auto
+setup_ehlr(MockRepository &mocks)
+{
+    auto vmcs = mocks.Mock<vmcs_intel_x64>();
+
+    mocks.OnCall(vmcs, vmcs_intel_x64::resume);
+    mocks.OnCall(vmcs, vmcs_intel_x64::promote);
+
+    auto ehlr = exit_handler_intel_x64{};
+    ehlr.set_vmcs(vmcs);
+    ehlr.set_state_save(&g_state_save);
+
+    return ehlr;
+}
+
+static auto
+make_record(uint64_t reason, uint64_t length, uint64_t rcx = 0)
+{
+    exit_trace_record_t record{};
+
+    record.reason = reason;
+    record.instruction_length = length;
+    record.rip = 0x1000;
+    record.rcx = rcx;
+    record.outcome = EXIT_TRACE_OUTCOME_RESUMED | EXIT_TRACE_OUTCOME_ADVANCED;
+
+    return record;
+}
+
+static trace_type
+synthetic_trace()
+{
+    namespace reason = vmcs::exit_reason::basic_exit_reason;
+
+    trace_type trace;
+
+    for (auto i = 0U; i < 0x1000U; i++) {
+        switch (i % 8) {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+                trace.push_back(make_record(reason::cpuid, 2));
+                break;
+
+            case 4:
+                trace.push_back(make_record(reason::rdmsr, 2, intel_x64::msrs::ia32_efer::addr));
+                break;
+
+            case 5:
+                trace.push_back(make_record(reason::wrmsr, 2, intel_x64::msrs::ia32_gs_base::addr));
+                break;
+
+            case 6:
+                trace.push_back(make_record(reason::pause, 2));
+                break;
+
+            default:
+                trace.push_back(make_record(reason::invd, 2));
+                break;
+        }
+    }
+
+    return trace;
+}
+
+static trace_type
+load_trace()
+{
+    auto &&path = std::getenv("BF_EXIT_TRACE");
+
+    if (path == nullptr) {
+        return synthetic_trace();
+    }
+
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file) {
+        throw std::runtime_error("unable to open the exit trace");
+    }
+
+    trace_type trace;
+    exit_trace_record_t record{};
+
+    while (file.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+        trace.push_back(record);
+    }
+
+    return trace;
+}
+
+static auto
+replay(exit_handler_intel_x64 &ehlr, const exit_trace_record_t &record)
+{
+    g_record = &record;
+
+    g_state_save.rip = record.rip;
+    g_state_save.rax = record.rax;
+    g_state_save.rbx = record.rbx;
+    g_state_save.rcx = record.rcx;
+    g_state_save.rdx = record.rdx;
+    g_state_save.rsi = record.rsi;
+    g_state_save.rdi = record.rdi;
+    g_state_save.r08 = record.r08;
+    g_state_save.r09 = record.r09;
+
+    ehlr.dispatch();
+    return g_state_save.rip != record.rip;
+}
+
+TEST_CASE("exit_handler_replay: synthetic_trace")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto ehlr = setup_ehlr(mocks);
+
+    auto &&trace = synthetic_trace();
+
+    for (const auto &record : trace) {
+        auto &&advanced = replay(ehlr, record);
+        CHECK(advanced == ((record.outcome & EXIT_TRACE_OUTCOME_ADVANCED) != 0));
+    }
+}
+
+TEST_CASE("exit_handler_replay: deterministic")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto ehlr = setup_ehlr(mocks);
+
+    auto &&trace = load_trace();
+
+    std::vector<uint64_t> first;
+    std::vector<uint64_t> second;
+
+    for (const auto &record : trace) {
+        replay(ehlr, record);
+        first.push_back(g_state_save.rax ^ g_state_save.rip);
+    }
+
+    for (const auto &record : trace) {
+        replay(ehlr, record);
+        second.push_back(g_state_save.rax ^ g_state_save.rip);
+    }
+
+    CHECK(first == second);
+}
+
+constexpr const auto NUM_REPLAYS = 0x10U;
+
+TEST_CASE("exit_handler_replay: benchmark")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+    auto ehlr = setup_ehlr(mocks);
+
+    auto &&trace = load_trace();
+    auto mismatches = 0ULL;
+
+    std::map<uint64_t, uint64_t> mix;
+
+    for (const auto &record : trace) {
+        auto &&advanced = replay(ehlr, record);
+
+        if (advanced != ((record.outcome & EXIT_TRACE_OUTCOME_ADVANCED) != 0)) {
+            mismatches++;
+        }
+
+        mix[vmcs::exit_reason::basic_exit_reason::get(record.reason)]++;
+    }
+
+    bfdebug_lnbr(0);
+    bfdebug_info(0, "exit replay");
+    bfdebug_subndec(0, "exits", trace.size());
+    bfdebug_subndec(0, "outcome mismatches", mismatches);
+    bfdebug_brk2(0);
+
+    CHECK(mismatches == 0);
+
+    for (const auto &reason : mix) {
+        bfdebug_subndec(0, vmcs::exit_reason::basic_exit_reason::basic_exit_reason_description(reason.first),
+                        reason.second);
+    }
+
+    bfdebug_brk2(0);
+
+    bfdebug_ndec(0, "replay (us)", benchmark([&] {
+        for (auto i = 0U; i < NUM_REPLAYS; i++) {
+            for (const auto &record : trace)
+            { replay(ehlr, record); }
+        }
+    }));
+
+    bfdebug_brk2(0);
+}
+
+#endif
@@ -0,0 +1,203 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <exit_handler/exit_trace_intel_x64.h>
+#include <intrinsics/x86/common_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+static uint64_t g_tsc = 0;
+
+static uint64_t
+test_read_tsc() noexcept
+{ return g_tsc; }
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_tsc = 0;
+    mocks.OnCallFunc(_read_tsc).Do(test_read_tsc);
+}
+
+static void
+trace_exit(exit_trace_intel_x64 &trace, state_save_intel_x64 &state,
+           uint64_t reason, uint64_t begin_tsc, uint64_t end_tsc, uint64_t len = 0)
+{
+    g_tsc = begin_tsc;
+    trace.begin(reason, 0x10, len, 0x20, state);
+
+    state.rip += len;
+
+    g_tsc = end_tsc;
+    trace.end(state, EXIT_TRACE_OUTCOME_RESUMED);
+}
+
+TEST_CASE("exit_trace: disabled_by_default")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    state_save_intel_x64 state{};
+    exit_trace_intel_x64 trace;
+
+    trace_exit(trace, state, 10, 100, 200);
+
+    CHECK_FALSE(trace.is_enabled());
+    CHECK(trace.size() == 0);
+}
+
+TEST_CASE("exit_trace: enable_invalid")
+{
+    exit_trace_intel_x64 trace;
+
+    CHECK_THROWS(trace.enable(0));
+    CHECK_THROWS(trace.enable(exit_trace_intel_x64::max_num_records + 1));
+    CHECK_FALSE(trace.is_enabled());
+    CHECK(trace.capacity() == 0);
+}
+
+TEST_CASE("exit_trace: record")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    state_save_intel_x64 state{};
+    exit_trace_intel_x64 trace;
+
+    state.rip = 0x1000;
+    state.rax = 1;
+    state.rbx = 2;
+    state.rcx = 3;
+    state.rdx = 4;
+    state.rsi = 5;
+    state.rdi = 6;
+    state.r08 = 7;
+    state.r09 = 8;
+
+    trace.enable(4);
+    trace_exit(trace, state, 10, 100, 150, 2);
+    trace_exit(trace, state, 31, 400, 420);
+
+    exit_trace_record_t records[4] = {};
+    exit_trace_intel_x64::size_type dropped = 0;
+
+    CHECK(trace.read(records, dropped) == 2);
+    CHECK(dropped == 0);
+
+    CHECK(records[0].reason == 10);
+    CHECK(records[0].qualification == 0x10);
+    CHECK(records[0].instruction_length == 2);
+    CHECK(records[0].instruction_information == 0x20);
+    CHECK(records[0].rip == 0x1000);
+    CHECK(records[0].rax == 1);
+    CHECK(records[0].rbx == 2);
+    CHECK(records[0].rcx == 3);
+    CHECK(records[0].rdx == 4);
+    CHECK(records[0].rsi == 5);
+    CHECK(records[0].rdi == 6);
+    CHECK(records[0].r08 == 7);
+    CHECK(records[0].r09 == 8);
+    CHECK(records[0].tsc_delta == 0);
+    CHECK(records[0].handler_tsc == 50);
+    CHECK(records[0].outcome == (EXIT_TRACE_OUTCOME_RESUMED | EXIT_TRACE_OUTCOME_ADVANCED));
+
+    CHECK(records[1].reason == 31);
+    CHECK(records[1].rip == 0x1002);
+    CHECK(records[1].tsc_delta == 250);
+    CHECK(records[1].handler_tsc == 20);
+    CHECK(records[1].outcome == EXIT_TRACE_OUTCOME_RESUMED);
+
+    CHECK(trace.size() == 0);
+}
+
+TEST_CASE("exit_trace: end_without_begin")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    state_save_intel_x64 state{};
+    exit_trace_intel_x64 trace;
+
+    trace.enable(4);
+    trace.end(state, EXIT_TRACE_OUTCOME_RESUMED);
+
+    CHECK(trace.size() == 0);
+}
+
+TEST_CASE("exit_trace: full")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    state_save_intel_x64 state{};
+    exit_trace_intel_x64 trace;
+
+    trace.enable(2);
+    trace_exit(trace, state, 1, 100, 110);
+    trace_exit(trace, state, 2, 200, 210);
+    trace_exit(trace, state, 3, 300, 310);
+
+    CHECK(trace.size() == 2);
+
+    exit_trace_record_t records[1] = {};
+    exit_trace_intel_x64::size_type dropped = 0;
+
+    CHECK(trace.read(records, dropped) == 1);
+    CHECK(records[0].reason == 1);
+    CHECK(dropped == 1);
+
+    trace_exit(trace, state, 4, 400, 410);
+
+    CHECK(trace.read(records, dropped) == 1);
+    CHECK(records[0].reason == 2);
+    CHECK(dropped == 0);
+
+    CHECK(trace.read(records, dropped) == 1);
+    CHECK(records[0].reason == 4);
+}
+
+TEST_CASE("exit_trace: disable_keeps_records")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    state_save_intel_x64 state{};
+    exit_trace_intel_x64 trace;
+
+    trace.enable(4);
+    trace_exit(trace, state, 1, 100, 110);
+    trace.disable();
+    trace_exit(trace, state, 2, 200, 210);
+
+    CHECK_FALSE(trace.is_enabled());
+    CHECK(trace.size() == 1);
+
+    trace.enable(4);
+    CHECK(trace.size() == 1);
+
+    trace.enable(8);
+    CHECK(trace.size() == 0);
+}
+
+#endif
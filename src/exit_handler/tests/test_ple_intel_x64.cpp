@@ -0,0 +1,240 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <exit_handler/ple_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#include <map>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+static std::map<uint64_t, uint64_t> g_vmcs;
+static std::map<uint32_t, uint64_t> g_msrs;
+static uint64_t g_vmwrite_count = 0;
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    *val = g_vmcs[field];
+    return true;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmwrite_count++;
+
+    g_vmcs[field] = val;
+    return true;
+}
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_vmcs.clear();
+    g_vmwrite_count = 0;
+
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = 0xFFFFFFFF00000000ULL;
+
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+}
+
+static auto
+secondary_ctls()
+{ return g_vmcs[vmcs::secondary_processor_based_vm_execution_controls::addr]; }
+
+static auto
+ple_window()
+{ return g_vmcs[vmcs::ple_window::addr]; }
+
+TEST_CASE("ple: disabled_by_default")
+{
+    ple_intel_x64 ple;
+
+    CHECK_FALSE(ple.is_enabled());
+    CHECK(ple.counters().exits == 0);
+}
+
+TEST_CASE("ple: enable")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ple_intel_x64 ple;
+
+    CHECK_THROWS(ple.enable(0, 0x1000, 0x4000));
+    CHECK_THROWS(ple.enable(0x80, 0, 0x4000));
+    CHECK_THROWS(ple.enable(0x80, 0x1000, 0x800));
+    CHECK_NOTHROW(ple.enable(0x80, 0x1000, 0x4000));
+
+    CHECK(ple.is_enabled());
+    CHECK(ple.gap() == 0x80);
+    CHECK(ple.window() == 0x1000);
+    CHECK(g_vmcs[vmcs::ple_gap::addr] == 0x80);
+    CHECK(ple_window() == 0x1000);
+    CHECK((secondary_ctls() & vmcs::secondary_processor_based_vm_execution_controls::pause_loop_exiting::mask) != 0);
+}
+
+TEST_CASE("ple: enable_clamps_to_32bits")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ple_intel_x64 ple;
+
+    CHECK_NOTHROW(ple.enable(0x100000000ULL, 0x100000000ULL, 0x100000000ULL));
+    CHECK(ple.gap() == 0xFFFFFFFFULL);
+    CHECK(ple.window() == 0xFFFFFFFFULL);
+}
+
+TEST_CASE("ple: enable_not_supported")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = 0;
+
+    ple_intel_x64 ple;
+
+    CHECK_THROWS(ple.enable());
+    CHECK_FALSE(ple.is_enabled());
+}
+
+TEST_CASE("ple: disable")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    ple_intel_x64 ple;
+
+    CHECK_NOTHROW(ple.disable());
+    CHECK(g_vmwrite_count == 0);
+
+    CHECK_NOTHROW(ple.enable());
+    CHECK_NOTHROW(ple.disable());
+
+    CHECK_FALSE(ple.is_enabled());
+    CHECK((secondary_ctls() & vmcs::secondary_processor_based_vm_execution_controls::pause_loop_exiting::mask) == 0);
+}
+
+TEST_CASE("ple: useless_exits_grow_the_window")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    ple_intel_x64 ple;
+
+    ple.enable(0x80, 0x1000, 0x4000);
+
+    ple.pause_exit(false, failed);
+    CHECK(ple.window() == 0x2000);
+    CHECK(ple_window() == 0x2000);
+
+    ple.pause_exit(false, failed);
+    ple.pause_exit(false, failed);
+    CHECK(ple.window() == 0x4000);
+    CHECK(ple_window() == 0x4000);
+
+    CHECK(ple.counters().exits == 3);
+    CHECK(ple.counters().useful_exits == 0);
+    CHECK(ple.counters().grows == 2);
+    CHECK(ple.counters().shrinks == 0);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("ple: useful_exits_shrink_the_window")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    ple_intel_x64 ple;
+
+    ple.enable(0x80, 0x1000, 0x4000);
+
+    ple.pause_exit(false, failed);
+    ple.pause_exit(false, failed);
+    ple.pause_exit(true, failed);
+    CHECK(ple.window() == 0x2000);
+    CHECK(ple_window() == 0x2000);
+
+    ple.pause_exit(true, failed);
+    ple.pause_exit(true, failed);
+    CHECK(ple.window() == 0x1000);
+    CHECK(ple_window() == 0x1000);
+
+    CHECK(ple.counters().exits == 5);
+    CHECK(ple.counters().useful_exits == 3);
+    CHECK(ple.counters().grows == 2);
+    CHECK(ple.counters().shrinks == 2);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("ple: fixed_window")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    ple_intel_x64 ple;
+
+    ple.enable(0x80, 0x1000, 0);
+    g_vmwrite_count = 0;
+
+    ple.pause_exit(false, failed);
+    ple.pause_exit(true, failed);
+
+    CHECK(ple.window() == 0x1000);
+    CHECK(ple.counters().exits == 2);
+    CHECK(g_vmwrite_count == 0);
+}
+
+TEST_CASE("ple: reset_counters")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    ple_intel_x64 ple;
+
+    ple.enable();
+    ple.pause_exit(false, failed);
+    ple.reset_counters();
+
+    CHECK(ple.counters().exits == 0);
+    CHECK(ple.counters().grows == 0);
+    CHECK(ple.window() == ple_intel_x64::default_window << 1);
+}
+
+#endif
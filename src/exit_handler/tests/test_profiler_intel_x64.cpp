@@ -0,0 +1,272 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <exit_handler/profiler_intel_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#include <map>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+static std::map<uint64_t, uint64_t> g_vmcs;
+static std::map<uint32_t, uint64_t> g_msrs;
+static uint64_t g_vmwrite_count = 0;
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    *val = g_vmcs[field];
+    return true;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmwrite_count++;
+
+    g_vmcs[field] = val;
+    return true;
+}
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_vmcs.clear();
+    g_vmwrite_count = 0;
+
+    g_msrs[msrs::ia32_vmx_true_pinbased_ctls::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_true_exit_ctls::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_misc::addr] = 0x5ULL;
+
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+}
+
+static auto
+pin_ctls()
+{ return g_vmcs[vmcs::pin_based_vm_execution_controls::addr]; }
+
+static auto
+exit_ctls()
+{ return g_vmcs[vmcs::vm_exit_controls::addr]; }
+
+static auto
+timer_value()
+{ return g_vmcs[vmcs::vmx_preemption_timer_value::addr]; }
+
+TEST_CASE("profiler: disabled_by_default")
+{
+    profiler_intel_x64 profiler;
+
+    CHECK_FALSE(profiler.is_enabled());
+    CHECK(profiler.size() == 0);
+}
+
+TEST_CASE("profiler: enable")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    profiler_intel_x64 profiler;
+
+    CHECK_THROWS(profiler.enable(0));
+    CHECK_NOTHROW(profiler.enable(0x1000));
+
+    CHECK(profiler.is_enabled());
+    CHECK(profiler.timer_value() == 0x80);
+    CHECK(timer_value() == 0x80);
+    CHECK((pin_ctls() & vmcs::pin_based_vm_execution_controls::activate_vmx_preemption_timer::mask) != 0);
+    CHECK((exit_ctls() & vmcs::vm_exit_controls::save_vmx_preemption_timer_value::mask) != 0);
+}
+
+TEST_CASE("profiler: enable_not_supported")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    g_msrs[msrs::ia32_vmx_true_pinbased_ctls::addr] = 0;
+
+    profiler_intel_x64 profiler;
+
+    CHECK_THROWS(profiler.enable(0x1000));
+    CHECK_FALSE(profiler.is_enabled());
+}
+
+TEST_CASE("profiler: enable_clamps_timer_value")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    profiler_intel_x64 profiler;
+
+    CHECK_NOTHROW(profiler.enable(0x1));
+    CHECK(profiler.timer_value() == 0x1);
+
+    CHECK_NOTHROW(profiler.enable(0xFFFFFFFFFFFFFFFFULL));
+    CHECK(profiler.timer_value() == 0xFFFFFFFFULL);
+}
+
+TEST_CASE("profiler: disable")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    profiler_intel_x64 profiler;
+
+    CHECK_NOTHROW(profiler.disable());
+    CHECK(g_vmwrite_count == 0);
+
+    CHECK_NOTHROW(profiler.enable(0x1000));
+    CHECK_NOTHROW(profiler.disable());
+
+    CHECK_FALSE(profiler.is_enabled());
+    CHECK((pin_ctls() & vmcs::pin_based_vm_execution_controls::activate_vmx_preemption_timer::mask) == 0);
+    CHECK((exit_ctls() & vmcs::vm_exit_controls::save_vmx_preemption_timer_value::mask) == 0);
+}
+
+TEST_CASE("profiler: sample_when_disabled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto &&failed = false;
+    profiler_intel_x64 profiler;
+
+    profiler.sample(0x1000, 0x2000, 0, failed);
+
+    CHECK(profiler.size() == 0);
+    CHECK(g_vmwrite_count == 0);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("profiler: sample_and_read")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto &&failed = false;
+    profiler_intel_x64 profiler;
+
+    CHECK_NOTHROW(profiler.enable(0x1000));
+
+    profiler.sample(0x1000, 0xA000, 0, failed);
+    profiler.sample(0x2000, 0xB000, 3, failed);
+    profiler.sample(0x3000, 0xC000, 3, failed);
+
+    CHECK(profiler.size() == 3);
+
+    profiler_sample_t samples[2] = {};
+    profiler_intel_x64::size_type dropped = 0;
+
+    CHECK(profiler.read(samples, dropped) == 2);
+    CHECK(dropped == 0);
+    CHECK(samples[0].rip == 0x1000);
+    CHECK(samples[0].cr3 == 0xA000);
+    CHECK(samples[0].cpl == 0);
+    CHECK(samples[1].rip == 0x2000);
+    CHECK(samples[1].cr3 == 0xB000);
+    CHECK(samples[1].cpl == 3);
+
+    CHECK(profiler.read(samples, dropped) == 1);
+    CHECK(samples[0].rip == 0x3000);
+
+    CHECK(profiler.read(samples, dropped) == 0);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("profiler: sample_ring_full")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto &&failed = false;
+    profiler_intel_x64 profiler(2);
+
+    CHECK_NOTHROW(profiler.enable(0x1000));
+
+    profiler.sample(0x1000, 0, 0, failed);
+    profiler.sample(0x2000, 0, 0, failed);
+    profiler.sample(0x3000, 0, 0, failed);
+    profiler.sample(0x4000, 0, 0, failed);
+
+    profiler_sample_t samples[4] = {};
+    profiler_intel_x64::size_type dropped = 0;
+
+    CHECK(profiler.read(samples, dropped) == 2);
+    CHECK(dropped == 2);
+    CHECK(samples[0].rip == 0x1000);
+    CHECK(samples[1].rip == 0x2000);
+
+    profiler.sample(0x5000, 0, 0, failed);
+
+    CHECK(profiler.read(samples, dropped) == 1);
+    CHECK(dropped == 0);
+    CHECK(samples[0].rip == 0x5000);
+}
+
+TEST_CASE("profiler: sample_rearms_timer")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto &&failed = false;
+    profiler_intel_x64 profiler;
+
+    CHECK_NOTHROW(profiler.enable(0x1000));
+
+    g_vmcs[vmcs::vmx_preemption_timer_value::addr] = 0;
+    profiler.sample(0x1000, 0, 0, failed);
+
+    CHECK(timer_value() == 0x80);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("profiler: sample_without_save_does_not_rearm")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    g_msrs[msrs::ia32_vmx_true_exit_ctls::addr] = 0;
+
+    auto &&failed = false;
+    profiler_intel_x64 profiler;
+
+    CHECK_NOTHROW(profiler.enable(0x1000));
+    CHECK((exit_ctls() & vmcs::vm_exit_controls::save_vmx_preemption_timer_value::mask) == 0);
+
+    g_vmwrite_count = 0;
+    profiler.sample(0x1000, 0, 0, failed);
+
+    CHECK(profiler.size() == 1);
+    CHECK(g_vmwrite_count == 0);
+}
+
+#endif
@@ -0,0 +1,332 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+
+#include <bfjson.h>
+#include <bfdebug.h>
+#include <bfbenchmark.h>
+
+#include <exit_handler/vmcall_cbor.h>
+
+#include <vector>
+#include <functional>
+
+static auto
+encode(const std::function<void(cbor_encoder &)> &func)
+{
+    std::vector<char> buf(0x100);
+    cbor_encoder encoder(gsl::span<char>(buf.data(), gsl::narrow_cast<std::ptrdiff_t>(buf.size())));
+
+    func(encoder);
+
+    buf.resize(encoder.size());
+    return buf;
+}
+
+static auto
+bytes(std::initializer_list<uint8_t> list)
+{
+    std::vector<char> buf;
+
+    for (auto byte : list) {
+        buf.push_back(static_cast<char>(byte));
+    }
+
+    return buf;
+}
+
+static auto
+span(const std::vector<char> &buf)
+{ return gsl::span<const char>(buf.data(), gsl::narrow_cast<std::ptrdiff_t>(buf.size())); }
+
+TEST_CASE("cbor: encode_uint")
+{
+    CHECK(encode([](auto & e) { e.encode_uint(0); }) == bytes({0x00}));
+    CHECK(encode([](auto & e) { e.encode_uint(23); }) == bytes({0x17}));
+    CHECK(encode([](auto & e) { e.encode_uint(24); }) == bytes({0x18, 0x18}));
+    CHECK(encode([](auto & e) { e.encode_uint(0xFF); }) == bytes({0x18, 0xFF}));
+    CHECK(encode([](auto & e) { e.encode_uint(0x100); }) == bytes({0x19, 0x01, 0x00}));
+    CHECK(encode([](auto & e) { e.encode_uint(0x10000); }) == bytes({0x1A, 0x00, 0x01, 0x00, 0x00}));
+    CHECK(encode([](auto & e) { e.encode_uint(0x100000000); }) == bytes({0x1B, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00}));
+}
+
+TEST_CASE("cbor: encode_int")
+{
+    CHECK(encode([](auto & e) { e.encode_int(10); }) == bytes({0x0A}));
+    CHECK(encode([](auto & e) { e.encode_int(-1); }) == bytes({0x20}));
+    CHECK(encode([](auto & e) { e.encode_int(-25); }) == bytes({0x38, 0x18}));
+    CHECK(encode([](auto & e) { e.encode_int(-1000); }) == bytes({0x39, 0x03, 0xE7}));
+}
+
+TEST_CASE("cbor: encode_simple")
+{
+    CHECK(encode([](auto & e) { e.encode_bool(false); }) == bytes({0xF4}));
+    CHECK(encode([](auto & e) { e.encode_bool(true); }) == bytes({0xF5}));
+    CHECK(encode([](auto & e) { e.encode_null(); }) == bytes({0xF6}));
+}
+
+TEST_CASE("cbor: encode_strings")
+{
+    CHECK(encode([](auto & e) { e.encode_text("IETF"); }) == bytes({0x64, 0x49, 0x45, 0x54, 0x46}));
+    CHECK(encode([](auto & e) { e.encode_text(""); }) == bytes({0x60}));
+
+    auto &&data = bytes({0x01, 0x02, 0x03, 0x04});
+    CHECK(encode([&](auto & e) { e.encode_bytes(span(data)); }) == bytes({0x44, 0x01, 0x02, 0x03, 0x04}));
+}
+
+TEST_CASE("cbor: encode_containers")
+{
+    auto &&buf = encode([](auto & e) {
+        e.encode_map(2);
+        e.encode_text("a");
+        e.encode_uint(1);
+        e.encode_text("b");
+        e.encode_array(2);
+        e.encode_uint(2);
+        e.encode_uint(3);
+    });
+
+    CHECK(buf == bytes({0xA2, 0x61, 0x61, 0x01, 0x61, 0x62, 0x82, 0x02, 0x03}));
+}
+
+TEST_CASE("cbor: encode_buffer_too_small")
+{
+    char buf[4] = {};
+    cbor_encoder encoder(gsl::span<char>(buf, 4));
+
+    CHECK_NOTHROW(encoder.encode_uint(1));
+    CHECK_THROWS(encoder.encode_uint(0x100000000));
+    CHECK_THROWS(encoder.encode_text("hello"));
+    CHECK(encoder.size() == 1);
+
+    CHECK_NOTHROW(encoder.encode_text("he"));
+    CHECK(encoder.size() == 4);
+    CHECK_THROWS(encoder.encode_null());
+}
+
+TEST_CASE("cbor: decode_round_trip")
+{
+    auto &&data = bytes({0xDE, 0xAD});
+    auto &&buf = encode([&](auto & e) {
+        e.encode_map(1);
+        e.encode_text("values");
+        e.encode_array(7);
+        e.encode_uint(0x100000000);
+        e.encode_int(-1000);
+        e.encode_bool(true);
+        e.encode_bool(false);
+        e.encode_null();
+        e.encode_bytes(span(data));
+        e.encode_text("end");
+    });
+
+    cbor_decoder decoder(span(buf));
+
+    CHECK(decoder.peek() == cbor::map);
+    CHECK(decoder.decode_map() == 1);
+    CHECK(std::string(decoder.decode_text().data(), 6) == "values");
+    CHECK(decoder.decode_array() == 7);
+    CHECK(decoder.decode_uint() == 0x100000000);
+    CHECK(decoder.decode_int() == -1000);
+    CHECK(decoder.decode_bool());
+    CHECK_FALSE(decoder.decode_bool());
+    CHECK_NOTHROW(decoder.decode_null());
+
+    auto &&bytes = decoder.decode_bytes();
+    CHECK(bytes.size() == 2);
+    CHECK(bytes.data() == &buf.at(buf.size() - 6));
+
+    CHECK(decoder.decode_text().size() == 3);
+    CHECK(decoder.empty());
+}
+
+TEST_CASE("cbor: decode_unexpected_type")
+{
+    auto &&buf = bytes({0x61, 0x61});
+    cbor_decoder decoder(span(buf));
+
+    CHECK_THROWS(decoder.decode_uint());
+    CHECK_THROWS(decoder.decode_int());
+    CHECK_THROWS(decoder.decode_bool());
+    CHECK_THROWS(decoder.decode_null());
+    CHECK_THROWS(decoder.decode_bytes());
+    CHECK_THROWS(decoder.decode_array());
+    CHECK_THROWS(decoder.decode_map());
+
+    CHECK(decoder.decode_text().size() == 1);
+}
+
+TEST_CASE("cbor: decode_truncated")
+{
+    auto &&empty = std::vector<char>();
+    CHECK_THROWS(cbor_decoder(span(empty)).peek());
+
+    auto &&head = bytes({0x19, 0x01});
+    CHECK_THROWS(cbor_decoder(span(head)).decode_uint());
+
+    auto &&text = bytes({0x64, 0x49, 0x45});
+    cbor_decoder decoder(span(text));
+    CHECK_THROWS(decoder.decode_text());
+    CHECK(decoder.peek() == cbor::text_string);
+}
+
+TEST_CASE("cbor: decode_indefinite_length")
+{
+    auto &&buf = bytes({0x9F, 0x01, 0xFF});
+    CHECK_THROWS(cbor_decoder(span(buf)).decode_array());
+    CHECK_THROWS(cbor_decoder(span(buf)).decode_raw());
+}
+
+TEST_CASE("cbor: decode_int_out_of_range")
+{
+    auto &&buf = bytes({0x1B, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CHECK_THROWS(cbor_decoder(span(buf)).decode_int());
+    CHECK(cbor_decoder(span(buf)).decode_uint() == 0x8000000000000000);
+}
+
+TEST_CASE("cbor: decode_raw")
+{
+    auto &&buf = bytes({0xA1, 0x61, 0x61, 0x82, 0xC1, 0x01, 0x61, 0x62, 0x07});
+    cbor_decoder decoder(span(buf));
+
+    auto &&item = decoder.decode_raw();
+    CHECK(item.data() == buf.data());
+    CHECK(item.size() == 8);
+    CHECK(decoder.decode_uint() == 7);
+    CHECK(decoder.empty());
+}
+
+TEST_CASE("cbor: decode_raw_deeply_nested")
+{
+    auto &&buf = std::vector<char>(0x10000, static_cast<char>(0x81));
+    buf.push_back(0x00);
+
+    cbor_decoder decoder(span(buf));
+
+    CHECK(decoder.decode_raw().size() == 0x10001);
+    CHECK(decoder.empty());
+}
+
+TEST_CASE("cbor: decode_raw_truncated")
+{
+    auto &&array = bytes({0x9B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00});
+    cbor_decoder decoder1(span(array));
+    CHECK_THROWS(decoder1.decode_raw());
+    CHECK(decoder1.peek() == cbor::array);
+
+    auto &&map = bytes({0xA2, 0x01, 0x02, 0x03});
+    CHECK_THROWS(cbor_decoder(span(map)).decode_raw());
+}
+
+// -----------------------------------------------------------------------------
+// Benchmark
+// -----------------------------------------------------------------------------
+
+static auto
+make_json(uint64_t size)
+{
+    std::string str = "{";
+
+    for (auto i = 0ULL; str.size() < size - 32; i++) {
+        if (i != 0) {
+            str += ",";
+        }
+
+        str += "\"key" + std::to_string(i) + "\":" + std::to_string(i * 1000);
+    }
+
+    return str + "}";
+}
+
+static auto
+make_cbor(uint64_t size)
+{
+    auto &&num = 0ULL;
+    for (auto len = 1ULL; len < size - 32; num++) {
+        len += 4 + std::to_string(num).size() + 5;
+    }
+
+    std::vector<char> buf(size * 2);
+    cbor_encoder encoder(gsl::span<char>(buf.data(), gsl::narrow_cast<std::ptrdiff_t>(buf.size())));
+
+    encoder.encode_map(num);
+    for (auto i = 0ULL; i < num; i++) {
+        auto &&key = "key" + std::to_string(i);
+
+        encoder.encode_text(key.c_str());
+        encoder.encode_uint(i * 1000);
+    }
+
+    buf.resize(encoder.size());
+    return buf;
+}
+
+static void
+benchmark_document(uint64_t size, uint64_t iterations)
+{
+    auto &&jstr = make_json(size);
+    auto &&cbuf = make_cbor(size);
+    auto &&obuf = std::vector<char>(size * 2);
+    auto &&ospan = gsl::span<char>(obuf.data(), gsl::narrow_cast<std::ptrdiff_t>(obuf.size()));
+
+    bfdebug_subndec(0, "json bytes", jstr.size());
+    bfdebug_subndec(0, "cbor bytes", cbuf.size());
+
+    bfdebug_ndec(0, "json", benchmark([&] {
+        for (auto i = 0ULL; i < iterations; i++) {
+            auto &&ijson = json::parse(std::string(jstr.data(), jstr.size()));
+            auto &&dmp = ijson.dump();
+
+            memcpy(ospan.data(), dmp.data(), dmp.size());
+        }
+    }));
+
+    bfdebug_ndec(0, "cbor", benchmark([&] {
+        for (auto i = 0ULL; i < iterations; i++) {
+            cbor_decoder decoder(span(cbuf));
+            cbor_encoder encoder(ospan);
+
+            auto &&num = decoder.decode_map();
+            encoder.encode_map(num);
+
+            for (auto j = 0ULL; j < num; j++) {
+                encoder.encode_text(decoder.decode_text());
+                encoder.encode_uint(decoder.decode_uint());
+            }
+        }
+    }));
+}
+
+TEST_CASE("cbor: benchmark")
+{
+    bfdebug_lnbr(0);
+    bfdebug_info(0, "vmcall data parse + reply");
+    bfdebug_brk2(0);
+
+    bfdebug_info(0, "1 KiB document");
+    benchmark_document(0x400, 0x1000);
+
+    bfdebug_info(0, "64 KiB document");
+    benchmark_document(0x10000, 0x40);
+
+    bfdebug_brk2(0);
+}
@@ -0,0 +1,317 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <exit_handler/xstate_intel_x64.h>
+#include <intrinsics/x86/common_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+#include <map>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+static state_save_intel_x64 g_state_save{};
+
+static uint64_t g_cr4 = 0;
+static uint64_t g_xcr0 = 0x7;
+static uint64_t g_xsaveopt_count = 0;
+static void *g_xsaveopt_area = nullptr;
+static uint64_t g_cpuid_subecx_count = 0;
+static uint64_t g_xsaveopt_rfbm = 0;
+static uint64_t g_gs_base = 0;
+static bool g_vmcs_fails = false;
+
+static std::map<uint64_t, uint64_t> g_vmcs;
+
+static uint64_t
+test_read_cr4() noexcept
+{ return g_cr4; }
+
+static uint64_t
+test_xgetbv(uint32_t xcr) noexcept
+{
+    bfignored(xcr);
+    return g_xcr0;
+}
+
+static uint32_t
+test_cpuid_subecx(uint32_t val, uint32_t sub) noexcept
+{
+    bfignored(val);
+    bfignored(sub);
+
+    g_cpuid_subecx_count++;
+    return 0xA88;
+}
+
+static void
+test_xsaveopt(void *area, uint64_t rfbm) noexcept
+{
+    g_xsaveopt_count++;
+    g_xsaveopt_area = area;
+    g_xsaveopt_rfbm = rfbm;
+}
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    *val = g_vmcs[field];
+    return !g_vmcs_fails;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    if (g_vmcs_fails) {
+        return false;
+    }
+
+    g_vmcs[field] = val;
+    return true;
+}
+
+static void
+test_write_msr(uint32_t addr, uint64_t val) noexcept
+{
+    if (addr == intel_x64::msrs::ia32_gs_base::addr) {
+        g_gs_base = val;
+    }
+}
+
+static auto
+host_cr0()
+{ return g_vmcs[intel_x64::vmcs::host_cr0::addr]; }
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_state_save = {};
+    g_cr4 = intel_x64::cr4::osxsave::mask;
+    g_xsaveopt_count = 0;
+    g_cpuid_subecx_count = 0;
+    g_gs_base = 0;
+    g_vmcs_fails = false;
+
+    g_vmcs.clear();
+    g_vmcs[intel_x64::vmcs::host_cr0::addr] = 0x80000033;
+
+    mocks.OnCallFunc(_read_cr4).Do(test_read_cr4);
+    mocks.OnCallFunc(_xgetbv).Do(test_xgetbv);
+    mocks.OnCallFunc(_cpuid_subecx).Do(test_cpuid_subecx);
+    mocks.OnCallFunc(_xsaveopt).Do(test_xsaveopt);
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_write_msr).Do(test_write_msr);
+}
+
+TEST_CASE("xstate: no_state_save")
+{
+    xstate_intel_x64 xstate;
+
+    CHECK_THROWS(xstate.enable_lazy());
+    CHECK_THROWS(xstate.disable_lazy());
+    CHECK_THROWS(xstate.is_lazy());
+    CHECK_THROWS(xstate.save());
+    CHECK_THROWS(xstate.is_saved());
+}
+
+TEST_CASE("xstate: lazy")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    xstate_intel_x64 xstate;
+    xstate.set_state_save(&g_state_save);
+
+    CHECK_FALSE(xstate.is_lazy());
+
+    CHECK_NOTHROW(xstate.enable_lazy());
+    CHECK(xstate.is_lazy());
+    CHECK(g_state_save.xstate_flags == 0x1);
+    CHECK(host_cr0() == 0x8000003B);
+
+    // The #NM handler cannot allocate the area, so it is allocated here
+
+    CHECK(xstate.area() != nullptr);
+    CHECK(g_state_save.xstate_area == reinterpret_cast<uintptr_t>(xstate.area()));
+    CHECK(g_xsaveopt_count == 0);
+
+    CHECK_NOTHROW(xstate.disable_lazy());
+    CHECK_FALSE(xstate.is_lazy());
+    CHECK(g_state_save.xstate_flags == 0x0);
+    CHECK(host_cr0() == 0x80000033);
+}
+
+TEST_CASE("xstate: lazy_without_osxsave")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    xstate_intel_x64 xstate;
+    xstate.set_state_save(&g_state_save);
+
+    g_cr4 = 0;
+
+    CHECK_THROWS(xstate.enable_lazy());
+    CHECK_FALSE(xstate.is_lazy());
+    CHECK(host_cr0() == 0x80000033);
+}
+
+TEST_CASE("xstate: resync")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    state_save_intel_x64 other{};
+
+    xstate_intel_x64 xstate;
+
+    CHECK_NOTHROW(xstate.resync(failed));
+    CHECK_FALSE(failed);
+    CHECK(host_cr0() == 0x80000033);
+
+    xstate.set_state_save(&g_state_save);
+    CHECK_NOTHROW(xstate.enable_lazy());
+
+    // The VMCS that is switched to does not have CR0.TS set
+
+    g_vmcs[intel_x64::vmcs::host_cr0::addr] = 0x80000033;
+
+    xstate.set_state_save(&other);
+    CHECK_NOTHROW(xstate.resync(failed));
+    CHECK_FALSE(failed);
+    CHECK(host_cr0() == 0x8000003B);
+    CHECK(g_gs_base == reinterpret_cast<uintptr_t>(&other));
+
+    CHECK_NOTHROW(xstate.disable_lazy());
+    g_vmcs[intel_x64::vmcs::host_cr0::addr] = 0x8000003B;
+
+    xstate.set_state_save(&g_state_save);
+    CHECK_NOTHROW(xstate.resync(failed));
+    CHECK_FALSE(failed);
+    CHECK(host_cr0() == 0x80000033);
+
+    g_vmcs_fails = true;
+
+    CHECK_NOTHROW(xstate.resync(failed));
+    CHECK(failed);
+}
+
+TEST_CASE("xstate: save_without_osxsave")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    xstate_intel_x64 xstate;
+    xstate.set_state_save(&g_state_save);
+
+    g_cr4 = 0;
+
+    CHECK_THROWS(xstate.save());
+    CHECK_FALSE(xstate.is_saved());
+}
+
+TEST_CASE("xstate: save")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    xstate_intel_x64 xstate;
+    xstate.set_state_save(&g_state_save);
+
+    CHECK(xstate.area() == nullptr);
+    CHECK_FALSE(xstate.is_saved());
+
+    CHECK_NOTHROW(xstate.save());
+    CHECK_NOTHROW(xstate.save());
+
+    CHECK(xstate.is_saved());
+    CHECK(xstate.area() != nullptr);
+    CHECK((reinterpret_cast<uintptr_t>(xstate.area()) & 0x3F) == 0);
+
+    CHECK(g_xsaveopt_count == 1);
+    CHECK(g_cpuid_subecx_count == 1);
+    CHECK(g_xsaveopt_area == xstate.area());
+    CHECK(g_xsaveopt_rfbm == g_xcr0);
+
+    CHECK(g_state_save.xstate_area == reinterpret_cast<uintptr_t>(xstate.area()));
+    CHECK(g_state_save.xstate_rfbm == g_xcr0);
+    CHECK(g_state_save.xstate_flags == 0x2);
+}
+
+TEST_CASE("xstate: save_reuses_area")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    xstate_intel_x64 xstate;
+    xstate.set_state_save(&g_state_save);
+
+    // lazy mode (as set by enable_lazy())
+
+    g_state_save.xstate_flags = 0x1;
+
+    CHECK_NOTHROW(xstate.save());
+    auto area = xstate.area();
+
+    // vmcs_resume clears the saved flag once the state is restored
+
+    g_state_save.xstate_flags = 0x1;
+
+    CHECK_NOTHROW(xstate.save());
+    CHECK(xstate.area() == area);
+    CHECK(g_xsaveopt_count == 2);
+    CHECK(g_state_save.xstate_flags == 0x3);
+}
+
+TEST_CASE("xstate: set_state_save_moves_state")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    state_save_intel_x64 other{};
+
+    xstate_intel_x64 xstate;
+    xstate.set_state_save(&g_state_save);
+
+    // lazy mode (as set by enable_lazy())
+
+    g_state_save.xstate_flags = 0x1;
+
+    CHECK_NOTHROW(xstate.save());
+
+    xstate.set_state_save(&other);
+
+    CHECK(xstate.is_lazy());
+    CHECK(xstate.is_saved());
+    CHECK(other.xstate_flags == 0x3);
+    CHECK(other.xstate_area == reinterpret_cast<uintptr_t>(xstate.area()));
+    CHECK(other.xstate_rfbm == g_xcr0);
+
+    CHECK(g_state_save.xstate_flags == 0x1);
+
+    xstate.set_state_save(&other);
+    CHECK(other.xstate_flags == 0x3);
+}
+
+#endif
@@ -24,6 +24,16 @@ default rel
 
 section .text
 
+global _read_dr6:function
+_read_dr6:
+    mov rax, dr6
+    ret
+
+global _write_dr6:function
+_write_dr6:
+    mov dr6, rdi
+    ret
+
 global _read_dr7:function
 _read_dr7:
     mov rax, dr7
@@ -24,6 +24,20 @@
 
 #include <intrinsics/x86/common/debug_x64.h>
 
+extern "C" uint64_t
+_read_dr6(void) noexcept
+{
+    std::cerr << __BFFUNC__ << " called" << '\n';
+    abort();
+}
+
+extern "C" void
+_write_dr6(uint64_t val) noexcept
+{
+    std::cerr << __BFFUNC__ << " called with: " << view_as_pointer(val) << '\n';
+    abort();
+}
+
 extern "C" uint64_t
 _read_dr7(void) noexcept
 {
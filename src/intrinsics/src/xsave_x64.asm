@@ -0,0 +1,58 @@
+;
+; Bareflank Hypervisor
+;
+; Copyright (C) 2015 Assured Information Security, Inc.
+; Author: Rian Quinn        <quinnr@ainfosec.com>
+; Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+;
+; This library is free software; you can redistribute it and/or
+; modify it under the terms of the GNU Lesser General Public
+; License as published by the Free Software Foundation; either
+; version 2.1 of the License, or (at your option) any later version.
+;
+; This library is distributed in the hope that it will be useful,
+; but WITHOUT ANY WARRANTY; without even the implied warranty of
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+; Lesser General Public License for more details.
+;
+; You should have received a copy of the GNU Lesser General Public
+; License along with this library; if not, write to the Free Software
+; Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+bits 64
+default rel
+
+section .text
+
+global _xgetbv:function
+_xgetbv:
+    mov ecx, edi
+    xgetbv
+    shl rdx, 32
+    or rax, rdx
+    ret
+
+global _xsetbv:function
+_xsetbv:
+    mov ecx, edi
+    mov rax, rsi
+    mov rdx, rsi
+    shr rdx, 32
+    xsetbv
+    ret
+
+global _xsaveopt:function
+_xsaveopt:
+    mov rax, rsi
+    mov rdx, rsi
+    shr rdx, 32
+    xsaveopt64 [rdi]
+    ret
+
+global _xrstor:function
+_xrstor:
+    mov rax, rsi
+    mov rdx, rsi
+    shr rdx, 32
+    xrstor64 [rdi]
+    ret
@@ -0,0 +1,53 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <bfgsl.h>
+#include <bfdebug.h>
+
+#include <intrinsics/x86/common_x64.h>
+
+extern "C" uint64_t
+_xgetbv(uint32_t xcr) noexcept
+{
+    std::cerr << __BFFUNC__ << " called with: " << xcr << '\n';
+    abort();
+}
+
+extern "C" void
+_xsetbv(uint32_t xcr, uint64_t val) noexcept
+{
+    std::cerr << __BFFUNC__ << " called with: " << xcr << " " << val << '\n';
+    abort();
+}
+
+extern "C" void
+_xsaveopt(void *area, uint64_t rfbm) noexcept
+{
+    std::cerr << __BFFUNC__ << " called with: " << area << " " << rfbm << '\n';
+    abort();
+}
+
+extern "C" void
+_xrstor(void *area, uint64_t rfbm) noexcept
+{
+    std::cerr << __BFFUNC__ << " called with: " << area << " " << rfbm << '\n';
+    abort();
+}
@@ -27,8 +27,17 @@
 
 using namespace x64;
 
+dr6::value_type g_dr6 = 0;
 dr7::value_type g_dr7 = 0;
 
+uint64_t
+test_read_dr6() noexcept
+{ return g_dr6; }
+
+void
+test_write_dr6(uint64_t val) noexcept
+{ g_dr6 = val; }
+
 uint64_t
 test_read_dr7() noexcept
 { return g_dr7; }
@@ -40,10 +49,24 @@ test_write_dr7(uint64_t val) noexcept
 static void
 setup_intrinsics(MockRepository &mocks)
 {
+    mocks.OnCallFunc(_read_dr6).Do(test_read_dr6);
+    mocks.OnCallFunc(_write_dr6).Do(test_write_dr6);
     mocks.OnCallFunc(_read_dr7).Do(test_read_dr7);
     mocks.OnCallFunc(_write_dr7).Do(test_write_dr7);
 }
 
+TEST_CASE("debug_x64_dr6")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    dr6::set(100U);
+    CHECK(dr6::get() == 100UL);
+
+    dr6::set(1000UL);
+    CHECK(dr6::get() == 1000UL);
+}
+
 TEST_CASE("debug_x64_dr7")
 {
     MockRepository mocks;
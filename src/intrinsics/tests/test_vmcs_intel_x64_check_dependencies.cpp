@@ -0,0 +1,299 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <bfbenchmark.h>
+
+#include <intrinsics/x86/common_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+using namespace vmcs;
+
+std::map<uint32_t, uint64_t> g_msrs;
+std::map<uint64_t, uint64_t> g_vmcs_fields;
+
+uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    *val = g_vmcs_fields[field];
+    return true;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmcs_fields[field] = val;
+    return true;
+}
+
+static bool
+test_vmptrld(void *ptr) noexcept
+{ (void) ptr; return true; }
+
+static uint64_t
+test_thread_context_cpuid() noexcept
+{ return 0; }
+
+// A VMCS that passes every check, without enabling anything that would
+// make a check read memory.
+
+static void
+setup_vmcs()
+{
+    g_msrs.clear();
+    g_vmcs_fields.clear();
+
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] =
+        primary_processor_based_vm_execution_controls::activate_secondary_controls::mask << 32;
+
+    g_vmcs_fields[host_cs_selector::addr] = 0x08;
+    g_vmcs_fields[host_ss_selector::addr] = 0x10;
+    g_vmcs_fields[host_tr_selector::addr] = 0x18;
+
+    g_vmcs_fields[guest_cs_access_rights::addr] = 0x9B;
+    g_vmcs_fields[guest_ss_access_rights::addr] = 0x93;
+    g_vmcs_fields[guest_ds_access_rights::addr] = 0x93;
+    g_vmcs_fields[guest_es_access_rights::addr] = 0x93;
+    g_vmcs_fields[guest_fs_access_rights::addr] = 0x93;
+    g_vmcs_fields[guest_gs_access_rights::addr] = 0x93;
+    g_vmcs_fields[guest_tr_access_rights::addr] = 0x8B;
+    g_vmcs_fields[guest_ldtr_access_rights::addr] = x64::access_rights::unusable;
+
+    g_vmcs_fields[guest_rflags::addr] = 0x2;
+    g_vmcs_fields[vmcs_link_pointer::addr] = 0xFFFFFFFFFFFFFFFFULL;
+}
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_vmptrld).Do(test_vmptrld);
+    mocks.OnCallFunc(thread_context_cpuid).Do(test_thread_context_cpuid);
+
+    setup_vmcs();
+}
+
+static auto
+num_affected_by(field_type field)
+{
+    auto num = 0ULL;
+
+    for (const auto &dependency : check::dependencies()) {
+
+        auto &&fields = gsl::make_span(dependency.fields, static_cast<std::ptrdiff_t>(dependency.num_fields));
+
+        if (dependency.reads_memory || std::find(fields.begin(), fields.end(), field) != fields.end()) {
+            num++;
+        }
+    }
+
+    return num;
+}
+
+// The checks that are run when every field is dirty (the rest don't read
+// anything, and so are never run again).
+
+static auto
+num_reading_anything()
+{
+    auto num = 0ULL;
+
+    for (const auto &dependency : check::dependencies()) {
+        if (dependency.reads_memory || dependency.num_fields != 0) {
+            num++;
+        }
+    }
+
+    return num;
+}
+
+static auto
+num_reading_memory()
+{
+    auto num = 0ULL;
+
+    for (const auto &dependency : check::dependencies()) {
+        if (dependency.reads_memory) {
+            num++;
+        }
+    }
+
+    return num;
+}
+
+TEST_CASE("check_dependencies_fields")
+{
+    for (const auto &dependency : check::dependencies()) {
+
+        CHECK(dependency.num_fields <= check::max_dependencies);
+
+        for (auto i = 0ULL; i < dependency.num_fields; i++) {
+            CHECK(registry::find(dependency.fields[i]) != nullptr);
+        }
+    }
+}
+
+TEST_CASE("check_dependencies_all_pass")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    CHECK_NOTHROW(check::all());
+
+    for (const auto &dependency : check::dependencies()) {
+        CHECK_NOTHROW(dependency.check());
+    }
+}
+
+TEST_CASE("check_dependencies_incremental_not_tracking")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vm::track_dirty_fields(false);
+
+    CHECK(check::incremental() == check::num_dependencies());
+    CHECK(check::incremental() == check::num_dependencies());
+}
+
+TEST_CASE("check_dependencies_incremental")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vm::track_dirty_fields(true);
+    auto ___ = gsl::finally([&]
+    { vm::track_dirty_fields(false); });
+
+    CHECK(check::incremental() == num_reading_anything());
+    CHECK(check::incremental() == num_reading_memory());
+
+    guest_cr0::set(0);
+    CHECK(check::incremental() == num_affected_by(guest_cr0::addr));
+    CHECK(check::incremental() == num_reading_memory());
+
+    pin_based_vm_execution_controls::set(0);
+    CHECK(check::incremental() == num_affected_by(pin_based_vm_execution_controls::addr));
+    CHECK(check::incremental() == num_reading_memory());
+}
+
+TEST_CASE("check_dependencies_incremental_nothrow")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vm::track_dirty_fields(true);
+    auto ___ = gsl::finally([&]
+    { vm::track_dirty_fields(false); });
+
+    auto failed = false;
+
+    CHECK_NOTHROW(check::incremental());
+    CHECK(check::incremental() == num_reading_memory());
+
+    guest_cr0::set_nothrow(0, failed);
+    CHECK_FALSE(failed);
+    CHECK(check::incremental() == num_affected_by(guest_cr0::addr));
+    CHECK(check::incremental() == num_reading_memory());
+}
+
+TEST_CASE("check_dependencies_incremental_failure")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vm::track_dirty_fields(true);
+    auto ___ = gsl::finally([&]
+    { vm::track_dirty_fields(false); });
+
+    CHECK_NOTHROW(check::incremental());
+
+    guest_rflags::set(0);
+    CHECK_THROWS(check::incremental());
+    CHECK_THROWS(check::incremental());
+
+    guest_rflags::set(0x2);
+    CHECK_NOTHROW(check::incremental());
+    CHECK(check::incremental() == num_reading_memory());
+}
+
+TEST_CASE("check_dependencies_incremental_load")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vm::track_dirty_fields(true);
+    auto ___ = gsl::finally([&]
+    { vm::track_dirty_fields(false); });
+
+    uint64_t phys = 0x1000;
+
+    CHECK_NOTHROW(check::incremental());
+    CHECK(check::incremental() == num_reading_memory());
+
+    vm::load(&phys);
+    CHECK(check::incremental() == num_reading_anything());
+}
+
+constexpr const auto NUM_ITERATIONS = 0x1000U;
+
+TEST_CASE("check_dependencies_benchmark")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    bfdebug_lnbr(0);
+    bfdebug_info(0, "vmcs checks (guest rip written before each entry)");
+    bfdebug_brk2(0);
+
+    bfdebug_ndec(0, "full", benchmark([&] {
+        for (auto i = 0U; i < NUM_ITERATIONS; i++)
+        {
+            guest_rip::set(i);
+            check::all();
+        }
+    }));
+
+    vm::track_dirty_fields(true);
+    auto ___ = gsl::finally([&]
+    { vm::track_dirty_fields(false); });
+
+    bfdebug_ndec(0, "incremental", benchmark([&] {
+        for (auto i = 0U; i < NUM_ITERATIONS; i++)
+        {
+            guest_rip::set(i);
+            check::incremental();
+        }
+    }));
+}
+
+#endif
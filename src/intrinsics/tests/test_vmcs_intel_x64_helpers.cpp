@@ -50,6 +50,24 @@ test_vmwrite(uint64_t field, uint64_t val) noexcept
     return true;
 }
 
+static bool
+test_vmread_fails(uint64_t field, uint64_t *val) noexcept
+{
+    bfignored(field);
+    bfignored(val);
+
+    return false;
+}
+
+static bool
+test_vmwrite_fails(uint64_t field, uint64_t val) noexcept
+{
+    bfignored(field);
+    bfignored(val);
+
+    return false;
+}
+
 static void
 setup_intrinsics(MockRepository &mocks)
 {
@@ -120,6 +138,67 @@ TEST_CASE("set_vmcs_field_if_exists")
     CHECK(g_vmcs_fields[0UL] == 1UL);
 }
 
+TEST_CASE("get_vmcs_field_nothrow")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    g_vmcs_fields[0UL] = 42UL;
+
+    CHECK(get_vmcs_field_nothrow(0ULL, true, failed) == 42UL);
+    CHECK(!failed);
+
+    CHECK(get_vmcs_field_nothrow(0ULL, false, failed) == 0UL);
+    CHECK(failed);
+
+    CHECK(get_vmcs_field_nothrow(0ULL, true, failed) == 42UL);
+    CHECK(failed);
+}
+
+TEST_CASE("get_vmcs_field_nothrow_vmread_fails")
+{
+    MockRepository mocks;
+    mocks.OnCallFunc(_vmread).Do(test_vmread_fails);
+
+    auto failed = false;
+
+    CHECK(get_vmcs_field_nothrow(0ULL, true, failed) == 0UL);
+    CHECK(failed);
+}
+
+TEST_CASE("set_vmcs_field_nothrow")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    g_vmcs_fields[0UL] = 0UL;
+
+    set_vmcs_field_nothrow(1ULL, 0ULL, true, failed);
+    CHECK(g_vmcs_fields[0UL] == 1UL);
+    CHECK(!failed);
+
+    set_vmcs_field_nothrow(2ULL, 0ULL, false, failed);
+    CHECK(g_vmcs_fields[0UL] == 1UL);
+    CHECK(failed);
+
+    set_vmcs_field_nothrow(3ULL, 0ULL, true, failed);
+    CHECK(g_vmcs_fields[0UL] == 3UL);
+    CHECK(failed);
+}
+
+TEST_CASE("set_vmcs_field_nothrow_vmwrite_fails")
+{
+    MockRepository mocks;
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite_fails);
+
+    auto failed = false;
+
+    set_vmcs_field_nothrow(1ULL, 0ULL, true, failed);
+    CHECK(failed);
+}
+
 TEST_CASE("set_vm_control")
 {
     MockRepository mocks;
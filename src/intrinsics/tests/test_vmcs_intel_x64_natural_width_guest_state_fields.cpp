@@ -78,6 +78,18 @@ TEST_CASE("vmcs_guest_cr0")
     vmcs::guest_cr0::dump();
 }
 
+TEST_CASE("vmcs_guest_cr0_nothrow")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+
+    vmcs::guest_cr0::set_nothrow(0xFFFFFFFFU, failed);
+    CHECK(vmcs::guest_cr0::get_nothrow(failed) == 0xFFFFFFFFU);
+    CHECK(!failed);
+}
+
 TEST_CASE("vmcs_guest_cr0_protection_enable")
 {
     MockRepository mocks;
@@ -0,0 +1,124 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+#include <intrinsics/x86/common_x64.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+using namespace vmcs;
+
+std::map<uint32_t, uint64_t> g_msrs;
+std::map<uint64_t, uint64_t> g_vmcs_fields;
+
+uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    *val = g_vmcs_fields[field];
+    return true;
+}
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] |=
+        primary_processor_based_vm_execution_controls::activate_secondary_controls::mask << 32;
+}
+
+TEST_CASE("vmcs_registry_num_fields")
+{
+    CHECK(registry::num_fields == 155);
+}
+
+TEST_CASE("vmcs_registry_sorted")
+{
+    CHECK(registry::is_sorted());
+}
+
+TEST_CASE("vmcs_registry_width_and_type")
+{
+    for (const auto &field : registry::fields)
+    {
+        CHECK(field.width == registry::width_of(field.addr));
+        CHECK(field.type == registry::type_of(field.addr));
+    }
+
+    CHECK(registry::width_of(guest_es_selector::addr) == registry::width::bits16);
+    CHECK(registry::width_of(tsc_offset::addr) == registry::width::bits64);
+    CHECK(registry::width_of(exit_reason::addr) == registry::width::bits32);
+    CHECK(registry::width_of(guest_cr3::addr) == registry::width::natural);
+
+    CHECK(registry::type_of(virtual_processor_identifier::addr) == registry::type::control);
+    CHECK(registry::type_of(exit_reason::addr) == registry::type::read_only);
+    CHECK(registry::type_of(guest_cr3::addr) == registry::type::guest_state);
+    CHECK(registry::type_of(host_rip::addr) == registry::type::host_state);
+}
+
+TEST_CASE("vmcs_registry_find")
+{
+    auto &&field = registry::find(guest_cr3::addr);
+
+    REQUIRE(field != nullptr);
+    CHECK(field->addr == guest_cr3::addr);
+    CHECK(field->name == guest_cr3::name);
+    CHECK(field->width == registry::width::natural);
+    CHECK(field->type == registry::type::guest_state);
+
+    CHECK(registry::find(registry::fields[0].addr) == &registry::fields[0]);
+    CHECK(registry::find(host_rip::addr) == &registry::fields[registry::num_fields - 1]);
+}
+
+TEST_CASE("vmcs_registry_find_unknown")
+{
+    CHECK(registry::find(0x0000000000000001ULL) == nullptr);
+    CHECK(registry::find(0x0000000000002001ULL) == nullptr);
+    CHECK(registry::find(0x000000000000FFFFULL) == nullptr);
+}
+
+TEST_CASE("vmcs_registry_name_of")
+{
+    CHECK(std::string(registry::name_of(exit_reason::addr)) == exit_reason::name);
+    CHECK(std::string(registry::name_of(0x000000000000FFFFULL)) == "unknown");
+}
+
+TEST_CASE("vmcs_registry_dump")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    for (const auto &field : registry::fields) {
+        CHECK_NOTHROW(field.dump(0, nullptr));
+    }
+
+    CHECK_NOTHROW(debug::dump());
+}
+
+#endif
@@ -0,0 +1,199 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <intrinsics/x86/intel_x64.h>
+#include <hippomocks.h>
+
+#include <set>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+static std::map<msrs::field_type, msrs::value_type> g_msrs;
+static std::set<msrs::field_type> g_msrs_read;
+static uint32_t g_addr_size = 0;
+static uint64_t g_cpuid = 0;
+
+extern "C" uint64_t
+test_read_msr(uint32_t addr) noexcept
+{
+    g_msrs_read.insert(addr);
+    return g_msrs[addr];
+}
+
+extern "C" uint32_t
+test_cpuid_eax(uint32_t val) noexcept
+{
+    bfignored(val);
+    return g_addr_size;
+}
+
+extern "C" uint64_t
+test_thread_context_cpuid(void)
+{ return g_cpuid; }
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_msrs.clear();
+    g_msrs_read.clear();
+    g_addr_size = 39;
+    g_cpuid = 0;
+
+    g_msrs[msrs::ia32_vmx_basic::addr] = (1ULL << 55) | (6ULL << 50) | 0x10;
+    g_msrs[msrs::ia32_vmx_procbased_ctls::addr] = (1ULL << 63);
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = (1ULL << 33) | (1ULL << 45);
+    g_msrs[msrs::ia32_vmx_ept_vpid_cap::addr] = 0x1;
+    g_msrs[msrs::ia32_vmx_vmfunc::addr] = 0x1;
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000ULL;
+
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+    mocks.OnCallFunc(_cpuid_eax).Do(test_cpuid_eax);
+    mocks.OnCallFunc(thread_context_cpuid).Do(test_thread_context_cpuid);
+}
+
+TEST_CASE("vmx_capabilities: not_captured")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmx_capabilities::release();
+    CHECK_FALSE(vmx_capabilities::is_captured());
+
+    CHECK(msrs::ia32_vmx_basic::revision_id::get() == 0x10);
+
+    g_msrs[msrs::ia32_vmx_basic::addr] = 0x20;
+    CHECK(msrs::ia32_vmx_basic::revision_id::get() == 0x20);
+    CHECK(vmx_capabilities::phys_addr_bits() == 39);
+}
+
+TEST_CASE("vmx_capabilities: captured")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    CHECK(vmx_capabilities::capture());
+    CHECK(vmx_capabilities::is_captured());
+
+    g_msrs[msrs::ia32_vmx_basic::addr] = 0x20;
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] = 0;
+    g_msrs_read.clear();
+    g_addr_size = 48;
+
+    CHECK(msrs::ia32_vmx_basic::revision_id::get() == 0x10);
+    CHECK(msrs::ia32_vmx_true_procbased_ctls::interrupt_window_exiting::is_allowed1());
+    CHECK(vmcs::primary_processor_based_vm_execution_controls::interrupt_window_exiting::is_allowed1());
+    CHECK(vmx_capabilities::phys_addr_bits() == 39);
+    CHECK(g_msrs_read.empty());
+
+    vmx_capabilities::release();
+}
+
+TEST_CASE("vmx_capabilities: capture_optional_msrs")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    CHECK(vmx_capabilities::capture());
+
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_procbased_ctls2::addr) == 1);
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_ept_vpid_cap::addr) == 1);
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_vmfunc::addr) == 1);
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_true_pinbased_ctls::addr) == 1);
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_true_entry_ctls::addr) == 1);
+
+    vmx_capabilities::release();
+}
+
+TEST_CASE("vmx_capabilities: capture_missing_msrs")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    g_msrs[msrs::ia32_vmx_basic::addr] = (6ULL << 50);
+    g_msrs[msrs::ia32_vmx_procbased_ctls::addr] = 0;
+
+    CHECK(vmx_capabilities::capture());
+
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_vmcs_enum::addr) == 1);
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_procbased_ctls2::addr) == 0);
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_ept_vpid_cap::addr) == 0);
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_vmfunc::addr) == 0);
+    CHECK(g_msrs_read.count(msrs::ia32_vmx_true_procbased_ctls::addr) == 0);
+
+    CHECK(msrs::ia32_vmx_procbased_ctls2::get() == 0);
+    CHECK(msrs::ia32_vmx_vmfunc::get() == 0);
+    CHECK_FALSE(msrs::ia32_vmx_true_procbased_ctls::interrupt_window_exiting::is_allowed1());
+
+    vmx_capabilities::release();
+}
+
+TEST_CASE("vmx_capabilities: capture_replaces")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    CHECK(vmx_capabilities::capture());
+
+    g_msrs[msrs::ia32_vmx_basic::addr] = 0x20;
+    CHECK(vmx_capabilities::capture());
+
+    CHECK(msrs::ia32_vmx_basic::revision_id::get() == 0x20);
+
+    vmx_capabilities::release();
+}
+
+TEST_CASE("vmx_capabilities: per_cpu")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    CHECK(vmx_capabilities::capture());
+
+    g_cpuid = 1;
+    g_msrs[msrs::ia32_vmx_basic::addr] = 0x20;
+
+    CHECK_FALSE(vmx_capabilities::is_captured());
+    CHECK(msrs::ia32_vmx_basic::revision_id::get() == 0x20);
+
+    g_cpuid = 0;
+    CHECK(msrs::ia32_vmx_basic::revision_id::get() == 0x10);
+
+    vmx_capabilities::release();
+    CHECK(msrs::ia32_vmx_basic::revision_id::get() == 0x20);
+}
+
+TEST_CASE("vmx_capabilities: cpuid_too_large")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    g_cpuid = per_cpu::max_cpus;
+
+    CHECK_FALSE(vmx_capabilities::capture());
+    CHECK_FALSE(vmx_capabilities::is_captured());
+    CHECK_NOTHROW(vmx_capabilities::release());
+    CHECK(msrs::ia32_vmx_basic::revision_id::get() == 0x10);
+}
+
+#endif
@@ -161,6 +161,27 @@ TEST_CASE("vmx_intel_x64_vmxoff_success")
     CHECK_NOTHROW(vmx::off());
 }
 
+TEST_CASE("vmx_intel_x64_vmxoff_count")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto ___ = gsl::finally([&]
+    { g_vmxoff_fails = false; });
+
+    auto &&cpuid = thread_context_cpuid();
+    auto &&count = vmx::off_count(cpuid);
+
+    CHECK_NOTHROW(vmx::off());
+    CHECK(vmx::off_count(cpuid) == count + 1);
+
+    g_vmxoff_fails = true;
+    CHECK_THROWS(vmx::off());
+    CHECK(vmx::off_count(cpuid) == count + 1);
+
+    CHECK(vmx::off_count(per_cpu::max_cpus) == ~0ULL);
+}
+
 TEST_CASE("vmx_intel_x64_vmclear_nullptr")
 {
     MockRepository mocks;
@@ -248,6 +269,32 @@ TEST_CASE("vmx_intel_x64_vmreset_success")
     CHECK_NOTHROW(vm::reset(&g_region));
 }
 
+TEST_CASE("vmx_intel_x64_current_vmcs")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    uintptr_t vmcs_phys = 0x1000;
+    uintptr_t other_vmcs_phys = 0x2000;
+
+    CHECK_NOTHROW(vm::load(&vmcs_phys));
+    CHECK(vm::current() == vmcs_phys);
+
+    CHECK_NOTHROW(vm::clear(&other_vmcs_phys));
+    CHECK(vm::current() == vmcs_phys);
+
+    CHECK_NOTHROW(vm::clear(&vmcs_phys));
+    CHECK(vm::current() == 0);
+
+    CHECK_NOTHROW(vm::load(&vmcs_phys));
+    CHECK_NOTHROW(vmx::off());
+    CHECK(vm::current() == 0);
+
+    CHECK_NOTHROW(vm::load(&vmcs_phys));
+    CHECK_NOTHROW(vmx::on(&g_region));
+    CHECK(vm::current() == 0);
+}
+
 TEST_CASE("vmx_intel_x64_vmread_failure")
 {
     MockRepository mocks;
@@ -284,6 +331,37 @@ TEST_CASE("vmx_intel_x64_vmread_vmwrite_succcess")
     CHECK(val == 10UL);
 }
 
+TEST_CASE("vmx_intel_x64_dirty_fields")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto ___ = gsl::finally([&]
+    { vm::track_dirty_fields(false); });
+
+    uintptr_t vmcs_phys = 0x1000;
+
+    vm::track_dirty_fields(true);
+    CHECK(vm::is_dirty(0x6800U));
+
+    vm::clear_dirty();
+    CHECK(!vm::is_dirty(0x6800U));
+
+    CHECK_NOTHROW(vm::write(0x6800U, 10U));
+    CHECK(vm::is_dirty(0x6800U));
+    CHECK(!vm::is_dirty(0x6802U));
+    CHECK(!vm::is_dirty(0x4800U));
+
+    vm::clear_dirty();
+    CHECK_NOTHROW(vm::load(&vmcs_phys));
+    CHECK(vm::is_dirty(0x6802U));
+
+    vm::clear_dirty();
+    vm::track_dirty_fields(false);
+    CHECK_NOTHROW(vm::write(0x6800U, 10U));
+    CHECK(!vm::is_dirty(0x6800U));
+}
+
 TEST_CASE("vmx_intel_x64_vmlaunch_demote_success")
 {
     MockRepository mocks;
@@ -28,18 +28,49 @@
 #include <intrinsics/x86/common_x64.h>
 using namespace x64;
 
-page_table_x64::page_table_x64(gsl::not_null<pointer> pte)
+page_table_x64::page_table_x64(gsl::not_null<pointer> pte, init_entry_type init_entry,
+                               split_entry_type split_entry) :
+    m_init_entry(init_entry),
+    m_split_entry(split_entry)
 {
     m_pt = std::make_unique<integer_pointer[]>(page_table::num_entries);
+    m_init_entry(pte, g_mm->virtptr_to_physint(m_pt.get()));
+}
 
+void
+page_table_x64::init_x64_entry(pointer pte, integer_pointer phys)
+{
     auto entry = page_table_entry_x64(pte);
     entry.clear();
-    entry.set_phys_addr(g_mm->virtptr_to_physint(m_pt.get()));
+    entry.set_phys_addr(phys);
     entry.set_present(true);
     entry.set_rw(true);
     entry.set_pat_index_4k(pat::write_back_index);
 }
 
+void
+page_table_x64::split_x64_entry(
+    pointer pte, integer_pointer large, integer_pointer offset, bool is_large)
+{
+    auto entry = page_table_entry_x64(pte);
+    *pte = large;
+
+    // The PAT bit of a large page is bit 12, which is part of the
+    // address of a 4k page
+
+    auto index = entry.pat_index_large();
+    entry.set_pat_large(false);
+    entry.set_phys_addr(entry.phys_addr() + offset);
+
+    if (is_large) {
+        entry.set_pat_index_large(index);
+        return;
+    }
+
+    entry.set_ps(false);
+    entry.set_pat_index_4k(index);
+}
+
 page_table_entry_x64
 page_table_x64::add_page(integer_pointer addr, integer_pointer bits, integer_pointer end)
 {
@@ -53,21 +84,46 @@ page_table_x64::add_page(integer_pointer addr, integer_pointer bits, integer_poi
         auto iter = bfn::find(m_pts, index);
         if (!(*iter)) {
             auto view = gsl::make_span(m_pt, page_table::num_entries);
-            (*iter) = std::make_unique<page_table_x64>(&view.at(index));
+            auto large = view.at(index);
+
+            (*iter) = std::make_unique<page_table_x64>(
+                          &view.at(index), m_init_entry, m_split_entry);
+
+            // An entry without a page table is a large page. The new table
+            // maps all of it using smaller pages, so that only the part
+            // that is being added changes
+
+            if (large != 0) {
+                (*iter)->split_page(large, bits - page_table::pt::size);
+            }
         }
 
         return (*iter)->add_page(addr, bits - page_table::pt::size, end);
     }
 
+    // Only the page table (if any) that the entry used to point to is
+    // removed, as a table can hold both pages and page tables (e.g. an
+    // identity map that uses 1g pages, and 4k pages for the first 2m)
+
     if (!m_pts.empty()) {
-        m_pts.clear();
-        m_pts.shrink_to_fit();
+        (*bfn::find(m_pts, index)) = nullptr;
     }
 
     auto view = gsl::make_span(m_pt, page_table::num_entries);
     return page_table_entry_x64(&view.at(index));
 }
 
+void
+page_table_x64::split_page(integer_pointer large, integer_pointer bits)
+{
+    auto offset = 0ULL;
+
+    for (auto &entry : gsl::make_span(m_pt, page_table::num_entries)) {
+        m_split_entry(&entry, large, offset, bits != page_table::pt::from);
+        offset += 1ULL << bits;
+    }
+}
+
 void
 page_table_x64::remove_page(integer_pointer addr, integer_pointer bits)
 {
@@ -83,14 +139,13 @@ page_table_x64::remove_page(integer_pointer addr, integer_pointer bits)
                 auto view = gsl::make_span(m_pt, page_table::num_entries);
                 view.at(index) = 0;
             }
+
+            return;
         }
     }
-    else {
-        auto view = gsl::make_span(m_pt, page_table::num_entries);
-        view.at(index) = 0;
 
-        return;
-    }
+    auto view = gsl::make_span(m_pt, page_table::num_entries);
+    view.at(index) = 0;
 }
 
 page_table_entry_x64
@@ -98,16 +153,22 @@ page_table_x64::virt_to_pte(integer_pointer addr, integer_pointer bits) const
 {
     auto index = page_table::index(addr, bits);
 
+    auto view = gsl::make_span(m_pt, page_table::num_entries);
+
     if (!m_pts.empty()) {
         auto iter = bfn::cfind(m_pts, index);
         if (auto pt = (*iter).get()) {
             return pt->virt_to_pte(addr, bits - page_table::pt::size);
         }
 
-        throw std::runtime_error("unable to locate pte. invalid address");
+        // An entry without a page table is a page (e.g. a 1g page in a
+        // table that also holds page tables)
+
+        if (view.at(index) == 0) {
+            throw std::runtime_error("unable to locate pte. invalid address");
+        }
     }
 
-    auto view = gsl::make_span(m_pt, page_table::num_entries);
     return page_table_entry_x64(&view.at(index));
 }
 
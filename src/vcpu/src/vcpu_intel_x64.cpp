@@ -79,8 +79,17 @@ vcpu_intel_x64::init(user_data *data)
     m_vmcs->set_exit_handler_entry(reinterpret_cast<void *>(exit_handler_entry));
 
     m_exit_handler->set_vmcs(m_vmcs.get());
+    m_exit_handler->set_msr_area(&m_vmcs->m_msr_area);
     m_exit_handler->set_state_save(m_state_save.get());
 
+    if (!m_contexts) {
+        m_contexts = std::make_unique<vmcs_intel_x64_context_set>(
+                         m_vmcs.get(), m_state_save.get(), m_vmm_state.get(),
+                         reinterpret_cast<void *>(exit_handler_entry));
+    }
+
+    m_exit_handler->set_contexts(m_contexts.get());
+
     bfdebug_transaction(1, [&](std::string * msg) {
         bfdebug_brk2(1, msg)
         bfdebug_nhex(1, "init vcpu", id(), msg);
@@ -125,6 +134,8 @@ vcpu_intel_x64::run(user_data *data)
             }
         });
 
+        m_contexts->reset();
+
         bfdebug_nhex(1, "launching vcpu", id());
         m_vmcs->launch(m_vmm_state.get(), m_guest_state.get());
     }
@@ -132,8 +143,8 @@ vcpu_intel_x64::run(user_data *data)
 
         bfdebug_nhex(1, "resuming vcpu", id());
 
-        m_vmcs->load();
-        m_vmcs->resume();
+        m_contexts->load();
+        m_contexts->resume();
     }
 }
 
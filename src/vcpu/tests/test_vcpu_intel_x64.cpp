@@ -273,7 +273,9 @@ TEST_CASE("vcpu_intel_x64: init_valid_params")
     mocks.OnCall(cs.get(), vmcs_intel_x64::set_exit_handler_entry);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -304,7 +306,9 @@ TEST_CASE("vcpu_intel_x64: init_valid")
     mocks.OnCall(cs.get(), vmcs_intel_x64::set_exit_handler_entry);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -335,7 +339,9 @@ TEST_CASE("vcpu_intel_x64: init_vmcs_throws")
     mocks.OnCall(cs.get(), vmcs_intel_x64::set_exit_handler_entry);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -385,7 +391,9 @@ TEST_CASE("vcpu_intel_x64: fini_valid_params")
     mocks.OnCall(cs.get(), vmcs_intel_x64::set_exit_handler_entry);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -417,7 +425,9 @@ TEST_CASE("vcpu_intel_x64: fini_valid")
     mocks.OnCall(cs.get(), vmcs_intel_x64::set_exit_handler_entry);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -480,7 +490,9 @@ TEST_CASE("vcpu_intel_x64: run_launch")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0x0001000000000000,
@@ -518,7 +530,9 @@ TEST_CASE("vcpu_intel_x64: run_launch_is_host_vcpu")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -556,7 +570,9 @@ TEST_CASE("vcpu_intel_x64: run_resume")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -595,7 +611,9 @@ TEST_CASE("vcpu_intel_x64: run_no_init")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -632,7 +650,9 @@ TEST_CASE("vcpu_intel_x64: run_vmxon_throws")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -670,7 +690,9 @@ TEST_CASE("vcpu_intel_x64: run_vmcs_throws")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -708,7 +730,9 @@ TEST_CASE("vcpu_intel_x64: hlt_no_init")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0x0001000000000000,
@@ -745,7 +769,9 @@ TEST_CASE("vcpu_intel_x64: hlt_no_run")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0x0001000000000000,
@@ -783,7 +809,9 @@ TEST_CASE("vcpu_intel_x64: hlt_valid")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0x0001000000000000,
@@ -822,7 +850,9 @@ TEST_CASE("vcpu_intel_x64: hlt_valid_is_host_vcpu")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop);
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
@@ -861,7 +891,9 @@ TEST_CASE("vcpu_intel_x64: hlt_vmxon_throws")
     mocks.OnCall(on.get(), vmxon_intel_x64::stop).Throw(std::runtime_error("error"));
 
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_msr_area);
     mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_contexts);
 
     auto vc = std::make_unique<vcpu_intel_x64>(
                   0,
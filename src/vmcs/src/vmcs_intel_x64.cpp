@@ -21,6 +21,7 @@
 
 #include <bfgsl.h>
 #include <bfdebug.h>
+#include <bfexception.h>
 #include <bfconstants.h>
 #include <bfthreadcontext.h>
 
@@ -30,6 +31,7 @@
 #include <vmcs/vmcs_intel_x64_launch.h>
 #include <vmcs/vmcs_intel_x64_resume.h>
 #include <vmcs/vmcs_intel_x64_promote.h>
+#include <vmcs/vmcs_intel_x64_control_registers.h>
 
 #include <intrinsics/x86/intel_x64.h>
 #include <intrinsics/x86/common_x64.h>
@@ -38,25 +40,193 @@ using namespace x64;
 using namespace intel_x64;
 using namespace vmcs;
 
+// -----------------------------------------------------------------------------
+// State Fields
+// -----------------------------------------------------------------------------
+
+// The guest / host state that is copied out of a vmcs_intel_x64_state when
+// the VMCS is launched. Each entry pairs a VMCS field with the state getter
+// that provides its value, so that launch is a single loop of VMWRITEs
+// instead of one named setter (and one debug string) per field. Fields that
+// are not listed here (e.g. the host RSP / RIP) are written by hand.
+
+struct state_field
+{
+    vmcs::field_type addr;
+    const char *name;
+    vmcs::value_type (*get)(const vmcs_intel_x64_state *state);
+    bool (*exists)();
+    bool optional;
+};
+
+template<class T, T(vmcs_intel_x64_state::*getter)() const>
+static vmcs::value_type
+get_state(const vmcs_intel_x64_state *state)
+{ return static_cast<vmcs::value_type>((state->*getter)()); }
+
+#define state_field_entry(field, getter, optional)                              \
+    {                                                                           \
+        vmcs::field::addr,                                                      \
+        vmcs::field::name,                                                      \
+        get_state<decltype(std::declval<vmcs_intel_x64_state>().getter()),      \
+            &vmcs_intel_x64_state::getter>,                                     \
+        vmcs::field::exists,                                                    \
+        optional                                                                \
+    }
+
+#define required_field(field, getter) state_field_entry(field, getter, false)
+#define optional_field(field, getter) state_field_entry(field, getter, true)
+
+constexpr const state_field g_guest_state_fields[] = {
+    required_field(guest_es_selector, es),
+    required_field(guest_cs_selector, cs),
+    required_field(guest_ss_selector, ss),
+    required_field(guest_ds_selector, ds),
+    required_field(guest_fs_selector, fs),
+    required_field(guest_gs_selector, gs),
+    required_field(guest_ldtr_selector, ldtr),
+    required_field(guest_tr_selector, tr),
+
+    required_field(guest_ia32_debugctl, ia32_debugctl_msr),
+    required_field(guest_ia32_pat, ia32_pat_msr),
+    required_field(guest_ia32_efer, ia32_efer_msr),
+    optional_field(guest_ia32_perf_global_ctrl, ia32_perf_global_ctrl_msr),
+
+    required_field(guest_es_limit, es_limit),
+    required_field(guest_cs_limit, cs_limit),
+    required_field(guest_ss_limit, ss_limit),
+    required_field(guest_ds_limit, ds_limit),
+    required_field(guest_fs_limit, fs_limit),
+    required_field(guest_gs_limit, gs_limit),
+    required_field(guest_ldtr_limit, ldtr_limit),
+    required_field(guest_tr_limit, tr_limit),
+    required_field(guest_gdtr_limit, gdt_limit),
+    required_field(guest_idtr_limit, idt_limit),
+
+    required_field(guest_es_access_rights, es_access_rights),
+    required_field(guest_cs_access_rights, cs_access_rights),
+    required_field(guest_ss_access_rights, ss_access_rights),
+    required_field(guest_ds_access_rights, ds_access_rights),
+    required_field(guest_fs_access_rights, fs_access_rights),
+    required_field(guest_gs_access_rights, gs_access_rights),
+    required_field(guest_ldtr_access_rights, ldtr_access_rights),
+    required_field(guest_tr_access_rights, tr_access_rights),
+
+    required_field(guest_ia32_sysenter_cs, ia32_sysenter_cs_msr),
+
+    required_field(guest_cr0, cr0),
+    required_field(guest_cr3, cr3),
+    required_field(guest_cr4, cr4),
+
+    required_field(guest_es_base, es_base),
+    required_field(guest_cs_base, cs_base),
+    required_field(guest_ss_base, ss_base),
+    required_field(guest_ds_base, ds_base),
+    required_field(guest_fs_base, ia32_fs_base_msr),
+    required_field(guest_gs_base, ia32_gs_base_msr),
+    required_field(guest_ldtr_base, ldtr_base),
+    required_field(guest_tr_base, tr_base),
+    required_field(guest_gdtr_base, gdt_base),
+    required_field(guest_idtr_base, idt_base),
+
+    required_field(guest_dr7, dr7),
+    required_field(guest_rflags, rflags),
+    required_field(guest_ia32_sysenter_esp, ia32_sysenter_esp_msr),
+    required_field(guest_ia32_sysenter_eip, ia32_sysenter_eip_msr),
+};
+
+constexpr const state_field g_host_state_fields[] = {
+    required_field(host_es_selector, es),
+    required_field(host_cs_selector, cs),
+    required_field(host_ss_selector, ss),
+    required_field(host_ds_selector, ds),
+    required_field(host_fs_selector, fs),
+    required_field(host_gs_selector, gs),
+    required_field(host_tr_selector, tr),
+
+    required_field(host_ia32_pat, ia32_pat_msr),
+    required_field(host_ia32_efer, ia32_efer_msr),
+    optional_field(host_ia32_perf_global_ctrl, ia32_perf_global_ctrl_msr),
+
+    required_field(host_ia32_sysenter_cs, ia32_sysenter_cs_msr),
+
+    required_field(host_cr0, cr0),
+    required_field(host_cr3, cr3),
+    required_field(host_cr4, cr4),
+
+    required_field(host_fs_base, ia32_fs_base_msr),
+    required_field(host_tr_base, tr_base),
+    required_field(host_gdtr_base, gdt_base),
+    required_field(host_idtr_base, idt_base),
+
+    required_field(host_ia32_sysenter_esp, ia32_sysenter_esp_msr),
+    required_field(host_ia32_sysenter_eip, ia32_sysenter_eip_msr),
+};
+
+#undef optional_field
+#undef required_field
+#undef state_field_entry
+
+template<std::size_t N>
+static void
+write_state_fields(const state_field(&fields)[N], const vmcs_intel_x64_state *state)
+{
+    for (const auto &field : fields) {
+
+        if (!field.exists()) {
+
+            if (field.optional) {
+                continue;
+            }
+
+            throw std::logic_error("field doesn't exist: " + std::string(field.name));
+        }
+
+        intel_x64::vm::write(field.addr, field.get(state), field.name);
+    }
+}
+
+template<std::size_t N>
+static void
+dump_state_fields(const state_field(&fields)[N], const vmcs_intel_x64_state *state,
+                  std::string *msg)
+{
+    for (const auto &field : fields) {
+        if (field.exists()) {
+            bfdebug_subnhex(1, field.name, field.get(state), msg);
+        }
+    }
+}
+
+vmcs_intel_x64::~vmcs_intel_x64()
+{
+    if (m_vmcs_region) {
+        this->release_vmcs_region();
+    }
+
+    if (m_exit_handler_stack) {
+        this->release_exit_handler_stack();
+    }
+}
+
 void
 vmcs_intel_x64::launch(gsl::not_null<vmcs_intel_x64_state *> host_state,
                        gsl::not_null<vmcs_intel_x64_state *> guest_state)
 {
-    this->create_vmcs_region();
+    this->prepare(host_state, guest_state);
+    m_prepared = false;
 
     auto ___ = gsl::on_failure([&] {
         this->release_vmcs_region();
     });
 
-    this->create_exit_handler_stack();
-
     auto ___ = gsl::on_failure([&] {
         this->release_exit_handler_stack();
     });
 
-    this->clear();
-    this->load();
-    this->write_fields(host_state, guest_state);
+    auto ___ = gsl::on_failure([&] {
+        m_launch_snapshot.reset();
+    });
 
     auto ___ = gsl::on_failure([&] {
         vmcs::check::all();
@@ -67,6 +237,11 @@ vmcs_intel_x64::launch(gsl::not_null<vmcs_intel_x64_state *> host_state,
     });
 
     if (guest_state->is_guest()) {
+
+        if (m_check_on_entry) {
+            this->check_entry();
+        }
+
         vmcs_launch(m_state_save);
         throw std::runtime_error("vmcs resume failed");
     }
@@ -75,6 +250,45 @@ vmcs_intel_x64::launch(gsl::not_null<vmcs_intel_x64_state *> host_state,
     }
 }
 
+void
+vmcs_intel_x64::prepare(gsl::not_null<vmcs_intel_x64_state *> host_state,
+                        gsl::not_null<vmcs_intel_x64_state *> guest_state)
+{
+    if (m_prepared) {
+        this->load();
+        return;
+    }
+
+    this->create_vmcs_region();
+
+    auto ___ = gsl::on_failure([&] {
+        this->release_vmcs_region();
+    });
+
+    this->create_exit_handler_stack();
+
+    auto ___ = gsl::on_failure([&] {
+        this->release_exit_handler_stack();
+    });
+
+    this->clear();
+    this->load();
+
+    auto ___ = gsl::on_failure([&] {
+        m_launch_snapshot.reset();
+    });
+
+    if (m_launch_snapshot.is_valid()) {
+        this->restore_fields(host_state, guest_state);
+    }
+    else {
+        this->write_fields(host_state, guest_state);
+        m_launch_snapshot.capture(vmcs_intel_x64_snapshot::control | vmcs_intel_x64_snapshot::host_state);
+    }
+
+    m_prepared = true;
+}
+
 void
 vmcs_intel_x64::promote()
 {
@@ -83,6 +297,8 @@ vmcs_intel_x64::promote()
     // Why are we not passing m_state_save? Seems safer then using the
     // VMCS
 
+    m_msr_area.load_guest_values();
+
     vmcs_promote(vmcs::host_gs_base::get());
     throw std::runtime_error("vmcs promote failed");
 }
@@ -90,6 +306,10 @@ vmcs_intel_x64::promote()
 void
 vmcs_intel_x64::resume()
 {
+    if (m_check_on_entry) {
+        this->check_entry();
+    }
+
     vmcs_resume(m_state_save);
     throw std::runtime_error("vmcs resume failed");
 }
@@ -97,28 +317,99 @@ vmcs_intel_x64::resume()
 void
 vmcs_intel_x64::load()
 {
+    auto cpuid = thread_context_cpuid();
+
+    if (this->is_active() && m_active_cpuid != cpuid) {
+        throw std::logic_error("vmcs is active on another cpu, and must be cleared there first");
+    }
+
+    if (this->is_active() && vm::current() == m_vmcs_region_phys) {
+        return;
+    }
+
     vm::load(&m_vmcs_region_phys);
+
+    m_active = true;
+    m_cleared = false;
+    m_active_cpuid = cpuid;
+    m_active_vmxoff_count = vmx::off_count(cpuid);
+
+    m_vpid.load();
+
     bfdebug_nhex(1, "loaded vmcs region", m_vmcs_region_phys);
 }
 
 void
 vmcs_intel_x64::clear()
 {
+    if (m_cleared) {
+        return;
+    }
+
+    if (this->is_active() && m_active_cpuid != thread_context_cpuid()) {
+        throw std::logic_error("vmcs is active on another cpu, and must be cleared there");
+    }
+
     vm::clear(&m_vmcs_region_phys);
+
+    m_active = false;
+    m_cleared = true;
+
     bfdebug_nhex(1, "cleared vmcs region", m_vmcs_region_phys);
 }
 
+void
+vmcs_intel_x64::set_check_on_entry(bool enabled)
+{
+    m_check_on_entry = enabled;
+
+    if (enabled) {
+        vm::track_dirty_fields(true);
+    }
+}
+
+void
+vmcs_intel_x64::check_entry()
+{
+    // vmcs_launch() and vmcs_resume() write the guest's RSP and RIP from
+    // the state save area, which vm::write() doesn't see.
+
+    vm::mark_dirty(vmcs::guest_rsp::addr);
+    vm::mark_dirty(vmcs::guest_rip::addr);
+
+    vmcs::check::incremental();
+}
+
 void
 vmcs_intel_x64::create_vmcs_region()
 {
+    // The region is allocated by the first launch, and reused by every
+    // launch after that (until the VMCS is destroyed). The memory of a
+    // VMCS that is still active must not be written, so a reused region
+    // is cleared first (which fails, leaving the region alone, if it is
+    // active on another CPU).
+
+    if (m_vmcs_region) {
+        this->clear();
+    }
+
     auto ___ = gsl::on_failure([&]
     { this->release_vmcs_region(); });
 
-    m_vmcs_region = std::make_unique<uint32_t[]>(1024);
-    m_vmcs_region_phys = g_mm->virtptr_to_physint(m_vmcs_region.get());
+    if (!m_vmcs_region) {
+        m_vmcs_region = std::make_unique<uint32_t[]>(1024);
+        m_vmcs_region_phys = g_mm->virtptr_to_physint(m_vmcs_region.get());
+
+        m_active = false;
+        m_cleared = false;
+    }
+
+    // Only the header of the region is defined by the SDM (the rest is
+    // initialized by VMCLEAR), so that is all that needs to be written.
 
-    gsl::span<uint32_t> id{m_vmcs_region.get(), 1024};
-    id[0] = gsl::narrow<uint32_t>(intel_x64::msrs::ia32_vmx_basic::revision_id::get());
+    gsl::span<uint32_t> header{m_vmcs_region.get(), 2};
+    header[0] = gsl::narrow<uint32_t>(intel_x64::msrs::ia32_vmx_basic::revision_id::get());
+    header[1] = 0;
 
     bfdebug_transaction(1, [&](std::string * msg) {
         bfdebug_pass(1, "create vmcs region", msg);
@@ -136,13 +427,59 @@ vmcs_intel_x64::release_vmcs_region() noexcept
         bfdebug_subnhex(1, "phys address", m_vmcs_region_phys, msg);
     });
 
+    // The CPU caches an active VMCS, and can write it back to the region
+    // at any time, so it has to be cleared before the region is freed. A
+    // VMCS that is active on another CPU can only be cleared there, so in
+    // that case the region is leaked instead. Clearing also tells this
+    // CPU that the VMCS is no longer current, as a new region could be
+    // allocated at the same physical address.
+    //
+    // VMXOFF deactivates every VMCS of the CPU, and VMCLEAR would #UD
+    // outside of VMX operation, so a VMCS whose CPU has left VMX operation
+    // since it was loaded (e.g. when the VMM is stopped, and the vCPU is
+    // deleted after it is halted) is freed without being cleared. A CPU
+    // that is not tracked cannot tell, and its VMCS is leaked instead.
+
+    if (this->is_active()) {
+        if (m_active_cpuid != thread_context_cpuid() || per_cpu::cpu(m_active_cpuid) == nullptr) {
+            bferror_nhex(0, "vmcs region might be active on another cpu, and is leaked", m_vmcs_region_phys);
+            m_vmcs_region.release();
+        }
+        else {
+            guard_exceptions([&]
+            { vm::clear(&m_vmcs_region_phys); });
+
+            if (vm::current() == m_vmcs_region_phys) {
+                vm::set_current(0);
+            }
+        }
+    }
+
     m_vmcs_region.reset();
     m_vmcs_region_phys = 0;
+
+    m_active = false;
+    m_cleared = false;
+    m_prepared = false;
+}
+
+bool
+vmcs_intel_x64::is_active() const noexcept
+{
+    if (!m_active) {
+        return false;
+    }
+
+    return vmx::off_count(m_active_cpuid) == m_active_vmxoff_count;
 }
 
 void
 vmcs_intel_x64::create_exit_handler_stack()
 {
+    if (m_exit_handler_stack) {
+        return;
+    }
+
     auto size = STACK_SIZE * 2;
     m_exit_handler_stack = std::make_unique<gsl::byte[]>(size);
 
@@ -168,20 +505,14 @@ void
 vmcs_intel_x64::write_fields(gsl::not_null<vmcs_intel_x64_state *> host_state,
                              gsl::not_null<vmcs_intel_x64_state *> guest_state)
 {
-    this->write_16bit_guest_state(guest_state);
-    this->write_64bit_guest_state(guest_state);
-    this->write_32bit_guest_state(guest_state);
-    this->write_natural_guest_state(guest_state);
+    this->write_guest_state(guest_state);
 
     this->write_16bit_control_state(host_state);
     this->write_64bit_control_state(host_state);
     this->write_32bit_control_state(host_state);
-    this->write_natural_control_state(host_state);
+    this->write_natural_control_state(guest_state);
 
-    this->write_16bit_host_state(host_state);
-    this->write_64bit_host_state(host_state);
-    this->write_32bit_host_state(host_state);
-    this->write_natural_host_state(host_state);
+    this->write_host_state(host_state);
 
     this->pin_based_vm_execution_controls();
     this->primary_processor_based_vm_execution_controls();
@@ -190,12 +521,31 @@ vmcs_intel_x64::write_fields(gsl::not_null<vmcs_intel_x64_state *> host_state,
     this->vm_entry_controls();
 }
 
+void
+vmcs_intel_x64::restore_fields(gsl::not_null<vmcs_intel_x64_state *> host_state,
+                               gsl::not_null<vmcs_intel_x64_state *> guest_state)
+{
+    m_launch_snapshot.restore();
+
+    this->write_guest_state(guest_state);
+
+    this->write_16bit_control_state(host_state);
+    this->write_64bit_control_state(host_state);
+    this->write_natural_control_state(guest_state);
+
+    this->write_exit_handler_state();
+}
+
 void
 vmcs_intel_x64::write_16bit_control_state(gsl::not_null<vmcs_intel_x64_state *> state)
 {
     (void) state;
 
-    // unused: VMCS_VIRTUAL_PROCESSOR_IDENTIFIER
+    // The virtual processor identifier (and the enable VPID control) are
+    // managed by the VPID
+
+    m_vpid.write_fields();
+
     // unused: VMCS_POSTED_INTERRUPT_NOTIFICATION_VECTOR
     // unused: VMCS_EPTP_INDEX
 
@@ -207,19 +557,28 @@ vmcs_intel_x64::write_64bit_control_state(gsl::not_null<vmcs_intel_x64_state *>
 {
     (void) state;
 
+    // The VM-exit MSR-store / MSR-load and VM-entry MSR-load addresses
+    // (and counts) are managed by the MSR area
+
+    m_msr_area.write_fields();
+
     // unused: VMCS_ADDRESS_OF_IO_BITMAP_A
     // unused: VMCS_ADDRESS_OF_IO_BITMAP_B
     // unused: VMCS_ADDRESS_OF_MSR_BITMAPS
-    // unused: VMCS_VM_EXIT_MSR_STORE_ADDRESS
-    // unused: VMCS_VM_EXIT_MSR_LOAD_ADDRESS
-    // unused: VMCS_VM_ENTRY_MSR_LOAD_ADDRESS
     // unused: VMCS_EXECUTIVE_VMCS_POINTER
     // unused: VMCS_TSC_OFFSET
     // unused: VMCS_VIRTUAL_APIC_ADDRESS
     // unused: VMCS_APIC_ACCESS_ADDRESS
     // unused: VMCS_POSTED_INTERRUPT_DESCRIPTOR_ADDRESS
     // unused: VMCS_VM_FUNCTION_CONTROLS
-    // unused: VMCS_EPT_POINTER
+
+    if (m_ept != nullptr) {
+        vmcs::ept_pointer::set(m_ept->eptp());
+        secondary_processor_based_vm_execution_controls::enable_ept::enable();
+
+        m_ept->flush();
+    }
+
     // unused: VMCS_EOI_EXIT_BITMAP_0
     // unused: VMCS_EOI_EXIT_BITMAP_1
     // unused: VMCS_EOI_EXIT_BITMAP_2
@@ -262,20 +621,19 @@ vmcs_intel_x64::write_32bit_control_state(gsl::not_null<vmcs_intel_x64_state *>
     upper = ((ia32_vmx_entry_ctls_msr >> 32) & 0x00000000FFFFFFFF);
     vm_entry_controls::set(lower & upper);
 
-    // unused: VMCS_EXCEPTION_BITMAP
-    // unused: VMCS_PAGE_FAULT_ERROR_CODE_MASK
-    // unused: VMCS_PAGE_FAULT_ERROR_CODE_MATCH
+    // VMCS_EXCEPTION_BITMAP, VMCS_PAGE_FAULT_ERROR_CODE_MASK and
+    // VMCS_PAGE_FAULT_ERROR_CODE_MATCH are programmed by the exit handler
+    // when an exception is intercepted
+
     // unused: VMCS_CR3_TARGET_COUNT
-    // unused: VMCS_VM_EXIT_MSR_STORE_COUNT
-    // unused: VMCS_VM_EXIT_MSR_LOAD_COUNT
-    // unused: VMCS_VM_ENTRY_MSR_LOAD_COUNT
     // unused: VMCS_VM_ENTRY_INTERRUPTION_INFORMATION_FIELD
     // unused: VMCS_VM_ENTRY_EXCEPTION_ERROR_CODE
     // unused: VMCS_VM_ENTRY_INSTRUCTION_LENGTH
     // unused: VMCS_TPR_THRESHOLD
     // unused: VMCS_SECONDARY_PROCESSOR_BASED_VM_EXECUTION_CONTROLS
-    // unused: VMCS_PLE_GAP
-    // unused: VMCS_PLE_WINDOW
+
+    // VMCS_PLE_GAP and VMCS_PLE_WINDOW are programmed by the exit handler
+    // if the guest enables pause-loop exiting
 
     bfdebug_transaction(1, [&](std::string * msg) {
         bfdebug_pass(1, "write 32bit control state", msg);
@@ -289,349 +647,84 @@ vmcs_intel_x64::write_32bit_control_state(gsl::not_null<vmcs_intel_x64_state *>
 void
 vmcs_intel_x64::write_natural_control_state(gsl::not_null<vmcs_intel_x64_state *> state)
 {
-    (void) state;
+    auto cr0_guest_host_mask = vmcs::control_registers::cr0_guest_host_mask();
+    auto cr4_guest_host_mask = vmcs::control_registers::cr4_guest_host_mask();
+    auto cr0_read_shadow = vmcs::control_registers::cr0_read_shadow(state->cr0());
+    auto cr4_read_shadow = vmcs::control_registers::cr4_read_shadow(state->cr4());
+
+    vmcs::cr0_guest_host_mask::set(cr0_guest_host_mask);
+    vmcs::cr4_guest_host_mask::set(cr4_guest_host_mask);
+    vmcs::cr0_read_shadow::set(cr0_read_shadow);
+    vmcs::cr4_read_shadow::set(cr4_read_shadow);
 
-    // unused: VMCS_CR0_GUEST_HOST_MASK
-    // unused: VMCS_CR4_GUEST_HOST_MASK
-    // unused: VMCS_CR0_READ_SHADOW
-    // unused: VMCS_CR4_READ_SHADOW
     // unused: VMCS_CR3_TARGET_VALUE_0
     // unused: VMCS_CR3_TARGET_VALUE_1
     // unused: VMCS_CR3_TARGET_VALUE_2
     // unused: VMCS_CR3_TARGET_VALUE_3
 
-    bfdebug_pass(1, "write natural width control state");
-}
-
-void
-vmcs_intel_x64::write_16bit_guest_state(gsl::not_null<vmcs_intel_x64_state *> state)
-{
-    auto es = state->es();
-    auto cs = state->cs();
-    auto ss = state->ss();
-    auto ds = state->ds();
-    auto fs = state->fs();
-    auto gs = state->gs();
-    auto ldtr = state->ldtr();
-    auto tr = state->tr();
-
-    vmcs::guest_es_selector::set(es);
-    vmcs::guest_cs_selector::set(cs);
-    vmcs::guest_ss_selector::set(ss);
-    vmcs::guest_ds_selector::set(ds);
-    vmcs::guest_fs_selector::set(fs);
-    vmcs::guest_gs_selector::set(gs);
-    vmcs::guest_ldtr_selector::set(ldtr);
-    vmcs::guest_tr_selector::set(tr);
-
-    // unused: VMCS_GUEST_INTERRUPT_STATUS
-
     bfdebug_transaction(1, [&](std::string * msg) {
-        bfdebug_pass(1, "write 16bit guest state", msg);
-        bfdebug_subnhex(1, "es", es, msg);
-        bfdebug_subnhex(1, "cs", cs, msg);
-        bfdebug_subnhex(1, "ss", ss, msg);
-        bfdebug_subnhex(1, "ds", ds, msg);
-        bfdebug_subnhex(1, "fs", fs, msg);
-        bfdebug_subnhex(1, "gs", gs, msg);
-        bfdebug_subnhex(1, "ldtr", ldtr, msg);
-        bfdebug_subnhex(1, "tr", tr, msg);
+        bfdebug_pass(1, "write natural width control state", msg);
+        bfdebug_subnhex(1, "cr0 guest host mask", cr0_guest_host_mask, msg);
+        bfdebug_subnhex(1, "cr4 guest host mask", cr4_guest_host_mask, msg);
+        bfdebug_subnhex(1, "cr0 read shadow", cr0_read_shadow, msg);
+        bfdebug_subnhex(1, "cr4 read shadow", cr4_read_shadow, msg);
     });
 }
 
 void
-vmcs_intel_x64::write_64bit_guest_state(gsl::not_null<vmcs_intel_x64_state *> state)
+vmcs_intel_x64::write_guest_state(gsl::not_null<vmcs_intel_x64_state *> state)
 {
-    auto link_pointer = 0xFFFFFFFFFFFFFFFF;
-    auto ia32_debugctl_msr = state->ia32_debugctl_msr();
-    auto ia32_pat_msr = state->ia32_pat_msr();
-    auto ia32_efer_msr = state->ia32_efer_msr();
-    auto ia32_perf_global_ctrl_msr = state->ia32_perf_global_ctrl_msr();
-
-    vmcs::vmcs_link_pointer::set(link_pointer);
-    vmcs::guest_ia32_debugctl::set(ia32_debugctl_msr);
-    vmcs::guest_ia32_pat::set(ia32_pat_msr);
-    vmcs::guest_ia32_efer::set(ia32_efer_msr);
-    vmcs::guest_ia32_perf_global_ctrl::set_if_exists(ia32_perf_global_ctrl_msr);
+    write_state_fields(g_guest_state_fields, state);
+
+    vmcs::vmcs_link_pointer::set(0xFFFFFFFFFFFFFFFF);
 
+    // unused: VMCS_GUEST_INTERRUPT_STATUS
     // unused: VMCS_GUEST_PDPTE0
     // unused: VMCS_GUEST_PDPTE1
     // unused: VMCS_GUEST_PDPTE2
     // unused: VMCS_GUEST_PDPTE3
-
-    bfdebug_transaction(1, [&](std::string * msg) {
-        bfdebug_pass(1, "write 64bit guest state", msg);
-        bfdebug_subnhex(1, "vmcs link pointer", link_pointer, msg);
-        bfdebug_subnhex(1, "ia32_debugctl_msr", ia32_debugctl_msr, msg);
-        bfdebug_subnhex(1, "ia32_pat_msr", ia32_pat_msr, msg);
-        bfdebug_subnhex(1, "ia32_efer_msr", ia32_efer_msr, msg);
-        bfdebug_subnhex(1, "ia32_perf_global_ctrl_msr", ia32_perf_global_ctrl_msr, msg);
-    });
-}
-
-void
-vmcs_intel_x64::write_32bit_guest_state(gsl::not_null<vmcs_intel_x64_state *> state)
-{
-    auto es_limit = state->es_limit();
-    auto cs_limit = state->cs_limit();
-    auto ss_limit = state->ss_limit();
-    auto ds_limit = state->ds_limit();
-    auto fs_limit = state->fs_limit();
-    auto gs_limit = state->gs_limit();
-    auto ldtr_limit = state->ldtr_limit();
-    auto tr_limit = state->tr_limit();
-
-    vmcs::guest_es_limit::set(es_limit);
-    vmcs::guest_cs_limit::set(cs_limit);
-    vmcs::guest_ss_limit::set(ss_limit);
-    vmcs::guest_ds_limit::set(ds_limit);
-    vmcs::guest_fs_limit::set(fs_limit);
-    vmcs::guest_gs_limit::set(gs_limit);
-    vmcs::guest_ldtr_limit::set(ldtr_limit);
-    vmcs::guest_tr_limit::set(tr_limit);
-
-    auto gdt_limit = state->gdt_limit();
-    auto idt_limit = state->idt_limit();
-
-    vmcs::guest_gdtr_limit::set(gdt_limit);
-    vmcs::guest_idtr_limit::set(idt_limit);
-
-    auto es_access_rights = state->es_access_rights();
-    auto cs_access_rights = state->cs_access_rights();
-    auto ss_access_rights = state->ss_access_rights();
-    auto ds_access_rights = state->ds_access_rights();
-    auto fs_access_rights = state->fs_access_rights();
-    auto gs_access_rights = state->gs_access_rights();
-    auto ldtr_access_rights = state->ldtr_access_rights();
-    auto tr_access_rights = state->tr_access_rights();
-
-    vmcs::guest_es_access_rights::set(es_access_rights);
-    vmcs::guest_cs_access_rights::set(cs_access_rights);
-    vmcs::guest_ss_access_rights::set(ss_access_rights);
-    vmcs::guest_ds_access_rights::set(ds_access_rights);
-    vmcs::guest_fs_access_rights::set(fs_access_rights);
-    vmcs::guest_gs_access_rights::set(gs_access_rights);
-    vmcs::guest_ldtr_access_rights::set(ldtr_access_rights);
-    vmcs::guest_tr_access_rights::set(tr_access_rights);
-
-    auto ia32_sysenter_cs_msr = state->ia32_sysenter_cs_msr();
-
-    vmcs::guest_ia32_sysenter_cs::set(ia32_sysenter_cs_msr);
-
     // unused: VMCS_GUEST_INTERRUPTIBILITY_STATE
     // unused: VMCS_GUEST_ACTIVITY_STATE
     // unused: VMCS_GUEST_SMBASE
     // unused: VMCS_VMX_PREEMPTION_TIMER_VALUE
-
-    bfdebug_transaction(1, [&](std::string * msg) {
-        bfdebug_pass(1, "write 32bit guest state", msg);
-        bfdebug_subnhex(1, "es limit", es_limit, msg);
-        bfdebug_subnhex(1, "cs limit", cs_limit, msg);
-        bfdebug_subnhex(1, "ss limit", ss_limit, msg);
-        bfdebug_subnhex(1, "ds limit", ds_limit, msg);
-        bfdebug_subnhex(1, "fs limit", fs_limit, msg);
-        bfdebug_subnhex(1, "gs limit", gs_limit, msg);
-        bfdebug_subnhex(1, "ldtr limit", ldtr_limit, msg);
-        bfdebug_subnhex(1, "tr limit", tr_limit, msg);
-        bfdebug_subnhex(1, "gdt limit", gdt_limit, msg);
-        bfdebug_subnhex(1, "idt limit", idt_limit, msg);
-        bfdebug_subnhex(1, "es access rights", es_access_rights, msg);
-        bfdebug_subnhex(1, "cs access rights", cs_access_rights, msg);
-        bfdebug_subnhex(1, "ss access rights", ss_access_rights, msg);
-        bfdebug_subnhex(1, "ds access rights", ds_access_rights, msg);
-        bfdebug_subnhex(1, "fs access rights", fs_access_rights, msg);
-        bfdebug_subnhex(1, "gs access rights", gs_access_rights, msg);
-        bfdebug_subnhex(1, "ldtr access rights", ldtr_access_rights, msg);
-        bfdebug_subnhex(1, "tr access rights", tr_access_rights, msg);
-        bfdebug_subnhex(1, "sysenter cs msr", ia32_sysenter_cs_msr, msg);
-    });
-}
-
-void
-vmcs_intel_x64::write_natural_guest_state(gsl::not_null<vmcs_intel_x64_state *> state)
-{
-    auto cr0 = state->cr0();
-    auto cr3 = state->cr3();
-    auto cr4 = state->cr4();
-
-    vmcs::guest_cr0::set(cr0);
-    vmcs::guest_cr3::set(cr3);
-    vmcs::guest_cr4::set(cr4);
-
-    auto es_base = state->es_base();
-    auto cs_base = state->cs_base();
-    auto ss_base = state->ss_base();
-    auto ds_base = state->ds_base();
-    auto fs_base = state->ia32_fs_base_msr();
-    auto gs_base = state->ia32_gs_base_msr();
-    auto ldtr_base = state->ldtr_base();
-    auto tr_base = state->tr_base();
-
-    vmcs::guest_es_base::set(es_base);
-    vmcs::guest_cs_base::set(cs_base);
-    vmcs::guest_ss_base::set(ss_base);
-    vmcs::guest_ds_base::set(ds_base);
-    vmcs::guest_fs_base::set(fs_base);
-    vmcs::guest_gs_base::set(gs_base);
-    vmcs::guest_ldtr_base::set(ldtr_base);
-    vmcs::guest_tr_base::set(tr_base);
-
-    auto gdt_base = state->gdt_base();
-    auto idt_base = state->idt_base();
-
-    vmcs::guest_gdtr_base::set(gdt_base);
-    vmcs::guest_idtr_base::set(idt_base);
-
-    auto dr7 = state->dr7();
-    auto rflags = state->rflags();
-
-    vmcs::guest_dr7::set(dr7);
-    vmcs::guest_rflags::set(rflags);
-
-    auto ia32_sysenter_esp_msr = state->ia32_sysenter_esp_msr();
-    auto ia32_sysenter_eip_msr = state->ia32_sysenter_eip_msr();
-
-    vmcs::guest_ia32_sysenter_esp::set(ia32_sysenter_esp_msr);
-    vmcs::guest_ia32_sysenter_eip::set(ia32_sysenter_eip_msr);
-
     // unused: VMCS_GUEST_RSP, see m_intrinsics->vmlaunch()
     // unused: VMCS_GUEST_RIP, see m_intrinsics->vmlaunch()
     // unused: VMCS_GUEST_PENDING_DEBUG_EXCEPTIONS
 
     bfdebug_transaction(1, [&](std::string * msg) {
-        bfdebug_pass(1, "write natural width guest state", msg);
-        bfdebug_subnhex(1, "cr0", cr0, msg);
-        bfdebug_subnhex(1, "cr3", cr3, msg);
-        bfdebug_subnhex(1, "cr4", cr4, msg);
-        bfdebug_subnhex(1, "es base", es_base, msg);
-        bfdebug_subnhex(1, "cs base", cs_base, msg);
-        bfdebug_subnhex(1, "ss base", ss_base, msg);
-        bfdebug_subnhex(1, "ds base", ds_base, msg);
-        bfdebug_subnhex(1, "fs base", fs_base, msg);
-        bfdebug_subnhex(1, "gs base", gs_base, msg);
-        bfdebug_subnhex(1, "ldtr base", ldtr_base, msg);
-        bfdebug_subnhex(1, "tr base", tr_base, msg);
-        bfdebug_subnhex(1, "gdt base", gdt_base, msg);
-        bfdebug_subnhex(1, "idt base", idt_base, msg);
-        bfdebug_subnhex(1, "dr7", dr7, msg);
-        bfdebug_subnhex(1, "rflags", rflags, msg);
-        bfdebug_subnhex(1, "ia32_sysenter_esp_msr", ia32_sysenter_esp_msr, msg);
-        bfdebug_subnhex(1, "ia32_sysenter_eip_msr", ia32_sysenter_eip_msr, msg);
-    });
-}
-
-void
-vmcs_intel_x64::write_16bit_host_state(gsl::not_null<vmcs_intel_x64_state *> state)
-{
-    auto es = state->es();
-    auto cs = state->cs();
-    auto ss = state->ss();
-    auto ds = state->ds();
-    auto fs = state->fs();
-    auto gs = state->gs();
-    auto tr = state->tr();
-
-    vmcs::host_es_selector::set(es);
-    vmcs::host_cs_selector::set(cs);
-    vmcs::host_ss_selector::set(ss);
-    vmcs::host_ds_selector::set(ds);
-    vmcs::host_fs_selector::set(fs);
-    vmcs::host_gs_selector::set(gs);
-    vmcs::host_tr_selector::set(tr);
-
-    bfdebug_transaction(1, [&](std::string * msg) {
-        bfdebug_pass(1, "write 16bit host state", msg);
-        bfdebug_subnhex(1, "es", es, msg);
-        bfdebug_subnhex(1, "cs", cs, msg);
-        bfdebug_subnhex(1, "ss", ss, msg);
-        bfdebug_subnhex(1, "ds", ds, msg);
-        bfdebug_subnhex(1, "fs", fs, msg);
-        bfdebug_subnhex(1, "gs", gs, msg);
-        bfdebug_subnhex(1, "tr", tr, msg);
+        bfdebug_pass(1, "write guest state", msg);
+        dump_state_fields(g_guest_state_fields, state, msg);
+        bfdebug_subnhex(1, "vmcs_link_pointer", 0xFFFFFFFFFFFFFFFF, msg);
     });
 }
 
 void
-vmcs_intel_x64::write_64bit_host_state(gsl::not_null<vmcs_intel_x64_state *> state)
+vmcs_intel_x64::write_host_state(gsl::not_null<vmcs_intel_x64_state *> state)
 {
-    auto ia32_pat_msr = state->ia32_pat_msr();
-    auto ia32_efer_msr = state->ia32_efer_msr();
-    auto ia32_perf_global_ctrl_msr = state->ia32_perf_global_ctrl_msr();
-
-    vmcs::host_ia32_pat::set(ia32_pat_msr);
-    vmcs::host_ia32_efer::set(ia32_efer_msr);
-    vmcs::host_ia32_perf_global_ctrl::set_if_exists(ia32_perf_global_ctrl_msr);
+    write_state_fields(g_host_state_fields, state);
 
     bfdebug_transaction(1, [&](std::string * msg) {
-        bfdebug_pass(1, "write 64bit host state", msg);
-        bfdebug_subnhex(1, "ia32_pat_msr", ia32_pat_msr, msg);
-        bfdebug_subnhex(1, "ia32_efer_msr", ia32_efer_msr, msg);
-        bfdebug_subnhex(1, "ia32_perf_global_ctrl_msr", ia32_perf_global_ctrl_msr, msg);
+        bfdebug_pass(1, "write host state", msg);
+        dump_state_fields(g_host_state_fields, state, msg);
     });
-}
 
-void
-vmcs_intel_x64::write_32bit_host_state(gsl::not_null<vmcs_intel_x64_state *> state)
-{
-    auto ia32_sysenter_cs_msr = state->ia32_sysenter_cs_msr();
-
-    vmcs::host_ia32_sysenter_cs::set(ia32_sysenter_cs_msr);
-
-    bfdebug_transaction(1, [&](std::string * msg) {
-        bfdebug_pass(1, "write 32bit host state", msg);
-        bfdebug_subnhex(1, "ia32_sysenter_cs_msr", ia32_sysenter_cs_msr, msg);
-    });
+    this->write_exit_handler_state();
 }
 
 void
-vmcs_intel_x64::write_natural_host_state(gsl::not_null<vmcs_intel_x64_state *> state)
+vmcs_intel_x64::write_exit_handler_state()
 {
-    auto cr0 = state->cr0();
-    auto cr3 = state->cr3();
-    auto cr4 = state->cr4();
-
-    vmcs::host_cr0::set(cr0);
-    vmcs::host_cr3::set(cr3);
-    vmcs::host_cr4::set(cr4);
-
-    auto fs_base = state->ia32_fs_base_msr();
     auto gs_base = reinterpret_cast<uintptr_t>(m_state_save);
-    auto tr_base = state->tr_base();
-
-    vmcs::host_fs_base::set(fs_base);
-    vmcs::host_gs_base::set(gs_base);
-    vmcs::host_tr_base::set(tr_base);
-
-    auto gdt_base = state->gdt_base();
-    auto idt_base = state->idt_base();
-
-    vmcs::host_gdtr_base::set(gdt_base);
-    vmcs::host_idtr_base::set(idt_base);
-
-    auto ia32_sysenter_esp_msr = state->ia32_sysenter_esp_msr();
-    auto ia32_sysenter_eip_msr = state->ia32_sysenter_eip_msr();
-
-    vmcs::host_ia32_sysenter_esp::set(ia32_sysenter_esp_msr);
-    vmcs::host_ia32_sysenter_eip::set(ia32_sysenter_eip_msr);
-
     auto exit_handler_stack = setup_stack(m_exit_handler_stack.get());
     auto exit_handler_entry = reinterpret_cast<uintptr_t>(m_exit_handler_entry);
 
+    vmcs::host_gs_base::set(gs_base);
     vmcs::host_rsp::set(exit_handler_stack);
     vmcs::host_rip::set(exit_handler_entry);
 
     bfdebug_transaction(1, [&](std::string * msg) {
-        bfdebug_pass(1, "write natural width host state", msg);
-        bfdebug_subnhex(1, "cr0", cr0, msg);
-        bfdebug_subnhex(1, "cr3", cr3, msg);
-        bfdebug_subnhex(1, "cr4", cr4, msg);
-        bfdebug_subnhex(1, "fs base", fs_base, msg);
-        bfdebug_subnhex(1, "gs base", gs_base, msg);
-        bfdebug_subnhex(1, "tr base", tr_base, msg);
-        bfdebug_subnhex(1, "gdt base", gdt_base, msg);
-        bfdebug_subnhex(1, "idt base", idt_base, msg);
-        bfdebug_subnhex(1, "ia32_sysenter_esp_msr", ia32_sysenter_esp_msr, msg);
-        bfdebug_subnhex(1, "ia32_sysenter_eip_msr", ia32_sysenter_eip_msr, msg);
+        bfdebug_pass(1, "write exit handler state", msg);
+        bfdebug_subnhex(1, "host_gs_base", gs_base, msg);
         bfdebug_subnhex(1, "exit_handler_stack", exit_handler_stack, msg);
         bfdebug_subnhex(1, "exit_handler_entry", exit_handler_entry, msg);
     });
@@ -685,11 +778,11 @@ void
 vmcs_intel_x64::secondary_processor_based_vm_execution_controls()
 {
     // secondary_processor_based_vm_execution_controls::virtualize_apic_accesses::enable_if_allowed();
-    // secondary_processor_based_vm_execution_controls::enable_ept::enable_if_allowed();
+    // enable_ept: managed by m_ept (see write_64bit_control_state)
     // secondary_processor_based_vm_execution_controls::descriptor_table_exiting::enable_if_allowed();
     secondary_processor_based_vm_execution_controls::enable_rdtscp::enable_if_allowed();
     // secondary_processor_based_vm_execution_controls::virtualize_x2apic_mode::enable_if_allowed();
-    // secondary_processor_based_vm_execution_controls::enable_vpid::enable_if_allowed();
+    // enable_vpid: managed by m_vpid (see write_16bit_control_state)
     // secondary_processor_based_vm_execution_controls::wbinvd_exiting::enable_if_allowed();
     // secondary_processor_based_vm_execution_controls::unrestricted_guest::enable_if_allowed();
     // secondary_processor_based_vm_execution_controls::apic_register_virtualization::enable_if_allowed();
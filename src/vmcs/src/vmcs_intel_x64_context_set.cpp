@@ -0,0 +1,146 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <bfgsl.h>
+
+#include <vmcs/vmcs_intel_x64_context_set.h>
+
+vmcs_intel_x64_context_set::vmcs_intel_x64_context_set(
+    gsl::not_null<vmcs_intel_x64 *> vmcs,
+    gsl::not_null<state_save_intel_x64 *> state_save,
+    gsl::not_null<vmcs_intel_x64_state *> host_state,
+    void *exit_handler_entry) :
+
+    m_host_state(host_state),
+    m_exit_handler_entry(exit_handler_entry)
+{
+    // The primary context is launched by the vCPU, and not by this set,
+    // so as far as this set is concerned, it is always launched.
+
+    m_contexts.push_back({vmcs, state_save, nullptr, true, nullptr, nullptr, nullptr});
+}
+
+vmcs_intel_x64_context_set::context_type
+vmcs_intel_x64_context_set::add(
+    std::unique_ptr<vmcs_intel_x64> vmcs,
+    std::unique_ptr<vmcs_intel_x64_state> guest_state)
+{
+    expects(vmcs);
+    expects(guest_state);
+    expects(guest_state->is_guest());
+
+    auto &&primary_state_save = m_contexts.front().state_save;
+    auto &&state_save = std::make_unique<state_save_intel_x64>();
+
+    state_save->vcpuid = primary_state_save->vcpuid;
+    state_save->vmxon_ptr = primary_state_save->vmxon_ptr;
+    state_save->vmcs_ptr = reinterpret_cast<uintptr_t>(vmcs.get());
+    state_save->exit_handler_ptr = primary_state_save->exit_handler_ptr;
+
+    vmcs->set_state_save(state_save.get());
+    vmcs->set_exit_handler_entry(m_exit_handler_entry);
+
+    m_contexts.push_back({
+        vmcs.get(), state_save.get(), guest_state.get(), false,
+        std::move(vmcs), std::move(state_save), std::move(guest_state)
+    });
+
+    return m_contexts.size() - 1;
+}
+
+void
+vmcs_intel_x64_context_set::switch_to(context_type ctx)
+{
+    auto &&next = this->get(ctx);
+
+    if (next.launched) {
+        next.vmcs->load();
+    }
+    else {
+        next.vmcs->prepare(m_host_state, next.guest_state);
+    }
+
+    m_current = ctx;
+}
+
+void
+vmcs_intel_x64_context_set::load()
+{
+    auto &&ctx = this->get(m_current);
+
+    if (ctx.launched) {
+        ctx.vmcs->load();
+    }
+}
+
+void
+vmcs_intel_x64_context_set::resume()
+{
+    auto &&ctx = this->get(m_current);
+
+    if (ctx.launched) {
+        ctx.vmcs->resume();
+        return;
+    }
+
+    ctx.launched = true;
+
+    auto ___ = gsl::on_failure([&]
+    { ctx.launched = false; });
+
+    ctx.vmcs->launch(m_host_state, ctx.guest_state);
+}
+
+void
+vmcs_intel_x64_context_set::reset() noexcept
+{
+    for (auto iter = m_contexts.begin() + 1; iter != m_contexts.end(); ++iter) {
+        iter->launched = false;
+    }
+
+    m_current = primary;
+}
+
+bool
+vmcs_intel_x64_context_set::is_launched(context_type ctx) const
+{ return this->get(ctx).launched; }
+
+vmcs_intel_x64 *
+vmcs_intel_x64_context_set::vmcs(context_type ctx) const
+{ return this->get(ctx).vmcs; }
+
+state_save_intel_x64 *
+vmcs_intel_x64_context_set::state_save(context_type ctx) const
+{ return this->get(ctx).state_save; }
+
+vmcs_intel_x64_context_set::context &
+vmcs_intel_x64_context_set::get(context_type ctx)
+{
+    expects(ctx < m_contexts.size());
+    return m_contexts[ctx];
+}
+
+const vmcs_intel_x64_context_set::context &
+vmcs_intel_x64_context_set::get(context_type ctx) const
+{
+    expects(ctx < m_contexts.size());
+    return m_contexts[ctx];
+}
@@ -0,0 +1,137 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <vmcs/vmcs_intel_x64_guest_shadow.h>
+
+using namespace intel_x64;
+
+// The order of this list is the order in which dirty fields are flushed.
+// The index of each field is its bit in m_valid / m_dirty.
+
+static constexpr const vmcs::field_type g_shadowed_fields[] = {
+    vmcs::guest_cr0::addr,
+    vmcs::guest_cr3::addr,
+    vmcs::guest_cr4::addr,
+    vmcs::guest_dr7::addr,
+    vmcs::guest_rflags::addr,
+    vmcs::guest_ia32_debugctl::addr,
+    vmcs::guest_ia32_pat::addr,
+    vmcs::guest_ia32_efer::addr,
+    vmcs::guest_ia32_perf_global_ctrl::addr,
+    vmcs::guest_ia32_sysenter_cs::addr,
+    vmcs::guest_ia32_sysenter_esp::addr,
+    vmcs::guest_ia32_sysenter_eip::addr,
+    vmcs::guest_fs_base::addr,
+    vmcs::guest_gs_base::addr,
+    vmcs::guest_interruptibility_state::addr,
+    vmcs::guest_activity_state::addr
+};
+
+constexpr const auto g_num_shadowed_fields = sizeof(g_shadowed_fields) / sizeof(vmcs::field_type);
+constexpr const auto g_not_shadowed = g_num_shadowed_fields;
+
+static_assert(g_num_shadowed_fields <= std::tuple_size<std::array<vmcs::value_type, 16>>::value,
+              "vmcs_intel_x64_guest_shadow::m_values is too small");
+
+vmcs_intel_x64_guest_shadow::value_type
+vmcs_intel_x64_guest_shadow::get(field_type addr, bool &failed) noexcept
+{
+    auto &&i = index(addr);
+
+    if (i == g_not_shadowed) {
+        return vmcs::get_vmcs_field_nothrow(addr, true, failed);
+    }
+
+    if (is_bit_set(m_valid, i)) {
+        return gsl::at(m_values, i);
+    }
+
+    auto read_failed = false;
+    auto &&val = vmcs::get_vmcs_field_nothrow(addr, true, read_failed);
+
+    if (read_failed) {
+        failed = true;
+        return val;
+    }
+
+    gsl::at(m_values, i) = val;
+    m_valid = set_bit(m_valid, i);
+
+    return val;
+}
+
+void
+vmcs_intel_x64_guest_shadow::set(field_type addr, value_type val, bool &failed) noexcept
+{
+    auto &&i = index(addr);
+
+    if (i == g_not_shadowed) {
+        return vmcs::set_vmcs_field_nothrow(val, addr, true, failed);
+    }
+
+    gsl::at(m_values, i) = val;
+
+    m_valid = set_bit(m_valid, i);
+    m_dirty = set_bit(m_dirty, i);
+}
+
+void
+vmcs_intel_x64_guest_shadow::flush(bool &failed) noexcept
+{
+    for (auto i = 0U; m_dirty != 0; i++) {
+        if (is_bit_set(m_dirty, i)) {
+            vmcs::set_vmcs_field_nothrow(gsl::at(m_values, i), gsl::at(g_shadowed_fields, i), true, failed);
+            m_dirty = clear_bit(m_dirty, i);
+        }
+    }
+
+    this->invalidate();
+}
+
+void
+vmcs_intel_x64_guest_shadow::invalidate() noexcept
+{
+    m_valid = 0;
+    m_dirty = 0;
+}
+
+bool
+vmcs_intel_x64_guest_shadow::is_shadowed(field_type addr) noexcept
+{ return index(addr) != g_not_shadowed; }
+
+bool
+vmcs_intel_x64_guest_shadow::is_dirty(field_type addr) const noexcept
+{
+    auto &&i = index(addr);
+    return i != g_not_shadowed && is_bit_set(m_dirty, i);
+}
+
+vmcs_intel_x64_guest_shadow::index_type
+vmcs_intel_x64_guest_shadow::index(field_type addr) noexcept
+{
+    for (auto i = 0U; i < g_num_shadowed_fields; i++) {
+        if (gsl::at(g_shadowed_fields, i) == addr) {
+            return i;
+        }
+    }
+
+    return g_not_shadowed;
+}
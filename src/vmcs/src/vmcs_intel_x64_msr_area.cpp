@@ -0,0 +1,249 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <bfgsl.h>
+
+#include <algorithm>
+
+#include <memory_manager/memory_manager_x64.h>
+#include <vmcs/vmcs_intel_x64_msr_area.h>
+
+using namespace intel_x64;
+
+constexpr const vmcs_intel_x64_msr_area::size_type vmcs_intel_x64_msr_area::max_entries;
+
+void
+vmcs_intel_x64_msr_area::add(msr_type msr, value_type guest_value, value_type host_value)
+{
+    if (is_dedicated(msr)) {
+        switch (msr) {
+            case msrs::ia32_efer::addr:
+                vmcs::vm_entry_controls::load_ia32_efer::enable();
+                vmcs::vm_exit_controls::save_ia32_efer::enable();
+                vmcs::vm_exit_controls::load_ia32_efer::enable();
+                vmcs::guest_ia32_efer::set(guest_value);
+                break;
+
+            case x64::msrs::ia32_pat::addr:
+                vmcs::vm_entry_controls::load_ia32_pat::enable();
+                vmcs::vm_exit_controls::save_ia32_pat::enable();
+                vmcs::vm_exit_controls::load_ia32_pat::enable();
+                vmcs::guest_ia32_pat::set(guest_value);
+                break;
+
+            default:
+                vmcs::vm_entry_controls::load_ia32_perf_global_ctrl::enable();
+                vmcs::vm_exit_controls::load_ia32_perf_global_ctrl::enable();
+                vmcs::guest_ia32_perf_global_ctrl::set(guest_value);
+                break;
+        }
+
+        this->set_host_value(msr, host_value);
+
+        return;
+    }
+
+    this->allocate();
+
+    auto &&i = find(msr);
+    auto &&guest = m_guest_area.get();
+    auto &&host = m_host_area.get();
+
+    if (i == m_size || guest[i].index != msr) {
+        expects(m_size < max_entries);
+
+        std::move_backward(&guest[i], &guest[m_size], &guest[m_size + 1]);
+        std::move_backward(&host[i], &host[m_size], &host[m_size + 1]);
+
+        guest[i].index = msr;
+        guest[i].reserved = 0;
+        host[i].index = msr;
+        host[i].reserved = 0;
+
+        m_size++;
+        this->write_fields();
+    }
+
+    guest[i].data = guest_value;
+    host[i].data = host_value;
+}
+
+void
+vmcs_intel_x64_msr_area::remove(msr_type msr)
+{
+    if (!contains(msr)) {
+        return;
+    }
+
+    auto &&i = find(msr);
+    auto &&guest = m_guest_area.get();
+    auto &&host = m_host_area.get();
+
+    std::move(&guest[i + 1], &guest[m_size], &guest[i]);
+    std::move(&host[i + 1], &host[m_size], &host[i]);
+
+    m_size--;
+    this->write_fields();
+}
+
+bool
+vmcs_intel_x64_msr_area::contains(msr_type msr) const noexcept
+{
+    auto &&i = find(msr);
+    return i != m_size && m_guest_area.get()[i].index == msr;
+}
+
+bool
+vmcs_intel_x64_msr_area::is_dedicated(msr_type msr)
+{
+    switch (msr) {
+        case msrs::ia32_efer::addr:
+            return vmcs::vm_entry_controls::load_ia32_efer::is_allowed1() &&
+                   vmcs::vm_exit_controls::save_ia32_efer::is_allowed1() &&
+                   vmcs::vm_exit_controls::load_ia32_efer::is_allowed1();
+
+        case x64::msrs::ia32_pat::addr:
+            return vmcs::vm_entry_controls::load_ia32_pat::is_allowed1() &&
+                   vmcs::vm_exit_controls::save_ia32_pat::is_allowed1() &&
+                   vmcs::vm_exit_controls::load_ia32_pat::is_allowed1();
+
+        case msrs::ia32_perf_global_ctrl::addr:
+            return vmcs::vm_entry_controls::load_ia32_perf_global_ctrl::is_allowed1() &&
+                   vmcs::vm_exit_controls::load_ia32_perf_global_ctrl::is_allowed1();
+
+        default:
+            return false;
+    }
+}
+
+vmcs_intel_x64_msr_area::value_type
+vmcs_intel_x64_msr_area::guest_value(msr_type msr) const
+{
+    expects(!is_dedicated(msr));
+    expects(contains(msr));
+    return m_guest_area.get()[find(msr)].data;
+}
+
+void
+vmcs_intel_x64_msr_area::set_guest_value(msr_type msr, value_type val)
+{
+    expects(!is_dedicated(msr));
+    expects(contains(msr));
+    m_guest_area.get()[find(msr)].data = val;
+}
+
+vmcs_intel_x64_msr_area::value_type
+vmcs_intel_x64_msr_area::host_value(msr_type msr) const
+{
+    if (is_dedicated(msr)) {
+        switch (msr) {
+            case msrs::ia32_efer::addr:
+                return vmcs::host_ia32_efer::get();
+
+            case x64::msrs::ia32_pat::addr:
+                return vmcs::host_ia32_pat::get();
+
+            default:
+                return vmcs::host_ia32_perf_global_ctrl::get();
+        }
+    }
+
+    expects(contains(msr));
+    return m_host_area.get()[find(msr)].data;
+}
+
+void
+vmcs_intel_x64_msr_area::set_host_value(msr_type msr, value_type val)
+{
+    if (is_dedicated(msr)) {
+        switch (msr) {
+            case msrs::ia32_efer::addr:
+                return vmcs::host_ia32_efer::set(val);
+
+            case x64::msrs::ia32_pat::addr:
+                return vmcs::host_ia32_pat::set(val);
+
+            default:
+                return vmcs::host_ia32_perf_global_ctrl::set(val);
+        }
+    }
+
+    expects(contains(msr));
+    m_host_area.get()[find(msr)].data = val;
+}
+
+void
+vmcs_intel_x64_msr_area::load_guest_values() const noexcept
+{
+    for (auto i = 0ULL; i < m_size; i++) {
+        x64::msrs::set(m_guest_area.get()[i].index, m_guest_area.get()[i].data);
+    }
+}
+
+void
+vmcs_intel_x64_msr_area::write_fields()
+{
+    vmcs::vm_entry_msr_load_count::set(m_size);
+    vmcs::vm_exit_msr_store_count::set(m_size);
+    vmcs::vm_exit_msr_load_count::set(m_size);
+
+    if (!m_guest_area) {
+        return;
+    }
+
+    vmcs::vm_entry_msr_load_address::set(m_guest_area_phys);
+    vmcs::vm_exit_msr_store_address::set(m_guest_area_phys);
+    vmcs::vm_exit_msr_load_address::set(m_host_area_phys);
+}
+
+vmcs_intel_x64_msr_area::size_type
+vmcs_intel_x64_msr_area::find(msr_type msr) const noexcept
+{
+    if (!m_guest_area) {
+        return 0;
+    }
+
+    auto &&begin = m_guest_area.get();
+    auto &&end = begin + m_size;
+
+    auto &&iter = std::lower_bound(begin, end, msr, [](const entry_type & entry, msr_type index) {
+        return entry.index < index;
+    });
+
+    return gsl::narrow_cast<size_type>(iter - begin);
+}
+
+void
+vmcs_intel_x64_msr_area::allocate()
+{
+    if (m_guest_area) {
+        return;
+    }
+
+    auto &&guest = std::make_unique<entry_type[]>(max_entries);
+    auto &&host = std::make_unique<entry_type[]>(max_entries);
+
+    m_guest_area_phys = g_mm->virtptr_to_physint(guest.get());
+    m_host_area_phys = g_mm->virtptr_to_physint(host.get());
+
+    m_guest_area = std::move(guest);
+    m_host_area = std::move(host);
+}
@@ -0,0 +1,64 @@
+;
+; Bareflank Hypervisor
+;
+; Copyright (C) 2015 Assured Information Security, Inc.
+; Author: Rian Quinn        <quinnr@ainfosec.com>
+; Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+;
+; This library is free software; you can redistribute it and/or
+; modify it under the terms of the GNU Lesser General Public
+; License as published by the Free Software Foundation; either
+; version 2.1 of the License, or (at your option) any later version.
+;
+; This library is distributed in the hope that it will be useful,
+; but WITHOUT ANY WARRANTY; without even the implied warranty of
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+; Lesser General Public License for more details.
+;
+; You should have received a copy of the GNU Lesser General Public
+; License along with this library; if not, write to the Free Software
+; Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+bits 64
+default rel
+
+global vmcs_nm_handler:function
+
+section .text
+
+; Device Not Available (#NM) Handler
+;
+; Saves the guest's extended state the first time the VMM uses the FPU /
+; SSE / AVX registers during an exit, when the host CR0.TS is set (lazy
+; mode, see xstate_intel_x64). The handler runs on its own stack (IST1), and
+; only uses the registers it saves. The XSAVE area is allocated when lazy
+; mode is enabled, as this handler cannot allocate memory.
+;
+vmcs_nm_handler:
+
+    push rax
+    push rcx
+    push rdx
+
+    clts
+
+    test qword [gs:0x320], 0x2
+    jnz .saved
+
+    xor ecx, ecx
+    xgetbv
+    mov [gs:0x330], eax
+    mov [gs:0x334], edx
+
+    mov rcx, [gs:0x328]
+    xsaveopt64 [rcx]
+
+    or qword [gs:0x320], 0x2
+
+.saved:
+
+    pop rdx
+    pop rcx
+    pop rax
+
+    iretq
@@ -102,6 +102,25 @@ vmcs_promote:
 
     mov r15, rdi
 
+    ;
+    ; Restore Extended State
+    ;
+    ; This is done before the guest's CR0 is restored, as the guest might
+    ; have CR0.TS set. xmm0-xmm7 are restored below (if the entry point
+    ; saved them), on top of the extended state, as they are in vmcs_resume.
+    ;
+
+    test qword [r15 + 0x320], 0x2
+    jz .xrstor_done
+
+    mov rax, [r15 + 0x330]
+    mov rdx, rax
+    shr rdx, 32
+    mov rsi, [r15 + 0x328]
+    xrstor64 [rsi]
+
+.xrstor_done:
+
     ;
     ; Restore Control Registers
     ;
@@ -269,6 +288,9 @@ vmcs_promote:
 
     mov rdi, r15
 
+    test qword [rdi + 0x320], 0x4
+    jz .xmm_restored
+
     movdqa xmm7,  [rdi + 0x1A0]
     movdqa xmm6,  [rdi + 0x180]
     movdqa xmm5,  [rdi + 0x160]
@@ -278,6 +300,8 @@ vmcs_promote:
     movdqa xmm1,  [rdi + 0x0E0]
     movdqa xmm0,  [rdi + 0x0C0]
 
+.xmm_restored:
+
     mov rsp,       [rdi + 0x080]
     mov rax,       [rdi + 0x078]
     push rax
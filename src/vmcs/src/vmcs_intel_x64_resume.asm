@@ -48,6 +48,27 @@ vmcs_resume:
     mov rsi, VMCS_GUEST_RIP
     vmwrite rsi, [rdi + 0x078]
 
+; If a handler saved the guest's extended state, it is restored here, just
+; prior to restoring xmm0-xmm7. In eager mode, xmm0-xmm7 in the XSAVE area
+; might have already been modified by the VMM, so the copy saved by the
+; entry point is the one that is used.
+
+    test qword [rdi + 0x320], 0x2
+    jz .xrstor_done
+
+    mov rax, [rdi + 0x330]
+    mov rdx, rax
+    shr rdx, 32
+    mov rsi, [rdi + 0x328]
+    xrstor64 [rsi]
+
+    and qword [rdi + 0x320], ~0x2
+
+.xrstor_done:
+
+    test qword [rdi + 0x320], 0x4
+    jz .xmm_restored
+
     movdqa xmm7,  [rdi + 0x1A0]
     movdqa xmm6,  [rdi + 0x180]
     movdqa xmm5,  [rdi + 0x160]
@@ -57,6 +78,10 @@ vmcs_resume:
     movdqa xmm1,  [rdi + 0x0E0]
     movdqa xmm0,  [rdi + 0x0C0]
 
+    and qword [rdi + 0x320], ~0x4
+
+.xmm_restored:
+
     mov r15, [rdi + 0x070]
     mov r14, [rdi + 0x068]
     mov r13, [rdi + 0x060]
@@ -0,0 +1,231 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <cstring>
+#include <algorithm>
+
+#include <bfgsl.h>
+#include <bfdebug.h>
+
+#include <vmcs/vmcs_intel_x64_snapshot.h>
+#include <intrinsics/x86/intel_x64.h>
+
+using namespace intel_x64;
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+constexpr const vmcs_intel_x64_snapshot::class_type vmcs_intel_x64_snapshot::control;
+constexpr const vmcs_intel_x64_snapshot::class_type vmcs_intel_x64_snapshot::read_only;
+constexpr const vmcs_intel_x64_snapshot::class_type vmcs_intel_x64_snapshot::guest_state;
+constexpr const vmcs_intel_x64_snapshot::class_type vmcs_intel_x64_snapshot::host_state;
+constexpr const vmcs_intel_x64_snapshot::class_type vmcs_intel_x64_snapshot::all;
+constexpr const uint32_t vmcs_intel_x64_snapshot::magic;
+constexpr const uint16_t vmcs_intel_x64_snapshot::version;
+
+static auto
+current_revision_id()
+{ return gsl::narrow_cast<uint32_t>(msrs::ia32_vmx_basic::revision_id::get()); }
+
+void
+vmcs_intel_x64_snapshot::capture(class_type classes)
+{
+    auto ___ = gsl::on_failure([&]
+    { this->reset(); });
+
+    m_entries.clear();
+
+    for (const auto &field : vmcs::registry::fields) {
+
+        if ((class_of(field.addr) & classes) == 0 || !field.exists()) {
+            continue;
+        }
+
+        m_entries.push_back({gsl::narrow_cast<uint32_t>(field.addr), 0, vm::read(field.addr)});
+    }
+
+    m_header.magic = magic;
+    m_header.version = version;
+    m_header.num_fields = gsl::narrow<uint16_t>(m_entries.size());
+    m_header.revision_id = current_revision_id();
+    m_header.checksum = this->checksum();
+
+    bfdebug_transaction(1, [&](std::string * msg) {
+        bfdebug_pass(1, "capture vmcs snapshot", msg);
+        bfdebug_subnhex(1, "classes", classes, msg);
+        bfdebug_subndec(1, "fields", m_entries.size(), msg);
+    });
+}
+
+void
+vmcs_intel_x64_snapshot::restore(class_type classes) const
+{
+    expects(this->is_valid());
+
+    if (m_header.revision_id != current_revision_id()) {
+        throw std::runtime_error("vmcs snapshot was captured with a different vmcs revision id");
+    }
+
+    // Both the entries and the fields are sorted by encoding, so the
+    // field of each entry is found by walking the two together
+
+    auto field = std::begin(vmcs::registry::fields);
+
+    for (const auto &entry : m_entries) {
+
+        auto cls = class_of(entry.encoding);
+
+        if ((cls & classes) == 0 || cls == read_only) {
+            continue;
+        }
+
+        while (field != std::end(vmcs::registry::fields) && field->addr < entry.encoding) {
+            ++field;
+        }
+
+        if (field == std::end(vmcs::registry::fields) || field->addr != entry.encoding) {
+            continue;
+        }
+
+        if (field->exists()) {
+            vm::write(entry.encoding, entry.value);
+        }
+    }
+}
+
+void
+vmcs_intel_x64_snapshot::reset() noexcept
+{
+    m_header = {};
+    m_entries.clear();
+}
+
+bool
+vmcs_intel_x64_snapshot::is_valid() const noexcept
+{
+    if (m_header.magic != magic || m_header.version != version) {
+        return false;
+    }
+
+    if (m_header.num_fields != m_entries.size()) {
+        return false;
+    }
+
+    return m_header.checksum == this->checksum();
+}
+
+bool
+vmcs_intel_x64_snapshot::contains(field_type field) const noexcept
+{
+    auto &&entry = std::lower_bound(m_entries.begin(), m_entries.end(), field,
+    [](const auto & e, auto f) { return e.encoding < f; });
+
+    return entry != m_entries.end() && entry->encoding == field;
+}
+
+vmcs_intel_x64_snapshot::value_type
+vmcs_intel_x64_snapshot::get(field_type field) const
+{
+    auto &&entry = std::lower_bound(m_entries.begin(), m_entries.end(), field,
+    [](const auto & e, auto f) { return e.encoding < f; });
+
+    if (entry == m_entries.end() || entry->encoding != field) {
+        throw std::logic_error("field not in vmcs snapshot");
+    }
+
+    return entry->value;
+}
+
+std::vector<gsl::byte>
+vmcs_intel_x64_snapshot::serialize() const
+{
+    expects(this->is_valid());
+
+    auto &&entries_size = m_entries.size() * sizeof(entry_type);
+    std::vector<gsl::byte> image(sizeof(header_type) + entries_size);
+
+    std::memcpy(image.data(), &m_header, sizeof(header_type));
+    std::memcpy(image.data() + sizeof(header_type), m_entries.data(), entries_size);
+
+    return image;
+}
+
+void
+vmcs_intel_x64_snapshot::deserialize(gsl::span<const gsl::byte> image)
+{
+    auto ___ = gsl::on_failure([&]
+    { this->reset(); });
+
+    this->reset();
+
+    auto &&size = static_cast<std::size_t>(image.size());
+
+    if (size < sizeof(header_type)) {
+        throw std::runtime_error("invalid vmcs snapshot: truncated header");
+    }
+
+    std::memcpy(&m_header, image.data(), sizeof(header_type));
+
+    if (m_header.magic != magic || m_header.version != version) {
+        throw std::runtime_error("invalid vmcs snapshot: unknown magic / version");
+    }
+
+    if (size != sizeof(header_type) + m_header.num_fields * sizeof(entry_type)) {
+        throw std::runtime_error("invalid vmcs snapshot: size mismatch");
+    }
+
+    m_entries.resize(m_header.num_fields);
+    std::memcpy(m_entries.data(), image.data() + sizeof(header_type), size - sizeof(header_type));
+
+    auto &&sorted = std::adjacent_find(m_entries.begin(), m_entries.end(),
+    [](const auto & lhs, const auto & rhs) { return lhs.encoding >= rhs.encoding; });
+
+    if (sorted != m_entries.end()) {
+        throw std::runtime_error("invalid vmcs snapshot: fields out of order");
+    }
+
+    if (m_header.checksum != this->checksum()) {
+        throw std::runtime_error("invalid vmcs snapshot: checksum mismatch");
+    }
+}
+
+uint32_t
+vmcs_intel_x64_snapshot::checksum() const noexcept
+{
+    // FNV-1a, over the header (without the checksum) and the entries
+
+    uint32_t hash = 0x811C9DC5U;
+    auto &&add = [&](const void *data, std::size_t size) {
+        auto &&bytes = static_cast<const uint8_t *>(data);
+        for (auto i = 0ULL; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x01000193U;
+        }
+    };
+
+    auto header = m_header;
+    header.checksum = 0;
+
+    add(&header, sizeof(header_type));
+    add(m_entries.data(), m_entries.size() * sizeof(entry_type));
+
+    return hash;
+}
@@ -19,6 +19,9 @@
 // License along with this library; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
 
+#include <bfconstants.h>
+
+#include <vmcs/vmcs_intel_x64_nm_handler.h>
 #include <vmcs/vmcs_intel_x64_vmm_state.h>
 
 #include <memory_manager/pat_x64.h>
@@ -47,6 +50,15 @@ vmcs_intel_x64_vmm_state::vmcs_intel_x64_vmm_state()
     m_gs = gsl::narrow_cast<segment_register::value_type>(m_gs_index << 3);
     m_tr = gsl::narrow_cast<segment_register::value_type>(m_tr_index << 3);
 
+    // The only exception the VMM handles is #NM, which is used to save the
+    // guest's extended state lazily (see vmcs_nm_handler). The IDT's
+    // descriptors use IST1, so the handler runs on its own stack.
+
+    m_ist1 = std::make_unique<gsl::byte[]>(STACK_SIZE);
+    m_tss.ist1 = (reinterpret_cast<uintptr_t>(m_ist1.get()) + STACK_SIZE) & ~0xFULL;
+
+    m_idt.set(7, vmcs_nm_handler, m_cs);
+
     m_cr0 = 0;
     m_cr0 |= cr0::protection_enable::mask;
     m_cr0 |= cr0::monitor_coprocessor::mask;
@@ -0,0 +1,229 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <bfgsl.h>
+#include <bfdebug.h>
+
+#include <vmcs/vmcs_intel_x64_vpid.h>
+#include <intrinsics/x86/intel_x64.h>
+
+using namespace intel_x64;
+
+// -----------------------------------------------------------------------------
+// Mutex
+// -----------------------------------------------------------------------------
+
+#include <mutex>
+static std::mutex g_vpid_allocator_mutex;
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+constexpr const vpid_allocator_intel_x64::size_type vpid_allocator_intel_x64::max_vpids;
+
+vpid_allocator_intel_x64 *
+vpid_allocator_intel_x64::instance() noexcept
+{
+    static vpid_allocator_intel_x64 self;
+    return &self;
+}
+
+vpid_allocator_intel_x64::vpid_type
+vpid_allocator_intel_x64::allocate() noexcept
+{
+    std::lock_guard<std::mutex> guard(g_vpid_allocator_mutex);
+
+    // The search starts after the last VPID that was handed out, so that a
+    // VPID that was just freed is the last one to be handed out again
+
+    for (auto i = 0ULL; i < max_vpids; i++) {
+        auto &&vpid = m_next;
+        m_next = m_next == max_vpids ? 1 : gsl::narrow_cast<vpid_type>(m_next + 1);
+
+        if (!m_allocated[vpid]) {
+            m_allocated[vpid] = true;
+            return vpid;
+        }
+    }
+
+    return 0;
+}
+
+void
+vpid_allocator_intel_x64::free(vpid_type vpid) noexcept
+{
+    std::lock_guard<std::mutex> guard(g_vpid_allocator_mutex);
+    m_allocated[vpid] = false;
+}
+
+bool
+vpid_allocator_intel_x64::is_allocated(vpid_type vpid) const noexcept
+{
+    std::lock_guard<std::mutex> guard(g_vpid_allocator_mutex);
+    return vpid != 0 && m_allocated[vpid];
+}
+
+vpid_allocator_intel_x64::size_type
+vpid_allocator_intel_x64::size() const noexcept
+{
+    std::lock_guard<std::mutex> guard(g_vpid_allocator_mutex);
+    return m_allocated.count();
+}
+
+vmcs_intel_x64_vpid::~vmcs_intel_x64_vpid() noexcept
+{
+    if (m_id != 0) {
+        vpid_allocator_intel_x64::instance()->free(m_id);
+    }
+}
+
+vmcs_intel_x64_vpid::vmcs_intel_x64_vpid(vmcs_intel_x64_vpid &&other) noexcept :
+    m_id(other.m_id),
+    m_cpuid(other.m_cpuid)
+{
+    other.m_id = 0;
+}
+
+vmcs_intel_x64_vpid &
+vmcs_intel_x64_vpid::operator=(vmcs_intel_x64_vpid &&other) noexcept
+{
+    if (this != &other) {
+        if (m_id != 0) {
+            vpid_allocator_intel_x64::instance()->free(m_id);
+        }
+
+        m_id = other.m_id;
+        m_cpuid = other.m_cpuid;
+        other.m_id = 0;
+    }
+
+    return *this;
+}
+
+void
+vmcs_intel_x64_vpid::write_fields()
+{
+    if (!is_supported()) {
+        return;
+    }
+
+    if (m_id == 0) {
+        auto &&vpid = vpid_allocator_intel_x64::instance()->allocate();
+
+        if (vpid == 0) {
+            bfalert_info(0, "out of VPIDs, the TLB is flushed on every VM entry / exit");
+            return;
+        }
+
+        auto ___ = gsl::on_failure([&]
+        { vpid_allocator_intel_x64::instance()->free(vpid); });
+
+        // The VPID might have been used by a vCPU that has since been
+        // deleted, in which case the TLB might still hold its translations
+
+        flush(vpid);
+
+        m_id = vpid;
+        m_cpuid = thread_context_cpuid();
+    }
+
+    vmcs::virtual_processor_identifier::set(m_id);
+    vmcs::secondary_processor_based_vm_execution_controls::enable_vpid::enable();
+}
+
+void
+vmcs_intel_x64_vpid::load()
+{
+    auto &&cpuid = thread_context_cpuid();
+
+    if (m_id == 0 || m_cpuid == cpuid) {
+        return;
+    }
+
+    // The VPID might have been flushed on another CPU since the VMCS last
+    // ran here, and a recycled VPID might still have the translations of
+    // its previous owner here
+
+    flush(m_id);
+    m_cpuid = cpuid;
+}
+
+bool
+vmcs_intel_x64_vpid::is_supported()
+{
+    if (!msrs::ia32_vmx_true_procbased_ctls::activate_secondary_controls::is_allowed1()) {
+        return false;
+    }
+
+    if (!msrs::ia32_vmx_procbased_ctls2::enable_vpid::is_allowed1()) {
+        return false;
+    }
+
+    if (!msrs::ia32_vmx_ept_vpid_cap::invvpid_support::is_enabled()) {
+        return false;
+    }
+
+    return msrs::ia32_vmx_ept_vpid_cap::invvpid_single_context_support::is_enabled() ||
+           msrs::ia32_vmx_ept_vpid_cap::invvpid_all_context_support::is_enabled();
+}
+
+void
+vmcs_intel_x64_vpid::flush(vpid_type vpid)
+{
+    if (vpid == 0) {
+        return;
+    }
+
+    if (msrs::ia32_vmx_ept_vpid_cap::invvpid_single_context_support::is_enabled()) {
+        return vmx::invvpid_single_context(vpid);
+    }
+
+    vmx::invvpid_all_contexts();
+}
+
+void
+vmcs_intel_x64_vpid::flush_non_global(vpid_type vpid)
+{
+    if (vpid == 0) {
+        return;
+    }
+
+    if (msrs::ia32_vmx_ept_vpid_cap::invvpid_single_context_retaining_globals_support::is_enabled()) {
+        return vmx::invvpid_single_context_global(vpid);
+    }
+
+    flush(vpid);
+}
+
+void
+vmcs_intel_x64_vpid::flush_address(vpid_type vpid, integer_pointer addr)
+{
+    if (vpid == 0) {
+        return;
+    }
+
+    if (msrs::ia32_vmx_ept_vpid_cap::invvpid_individual_address_support::is_enabled()) {
+        return vmx::invvpid_individual_address(vpid, addr);
+    }
+
+    flush(vpid);
+}
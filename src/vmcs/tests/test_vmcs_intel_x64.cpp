@@ -24,6 +24,7 @@
 #include <hippomocks.h>
 
 #include <bfgsl.h>
+#include <bfbenchmark.h>
 
 #include <intrinsics/x86/common_x64.h>
 #include <intrinsics/x86/intel_x64.h>
@@ -50,6 +51,11 @@ bool g_virt_to_phys_return_nullptr = false;
 bool g_phys_to_virt_return_nullptr = false;
 bool g_vmclear_fails = false;
 bool g_vmload_fails = false;
+
+uint64_t g_vmclear_count = 0;
+uint64_t g_vmptrld_count = 0;
+uintptr_t g_vmptrld_phys = 0;
+uint64_t g_thread_context_cpuid = 0;
 bool g_vmlaunch_fails = false;
 
 size_t g_new_throws_bad_alloc;
@@ -92,11 +98,20 @@ test_read_msr(uint32_t addr) noexcept
 
 static bool
 test_vmclear(void *ptr) noexcept
-{ (void)ptr; return !g_vmclear_fails; }
+{ (void)ptr; g_vmclear_count++; return !g_vmclear_fails; }
 
 static bool
 test_vmptrld(void *ptr) noexcept
-{ (void)ptr; return !g_vmload_fails; }
+{
+    g_vmptrld_count++;
+    g_vmptrld_phys = *static_cast<uintptr_t *>(ptr);
+
+    return !g_vmload_fails;
+}
+
+static uint64_t
+test_thread_context_cpuid() noexcept
+{ return g_thread_context_cpuid; }
 
 static bool
 test_vmlaunch_demote() noexcept
@@ -106,6 +121,10 @@ static uint32_t
 test_cpuid_eax(uint32_t val) noexcept
 { return g_eax_cpuid[val]; }
 
+static void
+test_write_msr(uint32_t addr, uint64_t val) noexcept
+{ g_msrs[addr] = val; }
+
 static void
 vmcs_promote_fail(bool state_save)
 {
@@ -243,6 +262,7 @@ setup_vmcs_intrinsics(MockRepository &mocks, memory_manager_x64 *mm)
     mocks.OnCallFunc(_vmptrld).Do(test_vmptrld);
     mocks.OnCallFunc(_vmlaunch_demote).Do(test_vmlaunch_demote);
     mocks.OnCallFunc(_cpuid_eax).Do(test_cpuid_eax);
+    mocks.OnCallFunc(thread_context_cpuid).Do(test_thread_context_cpuid);
 }
 
 TEST_CASE("vmcs: launch_success")
@@ -262,6 +282,211 @@ TEST_CASE("vmcs: launch_success")
     CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
 }
 
+TEST_CASE("vmcs: launch_writes_state_fields")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    mocks.OnCall(guest_state, vmcs_intel_x64_state::cs).Return(0x08);
+    mocks.OnCall(host_state, vmcs_intel_x64_state::tr).Return(0x40);
+
+    vmcs_intel_x64 vmcs{};
+    g_vmcs_fields.clear();
+
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    CHECK(g_vmcs_fields[vmcs::guest_cs_selector::addr] == 0x08);
+    CHECK(g_vmcs_fields[vmcs::guest_ss_selector::addr] == 0x10);
+    CHECK(g_vmcs_fields[vmcs::guest_cs_limit::addr] == 0xFFFFFFFF);
+    CHECK(g_vmcs_fields[vmcs::guest_tr_limit::addr] == sizeof(tss_x64));
+    CHECK(g_vmcs_fields[vmcs::guest_tr_access_rights::addr] == access_rights::ring0_tr_descriptor);
+    CHECK(g_vmcs_fields[vmcs::guest_rflags::addr] == rflags::interrupt_enable_flag::mask);
+    CHECK(g_vmcs_fields[vmcs::vmcs_link_pointer::addr] == 0xFFFFFFFFFFFFFFFF);
+    CHECK(g_vmcs_fields[vmcs::host_tr_selector::addr] == 0x40);
+    CHECK(g_vmcs_fields[vmcs::host_ia32_efer::addr] == (intel_x64::msrs::ia32_efer::lme::mask | intel_x64::msrs::ia32_efer::lma::mask));
+    CHECK(g_vmcs_fields[vmcs::host_cr4::addr] == cr4::physical_address_extensions::mask);
+}
+
+TEST_CASE("vmcs: launch_msr_area_empty")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    vmcs_intel_x64 vmcs{};
+    g_vmcs_fields.clear();
+
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    CHECK(vmcs.m_msr_area.size() == 0);
+    CHECK(g_vmcs_fields[vmcs::vm_entry_msr_load_count::addr] == 0);
+    CHECK(g_vmcs_fields[vmcs::vm_exit_msr_store_count::addr] == 0);
+    CHECK(g_vmcs_fields[vmcs::vm_exit_msr_load_count::addr] == 0);
+}
+
+TEST_CASE("vmcs: launch_required_state_field_missing")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    g_msrs[intel_x64::msrs::ia32_vmx_true_exit_ctls::addr] &=
+        ~(intel_x64::msrs::ia32_vmx_true_exit_ctls::load_ia32_efer::mask << 32);
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_THROWS(vmcs.launch(host_state, guest_state));
+
+    setup_launch_success_msrs();
+}
+
+TEST_CASE("vmcs: relaunch_restores_snapshot")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    vmcs_intel_x64 vmcs{};
+
+    g_vmcs_fields.clear();
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    auto fields = g_vmcs_fields;
+    g_vmcs_fields.clear();
+
+    mocks.OnCall(guest_state, vmcs_intel_x64_state::cs).Return(0x08);
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    CHECK(g_vmcs_fields[vmcs::pin_based_vm_execution_controls::addr] == fields[vmcs::pin_based_vm_execution_controls::addr]);
+    CHECK(g_vmcs_fields[vmcs::primary_processor_based_vm_execution_controls::addr] == fields[vmcs::primary_processor_based_vm_execution_controls::addr]);
+    CHECK(g_vmcs_fields[vmcs::vm_exit_controls::addr] == fields[vmcs::vm_exit_controls::addr]);
+    CHECK(g_vmcs_fields[vmcs::vm_entry_controls::addr] == fields[vmcs::vm_entry_controls::addr]);
+    CHECK(g_vmcs_fields[vmcs::host_cr4::addr] == fields[vmcs::host_cr4::addr]);
+    CHECK(g_vmcs_fields[vmcs::host_rip::addr] == fields[vmcs::host_rip::addr]);
+    CHECK(g_vmcs_fields[vmcs::host_rsp::addr] != 0);
+    CHECK(g_vmcs_fields[vmcs::guest_cs_selector::addr] == 0x08);
+}
+
+TEST_CASE("vmcs: relaunch_reuses_region_and_stack")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    vmcs_intel_x64 vmcs{};
+
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    auto phys = g_vmptrld_phys;
+    auto host_rsp = g_vmcs_fields[vmcs::host_rsp::addr];
+
+    g_vmclear_count = 0;
+    g_vmptrld_count = 0;
+
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    CHECK(g_vmptrld_phys == phys);
+    CHECK(g_vmcs_fields[vmcs::host_rsp::addr] == host_rsp);
+    CHECK(g_vmclear_count == 1);
+    CHECK(g_vmptrld_count == 1);
+}
+
+TEST_CASE("vmcs: relaunch_on_another_cpu")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    auto ___ = gsl::finally([&]
+    { g_thread_context_cpuid = 0; });
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    auto phys = g_vmptrld_phys;
+
+    g_thread_context_cpuid = 1;
+    CHECK_THROWS(vmcs.launch(host_state, guest_state));
+
+    g_thread_context_cpuid = 0;
+    CHECK_NOTHROW(vmcs.clear());
+
+    g_thread_context_cpuid = 1;
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+    CHECK(g_vmptrld_phys == phys);
+}
+
+constexpr const auto NUM_ITERATIONS = 0x100U;
+
+TEST_CASE("vmcs: relaunch_benchmark")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    bfdebug_lnbr(0);
+    bfdebug_info(0, "vmcs launch");
+    bfdebug_brk2(0);
+
+    bfdebug_ndec(0, "first launch", benchmark([&] {
+        for (auto i = 0U; i < NUM_ITERATIONS; i++)
+        {
+            vmcs_intel_x64 vmcs{};
+            vmcs.launch(host_state, guest_state);
+        }
+    }));
+
+    vmcs_intel_x64 vmcs{};
+    vmcs.launch(host_state, guest_state);
+
+    bfdebug_ndec(0, "relaunch", benchmark([&] {
+        for (auto i = 0U; i < NUM_ITERATIONS; i++)
+        { vmcs.launch(host_state, guest_state); }
+    }));
+}
+
 TEST_CASE("vmcs: launch_vmlaunch_failure")
 {
     MockRepository mocks;
@@ -314,7 +539,11 @@ TEST_CASE("vmcs: launch_vmlaunch_demote_failure")
         sub_path.setup();
     }
 
+    g_vmclear_count = 0;
+
     CHECK_THROWS(vmcs.launch(host_state, guest_state));
+    CHECK(g_vmclear_count == 2);
+    CHECK(vm::current() == 0);
 }
 
 TEST_CASE("vmcs: launch_create_vmcs_region_failure")
@@ -392,6 +621,232 @@ TEST_CASE("vmcs: launch_load_failure")
     CHECK_THROWS(vmcs.launch(host_state, guest_state));
 }
 
+TEST_CASE("vmcs: load_current_vmcs")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    g_vmptrld_count = 0;
+
+    CHECK_NOTHROW(vmcs.load());
+    CHECK_NOTHROW(vmcs.load());
+    CHECK(g_vmptrld_count == 0);
+}
+
+TEST_CASE("vmcs: load_after_another_vmcs")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    uintptr_t other_vmcs_phys = 0x1000;
+    CHECK_NOTHROW(vm::load(&other_vmcs_phys));
+
+    g_vmptrld_count = 0;
+
+    CHECK_NOTHROW(vmcs.load());
+    CHECK_NOTHROW(vmcs.load());
+    CHECK(g_vmptrld_count == 1);
+}
+
+TEST_CASE("vmcs: clear_cleared_vmcs")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    g_vmclear_count = 0;
+    g_vmptrld_count = 0;
+
+    CHECK_NOTHROW(vmcs.clear());
+    CHECK_NOTHROW(vmcs.clear());
+    CHECK(g_vmclear_count == 1);
+
+    CHECK_NOTHROW(vmcs.load());
+    CHECK_NOTHROW(vmcs.load());
+    CHECK(g_vmptrld_count == 1);
+}
+
+TEST_CASE("vmcs: move_between_cpus")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    auto ___ = gsl::finally([&]
+    { g_thread_context_cpuid = 0; });
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    g_vmclear_count = 0;
+    g_vmptrld_count = 0;
+    g_thread_context_cpuid = 1;
+
+    CHECK_THROWS(vmcs.load());
+    CHECK_THROWS(vmcs.clear());
+
+    g_thread_context_cpuid = 0;
+    CHECK_NOTHROW(vmcs.clear());
+
+    g_thread_context_cpuid = 1;
+    CHECK_NOTHROW(vmcs.load());
+    CHECK_NOTHROW(vmcs.load());
+
+    CHECK(g_vmclear_count == 1);
+    CHECK(g_vmptrld_count == 1);
+}
+
+TEST_CASE("vmcs: prepare_then_launch")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_NOTHROW(vmcs.prepare(host_state, guest_state));
+
+    // What is written to a prepared VMCS is launched as it is
+
+    g_vmclear_count = 0;
+    g_vmptrld_count = 0;
+    g_vmcs_fields[vmcs::cr0_read_shadow::addr] = 0x1234;
+
+    CHECK_NOTHROW(vmcs.prepare(host_state, guest_state));
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    CHECK(g_vmclear_count == 0);
+    CHECK(g_vmptrld_count == 0);
+    CHECK(g_vmcs_fields[vmcs::cr0_read_shadow::addr] == 0x1234);
+
+    // Once launched, the next launch writes the fields again
+
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+    CHECK(g_vmclear_count == 1);
+    CHECK(g_vmcs_fields[vmcs::cr0_read_shadow::addr] != 0x1234);
+}
+
+TEST_CASE("vmcs: destroy_clears_active_vmcs")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    {
+        vmcs_intel_x64 vmcs{};
+        CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+        g_vmclear_count = 0;
+    }
+
+    CHECK(g_vmclear_count == 1);
+    CHECK(vm::current() == 0);
+}
+
+TEST_CASE("vmcs: destroy_after_vmxoff_does_not_clear")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    mocks.OnCallFunc(_vmxoff).Return(true);
+
+    {
+        vmcs_intel_x64 vmcs{};
+        CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+        // The vCPU is halted (VMXOFF) before it is deleted
+
+        CHECK_NOTHROW(vmx::off());
+        g_vmclear_count = 0;
+    }
+
+    CHECK(g_vmclear_count == 0);
+    CHECK(vm::current() == 0);
+}
+
+TEST_CASE("vmcs: load_after_vmxoff_on_another_cpu")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    mocks.OnCallFunc(_vmxoff).Return(true);
+
+    auto ___ = gsl::finally([&]
+    { g_thread_context_cpuid = 0; });
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    g_thread_context_cpuid = 1;
+    CHECK_THROWS(vmcs.load());
+
+    g_thread_context_cpuid = 0;
+    CHECK_NOTHROW(vmx::off());
+
+    g_thread_context_cpuid = 1;
+    CHECK_NOTHROW(vmcs.load());
+}
+
 TEST_CASE("vmcs: promote_failure")
 {
     MockRepository mocks;
@@ -402,6 +857,33 @@ TEST_CASE("vmcs: promote_failure")
     CHECK_THROWS(vmcs.promote());
 }
 
+TEST_CASE("vmcs: promote_loads_guest_msrs")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    mocks.OnCallFunc(vmcs_promote).Do(vmcs_promote_fail);
+    mocks.OnCallFunc(_write_msr).Do(test_write_msr);
+
+    vmcs_intel_x64 vmcs{};
+    CHECK_NOTHROW(vmcs.launch(host_state, guest_state));
+
+    vmcs.m_msr_area.add(x64::msrs::ia32_lstar::addr, 0x5678, 0x1234);
+    g_msrs[x64::msrs::ia32_lstar::addr] = 0x1234;
+
+    CHECK_THROWS(vmcs.promote());
+    CHECK(g_msrs[x64::msrs::ia32_lstar::addr] == 0x5678);
+
+    g_msrs[x64::msrs::ia32_lstar::addr] = 0;
+}
+
 TEST_CASE("vmcs: resume_failure")
 {
     MockRepository mocks;
@@ -412,4 +894,23 @@ TEST_CASE("vmcs: resume_failure")
     CHECK_THROWS(vmcs.resume());
 }
 
+TEST_CASE("vmcs: resume_check_on_entry_failure")
+{
+    MockRepository mocks;
+    mocks.NeverCallFunc(vmcs_resume);
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(thread_context_cpuid).Do(test_thread_context_cpuid);
+
+    auto ___ = gsl::finally([&]
+    { vm::track_dirty_fields(false); });
+
+    g_vmcs_fields.clear();
+
+    vmcs_intel_x64 vmcs{};
+    vmcs.set_check_on_entry(true);
+
+    CHECK(vm::dirty_enabled());
+    CHECK_THROWS_AS(vmcs.resume(), std::logic_error);
+}
+
 #endif
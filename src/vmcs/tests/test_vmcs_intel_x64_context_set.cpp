@@ -0,0 +1,294 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <vmcs/vmcs_intel_x64_context_set.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+static state_save_intel_x64 g_state_save{};
+
+template<typename T> auto
+mock_no_delete(MockRepository &mocks)
+{
+    auto ptr = mocks.Mock<T>();
+    mocks.OnCallDestructor(ptr);
+
+    return ptr;
+}
+
+template <typename T> auto
+mock_unique(MockRepository &mocks)
+{
+    return std::unique_ptr<T>(mock_no_delete<T>(mocks));
+}
+
+static auto
+setup_guest_state(MockRepository &mocks, bool is_guest = true)
+{
+    auto gs = mock_unique<vmcs_intel_x64_state>(mocks);
+    mocks.OnCall(gs.get(), vmcs_intel_x64_state::is_guest).Return(is_guest);
+
+    return gs;
+}
+
+static auto
+setup_contexts(MockRepository &mocks, vmcs_intel_x64 *&primary, vmcs_intel_x64_state *&host_state)
+{
+    primary = mocks.Mock<vmcs_intel_x64>();
+    host_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    g_state_save = {};
+    g_state_save.vcpuid = 0x1;
+    g_state_save.vmxon_ptr = 0x2;
+    g_state_save.vmcs_ptr = 0x3;
+    g_state_save.exit_handler_ptr = 0x4;
+
+    return vmcs_intel_x64_context_set(primary, &g_state_save, host_state, reinterpret_cast<void *>(0x5));
+}
+
+TEST_CASE("vmcs_context_set: primary")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    CHECK(contexts.size() == 1);
+    CHECK(contexts.current() == vmcs_intel_x64_context_set::primary);
+    CHECK(contexts.is_launched(vmcs_intel_x64_context_set::primary));
+    CHECK(contexts.vmcs(vmcs_intel_x64_context_set::primary) == primary);
+    CHECK(contexts.state_save(vmcs_intel_x64_context_set::primary) == &g_state_save);
+
+    CHECK_THROWS(contexts.is_launched(1));
+    CHECK_THROWS(contexts.vmcs(1));
+    CHECK_THROWS(contexts.state_save(1));
+}
+
+TEST_CASE("vmcs_context_set: add_invalid")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    CHECK_THROWS(contexts.add(nullptr, setup_guest_state(mocks)));
+    CHECK_THROWS(contexts.add(mock_unique<vmcs_intel_x64>(mocks), nullptr));
+    CHECK_THROWS(contexts.add(mock_unique<vmcs_intel_x64>(mocks), setup_guest_state(mocks, false)));
+
+    CHECK(contexts.size() == 1);
+}
+
+TEST_CASE("vmcs_context_set: add")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    auto vmcs = mock_unique<vmcs_intel_x64>(mocks);
+    auto vmcs_ptr = vmcs.get();
+
+    mocks.ExpectCall(vmcs_ptr, vmcs_intel_x64::set_state_save);
+    mocks.ExpectCall(vmcs_ptr, vmcs_intel_x64::set_exit_handler_entry).With(reinterpret_cast<void *>(0x5));
+
+    auto ctx = contexts.add(std::move(vmcs), setup_guest_state(mocks));
+
+    CHECK(ctx == 1);
+    CHECK(contexts.size() == 2);
+    CHECK(contexts.current() == vmcs_intel_x64_context_set::primary);
+    CHECK_FALSE(contexts.is_launched(ctx));
+    CHECK(contexts.vmcs(ctx) == vmcs_ptr);
+
+    auto state_save = contexts.state_save(ctx);
+
+    CHECK(state_save != &g_state_save);
+    CHECK(state_save->vcpuid == 0x1);
+    CHECK(state_save->vmxon_ptr == 0x2);
+    CHECK(state_save->vmcs_ptr == reinterpret_cast<uintptr_t>(vmcs_ptr));
+    CHECK(state_save->exit_handler_ptr == 0x4);
+}
+
+TEST_CASE("vmcs_context_set: switch_to_invalid")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    CHECK_THROWS(contexts.switch_to(1));
+    CHECK(contexts.current() == vmcs_intel_x64_context_set::primary);
+}
+
+TEST_CASE("vmcs_context_set: switch_to_not_launched")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    auto vmcs = mock_unique<vmcs_intel_x64>(mocks);
+    auto vmcs_ptr = vmcs.get();
+    auto gs = setup_guest_state(mocks);
+    auto gs_ptr = gs.get();
+
+    // The VMCS is prepared, so that it can be written before it is
+    // launched (e.g. to inject an event)
+
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_state_save);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_exit_handler_entry);
+    mocks.ExpectCall(vmcs_ptr, vmcs_intel_x64::prepare).With(host_state, gs_ptr);
+    mocks.NeverCall(vmcs_ptr, vmcs_intel_x64::load);
+    mocks.NeverCall(vmcs_ptr, vmcs_intel_x64::launch);
+
+    auto ctx = contexts.add(std::move(vmcs), std::move(gs));
+
+    CHECK_NOTHROW(contexts.switch_to(ctx));
+    CHECK_NOTHROW(contexts.load());
+    CHECK(contexts.current() == ctx);
+}
+
+TEST_CASE("vmcs_context_set: resume_launches_once")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    auto vmcs = mock_unique<vmcs_intel_x64>(mocks);
+    auto vmcs_ptr = vmcs.get();
+    auto gs = setup_guest_state(mocks);
+    auto gs_ptr = gs.get();
+
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_state_save);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_exit_handler_entry);
+    mocks.ExpectCall(vmcs_ptr, vmcs_intel_x64::prepare).With(host_state, gs_ptr);
+    mocks.ExpectCall(vmcs_ptr, vmcs_intel_x64::launch).With(host_state, gs_ptr);
+    mocks.ExpectCall(vmcs_ptr, vmcs_intel_x64::resume);
+    mocks.NeverCall(primary, vmcs_intel_x64::launch);
+    mocks.NeverCall(primary, vmcs_intel_x64::resume);
+
+    auto ctx = contexts.add(std::move(vmcs), std::move(gs));
+    contexts.switch_to(ctx);
+
+    CHECK_NOTHROW(contexts.resume());
+    CHECK(contexts.is_launched(ctx));
+    CHECK_NOTHROW(contexts.resume());
+}
+
+TEST_CASE("vmcs_context_set: resume_launch_fails")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    auto vmcs = mock_unique<vmcs_intel_x64>(mocks);
+    auto vmcs_ptr = vmcs.get();
+
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_state_save);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_exit_handler_entry);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::prepare);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::launch).Throw(std::runtime_error("error"));
+
+    auto ctx = contexts.add(std::move(vmcs), setup_guest_state(mocks));
+    contexts.switch_to(ctx);
+
+    CHECK_THROWS(contexts.resume());
+    CHECK_FALSE(contexts.is_launched(ctx));
+}
+
+TEST_CASE("vmcs_context_set: switch_between_launched")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    auto vmcs = mock_unique<vmcs_intel_x64>(mocks);
+    auto vmcs_ptr = vmcs.get();
+
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_state_save);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_exit_handler_entry);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::prepare);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::launch);
+
+    auto ctx = contexts.add(std::move(vmcs), setup_guest_state(mocks));
+    contexts.switch_to(ctx);
+    contexts.resume();
+
+    // Switching only loads the VMCS. The host state is written when the
+    // VMCS is first switched to, and is never written again.
+
+    mocks.ExpectCall(primary, vmcs_intel_x64::load);
+    mocks.ExpectCall(primary, vmcs_intel_x64::resume);
+    mocks.NeverCall(primary, vmcs_intel_x64::launch);
+
+    CHECK_NOTHROW(contexts.switch_to(vmcs_intel_x64_context_set::primary));
+    CHECK_NOTHROW(contexts.resume());
+
+    mocks.ExpectCall(vmcs_ptr, vmcs_intel_x64::load);
+    mocks.ExpectCall(vmcs_ptr, vmcs_intel_x64::resume);
+    mocks.NeverCall(vmcs_ptr, vmcs_intel_x64::prepare);
+    mocks.NeverCall(vmcs_ptr, vmcs_intel_x64::launch);
+
+    CHECK_NOTHROW(contexts.switch_to(ctx));
+    CHECK_NOTHROW(contexts.resume());
+}
+
+TEST_CASE("vmcs_context_set: reset")
+{
+    MockRepository mocks;
+
+    vmcs_intel_x64 *primary = nullptr;
+    vmcs_intel_x64_state *host_state = nullptr;
+    auto contexts = setup_contexts(mocks, primary, host_state);
+
+    auto vmcs = mock_unique<vmcs_intel_x64>(mocks);
+    auto vmcs_ptr = vmcs.get();
+
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_state_save);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::set_exit_handler_entry);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::prepare);
+    mocks.OnCall(vmcs_ptr, vmcs_intel_x64::launch);
+
+    auto ctx = contexts.add(std::move(vmcs), setup_guest_state(mocks));
+    contexts.switch_to(ctx);
+    contexts.resume();
+
+    contexts.reset();
+
+    CHECK(contexts.current() == vmcs_intel_x64_context_set::primary);
+    CHECK(contexts.is_launched(vmcs_intel_x64_context_set::primary));
+    CHECK_FALSE(contexts.is_launched(ctx));
+}
+
+#endif
@@ -0,0 +1,91 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <vmcs/vmcs_intel_x64_control_registers.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+static std::map<uint32_t, uint64_t> g_msrs;
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static void
+setup_msrs(MockRepository &mocks)
+{
+    g_msrs[msrs::ia32_vmx_cr0_fixed0::addr] = 0x0000000080000021UL;
+    g_msrs[msrs::ia32_vmx_cr0_fixed1::addr] = 0x00000000FFFFFFFFUL;
+    g_msrs[msrs::ia32_vmx_cr4_fixed0::addr] = 0x0000000000002000UL;
+    g_msrs[msrs::ia32_vmx_cr4_fixed1::addr] = 0x00000000003767FFUL;
+
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+}
+
+TEST_CASE("vmcs_control_registers: cr0_guest_host_mask")
+{
+    MockRepository mocks;
+    setup_msrs(mocks);
+
+    CHECK(vmcs::control_registers::cr0_guest_host_mask() == 0xFFFFFFFF80000021UL);
+}
+
+TEST_CASE("vmcs_control_registers: cr4_guest_host_mask")
+{
+    MockRepository mocks;
+    setup_msrs(mocks);
+
+    CHECK(vmcs::control_registers::cr4_guest_host_mask() == 0xFFFFFFFFFFC8B800UL);
+}
+
+TEST_CASE("vmcs_control_registers: cr0_read_shadow")
+{
+    CHECK(vmcs::control_registers::cr0_read_shadow(0x80000031UL) == 0x80000031UL);
+}
+
+TEST_CASE("vmcs_control_registers: cr4_read_shadow hides vmxe")
+{
+    CHECK(vmcs::control_registers::cr4_read_shadow(0x000026A0UL) == 0x000006A0UL);
+}
+
+TEST_CASE("vmcs_control_registers: cr0_guest_value")
+{
+    MockRepository mocks;
+    setup_msrs(mocks);
+
+    CHECK(vmcs::control_registers::cr0_guest_value(0x00000010UL) == 0x80000031UL);
+}
+
+TEST_CASE("vmcs_control_registers: cr4_guest_value")
+{
+    MockRepository mocks;
+    setup_msrs(mocks);
+
+    CHECK(vmcs::control_registers::cr4_guest_value(0x000006A0UL) == 0x000026A0UL);
+    CHECK(vmcs::control_registers::cr4_guest_value(0x00800000UL) == 0x00002000UL);
+}
+
+#endif
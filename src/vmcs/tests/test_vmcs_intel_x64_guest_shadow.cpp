@@ -0,0 +1,251 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <vmcs/vmcs_intel_x64_guest_shadow.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+static std::map<uint64_t, uint64_t> g_vmcs_fields;
+static std::map<uint64_t, uint64_t> g_vmread_count;
+static std::map<uint64_t, uint64_t> g_vmwrite_count;
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    g_vmread_count[field]++;
+
+    *val = g_vmcs_fields[field];
+    return true;
+}
+
+static bool
+test_vmread_fails(uint64_t field, uint64_t *val) noexcept
+{
+    bfignored(field);
+    bfignored(val);
+
+    return false;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmwrite_count[field]++;
+
+    g_vmcs_fields[field] = val;
+    return true;
+}
+
+static bool
+test_vmwrite_fails(uint64_t field, uint64_t val) noexcept
+{
+    bfignored(field);
+    bfignored(val);
+
+    return false;
+}
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_vmcs_fields.clear();
+    g_vmread_count.clear();
+    g_vmwrite_count.clear();
+
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+}
+
+TEST_CASE("vmcs_guest_shadow: is_shadowed")
+{
+    CHECK(vmcs_intel_x64_guest_shadow::is_shadowed(vmcs::guest_cr0::addr));
+    CHECK(vmcs_intel_x64_guest_shadow::is_shadowed(vmcs::guest_ia32_efer::addr));
+    CHECK(vmcs_intel_x64_guest_shadow::is_shadowed(vmcs::guest_gs_base::addr));
+    CHECK_FALSE(vmcs_intel_x64_guest_shadow::is_shadowed(vmcs::guest_rip::addr));
+    CHECK_FALSE(vmcs_intel_x64_guest_shadow::is_shadowed(vmcs::exit_reason::addr));
+}
+
+TEST_CASE("vmcs_guest_shadow: get_reads_once")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    vmcs_intel_x64_guest_shadow shadow;
+
+    g_vmcs_fields[vmcs::guest_cr3::addr] = 42;
+
+    CHECK(shadow.get(vmcs::guest_cr3::addr, failed) == 42);
+    CHECK(shadow.get(vmcs::guest_cr3::addr, failed) == 42);
+    CHECK(shadow.get(vmcs::guest_cr3::addr, failed) == 42);
+    CHECK(g_vmread_count[vmcs::guest_cr3::addr] == 1);
+    CHECK_FALSE(failed);
+
+    shadow.invalidate();
+
+    CHECK(shadow.get(vmcs::guest_cr3::addr, failed) == 42);
+    CHECK(g_vmread_count[vmcs::guest_cr3::addr] == 2);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("vmcs_guest_shadow: get_not_shadowed")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    vmcs_intel_x64_guest_shadow shadow;
+
+    g_vmcs_fields[vmcs::guest_rip::addr] = 42;
+
+    CHECK(shadow.get(vmcs::guest_rip::addr, failed) == 42);
+    CHECK(shadow.get(vmcs::guest_rip::addr, failed) == 42);
+    CHECK(g_vmread_count[vmcs::guest_rip::addr] == 2);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("vmcs_guest_shadow: get_fails")
+{
+    MockRepository mocks;
+    mocks.OnCallFunc(_vmread).Do(test_vmread_fails);
+
+    auto failed = false;
+    vmcs_intel_x64_guest_shadow shadow;
+
+    CHECK(shadow.get(vmcs::guest_cr3::addr, failed) == 0);
+    CHECK(failed);
+}
+
+TEST_CASE("vmcs_guest_shadow: set_is_deferred")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    vmcs_intel_x64_guest_shadow shadow;
+
+    shadow.set(vmcs::guest_ia32_efer::addr, 1, failed);
+    shadow.set(vmcs::guest_ia32_efer::addr, 2, failed);
+
+    CHECK(shadow.is_dirty(vmcs::guest_ia32_efer::addr));
+    CHECK(shadow.get(vmcs::guest_ia32_efer::addr, failed) == 2);
+    CHECK(g_vmread_count[vmcs::guest_ia32_efer::addr] == 0);
+    CHECK(g_vmwrite_count[vmcs::guest_ia32_efer::addr] == 0);
+
+    shadow.flush(failed);
+
+    CHECK_FALSE(shadow.is_dirty(vmcs::guest_ia32_efer::addr));
+    CHECK(g_vmwrite_count[vmcs::guest_ia32_efer::addr] == 1);
+    CHECK(g_vmcs_fields[vmcs::guest_ia32_efer::addr] == 2);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("vmcs_guest_shadow: set_not_shadowed")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    vmcs_intel_x64_guest_shadow shadow;
+
+    shadow.set(vmcs::guest_rip::addr, 42, failed);
+
+    CHECK_FALSE(shadow.is_dirty(vmcs::guest_rip::addr));
+    CHECK(g_vmwrite_count[vmcs::guest_rip::addr] == 1);
+    CHECK(g_vmcs_fields[vmcs::guest_rip::addr] == 42);
+    CHECK_FALSE(failed);
+}
+
+TEST_CASE("vmcs_guest_shadow: flush_writes_each_field_at_most_once")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    vmcs_intel_x64_guest_shadow shadow;
+
+    for (auto i = 0U; i < 10; i++) {
+        shadow.set(vmcs::guest_cr0::addr, i, failed);
+        shadow.set(vmcs::guest_cr4::addr, i, failed);
+        shadow.set(vmcs::guest_ia32_pat::addr, i, failed);
+        shadow.set(vmcs::guest_ia32_sysenter_eip::addr, i, failed);
+        shadow.set(vmcs::guest_fs_base::addr, i, failed);
+        shadow.set(vmcs::guest_gs_base::addr, i, failed);
+    }
+
+    shadow.get(vmcs::guest_cr3::addr, failed);
+    shadow.flush(failed);
+
+    for (const auto &count : g_vmwrite_count) {
+        CHECK(count.second <= 1);
+    }
+
+    CHECK(g_vmwrite_count.size() == 6);
+    CHECK(g_vmwrite_count[vmcs::guest_cr3::addr] == 0);
+    CHECK(g_vmcs_fields[vmcs::guest_cr0::addr] == 9);
+    CHECK(g_vmcs_fields[vmcs::guest_gs_base::addr] == 9);
+    CHECK_FALSE(failed);
+
+    shadow.flush(failed);
+
+    for (const auto &count : g_vmwrite_count) {
+        CHECK(count.second <= 1);
+    }
+}
+
+TEST_CASE("vmcs_guest_shadow: flush_fails")
+{
+    MockRepository mocks;
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite_fails);
+
+    auto failed = false;
+    vmcs_intel_x64_guest_shadow shadow;
+
+    shadow.set(vmcs::guest_cr0::addr, 1, failed);
+    CHECK_FALSE(failed);
+
+    shadow.flush(failed);
+    CHECK(failed);
+    CHECK_FALSE(shadow.is_dirty(vmcs::guest_cr0::addr));
+}
+
+TEST_CASE("vmcs_guest_shadow: invalidate_discards_dirty_fields")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    auto failed = false;
+    vmcs_intel_x64_guest_shadow shadow;
+
+    shadow.set(vmcs::guest_cr0::addr, 1, failed);
+    shadow.invalidate();
+    shadow.flush(failed);
+
+    CHECK(g_vmwrite_count[vmcs::guest_cr0::addr] == 0);
+}
+
+#endif
@@ -0,0 +1,283 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <vmcs/vmcs_intel_x64_msr_area.h>
+#include <memory_manager/memory_manager_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+static std::map<uint64_t, uint64_t> g_vmcs_fields;
+static std::map<uint32_t, uint64_t> g_msrs;
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    *val = g_vmcs_fields[field];
+    return true;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmcs_fields[field] = val;
+    return true;
+}
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static uintptr_t
+test_virtptr_to_physint(void *ptr)
+{ return reinterpret_cast<uintptr_t>(ptr); }
+
+static void
+setup_intrinsics(MockRepository &mocks, bool dedicated)
+{
+    g_vmcs_fields.clear();
+
+    auto &&ctls = dedicated ? 0xFFFFFFFF00000000ULL : 0ULL;
+
+    g_msrs[msrs::ia32_vmx_true_exit_ctls::addr] = ctls;
+    g_msrs[msrs::ia32_vmx_true_entry_ctls::addr] = ctls;
+
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Do(test_virtptr_to_physint);
+
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+}
+
+static auto
+guest_area()
+{
+    return reinterpret_cast<vmcs_intel_x64_msr_area::entry_type *>(
+               g_vmcs_fields[vmcs::vm_entry_msr_load_address::addr]);
+}
+
+static auto
+host_area()
+{
+    return reinterpret_cast<vmcs_intel_x64_msr_area::entry_type *>(
+               g_vmcs_fields[vmcs::vm_exit_msr_load_address::addr]);
+}
+
+TEST_CASE("vmcs_msr_area: empty")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, true);
+
+    vmcs_intel_x64_msr_area area;
+
+    CHECK(area.size() == 0);
+    CHECK_FALSE(area.contains(x64::msrs::ia32_tsc_aux::addr));
+    CHECK_NOTHROW(area.remove(x64::msrs::ia32_tsc_aux::addr));
+    CHECK_THROWS(area.guest_value(x64::msrs::ia32_tsc_aux::addr));
+    CHECK_THROWS(area.set_host_value(x64::msrs::ia32_tsc_aux::addr, 1));
+
+    CHECK_NOTHROW(area.write_fields());
+    CHECK(g_vmcs_fields[vmcs::vm_entry_msr_load_count::addr] == 0);
+    CHECK(g_vmcs_fields.count(vmcs::vm_entry_msr_load_address::addr) == 0);
+}
+
+TEST_CASE("vmcs_msr_area: add")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, true);
+
+    vmcs_intel_x64_msr_area area;
+
+    CHECK_NOTHROW(area.add(x64::msrs::ia32_tsc_aux::addr, 1, 2));
+
+    CHECK(area.size() == 1);
+    CHECK(area.contains(x64::msrs::ia32_tsc_aux::addr));
+    CHECK(area.guest_value(x64::msrs::ia32_tsc_aux::addr) == 1);
+    CHECK(area.host_value(x64::msrs::ia32_tsc_aux::addr) == 2);
+
+    CHECK(g_vmcs_fields[vmcs::vm_entry_msr_load_count::addr] == 1);
+    CHECK(g_vmcs_fields[vmcs::vm_exit_msr_store_count::addr] == 1);
+    CHECK(g_vmcs_fields[vmcs::vm_exit_msr_load_count::addr] == 1);
+    CHECK(g_vmcs_fields[vmcs::vm_exit_msr_store_address::addr] ==
+          g_vmcs_fields[vmcs::vm_entry_msr_load_address::addr]);
+
+    CHECK(guest_area()[0].index == x64::msrs::ia32_tsc_aux::addr);
+    CHECK(guest_area()[0].data == 1);
+    CHECK(host_area()[0].index == x64::msrs::ia32_tsc_aux::addr);
+    CHECK(host_area()[0].data == 2);
+}
+
+TEST_CASE("vmcs_msr_area: add_sorted")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, true);
+
+    vmcs_intel_x64_msr_area area;
+
+    area.add(x64::msrs::ia32_tsc_aux::addr, 1, 1);
+    area.add(x64::msrs::ia32_star::addr, 2, 2);
+    area.add(x64::msrs::ia32_kernel_gs_base::addr, 3, 3);
+    area.add(x64::msrs::ia32_lstar::addr, 4, 4);
+
+    CHECK(area.size() == 4);
+
+    CHECK(guest_area()[0].index == x64::msrs::ia32_star::addr);
+    CHECK(guest_area()[1].index == x64::msrs::ia32_lstar::addr);
+    CHECK(guest_area()[2].index == x64::msrs::ia32_kernel_gs_base::addr);
+    CHECK(guest_area()[3].index == x64::msrs::ia32_tsc_aux::addr);
+
+    for (auto i = 0; i < 4; i++) {
+        CHECK(host_area()[i].index == guest_area()[i].index);
+        CHECK(host_area()[i].data == guest_area()[i].data);
+    }
+}
+
+TEST_CASE("vmcs_msr_area: add_existing_updates")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, true);
+
+    vmcs_intel_x64_msr_area area;
+
+    area.add(x64::msrs::ia32_tsc_aux::addr, 1, 2);
+    area.add(x64::msrs::ia32_tsc_aux::addr, 3, 4);
+
+    CHECK(area.size() == 1);
+    CHECK(area.guest_value(x64::msrs::ia32_tsc_aux::addr) == 3);
+    CHECK(area.host_value(x64::msrs::ia32_tsc_aux::addr) == 4);
+}
+
+TEST_CASE("vmcs_msr_area: set_values")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, true);
+
+    vmcs_intel_x64_msr_area area;
+
+    area.add(x64::msrs::ia32_tsc_aux::addr, 1, 2);
+    area.set_guest_value(x64::msrs::ia32_tsc_aux::addr, 5);
+    area.set_host_value(x64::msrs::ia32_tsc_aux::addr, 6);
+
+    CHECK(guest_area()[0].data == 5);
+    CHECK(host_area()[0].data == 6);
+
+    guest_area()[0].data = 7;
+    CHECK(area.guest_value(x64::msrs::ia32_tsc_aux::addr) == 7);
+}
+
+TEST_CASE("vmcs_msr_area: remove")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, true);
+
+    vmcs_intel_x64_msr_area area;
+
+    area.add(x64::msrs::ia32_star::addr, 1, 1);
+    area.add(x64::msrs::ia32_lstar::addr, 2, 2);
+    area.add(x64::msrs::ia32_tsc_aux::addr, 3, 3);
+
+    CHECK_NOTHROW(area.remove(x64::msrs::ia32_lstar::addr));
+
+    CHECK(area.size() == 2);
+    CHECK_FALSE(area.contains(x64::msrs::ia32_lstar::addr));
+    CHECK(g_vmcs_fields[vmcs::vm_entry_msr_load_count::addr] == 2);
+
+    CHECK(guest_area()[0].index == x64::msrs::ia32_star::addr);
+    CHECK(guest_area()[1].index == x64::msrs::ia32_tsc_aux::addr);
+    CHECK(host_area()[1].data == 3);
+}
+
+TEST_CASE("vmcs_msr_area: full")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, true);
+
+    vmcs_intel_x64_msr_area area;
+
+    for (auto i = 0U; i < vmcs_intel_x64_msr_area::max_entries; i++) {
+        area.add(0x1000U + i, i, i);
+    }
+
+    CHECK_THROWS(area.add(0x2000U, 0, 0));
+    CHECK_NOTHROW(area.add(0x1000U, 1, 1));
+    CHECK(area.size() == vmcs_intel_x64_msr_area::max_entries);
+}
+
+TEST_CASE("vmcs_msr_area: dedicated_fields")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, true);
+
+    vmcs_intel_x64_msr_area area;
+
+    CHECK(vmcs_intel_x64_msr_area::is_dedicated(msrs::ia32_efer::addr));
+    CHECK(vmcs_intel_x64_msr_area::is_dedicated(x64::msrs::ia32_pat::addr));
+    CHECK(vmcs_intel_x64_msr_area::is_dedicated(msrs::ia32_perf_global_ctrl::addr));
+    CHECK_FALSE(vmcs_intel_x64_msr_area::is_dedicated(x64::msrs::ia32_tsc_aux::addr));
+
+    area.add(msrs::ia32_efer::addr, 1, 2);
+    area.add(x64::msrs::ia32_pat::addr, 3, 4);
+    area.add(msrs::ia32_perf_global_ctrl::addr, 5, 6);
+
+    CHECK(area.size() == 0);
+    CHECK(g_vmcs_fields[vmcs::guest_ia32_efer::addr] == 1);
+    CHECK(g_vmcs_fields[vmcs::host_ia32_efer::addr] == 2);
+    CHECK(g_vmcs_fields[vmcs::guest_ia32_pat::addr] == 3);
+    CHECK(g_vmcs_fields[vmcs::host_ia32_pat::addr] == 4);
+    CHECK(g_vmcs_fields[vmcs::guest_ia32_perf_global_ctrl::addr] == 5);
+    CHECK(g_vmcs_fields[vmcs::host_ia32_perf_global_ctrl::addr] == 6);
+
+    CHECK_THROWS(area.guest_value(msrs::ia32_efer::addr));
+    CHECK_THROWS(area.set_guest_value(msrs::ia32_efer::addr, 7));
+    CHECK(g_vmcs_fields[vmcs::guest_ia32_efer::addr] == 1);
+    CHECK(area.host_value(x64::msrs::ia32_pat::addr) == 4);
+
+    CHECK((g_vmcs_fields[vmcs::vm_entry_controls::addr] & vmcs::vm_entry_controls::load_ia32_efer::mask) != 0);
+    CHECK((g_vmcs_fields[vmcs::vm_exit_controls::addr] & vmcs::vm_exit_controls::save_ia32_efer::mask) != 0);
+
+    CHECK_NOTHROW(area.remove(msrs::ia32_efer::addr));
+    CHECK(g_vmcs_fields[vmcs::guest_ia32_efer::addr] == 1);
+}
+
+TEST_CASE("vmcs_msr_area: dedicated_fields_not_supported")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, false);
+
+    vmcs_intel_x64_msr_area area;
+
+    CHECK_FALSE(vmcs_intel_x64_msr_area::is_dedicated(msrs::ia32_efer::addr));
+
+    area.add(msrs::ia32_efer::addr, 1, 2);
+
+    CHECK(area.size() == 1);
+    CHECK(area.contains(msrs::ia32_efer::addr));
+    CHECK(guest_area()[0].index == msrs::ia32_efer::addr);
+    CHECK(g_vmcs_fields.count(vmcs::guest_ia32_efer::addr) == 0);
+}
+
+#endif
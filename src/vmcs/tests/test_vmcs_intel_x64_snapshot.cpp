@@ -0,0 +1,282 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <map>
+
+#include <vmcs/vmcs_intel_x64_snapshot.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+static std::map<uint64_t, uint64_t> g_vmcs_fields;
+static std::map<uint32_t, uint64_t> g_msrs;
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    *val = g_vmcs_fields[field];
+    return true;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmcs_fields[field] = val;
+    return true;
+}
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static void
+setup_intrinsics(MockRepository &mocks)
+{
+    g_vmcs_fields.clear();
+    g_msrs.clear();
+
+    g_msrs[msrs::ia32_vmx_basic::addr] = 0x0000000000000042ULL;
+    g_msrs[msrs::ia32_vmx_true_pinbased_ctls::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_true_exit_ctls::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_true_entry_ctls::addr] = 0xFFFFFFFF00000000ULL;
+
+    g_vmcs_fields[vmcs::pin_based_vm_execution_controls::addr] = 0x16;
+    g_vmcs_fields[vmcs::exit_reason::addr] = 0x1E;
+    g_vmcs_fields[vmcs::guest_cs_selector::addr] = 0x10;
+    g_vmcs_fields[vmcs::guest_cr3::addr] = 0x1000;
+    g_vmcs_fields[vmcs::guest_ia32_perf_global_ctrl::addr] = 0x3;
+    g_vmcs_fields[vmcs::host_cr3::addr] = 0x2000;
+
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+}
+
+TEST_CASE("vmcs_snapshot: empty")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+
+    CHECK_FALSE(snapshot.is_valid());
+    CHECK(snapshot.size() == 0);
+    CHECK_FALSE(snapshot.contains(vmcs::guest_cr3::addr));
+    CHECK_THROWS(snapshot.get(vmcs::guest_cr3::addr));
+    CHECK_THROWS(snapshot.restore());
+    CHECK_THROWS(snapshot.serialize());
+}
+
+TEST_CASE("vmcs_snapshot: capture")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+
+    CHECK(snapshot.is_valid());
+    CHECK(snapshot.revision_id() == 0x42);
+    CHECK(snapshot.get(vmcs::pin_based_vm_execution_controls::addr) == 0x16);
+    CHECK(snapshot.get(vmcs::exit_reason::addr) == 0x1E);
+    CHECK(snapshot.get(vmcs::guest_cs_selector::addr) == 0x10);
+    CHECK(snapshot.get(vmcs::guest_cr3::addr) == 0x1000);
+    CHECK(snapshot.get(vmcs::host_cr3::addr) == 0x2000);
+    CHECK(snapshot.get(vmcs::host_rip::addr) == 0);
+}
+
+TEST_CASE("vmcs_snapshot: capture classes")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture(vmcs_intel_x64_snapshot::control | vmcs_intel_x64_snapshot::host_state));
+
+    CHECK(snapshot.contains(vmcs::pin_based_vm_execution_controls::addr));
+    CHECK(snapshot.contains(vmcs::host_cr3::addr));
+    CHECK_FALSE(snapshot.contains(vmcs::exit_reason::addr));
+    CHECK_FALSE(snapshot.contains(vmcs::guest_cr3::addr));
+}
+
+TEST_CASE("vmcs_snapshot: capture skips fields that do not exist")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    g_msrs[msrs::ia32_vmx_true_entry_ctls::addr] = 0;
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+
+    CHECK(snapshot.contains(vmcs::guest_cr3::addr));
+    CHECK_FALSE(snapshot.contains(vmcs::guest_ia32_perf_global_ctrl::addr));
+}
+
+TEST_CASE("vmcs_snapshot: restore")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+
+    g_vmcs_fields.clear();
+    CHECK_NOTHROW(snapshot.restore());
+
+    CHECK(g_vmcs_fields[vmcs::pin_based_vm_execution_controls::addr] == 0x16);
+    CHECK(g_vmcs_fields[vmcs::guest_cs_selector::addr] == 0x10);
+    CHECK(g_vmcs_fields[vmcs::guest_cr3::addr] == 0x1000);
+    CHECK(g_vmcs_fields[vmcs::guest_ia32_perf_global_ctrl::addr] == 0x3);
+    CHECK(g_vmcs_fields[vmcs::host_cr3::addr] == 0x2000);
+    CHECK(g_vmcs_fields.count(vmcs::exit_reason::addr) == 0);
+}
+
+TEST_CASE("vmcs_snapshot: restore classes")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+
+    g_vmcs_fields.clear();
+    CHECK_NOTHROW(snapshot.restore(vmcs_intel_x64_snapshot::guest_state));
+
+    CHECK(g_vmcs_fields[vmcs::guest_cr3::addr] == 0x1000);
+    CHECK(g_vmcs_fields.count(vmcs::host_cr3::addr) == 0);
+    CHECK(g_vmcs_fields.count(vmcs::pin_based_vm_execution_controls::addr) == 0);
+}
+
+TEST_CASE("vmcs_snapshot: restore skips fields that do not exist")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+
+    g_vmcs_fields.clear();
+    g_msrs[msrs::ia32_vmx_true_entry_ctls::addr] = 0;
+
+    CHECK_NOTHROW(snapshot.restore());
+    CHECK(g_vmcs_fields[vmcs::guest_cr3::addr] == 0x1000);
+    CHECK(g_vmcs_fields.count(vmcs::guest_ia32_perf_global_ctrl::addr) == 0);
+}
+
+TEST_CASE("vmcs_snapshot: restore different revision id")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+
+    g_msrs[msrs::ia32_vmx_basic::addr] = 0x0000000000000043ULL;
+    CHECK_THROWS(snapshot.restore());
+}
+
+TEST_CASE("vmcs_snapshot: serialize / deserialize")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+
+    auto &&image = snapshot.serialize();
+    CHECK(image.size() ==
+          sizeof(vmcs_intel_x64_snapshot::header_type) +
+          snapshot.size() * sizeof(vmcs_intel_x64_snapshot::entry_type));
+
+    vmcs_intel_x64_snapshot copy;
+    CHECK_NOTHROW(copy.deserialize(image));
+
+    CHECK(copy.is_valid());
+    CHECK(copy.size() == snapshot.size());
+    CHECK(copy.revision_id() == snapshot.revision_id());
+    CHECK(copy.get(vmcs::guest_cr3::addr) == 0x1000);
+    CHECK(copy.get(vmcs::host_cr3::addr) == 0x2000);
+}
+
+TEST_CASE("vmcs_snapshot: deserialize corrupt image")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+
+    auto &&image = snapshot.serialize();
+    auto &&header_size = sizeof(vmcs_intel_x64_snapshot::header_type);
+    auto &&entry_size = sizeof(vmcs_intel_x64_snapshot::entry_type);
+
+    vmcs_intel_x64_snapshot copy;
+
+    auto truncated = image;
+    truncated.resize(header_size - 1);
+    CHECK_THROWS(copy.deserialize(truncated));
+    CHECK_FALSE(copy.is_valid());
+
+    auto short_image = image;
+    short_image.resize(image.size() - entry_size);
+    CHECK_THROWS(copy.deserialize(short_image));
+    CHECK_FALSE(copy.is_valid());
+
+    auto bad_magic = image;
+    bad_magic[0] = static_cast<gsl::byte>(0);
+    CHECK_THROWS(copy.deserialize(bad_magic));
+    CHECK_FALSE(copy.is_valid());
+
+    auto bad_value = image;
+    bad_value[header_size + 8] = static_cast<gsl::byte>(0xFF);
+    CHECK_THROWS(copy.deserialize(bad_value));
+    CHECK_FALSE(copy.is_valid());
+
+    auto out_of_order = image;
+    std::swap_ranges(out_of_order.begin() + header_size,
+                     out_of_order.begin() + header_size + entry_size,
+                     out_of_order.begin() + header_size + entry_size);
+    CHECK_THROWS(copy.deserialize(out_of_order));
+    CHECK_FALSE(copy.is_valid());
+}
+
+TEST_CASE("vmcs_snapshot: reset")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks);
+
+    vmcs_intel_x64_snapshot snapshot;
+    CHECK_NOTHROW(snapshot.capture());
+    CHECK_NOTHROW(snapshot.reset());
+
+    CHECK_FALSE(snapshot.is_valid());
+    CHECK(snapshot.size() == 0);
+}
+
+#endif
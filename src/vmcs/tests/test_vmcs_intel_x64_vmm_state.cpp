@@ -24,6 +24,7 @@
 #include <hippomocks.h>
 #include <bftypes.h>
 
+#include <vmcs/vmcs_intel_x64_nm_handler.h>
 #include <vmcs/vmcs_intel_x64_vmm_state.h>
 
 #include <intrinsics/x86/common_x64.h>
@@ -109,4 +110,27 @@ TEST_CASE("vmcs: vmm_state")
     vmcs_intel_x64_vmm_state state{};
 }
 
+TEST_CASE("vmcs: vmm_state_nm_handler")
+{
+    MockRepository mocks;
+    setup_vmm_state(mocks);
+
+    vmcs_intel_x64_vmm_state state{};
+
+    auto &&idt = reinterpret_cast<uint64_t *>(state.idt_base());
+    auto &&tss = reinterpret_cast<tss_x64 *>(state.tr_base());
+
+    auto offset = (idt[14] & 0x000000000000FFFFULL) |
+                  ((idt[14] & 0xFFFF000000000000ULL) >> 32) |
+                  ((idt[15] & 0x00000000FFFFFFFFULL) << 32);
+
+    CHECK(offset == reinterpret_cast<uint64_t>(vmcs_nm_handler));
+    CHECK(((idt[14] >> 16) & 0xFFFF) == state.cs());
+    CHECK((idt[14] & 0x0000800000000000ULL) != 0);
+    CHECK(((idt[14] >> 32) & 0x7) == 1);
+
+    CHECK(tss->ist1 != 0);
+    CHECK((tss->ist1 & 0xF) == 0);
+}
+
 #endif
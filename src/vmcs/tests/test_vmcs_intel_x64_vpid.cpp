@@ -0,0 +1,487 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <catch/catch.hpp>
+#include <hippomocks.h>
+
+#include <vector>
+
+#include <vmcs/vmcs_intel_x64_vpid.h>
+#include <intrinsics/x86/intel_x64.h>
+
+#ifdef _HIPPOMOCKS__ENABLE_CFUNC_MOCKING_SUPPORT
+
+using namespace intel_x64;
+
+struct invvpid_call
+{
+    uint64_t type;
+    uint64_t vpid;
+    uint64_t addr;
+};
+
+static std::map<uint64_t, uint64_t> g_vmcs_fields;
+static std::map<uint32_t, uint64_t> g_msrs;
+static std::vector<invvpid_call> g_invvpid_calls;
+static bool g_invvpid_fails = false;
+static uint64_t g_cpuid = 0;
+
+static bool
+test_vmread(uint64_t field, uint64_t *val) noexcept
+{
+    *val = g_vmcs_fields[field];
+    return true;
+}
+
+static bool
+test_vmwrite(uint64_t field, uint64_t val) noexcept
+{
+    g_vmcs_fields[field] = val;
+    return true;
+}
+
+static uint64_t
+test_read_msr(uint32_t addr) noexcept
+{ return g_msrs[addr]; }
+
+static uint64_t
+test_thread_context_cpuid() noexcept
+{ return g_cpuid; }
+
+static bool
+test_invvpid(uint64_t type, void *ptr) noexcept
+{
+    auto &&descriptor = static_cast<uint64_t *>(ptr);
+    g_invvpid_calls.push_back({type, descriptor[0], descriptor[1]});
+
+    return !g_invvpid_fails;
+}
+
+static void
+setup_intrinsics(MockRepository &mocks, uint64_t ept_vpid_cap)
+{
+    g_vmcs_fields.clear();
+    g_invvpid_calls.clear();
+    g_invvpid_fails = false;
+    g_cpuid = 0;
+
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = 0xFFFFFFFF00000000ULL;
+    g_msrs[msrs::ia32_vmx_ept_vpid_cap::addr] = ept_vpid_cap;
+
+    mocks.OnCallFunc(_vmread).Do(test_vmread);
+    mocks.OnCallFunc(_vmwrite).Do(test_vmwrite);
+    mocks.OnCallFunc(_read_msr).Do(test_read_msr);
+    mocks.OnCallFunc(_invvpid).Do(test_invvpid);
+    mocks.OnCallFunc(thread_context_cpuid).Do(test_thread_context_cpuid);
+}
+
+static const auto g_all_invvpid =
+    msrs::ia32_vmx_ept_vpid_cap::invvpid_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::invvpid_individual_address_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::invvpid_single_context_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::invvpid_all_context_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::invvpid_single_context_retaining_globals_support::mask;
+
+static const auto g_all_context_invvpid =
+    msrs::ia32_vmx_ept_vpid_cap::invvpid_support::mask |
+    msrs::ia32_vmx_ept_vpid_cap::invvpid_all_context_support::mask;
+
+TEST_CASE("vpid_allocator: allocate unique")
+{
+    auto &&allocator = vpid_allocator_intel_x64::instance();
+    auto &&size = allocator->size();
+
+    auto &&vpid1 = allocator->allocate();
+    auto &&vpid2 = allocator->allocate();
+
+    CHECK(vpid1 != 0);
+    CHECK(vpid2 != 0);
+    CHECK(vpid1 != vpid2);
+    CHECK(allocator->is_allocated(vpid1));
+    CHECK(allocator->is_allocated(vpid2));
+    CHECK(allocator->size() == size + 2);
+
+    allocator->free(vpid1);
+    allocator->free(vpid2);
+
+    CHECK_FALSE(allocator->is_allocated(vpid1));
+    CHECK_FALSE(allocator->is_allocated(vpid2));
+    CHECK(allocator->size() == size);
+}
+
+TEST_CASE("vpid_allocator: free invalid")
+{
+    auto &&allocator = vpid_allocator_intel_x64::instance();
+    auto &&size = allocator->size();
+
+    CHECK_NOTHROW(allocator->free(0));
+    CHECK_NOTHROW(allocator->free(0xFFFF));
+    CHECK_FALSE(allocator->is_allocated(0));
+    CHECK(allocator->size() == size);
+}
+
+TEST_CASE("vpid_allocator: exhausted")
+{
+    auto &&allocator = vpid_allocator_intel_x64::instance();
+    auto &&vpids = std::vector<vpid_allocator_intel_x64::vpid_type>();
+
+    while (auto &&vpid = allocator->allocate()) {
+        vpids.push_back(vpid);
+    }
+
+    CHECK(allocator->size() == vpid_allocator_intel_x64::max_vpids);
+    CHECK(allocator->allocate() == 0);
+
+    allocator->free(vpids.back());
+    CHECK(allocator->allocate() == vpids.back());
+
+    for (auto vpid : vpids) {
+        allocator->free(vpid);
+    }
+
+    CHECK(allocator->size() == 0);
+}
+
+TEST_CASE("vmcs_vpid: not supported")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, 0);
+
+    vmcs_intel_x64_vpid vpid;
+
+    CHECK_FALSE(vmcs_intel_x64_vpid::is_supported());
+    CHECK_NOTHROW(vpid.write_fields());
+
+    CHECK(vpid.id() == 0);
+    CHECK(g_vmcs_fields.count(vmcs::virtual_processor_identifier::addr) == 0);
+    CHECK(vmcs::secondary_processor_based_vm_execution_controls::enable_vpid::is_disabled());
+    CHECK(g_invvpid_calls.empty());
+}
+
+TEST_CASE("vmcs_vpid: not supported without enable vpid")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = 0;
+
+    vmcs_intel_x64_vpid vpid;
+
+    CHECK_FALSE(vmcs_intel_x64_vpid::is_supported());
+    CHECK_NOTHROW(vpid.write_fields());
+    CHECK(vpid.id() == 0);
+}
+
+TEST_CASE("vmcs_vpid: not supported without invvpid context support")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, msrs::ia32_vmx_ept_vpid_cap::invvpid_support::mask |
+                     msrs::ia32_vmx_ept_vpid_cap::invvpid_individual_address_support::mask);
+
+    CHECK_FALSE(vmcs_intel_x64_vpid::is_supported());
+}
+
+TEST_CASE("vmcs_vpid: write fields")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    auto &&size = vpid_allocator_intel_x64::instance()->size();
+
+    {
+        vmcs_intel_x64_vpid vpid;
+
+        CHECK(vmcs_intel_x64_vpid::is_supported());
+        CHECK_NOTHROW(vpid.write_fields());
+
+        CHECK(vpid.id() != 0);
+        CHECK(vpid_allocator_intel_x64::instance()->is_allocated(vpid.id()));
+        CHECK(vpid_allocator_intel_x64::instance()->size() == size + 1);
+        CHECK(g_vmcs_fields[vmcs::virtual_processor_identifier::addr] == vpid.id());
+        CHECK(vmcs::secondary_processor_based_vm_execution_controls::enable_vpid::is_enabled());
+
+        REQUIRE(g_invvpid_calls.size() == 1);
+        CHECK(g_invvpid_calls[0].type == 1);
+        CHECK(g_invvpid_calls[0].vpid == vpid.id());
+
+        auto &&id = vpid.id();
+
+        g_invvpid_calls.clear();
+        CHECK_NOTHROW(vpid.write_fields());
+
+        CHECK(vpid.id() == id);
+        CHECK(g_invvpid_calls.empty());
+    }
+
+    CHECK(vpid_allocator_intel_x64::instance()->size() == size);
+}
+
+TEST_CASE("vmcs_vpid: write fields out of vpids")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    auto &&allocator = vpid_allocator_intel_x64::instance();
+    auto &&vpids = std::vector<vpid_allocator_intel_x64::vpid_type>();
+
+    while (auto &&id = allocator->allocate()) {
+        vpids.push_back(id);
+    }
+
+    vmcs_intel_x64_vpid vpid;
+
+    CHECK_NOTHROW(vpid.write_fields());
+    CHECK(vpid.id() == 0);
+    CHECK(vmcs::secondary_processor_based_vm_execution_controls::enable_vpid::is_disabled());
+
+    for (auto id : vpids) {
+        allocator->free(id);
+    }
+}
+
+TEST_CASE("vmcs_vpid: write fields invvpid fails")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    auto &&size = vpid_allocator_intel_x64::instance()->size();
+
+    vmcs_intel_x64_vpid vpid;
+    g_invvpid_fails = true;
+
+    CHECK_THROWS(vpid.write_fields());
+    CHECK(vpid.id() == 0);
+    CHECK(vpid_allocator_intel_x64::instance()->size() == size);
+    CHECK(vmcs::secondary_processor_based_vm_execution_controls::enable_vpid::is_disabled());
+}
+
+TEST_CASE("vmcs_vpid: recycled")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    auto &&allocator = vpid_allocator_intel_x64::instance();
+    auto &&vpids = std::vector<vpid_allocator_intel_x64::vpid_type>();
+
+    // Use up all but one VPID, so that the VPID that is freed is the only
+    // one left to hand out
+
+    while (allocator->size() < vpid_allocator_intel_x64::max_vpids - 1) {
+        vpids.push_back(allocator->allocate());
+    }
+
+    vmcs_intel_x64_vpid::vpid_type id = 0;
+
+    {
+        vmcs_intel_x64_vpid vpid;
+        CHECK_NOTHROW(vpid.write_fields());
+
+        id = vpid.id();
+        CHECK(id != 0);
+    }
+
+    CHECK_FALSE(allocator->is_allocated(id));
+
+    g_invvpid_calls.clear();
+
+    vmcs_intel_x64_vpid vpid;
+    CHECK_NOTHROW(vpid.write_fields());
+
+    CHECK(vpid.id() == id);
+
+    REQUIRE(g_invvpid_calls.size() == 1);
+    CHECK(g_invvpid_calls[0].type == 1);
+    CHECK(g_invvpid_calls[0].vpid == id);
+
+    for (auto vpid_id : vpids) {
+        allocator->free(vpid_id);
+    }
+}
+
+TEST_CASE("vmcs_vpid: move")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    auto &&size = vpid_allocator_intel_x64::instance()->size();
+
+    {
+        vmcs_intel_x64_vpid vpid1;
+        CHECK_NOTHROW(vpid1.write_fields());
+
+        auto &&id = vpid1.id();
+        vmcs_intel_x64_vpid vpid2{std::move(vpid1)};
+
+        CHECK(vpid1.id() == 0);
+        CHECK(vpid2.id() == id);
+        CHECK(vpid_allocator_intel_x64::instance()->size() == size + 1);
+    }
+
+    CHECK(vpid_allocator_intel_x64::instance()->size() == size);
+}
+
+TEST_CASE("vmcs_vpid: flush")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush(0));
+    CHECK(g_invvpid_calls.empty());
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush(42));
+
+    REQUIRE(g_invvpid_calls.size() == 1);
+    CHECK(g_invvpid_calls[0].type == 1);
+    CHECK(g_invvpid_calls[0].vpid == 42);
+}
+
+TEST_CASE("vmcs_vpid: flush all contexts fallback")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_context_invvpid);
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush(42));
+
+    REQUIRE(g_invvpid_calls.size() == 1);
+    CHECK(g_invvpid_calls[0].type == 2);
+}
+
+TEST_CASE("vmcs_vpid: flush non-global")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush_non_global(0));
+    CHECK(g_invvpid_calls.empty());
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush_non_global(42));
+
+    REQUIRE(g_invvpid_calls.size() == 1);
+    CHECK(g_invvpid_calls[0].type == 3);
+    CHECK(g_invvpid_calls[0].vpid == 42);
+}
+
+TEST_CASE("vmcs_vpid: flush non-global fallback")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_context_invvpid);
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush_non_global(42));
+
+    REQUIRE(g_invvpid_calls.size() == 1);
+    CHECK(g_invvpid_calls[0].type == 2);
+}
+
+TEST_CASE("vmcs_vpid: flush address")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush_address(0, 0x1000));
+    CHECK(g_invvpid_calls.empty());
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush_address(42, 0x1000));
+
+    REQUIRE(g_invvpid_calls.size() == 1);
+    CHECK(g_invvpid_calls[0].type == 0);
+    CHECK(g_invvpid_calls[0].vpid == 42);
+    CHECK(g_invvpid_calls[0].addr == 0x1000);
+}
+
+TEST_CASE("vmcs_vpid: flush address fallback")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_context_invvpid);
+
+    CHECK_NOTHROW(vmcs_intel_x64_vpid::flush_address(42, 0x1000));
+
+    REQUIRE(g_invvpid_calls.size() == 1);
+    CHECK(g_invvpid_calls[0].type == 2);
+}
+
+TEST_CASE("vmcs_vpid: flush fails")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    g_invvpid_fails = true;
+
+    CHECK_THROWS(vmcs_intel_x64_vpid::flush(42));
+    CHECK_THROWS(vmcs_intel_x64_vpid::flush_non_global(42));
+    CHECK_THROWS(vmcs_intel_x64_vpid::flush_address(42, 0x1000));
+}
+
+TEST_CASE("vmcs_vpid: member flush")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    vmcs_intel_x64_vpid vpid;
+
+    CHECK_NOTHROW(vpid.flush());
+    CHECK(g_invvpid_calls.empty());
+
+    CHECK_NOTHROW(vpid.write_fields());
+    g_invvpid_calls.clear();
+
+    CHECK_NOTHROW(vpid.flush());
+    CHECK_NOTHROW(vpid.flush_non_global());
+    CHECK_NOTHROW(vpid.flush_address(0x1000));
+
+    REQUIRE(g_invvpid_calls.size() == 3);
+    CHECK(g_invvpid_calls[0].vpid == vpid.id());
+    CHECK(g_invvpid_calls[1].vpid == vpid.id());
+    CHECK(g_invvpid_calls[2].vpid == vpid.id());
+}
+
+TEST_CASE("vmcs_vpid: load")
+{
+    MockRepository mocks;
+    setup_intrinsics(mocks, g_all_invvpid);
+
+    vmcs_intel_x64_vpid vpid;
+
+    CHECK_NOTHROW(vpid.load());
+    CHECK(g_invvpid_calls.empty());
+
+    CHECK_NOTHROW(vpid.write_fields());
+    g_invvpid_calls.clear();
+
+    CHECK_NOTHROW(vpid.load());
+    CHECK(g_invvpid_calls.empty());
+
+    g_cpuid = 1;
+    CHECK_NOTHROW(vpid.load());
+    CHECK_NOTHROW(vpid.load());
+
+    REQUIRE(g_invvpid_calls.size() == 1);
+    CHECK(g_invvpid_calls[0].type == 1);
+    CHECK(g_invvpid_calls[0].vpid == vpid.id());
+
+    g_cpuid = 0;
+    CHECK_NOTHROW(vpid.load());
+
+    REQUIRE(g_invvpid_calls.size() == 2);
+    CHECK(g_invvpid_calls[1].vpid == vpid.id());
+}
+
+#endif
@@ -35,6 +35,14 @@ void
 vmxon_intel_x64::start()
 {
     this->check_cpuid_vmx_supported();
+
+    // From here on, the capability MSRs are read from this CPU's snapshot
+
+    intel_x64::vmx_capabilities::capture();
+
+    auto ___ = gsl::on_failure([&]
+    { intel_x64::vmx_capabilities::release(); });
+
     this->check_vmx_capabilities_msr();
     this->check_ia32_vmx_cr0_fixed_msr();
     this->check_ia32_feature_control_msr();
@@ -60,6 +68,8 @@ vmxon_intel_x64::stop()
     this->execute_vmxoff();
     this->disable_vmx();
     this->release_vmxon_region();
+
+    intel_x64::vmx_capabilities::release();
 }
 
 void
@@ -368,6 +368,38 @@ TEST_CASE("vmxon: start_virt_to_phys_failure")
     CHECK_THROWS(vmxon.start());
 }
 
+TEST_CASE("vmxon: start_captures_vmx_capabilities")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+
+    setup_intrinsics(mocks, mm);
+
+    vmxon_intel_x64 vmxon{};
+    CHECK_NOTHROW(vmxon.start());
+    CHECK(intel_x64::vmx_capabilities::is_captured());
+
+    g_msrs[intel_x64::msrs::ia32_vmx_basic::addr] = 0;
+    CHECK(intel_x64::msrs::ia32_vmx_basic::true_based_controls::is_enabled());
+
+    CHECK_NOTHROW(vmxon.stop());
+    CHECK_FALSE(intel_x64::vmx_capabilities::is_captured());
+}
+
+TEST_CASE("vmxon: start_failure_releases_vmx_capabilities")
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+
+    setup_intrinsics(mocks, mm);
+
+    vmxon_intel_x64 vmxon{};
+
+    g_msrs[intel_x64::msrs::ia32_vmx_basic::addr] = (1ULL << 55);
+    CHECK_THROWS(vmxon.start());
+    CHECK_FALSE(intel_x64::vmx_capabilities::is_captured());
+}
+
 TEST_CASE("vmxon: stop_success")
 {
     MockRepository mocks;